@@ -44,8 +44,99 @@
 #include "covariance_functions.h"
 #include "math_tools.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 namespace covariance_functions
 {
+    namespace
+    {
+        bool parametersChanged(const Eigen::VectorXd& current, const Eigen::Ref<const Eigen::VectorXd>& params)
+        {
+            return current.size() != params.size() || current != params;
+        }
+
+        // grid indices of the locations relative to origin, false if a location is not on the grid
+        bool gridIndex(const Eigen::Ref<const Eigen::VectorXd>& x, double origin, double spacing, std::vector<int>& index)
+        {
+            index.resize(x.size());
+            for (int i = 0; i < x.size(); ++i)
+            {
+                double cells = (x(i) - origin) / spacing;
+                double rounded = std::round(cells);
+                // all locations have to be on the grid, up to rounding errors
+                if (!(std::abs(cells - rounded) < 1e-6))
+                {
+                    return false;
+                }
+                index[i] = static_cast<int>(rounded);
+            }
+            return true;
+        }
+    }
+
+    /* GridCache */
+    void GridCache::setSpacing(double spacing)
+    {
+        if (spacing != spacing_)
+        {
+            spacing_ = spacing;
+            clear();
+        }
+    }
+
+    void GridCache::clear()
+    {
+        values_.clear(); // keeps the memory
+    }
+
+    void GridCache::reserve(int max_cells)
+    {
+        values_.reserve(max_cells);
+        x_index_.reserve(max_cells);
+        y_index_.reserve(max_cells);
+    }
+
+    bool GridCache::index(const Eigen::Ref<const Eigen::VectorXd>& x, const Eigen::Ref<const Eigen::VectorXd>& y)
+    {
+        if (spacing_ <= 0.0 || x.size() == 0 || y.size() == 0)
+        {
+            return false;
+        }
+
+        double origin = x(0);
+        return gridIndex(x, origin, spacing_, x_index_) && gridIndex(y, origin, spacing_, y_index_);
+    }
+
+    int GridCache::maxDistance() const
+    {
+        std::pair<std::vector<int>::const_iterator, std::vector<int>::const_iterator> x_range =
+            std::minmax_element(x_index_.begin(), x_index_.end());
+        std::pair<std::vector<int>::const_iterator, std::vector<int>::const_iterator> y_range =
+            std::minmax_element(y_index_.begin(), y_index_.end());
+        return std::max(*x_range.second - *y_range.first, *y_range.second - *x_range.first);
+    }
+
+    Eigen::Map<Eigen::ArrayXd> GridCache::extend(int size)
+    {
+        int first = this->size();
+        assert(size >= first);
+        values_.resize(size);
+        return Eigen::Map<Eigen::ArrayXd>(values_.data() + first, size - first);
+    }
+
+    void GridCache::lookup(Eigen::Ref<Eigen::MatrixXd> result) const
+    {
+        assert(result.rows() == static_cast<int>(x_index_.size()) && result.cols() == static_cast<int>(y_index_.size()));
+        for (int j = 0; j < result.cols(); ++j)
+        {
+            for (int i = 0; i < result.rows(); ++i)
+            {
+                result(i, j) = values_[std::abs(x_index_[i] - y_index_[j])];
+            }
+        }
+    }
 
     /* PeriodicSquareExponential */
     PeriodicSquareExponential::PeriodicSquareExponential() :
@@ -56,7 +147,43 @@ namespace covariance_functions
 
     Eigen::MatrixXd PeriodicSquareExponential::evaluate(const Eigen::VectorXd& x, const Eigen::VectorXd& y)
     {
+        Eigen::MatrixXd result(x.size(), y.size());
+        evaluate(x, y, result);
+        return result;
+    }
+
+    void PeriodicSquareExponential::evaluate(const Eigen::Ref<const Eigen::VectorXd>& x,
+                                             const Eigen::Ref<const Eigen::VectorXd>& y,
+                                             Eigen::Ref<Eigen::MatrixXd> result)
+    {
+        // on a grid, the covariance matrix is gathered from the cached values
+        if (gridCache.index(x, y))
+        {
+            int first = gridCache.size();
+            int last = gridCache.maxDistance();
+            if (last >= first)
+            {
+                double spacing = gridCache.getSpacing();
+                evaluateDistance(spacing * Eigen::ArrayXd::LinSpaced(last - first + 1, first, last),
+                                 gridCache.extend(last + 1));
+            }
+            gridCache.lookup(result);
+            return;
+        }
+
+        // the pairwise distances are a lazy expression, evaluated directly into the result
+        evaluateDistance((x.replicate(1, y.size()) - y.transpose().replicate(x.size(), 1)).array().abs(), result.array());
+    }
 
+    void PeriodicSquareExponential::reserve(int max_locations)
+    {
+        gridCache.reserve(max_locations);
+    }
+
+    template<typename Distance, typename Result>
+    void PeriodicSquareExponential::evaluateDistance(const Eigen::ArrayBase<Distance>& distanceXY,
+                                                     const Eigen::ArrayBase<Result>& result) const
+    {
         double lsSE0 = exp(hyperParameters(0));
         double svSE0 = exp(2 * hyperParameters(1));
         double lsP  = exp(hyperParameters(2));
@@ -66,22 +193,25 @@ namespace covariance_functions
 
         // Work with arrays internally, convert to matrix for return value.
         // This is because all the operations act elementwise, and Eigen::Arrays
-        // do so, too.
+        // do so, too. The factors are computed once, so that the expression
+        // compiles to a single vectorized loop over the distances.
+        double se0Factor = -0.5 / (lsSE0 * lsSE0);
+        double pFrequency = M_PI / plP;
+        double pFactor = -2 / (lsP * lsP);
 
-        // Compute Distances
-        Eigen::ArrayXXd squareDistanceXY = math_tools::squareDistance( x.transpose(), y.transpose());
-
-        // fast version
-        return svSE0 * ((-0.5 / std::pow(lsSE0, 2)) * squareDistanceXY).exp()
-            + svP * (-2 * (((M_PI / plP) * squareDistanceXY.sqrt()).sin() / lsP).square()).exp();
+        // fast version, the result is writable, see "Writing Functions Taking Eigen Types as Parameters"
+        const_cast<Eigen::ArrayBase<Result>&>(result) = svSE0 * (se0Factor * distanceXY.square()).exp()
+            + svP * (pFactor * (pFrequency * distanceXY).sin().square()).exp();
 
         /* // verbose version
+        Eigen::ArrayXXd squareDistanceXY = distanceXY.square();
+
         // Square Exponential Kernel
         Eigen::ArrayXXd K0 = squareDistanceXY / std::pow(lsSE0, 2);
         K0 = svSE0 * (-0.5 * K0).exp();
 
         // Periodic Kernel
-        Eigen::ArrayXXd K1 = (M_PI * squareDistanceXY.sqrt() / plP);
+        Eigen::ArrayXXd K1 = (M_PI * distanceXY / plP);
         K1 = K1.sin() / lsP;
         K1 = K1.square();
         K1 = svP * (-2 * K1).exp();
@@ -91,13 +221,26 @@ namespace covariance_functions
         */
     }
 
-    void PeriodicSquareExponential::setParameters(const Eigen::VectorXd& params)
+    void PeriodicSquareExponential::setGridSpacing(double spacing)
+    {
+        gridCache.setSpacing(spacing);
+    }
+
+    void PeriodicSquareExponential::setParameters(const Eigen::Ref<const Eigen::VectorXd>& params)
     {
+        if (parametersChanged(this->hyperParameters, params))
+        {
+            gridCache.clear();
+        }
         this->hyperParameters = params;
     }
 
-    void PeriodicSquareExponential::setExtraParameters(const Eigen::VectorXd& params)
+    void PeriodicSquareExponential::setExtraParameters(const Eigen::Ref<const Eigen::VectorXd>& params)
     {
+        if (parametersChanged(this->extraParameters, params))
+        {
+            gridCache.clear();
+        }
         this->extraParameters = params;
     }
 
@@ -131,7 +274,43 @@ namespace covariance_functions
 
     Eigen::MatrixXd PeriodicSquareExponential2::evaluate(const Eigen::VectorXd& x, const Eigen::VectorXd& y)
     {
+        Eigen::MatrixXd result(x.size(), y.size());
+        evaluate(x, y, result);
+        return result;
+    }
+
+    void PeriodicSquareExponential2::evaluate(const Eigen::Ref<const Eigen::VectorXd>& x,
+                                              const Eigen::Ref<const Eigen::VectorXd>& y,
+                                              Eigen::Ref<Eigen::MatrixXd> result)
+    {
+        // on a grid, the covariance matrix is gathered from the cached values
+        if (gridCache.index(x, y))
+        {
+            int first = gridCache.size();
+            int last = gridCache.maxDistance();
+            if (last >= first)
+            {
+                double spacing = gridCache.getSpacing();
+                evaluateDistance(spacing * Eigen::ArrayXd::LinSpaced(last - first + 1, first, last),
+                                 gridCache.extend(last + 1));
+            }
+            gridCache.lookup(result);
+            return;
+        }
+
+        // the pairwise distances are a lazy expression, evaluated directly into the result
+        evaluateDistance((x.replicate(1, y.size()) - y.transpose().replicate(x.size(), 1)).array().abs(), result.array());
+    }
 
+    void PeriodicSquareExponential2::reserve(int max_locations)
+    {
+        gridCache.reserve(max_locations);
+    }
+
+    template<typename Distance, typename Result>
+    void PeriodicSquareExponential2::evaluateDistance(const Eigen::ArrayBase<Distance>& distanceXY,
+                                                      const Eigen::ArrayBase<Result>& result) const
+    {
         double lsSE0 = exp(hyperParameters(0));
         double svSE0 = exp(2 * hyperParameters(1));
         double lsP  = exp(hyperParameters(2));
@@ -143,23 +322,27 @@ namespace covariance_functions
 
         // Work with arrays internally, convert to matrix for return value.
         // This is because all the operations act elementwise, and Eigen::Arrays
-        // do so, too.
-
-        // Compute Distances
-        Eigen::ArrayXXd squareDistanceXY = math_tools::squareDistance( x.transpose(), y.transpose());
-
-        // fast version
-        return svSE0 * ((-0.5 / std::pow(lsSE0, 2)) * squareDistanceXY).exp()
-            + svP * (-2 * (((M_PI / plP) * squareDistanceXY.sqrt()).sin() / lsP).square()).exp()
-            + svSE1 * ((-0.5 / std::pow(lsSE1, 2)) * squareDistanceXY).exp();
+        // do so, too. The factors are computed once, so that the expression
+        // compiles to a single vectorized loop over the distances.
+        double se0Factor = -0.5 / (lsSE0 * lsSE0);
+        double pFrequency = M_PI / plP;
+        double pFactor = -2 / (lsP * lsP);
+        double se1Factor = -0.5 / (lsSE1 * lsSE1);
+
+        // fast version, the result is writable, see "Writing Functions Taking Eigen Types as Parameters"
+        const_cast<Eigen::ArrayBase<Result>&>(result) = svSE0 * (se0Factor * distanceXY.square()).exp()
+            + svP * (pFactor * (pFrequency * distanceXY).sin().square()).exp()
+            + svSE1 * (se1Factor * distanceXY.square()).exp();
 
         /* // verbose version
+        Eigen::ArrayXXd squareDistanceXY = distanceXY.square();
+
         // Square Exponential Kernel
         Eigen::ArrayXXd K0 = squareDistanceXY / pow(lsSE0, 2);
         K0 = svSE0 * (-0.5 * K0).exp();
 
         // Periodic Kernel
-        Eigen::ArrayXXd K1 = (M_PI * squareDistanceXY.sqrt() / plP);
+        Eigen::ArrayXXd K1 = (M_PI * distanceXY / plP);
         K1 = K1.sin() / lsP;
         K1 = K1.square();
         K1 = svP * (-2 * K1).exp();
@@ -173,13 +356,26 @@ namespace covariance_functions
         */
     }
 
-    void PeriodicSquareExponential2::setParameters(const Eigen::VectorXd& params)
+    void PeriodicSquareExponential2::setGridSpacing(double spacing)
+    {
+        gridCache.setSpacing(spacing);
+    }
+
+    void PeriodicSquareExponential2::setParameters(const Eigen::Ref<const Eigen::VectorXd>& params)
     {
+        if (parametersChanged(this->hyperParameters, params))
+        {
+            gridCache.clear();
+        }
         this->hyperParameters = params;
     }
 
-    void PeriodicSquareExponential2::setExtraParameters(const Eigen::VectorXd& params)
+    void PeriodicSquareExponential2::setExtraParameters(const Eigen::Ref<const Eigen::VectorXd>& params)
     {
+        if (parametersChanged(this->extraParameters, params))
+        {
+            gridCache.clear();
+        }
         this->extraParameters = params;
     }
 
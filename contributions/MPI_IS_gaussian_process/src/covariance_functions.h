@@ -66,9 +66,24 @@ namespace covariance_functions
          */
         virtual Eigen::MatrixXd evaluate(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) = 0;
 
+        /*!
+         * Evaluates the covariance function into a preallocated matrix of size
+         * x1.size() x x2.size(). Covariance functions that override this don't
+         * allocate memory once reserve() has been called.
+         */
+        virtual void evaluate(const Eigen::Ref<const Eigen::VectorXd>& x1,
+                              const Eigen::Ref<const Eigen::VectorXd>& x2,
+                              Eigen::Ref<Eigen::MatrixXd> result)
+        {
+            result = evaluate(Eigen::VectorXd(x1), Eigen::VectorXd(x2));
+        }
+
+        //! Prepares the internal buffers for evaluations on up to max_locations locations.
+        virtual void reserve(int /*max_locations*/) { }
+
         //! Method to set the hyper-parameters.
-        virtual void setParameters(const Eigen::VectorXd& params) = 0;
-        virtual void setExtraParameters(const Eigen::VectorXd& params) = 0;
+        virtual void setParameters(const Eigen::Ref<const Eigen::VectorXd>& params) = 0;
+        virtual void setExtraParameters(const Eigen::Ref<const Eigen::VectorXd>& params) = 0;
 
         //! Returns the hyper-parameters.
         virtual const Eigen::VectorXd& getParameters() const = 0;
@@ -82,6 +97,57 @@ namespace covariance_functions
         virtual CovFunc* clone() const = 0;
     };
 
+    /*!
+     * Caches the values of a stationary covariance function for points on a
+     * regular grid. The covariance only depends on the distance between two
+     * points, and on a grid every distance is a multiple of the spacing. So
+     * each value has to be computed only once, and the covariance matrix of
+     * any set of grid points is gathered from the cached values.
+     */
+    class GridCache
+    {
+    private:
+        double spacing_;
+        std::vector<double> values_; // covariance for a distance of i grid cells
+        std::vector<int> x_index_; // grid indices of the last call to index()
+        std::vector<int> y_index_;
+
+    public:
+        GridCache() : spacing_(0.0) { }
+
+        //! Sets the grid spacing, zero disables the cache.
+        void setSpacing(double spacing);
+        double getSpacing() const { return spacing_; }
+
+        //! Removes the cached values, needed whenever the hyperparameters change.
+        void clear();
+
+        //! Reserves memory for grids of up to max_cells cells.
+        void reserve(int max_cells);
+
+        /*!
+         * Computes the grid index of each location relative to the first
+         * location of x. Returns false if the cache is disabled or a location
+         * is not on the grid.
+         */
+        bool index(const Eigen::Ref<const Eigen::VectorXd>& x, const Eigen::Ref<const Eigen::VectorXd>& y);
+
+        //! Number of cached distances.
+        int size() const { return static_cast<int>(values_.size()); }
+
+        //! The largest distance in grid cells between the locations passed to index().
+        int maxDistance() const;
+
+        /*!
+         * Grows the cache to hold the given number of distances and returns
+         * the new values, which have to be filled in by the caller.
+         */
+        Eigen::Map<Eigen::ArrayXd> extend(int size);
+
+        //! Gathers the covariance matrix of the locations passed to index().
+        void lookup(Eigen::Ref<Eigen::MatrixXd> result) const;
+    };
+
     /*!
      * The function computes a combined covariance function. It is a periodic
      * covariance function with an additional square exponential. This
@@ -117,6 +183,11 @@ namespace covariance_functions
      private:
          Eigen::VectorXd hyperParameters;
          Eigen::VectorXd extraParameters;
+         GridCache gridCache;
+
+         //! Evaluates the covariance function for the given distances.
+         template<typename Distance, typename Result>
+         void evaluateDistance(const Eigen::ArrayBase<Distance>& distance, const Eigen::ArrayBase<Result>& result) const;
 
      public:
          PeriodicSquareExponential();
@@ -127,10 +198,18 @@ namespace covariance_functions
           * to calculate gradient and Hessian.
           */
          Eigen::MatrixXd evaluate(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2);
+         void evaluate(const Eigen::Ref<const Eigen::VectorXd>& x1,
+                       const Eigen::Ref<const Eigen::VectorXd>& x2,
+                       Eigen::Ref<Eigen::MatrixXd> result);
+
+         void reserve(int max_locations);
+
+         //! Enables the cache for locations on a grid with the given spacing.
+         void setGridSpacing(double spacing);
 
          //! Method to set the hyper-parameters.
-         void setParameters(const Eigen::VectorXd& params);
-         void setExtraParameters(const Eigen::VectorXd& params);
+         void setParameters(const Eigen::Ref<const Eigen::VectorXd>& params);
+         void setExtraParameters(const Eigen::Ref<const Eigen::VectorXd>& params);
 
          //! Returns the hyper-parameters.
          const Eigen::VectorXd& getParameters() const;
@@ -187,16 +266,29 @@ namespace covariance_functions
     private:
         Eigen::VectorXd hyperParameters;
         Eigen::VectorXd extraParameters;
+        GridCache gridCache;
+
+        //! Evaluates the covariance function for the given distances.
+        template<typename Distance, typename Result>
+        void evaluateDistance(const Eigen::ArrayBase<Distance>& distance, const Eigen::ArrayBase<Result>& result) const;
 
     public:
         PeriodicSquareExponential2();
         explicit PeriodicSquareExponential2(const Eigen::VectorXd& hyperParameters);
 
         Eigen::MatrixXd evaluate(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2);
+        void evaluate(const Eigen::Ref<const Eigen::VectorXd>& x1,
+                      const Eigen::Ref<const Eigen::VectorXd>& x2,
+                      Eigen::Ref<Eigen::MatrixXd> result);
+
+        void reserve(int max_locations);
+
+        //! Enables the cache for locations on a grid with the given spacing.
+        void setGridSpacing(double spacing);
 
         //! Method to set the hyper-parameters.
-        void setParameters(const Eigen::VectorXd& params);
-        void setExtraParameters(const Eigen::VectorXd& params);
+        void setParameters(const Eigen::Ref<const Eigen::VectorXd>& params);
+        void setExtraParameters(const Eigen::Ref<const Eigen::VectorXd>& params);
 
         //! Returns the hyper-parameters.
         const Eigen::VectorXd& getParameters() const;
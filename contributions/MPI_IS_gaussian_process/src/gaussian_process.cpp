@@ -42,6 +42,8 @@
  */
 
 #include <cstdint>
+#include <algorithm>
+#include <vector>
 
 #include "gaussian_process.h"
 #include "math_tools.h"
@@ -58,55 +60,103 @@ struct covariance_ordering
     Eigen::VectorXd const& covariance_;
 };
 
+// Removes element i of the first n elements of a vector, keeping the order of the other elements.
+static void remove_element(Eigen::VectorXd& v, int n, int i)
+{
+    for (int j = i; j < n - 1; ++j)
+    {
+        v(j) = v(j + 1);
+    }
+}
+
+// Removes row and column i from the leading n x n block of a square matrix.
+static void remove_row_column(Eigen::MatrixXd& m, int n, int i)
+{
+    for (int c = 0; c < n - 1; ++c)
+    {
+        int src_c = c < i ? c : c + 1;
+        for (int r = 0; r < n - 1; ++r)
+        {
+            m(r, c) = m(r < i ? r : r + 1, src_c);
+        }
+    }
+}
+
+// Grows a workspace to at least the given size, the content is not kept.
+static void grow(Eigen::VectorXd& v, int rows)
+{
+    if (v.rows() < rows)
+    {
+        v.resize(rows);
+    }
+}
+
+static void grow(Eigen::MatrixXd& m, int rows, int cols)
+{
+    if (m.rows() < rows || m.cols() < cols)
+    {
+        m.resize(std::max(rows, static_cast<int>(m.rows())), std::max(cols, static_cast<int>(m.cols())));
+    }
+}
+
 GP::GP() : covFunc_(nullptr), // initialize pointer to null
     covFuncProj_(nullptr), // initialize pointer to null
+    num_points_(0),
+    heteroscedastic_(false),
     data_loc_(Eigen::VectorXd()),
     data_out_(Eigen::VectorXd()),
     data_var_(Eigen::VectorXd()),
     gram_matrix_(Eigen::MatrixXd()),
     alpha_(Eigen::VectorXd()),
-    chol_gram_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
+    chol_gram_matrix_(Eigen::MatrixXd()),
     log_noise_sd_(-1E20),
     use_explicit_trend_(false),
     feature_vectors_(Eigen::MatrixXd()),
     feature_matrix_(Eigen::MatrixXd()),
     chol_feature_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
-    beta_(Eigen::VectorXd())
+    beta_(Eigen::VectorXd()),
+    updates_since_factorization_(0)
 { }
 
 GP::GP(const covariance_functions::CovFunc& covFunc) :
     covFunc_(covFunc.clone()),
     covFuncProj_(nullptr),
+    num_points_(0),
+    heteroscedastic_(false),
     data_loc_(Eigen::VectorXd()),
     data_out_(Eigen::VectorXd()),
     data_var_(Eigen::VectorXd()),
     gram_matrix_(Eigen::MatrixXd()),
     alpha_(Eigen::VectorXd()),
-    chol_gram_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
+    chol_gram_matrix_(Eigen::MatrixXd()),
     log_noise_sd_(-1E20),
     use_explicit_trend_(false),
     feature_vectors_(Eigen::MatrixXd()),
     feature_matrix_(Eigen::MatrixXd()),
     chol_feature_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
-    beta_(Eigen::VectorXd())
+    beta_(Eigen::VectorXd()),
+    updates_since_factorization_(0)
 { }
 
 GP::GP(const double noise_variance,
        const covariance_functions::CovFunc& covFunc) :
     covFunc_(covFunc.clone()),
     covFuncProj_(nullptr),
+    num_points_(0),
+    heteroscedastic_(false),
     data_loc_(Eigen::VectorXd()),
     data_out_(Eigen::VectorXd()),
     data_var_(Eigen::VectorXd()),
     gram_matrix_(Eigen::MatrixXd()),
     alpha_(Eigen::VectorXd()),
-    chol_gram_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
+    chol_gram_matrix_(Eigen::MatrixXd()),
     log_noise_sd_(std::log(noise_variance)),
     use_explicit_trend_(false),
     feature_vectors_(Eigen::MatrixXd()),
     feature_matrix_(Eigen::MatrixXd()),
     chol_feature_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
-    beta_(Eigen::VectorXd())
+    beta_(Eigen::VectorXd()),
+    updates_since_factorization_(0)
 { }
 
 GP::~GP()
@@ -118,6 +168,8 @@ GP::~GP()
 GP::GP(const GP& that) :
     covFunc_(nullptr), // initialize to nullptr, clone later
     covFuncProj_(nullptr), // initialize to nullptr, clone later
+    num_points_(that.num_points_),
+    heteroscedastic_(that.heteroscedastic_),
     data_loc_(that.data_loc_),
     data_out_(that.data_out_),
     data_var_(that.data_var_),
@@ -129,16 +181,21 @@ GP::GP(const GP& that) :
     feature_vectors_(that.feature_vectors_),
     feature_matrix_(that.feature_matrix_),
     chol_feature_matrix_(that.chol_feature_matrix_),
-    beta_(that.beta_)
+    beta_(that.beta_),
+    updates_since_factorization_(that.updates_since_factorization_),
+    workspace_(that.workspace_) // the copy can predict without allocating, too
 {
     covFunc_ = that.covFunc_->clone();
-    covFuncProj_ = that.covFuncProj_->clone();
+    if (that.covFuncProj_ != nullptr) // the output projection is optional
+    {
+        covFuncProj_ = that.covFuncProj_->clone();
+    }
 }
 
 bool GP::setCovarianceFunction(const covariance_functions::CovFunc& covFunc)
 {
     // can only set the covariance function if training dataset is empty
-    if (data_loc_.size() != 0 || data_out_.size() != 0)
+    if (num_points_ != 0)
         return false;
     delete covFunc_; // initialized to zero, so delete is safe
     covFunc_ = covFunc.clone();
@@ -158,6 +215,71 @@ void GP::disableOutputProjection()
     covFuncProj_ = nullptr;
 }
 
+void GP::reserve(int max_data, int max_points, int max_locations /*= 2*/)
+{
+    ensureCapacity(max_points);
+
+    Workspace& ws = workspace_;
+    grow(ws.covariance, max_data);
+    ws.index.reserve(max_data);
+    grow(ws.sd_loc, max_points);
+    grow(ws.sd_out, max_points);
+    grow(ws.sd_var, max_points);
+    ws.order.reserve(max_points);
+    ws.kept.reserve(max_points);
+    ws.removed.reserve(max_points);
+
+    grow(ws.kernel_column, max_points);
+    grow(ws.feature_solve, max_points, 2);
+    grow(ws.trend_weights, 2, max_points);
+
+    grow(ws.mixed_cov, max_locations, max_points);
+    grow(ws.gamma, max_points, max_locations);
+    grow(ws.residual_features, 2, max_locations);
+
+    if (covFunc_ != nullptr)
+    {
+        covFunc_->reserve(max_data);
+    }
+    if (covFuncProj_ != nullptr)
+    {
+        covFuncProj_->reserve(max_data);
+    }
+}
+
+void GP::ensureCapacity(int points)
+{
+    if (points <= data_loc_.rows())
+    {
+        return;
+    }
+
+    data_loc_.conservativeResize(points);
+    data_out_.conservativeResize(points);
+    data_var_.conservativeResize(points);
+    alpha_.conservativeResize(points);
+    gram_matrix_.conservativeResize(points, points);
+    chol_gram_matrix_.conservativeResize(points, points);
+    feature_vectors_.conservativeResize(2, points);
+}
+
+void GP::storeData(const Eigen::Ref<const Eigen::VectorXd>& data_loc,
+                   const Eigen::Ref<const Eigen::VectorXd>& data_out,
+                   const Eigen::Ref<const Eigen::VectorXd>& data_var)
+{
+    int n = static_cast<int>(data_loc.rows());
+    ensureCapacity(n);
+
+    num_points_ = n;
+    heteroscedastic_ = data_var.rows() > 0;
+    data_loc_.head(n) = data_loc;
+    data_out_.head(n) = data_out;
+    if (heteroscedastic_)
+    {
+        data_var_.head(n) = data_var;
+    }
+}
+
 GP& GP::operator=(const GP& that)
 {
     if (this != &that)
@@ -167,6 +289,8 @@ GP& GP::operator=(const GP& that)
         delete temp;  // ... and then delete.
 
         // copy the rest
+        num_points_ = that.num_points_;
+        heteroscedastic_ = that.heteroscedastic_;
         data_loc_ = that.data_loc_;
         data_out_ = that.data_out_;
         data_var_ = that.data_var_;
@@ -174,6 +298,12 @@ GP& GP::operator=(const GP& that)
         alpha_ = that.alpha_;
         chol_gram_matrix_ = that.chol_gram_matrix_;
         log_noise_sd_ = that.log_noise_sd_;
+        feature_vectors_ = that.feature_vectors_; // has the same capacity as the data
+        feature_matrix_ = that.feature_matrix_;
+        chol_feature_matrix_ = that.chol_feature_matrix_;
+        beta_ = that.beta_;
+        updates_since_factorization_ = that.updates_since_factorization_;
+        workspace_ = that.workspace_;
     }
     return *this;
 }
@@ -196,7 +326,7 @@ Eigen::VectorXd GP::drawSample(const Eigen::VectorXd& locations,
     prior_covariance = covFunc_->evaluate(locations, locations);
     kernel_matrix = prior_covariance;
 
-    if (gram_matrix_.cols() == 0)   // no data, i.e. only a prior
+    if (num_points_ == 0)   // no data, i.e. only a prior
     {
         kernel_matrix = prior_covariance + JITTER * Eigen::MatrixXd::Identity(
                             prior_covariance.rows(), prior_covariance.cols());
@@ -204,10 +334,10 @@ Eigen::VectorXd GP::drawSample(const Eigen::VectorXd& locations,
     else // we have some data
     {
         Eigen::MatrixXd mixed_covariance;
-        mixed_covariance = covFunc_->evaluate(locations, data_loc_);
+        mixed_covariance = covFunc_->evaluate(locations, data_loc_.head(num_points_));
         Eigen::MatrixXd posterior_covariance;
         posterior_covariance = prior_covariance - mixed_covariance *
-                               (chol_gram_matrix_.solve(mixed_covariance.transpose()));
+                               (solveGram(mixed_covariance.transpose()));
         kernel_matrix = posterior_covariance + JITTER * Eigen::MatrixXd::Identity(
                             posterior_covariance.rows(), posterior_covariance.cols());
     }
@@ -223,164 +353,316 @@ Eigen::VectorXd GP::drawSample(const Eigen::VectorXd& locations,
 
 void GP::infer()
 {
-    assert(data_loc_.rows() > 0 && "Error: the GP is not yet initialized!");
+    assert(num_points_ > 0 && "Error: the GP is not yet initialized!");
+    int n = num_points_;
 
     // The data covariance matrix
-    Eigen::MatrixXd data_cov = covFunc_->evaluate(data_loc_, data_loc_);
+    covFunc_->evaluate(data_loc_.head(n), data_loc_.head(n), gram_matrix_.topLeftCorner(n, n));
 
-    // swapping in the Gram matrix is faster than directly assigning it
-    gram_matrix_.swap(data_cov); // store the new data_cov as gram matrix
-    if (data_var_.rows() == 0) // homoscedastic
+    if (!heteroscedastic_) // homoscedastic
     {
-        gram_matrix_ += (std::exp(2 * log_noise_sd_) + JITTER) *
-                    Eigen::MatrixXd::Identity(gram_matrix_.rows(), gram_matrix_.cols());
+        gram_matrix_.topLeftCorner(n, n).diagonal().array() += std::exp(2 * log_noise_sd_) + JITTER;
     }
     else // heteroscedastic
     {
-        gram_matrix_ += data_var_.asDiagonal();
+        gram_matrix_.topLeftCorner(n, n).diagonal() += data_var_.head(n);
     }
 
-    // compute the Cholesky decomposition of the Gram matrix
-    chol_gram_matrix_ = gram_matrix_.ldlt();
+    // compute the Cholesky decomposition of the Gram matrix, in place in the storage of the factor
+    Eigen::Ref<Eigen::MatrixXd> chol = chol_gram_matrix_.topLeftCorner(n, n);
+    chol = gram_matrix_.topLeftCorner(n, n);
+    Eigen::LLT<Eigen::Ref<Eigen::MatrixXd> > llt(chol);
+
+    // Round-off can make the Gram matrix of close points slightly indefinite.
+    // More jitter on the diagonal makes it positive definite again.
+    double jitter = JITTER;
+    for (int attempt = 0; llt.info() != Eigen::Success && attempt < MAX_JITTER_ATTEMPTS; ++attempt)
+    {
+        gram_matrix_.topLeftCorner(n, n).diagonal().array() += 9 * jitter; // ten times the jitter in total
+        jitter *= 10;
+        chol = gram_matrix_.topLeftCorner(n, n);
+        llt.compute(chol);
+    }
+    assert(llt.info() == Eigen::Success && "Error: the Gram matrix is not positive definite!");
+    updates_since_factorization_ = 0;
+
+    updateWeights();
+}
+
+Eigen::MatrixXd GP::solveGram(const Eigen::MatrixXd& rhs) const
+{
+    Eigen::MatrixXd result = rhs;
+    solveGramInPlace(result);
+    return result;
+}
+
+template<typename Derived>
+void GP::solveGramInPlace(const Eigen::MatrixBase<Derived>& rhs) const
+{
+    // the rhs is writable, see "Writing Functions Taking Eigen Types as Parameters"
+    Eigen::MatrixBase<Derived>& result = const_cast<Eigen::MatrixBase<Derived>&>(rhs);
+    Eigen::MatrixXd::ConstBlockXpr L = chol_gram_matrix_.topLeftCorner(num_points_, num_points_);
+
+    // Column by column, the triangular solver needs no blocking workspace.
+    // There are only a few columns anyway.
+    for (int j = 0; j < result.cols(); ++j)
+    {
+        L.triangularView<Eigen::Lower>().solveInPlace(result.col(j));
+        L.transpose().triangularView<Eigen::Upper>().solveInPlace(result.col(j));
+    }
+}
+
+void GP::updateWeights()
+{
+    int n = num_points_;
+    Workspace& ws = workspace_;
 
     // pre-compute the alpha, which is the solution of the chol to the data
-    alpha_ = chol_gram_matrix_.solve(data_out_);
+    alpha_.head(n) = data_out_.head(n);
+    solveGramInPlace(alpha_.head(n));
 
     if (use_explicit_trend_)
     {
-        feature_vectors_ = Eigen::MatrixXd(2, data_loc_.rows());
         // precompute necessary matrices for the explicit trend function
-        feature_vectors_.row(0) = Eigen::MatrixXd::Ones(1,data_loc_.rows()); // instead of pow(0)
-        feature_vectors_.row(1) = data_loc_.array(); // instead of pow(1)
+        feature_vectors_.row(0).head(n).setOnes(); // instead of pow(0)
+        feature_vectors_.row(1).head(n) = data_loc_.head(n).transpose(); // instead of pow(1)
 
-        feature_matrix_ = feature_vectors_ * chol_gram_matrix_.solve(feature_vectors_.transpose());
-        chol_feature_matrix_ = feature_matrix_.ldlt();
+        grow(ws.feature_solve, n, 2);
+        ws.feature_solve.topRows(n) = feature_vectors_.leftCols(n).transpose();
+        solveGramInPlace(ws.feature_solve.topRows(n));
 
-        beta_ = chol_feature_matrix_.solve(feature_vectors_) * alpha_;
+        feature_matrix_.noalias() = feature_vectors_.leftCols(n) * ws.feature_solve.topRows(n);
+        chol_feature_matrix_.compute(feature_matrix_);
+
+        grow(ws.trend_weights, 2, n);
+        ws.trend_weights.leftCols(n) = chol_feature_matrix_.solve(feature_vectors_.leftCols(n));
+        beta_.noalias() = ws.trend_weights.leftCols(n) * alpha_.head(n);
     }
 }
 
-void GP::infer(const Eigen::VectorXd& data_loc,
-               const Eigen::VectorXd& data_out,
-               const Eigen::VectorXd& data_var /* = EigenVectorXd() */)
+bool GP::updateInference(const Eigen::Ref<const Eigen::VectorXd>& data_loc,
+                         const Eigen::Ref<const Eigen::VectorXd>& data_out,
+                         const Eigen::Ref<const Eigen::VectorXd>& data_var)
 {
-    data_loc_ = data_loc;
-    data_out_ = data_out;
-    if (data_var.rows() > 0)
+    int n_old = num_points_;
+    int n_new = static_cast<int>(data_loc.rows());
+    bool use_var = data_var.rows() > 0;
+    Workspace& ws = workspace_;
+
+    // we need a factorization of the current data with the same noise model
+    if (n_old == 0 || n_new == 0 || use_var != heteroscedastic_)
     {
-        data_var_ = data_var;
+        return false;
     }
-    infer(); // updates the Gram matrix and its Cholesky decomposition
-}
 
-void GP::inferSD(const Eigen::VectorXd& data_loc,
-            const Eigen::VectorXd& data_out,
-            const int n, const Eigen::VectorXd& data_var /* = EigenVectorXd() */,
-            const double prediction_point /*= std::numeric_limits<double>::quiet_NaN()*/)
-{
-    Eigen::VectorXd covariance;
+    // sort the new points by location, so that the old ones can be found quickly
+    std::vector<int>& order = ws.order;
+    order.resize(n_new);
+    for (int i = 0; i < n_new; ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&data_loc](int a, int b) { return data_loc(a) < data_loc(b); });
+
+    // an old point is kept only if it is still part of the data with the same values
+    std::vector<bool>& kept = ws.kept;
+    std::vector<int>& removed = ws.removed;
+    kept.assign(n_new, false);
+    removed.clear();
+    for (int i = 0; i < n_old; ++i)
+    {
+        double loc = data_loc_(i);
+        std::vector<int>::iterator it = std::lower_bound(order.begin(), order.end(), loc,
+            [&data_loc](int a, double value) { return data_loc(a) < value; });
+        if (it != order.end() && data_loc(*it) == loc && !kept[*it] && data_out(*it) == data_out_(i)
+            && (!use_var || data_var(*it) == data_var_(i)))
+        {
+            kept[*it] = true;
+        }
+        else
+        {
+            removed.push_back(i);
+        }
+    }
 
-    Eigen::VectorXd prediction_loc(1);
-    if ( math_tools::isNaN(prediction_point) )
+    int num_kept = n_old - static_cast<int>(removed.size());
+    int changes = static_cast<int>(removed.size()) + (n_new - num_kept);
+    if (changes == 0)
     {
-        // if none given, use the last datapoint as prediction reference
-        prediction_loc = data_loc.tail(1);
+        return true; // nothing to do
     }
-    else
+
+    // Each change costs O(n^2), a new factorization O(n^3). Large changes are
+    // cheaper with a new factorization, and refactoring once the whole window
+    // has been replaced bounds the accumulated round-off error.
+    if (num_kept == 0 || 4 * changes > n_new || updates_since_factorization_ + changes > n_new)
     {
-        prediction_loc << prediction_point;
+        return false;
     }
 
-    // calculate covariance between data and prediction point for point selection
-    covariance = covFunc_->evaluate(data_loc, prediction_loc);
+    ensureCapacity(n_new);
 
-    // generate index vector
-    std::vector<int> index(covariance.size(), 0);
-    for (size_t i = 0 ; i != index.size() ; i++) {
-        index[i] = i;
+    // remove from the back, so that the remaining indices stay valid
+    int n = n_old;
+    for (std::vector<int>::reverse_iterator it = removed.rbegin(); it != removed.rend(); ++it)
+    {
+        math_tools::cholesky_remove(chol_gram_matrix_, n, *it);
+        remove_row_column(gram_matrix_, n, *it);
+        remove_element(data_loc_, n, *it);
+        remove_element(data_out_, n, *it);
+        if (use_var)
+        {
+            remove_element(data_var_, n, *it);
+        }
+        num_points_ = --n;
     }
 
-    // sort indices with respect to covariance value
-    std::sort(index.begin(), index.end(),
-         covariance_ordering(covariance)
-    );
+    double noise_variance = std::exp(2 * log_noise_sd_) + JITTER;
+    grow(ws.kernel_column, n_new);
+    Eigen::Matrix<double, 1, 1> self_covariance;
+    for (int j = 0; j < n_new; ++j)
+    {
+        if (kept[j])
+        {
+            continue;
+        }
 
+        Eigen::VectorXd::SegmentReturnType k = ws.kernel_column.head(n);
+        covFunc_->evaluate(data_loc_.head(n), data_loc.segment(j, 1), k);
+        covFunc_->evaluate(data_loc.segment(j, 1), data_loc.segment(j, 1), self_covariance);
+        double kappa = self_covariance(0, 0) + (use_var ? data_var(j) : noise_variance);
+
+        if (!math_tools::cholesky_append(chol_gram_matrix_, n, k, kappa))
+        {
+            return false;
+        }
+
+        gram_matrix_.block(0, n, n, 1) = k;
+        gram_matrix_.block(n, 0, 1, n) = k.transpose();
+        gram_matrix_(n, n) = kappa;
+
+        data_loc_(n) = data_loc(j);
+        data_out_(n) = data_out(j);
+        if (use_var)
+        {
+            data_var_(n) = data_var(j);
+        }
+        num_points_ = ++n;
+    }
+
+    updates_since_factorization_ += changes;
+    updateWeights();
+    return true;
+}
+
+void GP::infer(const Eigen::VectorXd& data_loc,
+               const Eigen::VectorXd& data_out,
+               const Eigen::VectorXd& data_var /* = EigenVectorXd() */)
+{
+    storeData(data_loc, data_out, data_var);
+    infer(); // updates the Gram matrix and its Cholesky decomposition
+}
+
+void GP::inferSD(const Eigen::Ref<const Eigen::VectorXd>& data_loc,
+            const Eigen::Ref<const Eigen::VectorXd>& data_out,
+            const int n, const Eigen::Ref<const Eigen::VectorXd>& data_var /* = EigenVectorXd() */,
+            const double prediction_point /*= std::numeric_limits<double>::quiet_NaN()*/)
+{
+    int num_data = static_cast<int>(data_loc.rows());
     bool use_var = data_var.rows() > 0; // true means heteroscedastic noise
+    Workspace& ws = workspace_;
+
+    if (n < num_data) {
+        double prediction_loc = prediction_point;
+        if ( math_tools::isNaN(prediction_point) )
+        {
+            // if none given, use the last datapoint as prediction reference
+            prediction_loc = data_loc(num_data - 1);
+        }
+
+        // calculate covariance between data and prediction point for point selection
+        grow(ws.covariance, num_data);
+        covFunc_->evaluate(data_loc, Eigen::Map<const Eigen::VectorXd>(&prediction_loc, 1),
+                           ws.covariance.head(num_data));
+
+        // generate index vector
+        std::vector<int>& index = ws.index;
+        index.resize(num_data);
+        for (size_t i = 0 ; i != index.size() ; i++) {
+            index[i] = i;
+        }
 
-    if (n < data_loc.rows()) {
-        std::vector<double> loc_arr(n);
-        std::vector<double> out_arr(n);
-        std::vector<double> var_arr(n);
+        // only the n points with the highest covariance are needed, their order doesn't matter
+        std::partial_sort(index.begin(), index.begin() + n, index.end(),
+             covariance_ordering(ws.covariance)
+        );
+
+        grow(ws.sd_loc, n);
+        grow(ws.sd_out, n);
+        if (use_var)
+        {
+            grow(ws.sd_var, n);
+        }
 
         for (int i = 0; i < n; ++i)
         {
-            loc_arr[i] = data_loc[index[i]];
-            out_arr[i] = data_out[index[i]];
+            ws.sd_loc[i] = data_loc[index[i]];
+            ws.sd_out[i] = data_out[index[i]];
             if (use_var)
             {
-                var_arr[i] = data_var[index[i]];
+                ws.sd_var[i] = data_var[index[i]];
             }
         }
 
-        data_loc_ = Eigen::Map<Eigen::VectorXd>(loc_arr.data(),n,1);
-        data_out_ = Eigen::Map<Eigen::VectorXd>(out_arr.data(),n,1);
-        if (use_var)
+        // reuse the factorization of the previous subset if possible
+        Eigen::VectorXd::SegmentReturnType sd_loc = ws.sd_loc.head(n);
+        Eigen::VectorXd::SegmentReturnType sd_out = ws.sd_out.head(n);
+        Eigen::VectorXd::SegmentReturnType sd_var = ws.sd_var.head(use_var ? n : 0);
+        if (!updateInference(sd_loc, sd_out, sd_var))
         {
-            data_var_ = Eigen::Map<Eigen::VectorXd>(var_arr.data(),n,1);
+            storeData(sd_loc, sd_out, sd_var);
+            infer();
         }
     }
     else // we can use all points and don't neet to select
     {
-        data_loc_ = data_loc;
-        data_out_ = data_out;
-        if (use_var)
+        if (!updateInference(data_loc, data_out, data_var))
         {
-            data_var_ = data_var;
+            storeData(data_loc, data_out, data_var);
+            infer();
         }
     }
-    infer();
 }
 
 void GP::clearData()
 {
-    gram_matrix_ = Eigen::MatrixXd();
-    chol_gram_matrix_ = Eigen::LDLT<Eigen::MatrixXd>();
-    data_loc_ = Eigen::VectorXd();
-    data_out_ = Eigen::VectorXd();
+    // the storage is kept for the next data
+    num_points_ = 0;
+    updates_since_factorization_ = 0;
 }
 
 Eigen::VectorXd GP::predict(const Eigen::VectorXd& locations, Eigen::VectorXd* variances /*=nullptr*/) const
 {
-    // The prior covariance matrix (evaluated on test points)
-    Eigen::MatrixXd prior_cov = covFunc_->evaluate(locations, locations);
-
-    if (data_loc_.rows() == 0)  // check if the data is empty
-    {
-        if (variances != nullptr)
-        {
-            (*variances) = prior_cov.diagonal();
-        }
-        return Eigen::VectorXd::Zero(locations.size());
-    }
-    else
-    {
-        // Calculate mixed covariance matrix (test and data points)
-        Eigen::MatrixXd mixed_cov = covFunc_->evaluate(locations, data_loc_);
-
-        // Calculate feature matrix for linear feature
-        Eigen::MatrixXd phi(2, locations.rows());
-        if (use_explicit_trend_)
-        {
-            phi.row(0) = Eigen::MatrixXd::Ones(1,locations.rows()); // instead of pow(0)
-            phi.row(1) = locations.array(); // instead of pow(1)
+    Eigen::VectorXd mean(locations.rows());
+    predict(covFunc_, locations, mean, variances);
+    return mean;
+}
 
-            return predict(prior_cov, mixed_cov, phi, variances);
-        }
-        return predict(prior_cov, mixed_cov, Eigen::MatrixXd(), variances);
-    }
+void GP::predict(const Eigen::Ref<const Eigen::VectorXd>& locations, Eigen::Ref<Eigen::VectorXd> mean,
+                 Eigen::VectorXd* variances /*=nullptr*/) const
+{
+    predict(covFunc_, locations, mean, variances);
 }
 
 Eigen::VectorXd GP::predictProjected(const Eigen::VectorXd& locations, Eigen::VectorXd* variances /*=nullptr*/) const
+{
+    Eigen::VectorXd mean(locations.rows());
+    predictProjected(locations, mean, variances);
+    return mean;
+}
+
+void GP::predictProjected(const Eigen::Ref<const Eigen::VectorXd>& locations, Eigen::Ref<Eigen::VectorXd> mean,
+                          Eigen::VectorXd* variances /*=nullptr*/) const
 {
     // use the suitable covariance function, depending on whether an
     // output projection is used or not.
@@ -396,32 +678,77 @@ Eigen::VectorXd GP::predictProjected(const Eigen::VectorXd& locations, Eigen::Ve
 
     assert(covFunc != nullptr);
 
-    // The prior covariance matrix (evaluated on test points)
-    Eigen::MatrixXd prior_cov = covFunc->evaluate(locations, locations);
+    predict(covFunc, locations, mean, variances);
+}
+
+void GP::predict(covariance_functions::CovFunc* covFunc,
+                 const Eigen::Ref<const Eigen::VectorXd>& locations,
+                 Eigen::Ref<Eigen::VectorXd> mean,
+                 Eigen::VectorXd* variances) const
+{
+    int m = static_cast<int>(locations.rows());
+    int n = num_points_;
+    assert(mean.rows() == m);
+
+    // The prior covariance matrix (evaluated on test points) is only needed for the variances
+    Eigen::MatrixXd prior_cov;
+    if (variances != nullptr)
+    {
+        prior_cov.resize(m, m);
+        covFunc->evaluate(locations, locations, prior_cov);
+    }
 
-    if (data_loc_.rows() == 0)  // check if the data is empty
+    if (n == 0)  // check if the data is empty
     {
         if (variances != nullptr)
         {
             (*variances) = prior_cov.diagonal();
         }
-        return Eigen::VectorXd::Zero(locations.size());
+        mean.setZero();
+        return;
     }
-    else
+
+    Workspace& ws = workspace_;
+
+    // Calculate mixed covariance matrix (test and data points)
+    grow(ws.mixed_cov, m, n);
+    Eigen::MatrixXd::BlockXpr mixed_cov = ws.mixed_cov.topLeftCorner(m, n);
+    covFunc->evaluate(locations, data_loc_.head(n), mixed_cov);
+
+    // calculate GP mean from precomputed alpha vector
+    mean.noalias() = mixed_cov * alpha_.head(n);
+
+    // precompute K^{-1} * mixed_cov
+    grow(ws.gamma, n, m);
+    Eigen::MatrixXd::BlockXpr gamma = ws.gamma.topLeftCorner(n, m);
+    gamma = mixed_cov.transpose();
+    solveGramInPlace(gamma);
+
+    // include fixed-features in the calculations
+    grow(ws.residual_features, 2, m);
+    Eigen::MatrixXd::ColsBlockXpr R = ws.residual_features.leftCols(m);
+    if (use_explicit_trend_)
     {
-        // The mixed covariance matrix (test and data points)
-        Eigen::MatrixXd mixed_cov = covFunc->evaluate(locations, data_loc_);
+        // Calculate feature matrix for linear feature
+        R.row(0).setOnes(); // instead of pow(0)
+        R.row(1) = locations.transpose(); // instead of pow(1)
+        R.noalias() -= feature_vectors_.leftCols(n) * gamma;
+
+        mean.noalias() += R.transpose() * beta_;
+    }
+
+    if (variances != nullptr)
+    {
+        // calculate GP variance
+        Eigen::MatrixXd v = prior_cov - mixed_cov * gamma;
 
-        Eigen::MatrixXd phi(2, locations.rows());
+        // include fixed-features in the calculations
         if (use_explicit_trend_)
         {
-            // calculate the feature vectors for linear regression
-            phi.row(0) = Eigen::MatrixXd::Ones(1,locations.rows()); // instead of pow(0)
-            phi.row(1) = locations.array(); // instead of pow(1)
-
-            return predict(prior_cov, mixed_cov, phi, variances);
+            v += R.transpose() * chol_feature_matrix_.solve(R);
         }
-        return predict(prior_cov, mixed_cov, Eigen::MatrixXd(), variances);
+
+        (*variances) = v.diagonal();
     }
 }
 
@@ -431,17 +758,17 @@ Eigen::VectorXd GP::predict(const Eigen::MatrixXd& prior_cov, const Eigen::Matri
 {
 
     // calculate GP mean from precomputed alpha vector
-    Eigen::VectorXd m = mixed_cov * alpha_;
+    Eigen::VectorXd m = mixed_cov * alpha_.head(num_points_);
 
     // precompute K^{-1} * mixed_cov
-    Eigen::MatrixXd gamma = chol_gram_matrix_.solve(mixed_cov.transpose());
+    Eigen::MatrixXd gamma = solveGram(mixed_cov.transpose());
 
     Eigen::MatrixXd R;
 
     // include fixed-features in the calculations
     if (use_explicit_trend_)
     {
-        R = phi - feature_vectors_ * gamma;
+        R = phi - feature_vectors_.leftCols(num_points_) * gamma;
 
         m += R.transpose() * beta_;
     }
@@ -463,14 +790,22 @@ Eigen::VectorXd GP::predict(const Eigen::MatrixXd& prior_cov, const Eigen::Matri
     return m;
 }
 
-void GP::setHyperParameters(const Eigen::VectorXd& hyperParameters)
+void GP::setHyperParameters(const Eigen::Ref<const Eigen::VectorXd>& hyperParameters)
 {
-    assert(hyperParameters.rows() == covFunc_->getParameterCount() + covFunc_->getExtraParameterCount() + 1 &&
+    int num_parameters = covFunc_->getParameterCount();
+    int num_extra_parameters = covFunc_->getExtraParameterCount();
+    assert(hyperParameters.rows() == num_parameters + num_extra_parameters + 1 &&
            "Wrong number of hyperparameters supplied to setHyperParameters()!");
+
+    // the factorization only needs to be rebuilt if the parameters changed
+    bool changed = hyperParameters(0) != log_noise_sd_
+        || hyperParameters.segment(1, num_parameters) != covFunc_->getParameters()
+        || hyperParameters.tail(num_extra_parameters) != covFunc_->getExtraParameters();
+
     log_noise_sd_ = hyperParameters[0];
-    covFunc_->setParameters(hyperParameters.segment(1, covFunc_->getParameterCount()));
-    covFunc_->setExtraParameters(hyperParameters.tail(covFunc_->getExtraParameterCount()));
-    if (data_loc_.rows() > 0)
+    covFunc_->setParameters(hyperParameters.segment(1, num_parameters));
+    covFunc_->setExtraParameters(hyperParameters.tail(num_extra_parameters));
+    if (changed && num_points_ > 0)
     {
         infer();
     }
@@ -478,18 +813,29 @@ void GP::setHyperParameters(const Eigen::VectorXd& hyperParameters)
     // if the projection kernel is set, set the parameters there as well.
     if (covFuncProj_ != nullptr)
     {
-        covFuncProj_->setParameters(hyperParameters.segment(1, covFunc_->getParameterCount()));
-        covFuncProj_->setExtraParameters(hyperParameters.tail(covFunc_->getExtraParameterCount()));
+        covFuncProj_->setParameters(hyperParameters.segment(1, num_parameters));
+        covFuncProj_->setExtraParameters(hyperParameters.tail(num_extra_parameters));
     }
 }
 
 Eigen::VectorXd GP::getHyperParameters() const
 {
     Eigen::VectorXd hyperParameters(covFunc_->getParameterCount() + covFunc_->getExtraParameterCount() + 1);
-    hyperParameters << log_noise_sd_, covFunc_->getParameters(), covFunc_->getExtraParameters();
+    getHyperParameters(hyperParameters);
     return hyperParameters;
 }
 
+void GP::getHyperParameters(Eigen::Ref<Eigen::VectorXd> hyperParameters) const
+{
+    int num_parameters = covFunc_->getParameterCount();
+    int num_extra_parameters = covFunc_->getExtraParameterCount();
+    assert(hyperParameters.rows() == num_parameters + num_extra_parameters + 1);
+
+    hyperParameters(0) = log_noise_sd_;
+    hyperParameters.segment(1, num_parameters) = covFunc_->getParameters();
+    hyperParameters.tail(num_extra_parameters) = covFunc_->getExtraParameters();
+}
+
 void GP::enableExplicitTrend()
 {
     use_explicit_trend_ = true;
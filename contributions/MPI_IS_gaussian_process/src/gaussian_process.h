@@ -59,23 +59,113 @@
 // make the Cholesky decomposition stable.
 #define JITTER 1e-6
 
+// The jitter is increased tenfold at most this many times if the Cholesky
+// decomposition fails nevertheless.
+#define MAX_JITTER_ATTEMPTS 6
+
 class GP
 {
 private:
+    /*!
+     * Preallocated temporaries of inference and prediction. Once they are
+     * large enough, updating the GP and predicting from it doesn't allocate
+     * memory. Since prediction uses them as well, a GP must not be used for
+     * prediction from several threads at once.
+     */
+    struct Workspace
+    {
+        // subset of data selection
+        Eigen::VectorXd covariance;
+        std::vector<int> index;
+        Eigen::VectorXd sd_loc;
+        Eigen::VectorXd sd_out;
+        Eigen::VectorXd sd_var;
+        std::vector<int> order;
+        std::vector<bool> kept;
+        std::vector<int> removed;
+
+        // inference
+        Eigen::VectorXd kernel_column;
+        Eigen::MatrixXd feature_solve;
+        Eigen::MatrixXd trend_weights;
+
+        // prediction
+        Eigen::MatrixXd mixed_cov;
+        Eigen::MatrixXd gamma;
+        Eigen::MatrixXd residual_features;
+    };
+
     covariance_functions::CovFunc* covFunc_;
     covariance_functions::CovFunc* covFuncProj_;
+
+    // The data and the matrices that depend on it are allocated for a
+    // capacity of points, only the first num_points_ entries (the leading
+    // block of the matrices) are in use.
+    int num_points_;
+    bool heteroscedastic_; // data_var_ holds the noise of each point
     Eigen::VectorXd data_loc_;
     Eigen::VectorXd data_out_;
     Eigen::VectorXd data_var_;
     Eigen::MatrixXd gram_matrix_;
     Eigen::VectorXd alpha_;
-    Eigen::LDLT<Eigen::MatrixXd> chol_gram_matrix_;
+    Eigen::MatrixXd chol_gram_matrix_; // lower Cholesky factor of the Gram matrix, the upper part is unused
     double log_noise_sd_;
     bool use_explicit_trend_;
     Eigen::MatrixXd feature_vectors_;
     Eigen::MatrixXd feature_matrix_;
     Eigen::LDLT<Eigen::MatrixXd> chol_feature_matrix_;
     Eigen::VectorXd beta_;
+    int updates_since_factorization_;
+    mutable Workspace workspace_;
+
+    /*!
+     * Grows the storage of the data and the matrices to hold at least the
+     * given number of points, keeping the current content.
+     */
+    void ensureCapacity(int points);
+
+    /*!
+     * Replaces the stored data, without updating the inference.
+     */
+    void storeData(const Eigen::Ref<const Eigen::VectorXd>& data_loc,
+                   const Eigen::Ref<const Eigen::VectorXd>& data_out,
+                   const Eigen::Ref<const Eigen::VectorXd>& data_var);
+
+    /*!
+     * Solves the Gram matrix system K x = rhs with the stored Cholesky factor.
+     */
+    Eigen::MatrixXd solveGram(const Eigen::MatrixXd& rhs) const;
+
+    /*!
+     * Same as solveGram(), but overwrites rhs with the solution.
+     */
+    template<typename Derived>
+    void solveGramInPlace(const Eigen::MatrixBase<Derived>& rhs) const;
+
+    /*!
+     * Predicts the mean and optionally the variances for the given locations
+     * with the given covariance function.
+     */
+    void predict(covariance_functions::CovFunc* covFunc,
+                 const Eigen::Ref<const Eigen::VectorXd>& locations,
+                 Eigen::Ref<Eigen::VectorXd> mean,
+                 Eigen::VectorXd* variances) const;
+
+    /*!
+     * Computes alpha and the explicit trend terms from a valid Cholesky
+     * factorization of the Gram matrix.
+     */
+    void updateWeights();
+
+    /*!
+     * Tries to move the current inference to the given dataset by removing
+     * the points that are no longer present and appending the new ones with
+     * rank-one updates of the Cholesky factor. Returns false if this is not
+     * possible or not worth it, the caller has to run a full infer() then.
+     */
+    bool updateInference(const Eigen::Ref<const Eigen::VectorXd>& data_loc,
+                         const Eigen::Ref<const Eigen::VectorXd>& data_out,
+                         const Eigen::Ref<const Eigen::VectorXd>& data_var);
 
 public:
     typedef std::pair<Eigen::VectorXd, Eigen::MatrixXd> VectorMatrixPair;
@@ -106,6 +196,15 @@ public:
      */
     void disableOutputProjection();
 
+    /*!
+     * Allocates the storage for inference on up to \a max_data data points
+     * with subsets of up to \a max_points points, and for prediction at up to
+     * \a max_locations locations at once. Afterwards, inferSD() and the
+     * predict functions that write into a given vector don't allocate memory.
+     * Has to be called after the covariance functions are set.
+     */
+    void reserve(int max_data, int max_points, int max_locations = 2);
+
     /*!
      * Returns a GP sample for the given locations.
      *
@@ -143,11 +242,16 @@ public:
      * where the importance is defined as covariance to the prediction point. If
      * no prediction point is given, the last data point is used (extrapolation
      * mode).
+     *
+     * Points that were already part of the previous subset keep their share
+     * of the Cholesky factorization, only the points that entered or left the
+     * subset are updated. On a sliding window this makes the cost per call
+     * quadratic instead of cubic in \a n.
      */
-    void inferSD(const Eigen::VectorXd& data_loc,
-                 const Eigen::VectorXd& data_out,
+    void inferSD(const Eigen::Ref<const Eigen::VectorXd>& data_loc,
+                 const Eigen::Ref<const Eigen::VectorXd>& data_out,
                  const int n,
-                 const Eigen::VectorXd& data_var = Eigen::VectorXd(),
+                 const Eigen::Ref<const Eigen::VectorXd>& data_var = Eigen::VectorXd(),
                  const double prediction_point = std::numeric_limits<double>::quiet_NaN());
 
     /*!
@@ -164,6 +268,13 @@ public:
      */
     Eigen::VectorXd predict(const Eigen::VectorXd& locations, Eigen::VectorXd* variances = nullptr) const;
 
+    /*!
+     * Same as predict(), but writes the mean into the given vector. This
+     * doesn't allocate memory if no variances are requested.
+     */
+    void predict(const Eigen::Ref<const Eigen::VectorXd>& locations, Eigen::Ref<Eigen::VectorXd> mean,
+                 Eigen::VectorXd* variances = nullptr) const;
+
     /*!
      * Predicts the mean and covariance for a vector of locations based on
      * the output projection.
@@ -173,6 +284,13 @@ public:
      */
     Eigen::VectorXd predictProjected(const Eigen::VectorXd& locations, Eigen::VectorXd* variances = nullptr) const;
 
+    /*!
+     * Same as predictProjected(), but writes the mean into the given vector.
+     * This doesn't allocate memory if no variances are requested.
+     */
+    void predictProjected(const Eigen::Ref<const Eigen::VectorXd>& locations, Eigen::Ref<Eigen::VectorXd> mean,
+                          Eigen::VectorXd* variances = nullptr) const;
+
     /*!
      * Does the real work for predict. Solves the Cholesky decomposition for the
      * given matrices. The Gram matrix and measurements need to be cached
@@ -184,13 +302,19 @@ public:
     /*!
      * Sets the hyperparameters to the given vector.
      */
-    void setHyperParameters(const Eigen::VectorXd& hyperParameters);
+    void setHyperParameters(const Eigen::Ref<const Eigen::VectorXd>& hyperParameters);
 
     /*!
      * Returns the hyperparameters to the given vector.
      */
     Eigen::VectorXd getHyperParameters() const;
 
+    /*!
+     * Writes the hyperparameters to the given vector, which needs to have
+     * the right size already.
+     */
+    void getHyperParameters(Eigen::Ref<Eigen::VectorXd> hyperParameters) const;
+
     /*!
      * Enables the use of a explicit linear basis function.
      */
@@ -41,25 +41,33 @@
 
 #include "gaussian_process_guider.h"
 
+#include <algorithm>
 #include <cmath>
 #include <ctime>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <limits>
+#include <locale>
+#include <string>
 
 #define SAVE_FFT_DATA_ 0
 #define PRINT_TIMINGS_ 0
 
 #define CIRCULAR_BUFFER_SIZE 8192 // for the raw data storage
 #define REGULAR_BUFFER_SIZE 2048 // for the regularized data storage
-#define FFT_SIZE 4096 // for zero-padding the FFT, >= REGULAR_BUFFER_SIZE!
+#define FFT_SIZE 4096 // DFT length of the period spectrum, >= REGULAR_BUFFER_SIZE!
 #define GRID_INTERVAL 5.0
+#define MAX_WARM_START_CELLS 512 // history kept for a warm start, about 40 minutes
+#define SI_SECONDS_PER_SIDEREAL_HOUR 3590.17 // 3600 * 0.99727
 #define MAX_DITHER_STEPS 10 // for our fallback dithering
 
 #define DEFAULT_LEARNING_RATE 0.01 // for a smooth parameter adaptation
 
 #define HYSTERESIS 0.1 // for the hybrid mode
 
+#define DEFAULT_UPDATE_TIME_BUDGET 0.05 // seconds a step waits for a running model update
+
 GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
     start_time_(std::chrono::system_clock::now()),
     last_time_(std::chrono::system_clock::now()),
@@ -70,17 +78,40 @@ GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
     dithering_active_(false),
     dither_offset_(0.0),
     circular_buffer_data_(CIRCULAR_BUFFER_SIZE),
+    regular_grid_(),
+    period_spectrum_(FFT_SIZE),
+    spectrum_shifts_(0),
+    spectrum_power_(FFT_SIZE / 2 + 1),
+    spectrum_frequencies_(FFT_SIZE / 2 + 1),
+    submitted_points_(0),
     covariance_function_(),
     output_covariance_function_(),
     gp_(covariance_function_),
+    asynchronous_update_(false),
+    update_time_budget_(DEFAULT_UPDATE_TIME_BUDGET),
+    warm_started_(false),
+    update_pending_(false),
+    update_running_(false),
+    stop_update_thread_(false),
     learning_rate_(DEFAULT_LEARNING_RATE),
     parameters(parameters)
 {
     circular_buffer_data_.push_front(data_point()); // add first point
     circular_buffer_data_[0].control = 0; // set first control to zero
+    covariance_function_.setGridSpacing(GRID_INTERVAL); // the regularized data lies on a grid
+    gp_.setCovarianceFunction(covariance_function_);
     gp_.enableExplicitTrend(); // enable the explicit basis function for the linear drift
     gp_.enableOutputProjection(output_covariance_function_); // for prediction
 
+    // allocate everything a guiding step needs up front, so that the steps don't allocate memory
+    // The grid has room for the new cells of an update before the oldest ones are removed.
+    regular_grid_.timestamps.reserve(2 * REGULAR_BUFFER_SIZE);
+    regular_grid_.gear_error.reserve(2 * REGULAR_BUFFER_SIZE);
+    regular_grid_.variances.reserve(2 * REGULAR_BUFFER_SIZE);
+    pending_update_.points.reserve(CIRCULAR_BUFFER_SIZE);
+    current_update_.points.reserve(CIRCULAR_BUFFER_SIZE);
+    gp_.reserve(REGULAR_BUFFER_SIZE, std::min(parameters.points_for_approximation_, REGULAR_BUFFER_SIZE));
+
     std::vector<double> hyperparameters(NumParameters);
     hyperparameters[SE0KLengthScale] = parameters.SE0KLengthScale_;
     hyperparameters[SE0KSignalVariance] = parameters.SE0KSignalVariance_;
@@ -94,6 +125,7 @@ GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
 
 GaussianProcessGuider::~GaussianProcessGuider()
 {
+    StopUpdateThread();
 }
 
 void GaussianProcessGuider::SetTimestamp()
@@ -142,84 +174,136 @@ double GaussianProcessGuider::CalculateVariance(double SNR)
 
 void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_limits<double>::quiet_NaN()*/)
 {
-#if PRINT_TIMINGS_
-    clock_t begin = std::clock(); // this is for timing the method in a simple way
-#endif
+    WaitForUpdate(-1.0); // the working model must not be in use by the update thread
 
-    size_t N = get_number_of_measurements();
+    current_update_.points.clear();
+    CollectUpdate(prediction_point, get_last_point().timestamp, current_update_);
+    RunUpdate(current_update_);
 
-    // initialize the different vectors needed for the GP
-    Eigen::VectorXd timestamps(N-1);
-    Eigen::VectorXd measurements(N-1);
-    Eigen::VectorXd variances(N-1);
-    Eigen::VectorXd sum_controls(N-1);
+    if (asynchronous_update_)
+    {
+        PublishModel();
+    }
+}
 
-    double sum_control = 0;
+void GaussianProcessGuider::CollectUpdate(double prediction_point, double last_timestamp, update_job& job)
+{
+    size_t N = get_number_of_measurements();
 
-    // transfer the data from the circular buffer to the Eigen::Vectors
-    for (size_t i = 0; i < N-1; i++)
+    // Once the circular buffer is full, every new point pushes out the oldest
+    // one. The grid cells before the oldest remaining point are dropped then.
+    job.data_start = -std::numeric_limits<double>::infinity();
+    if (circular_buffer_data_.size() == circular_buffer_data_.capacity())
     {
-        sum_control += circular_buffer_data_[i].control; // sum over the control signals
-        timestamps(i) = circular_buffer_data_[i].timestamp;
-        measurements(i) = circular_buffer_data_[i].measurement;
-        variances(i) = circular_buffer_data_[i].variance;
-        sum_controls(i) = sum_control; // store current accumulated control signal
+        job.data_start = circular_buffer_data_[0].timestamp;
     }
 
-    Eigen::VectorXd gear_error(N-1);
-    Eigen::VectorXd linear_fit(N-1);
+    // the last point is still incomplete
+    for (size_t i = submitted_points_; i < N-1; i++)
+    {
+        job.points.push_back(circular_buffer_data_[i]);
+    }
+    submitted_points_ = N-1;
 
-    // calculate the accumulated gear error
-    gear_error = sum_controls + measurements; // for each time step, add the residual error
+    job.prediction_point = prediction_point + dither_offset_; // in gear time, like the data
+    job.last_timestamp = last_timestamp;
+    job.parameters = parameters;
+}
 
+void GaussianProcessGuider::RunUpdate(const update_job& job)
+{
 #if PRINT_TIMINGS_
-    clock_t end = std::clock();
-    double time_init = double(end - begin) / CLOCKS_PER_SEC;
-    begin = std::clock();
+    clock_t begin = std::clock(); // this is for timing the method in a simple way
 #endif
 
-    // regularize the measurements
-    Eigen::MatrixXd result = regularize_dataset(timestamps, gear_error, variances);
+    // regularize the measurements that were completed since the last update
+    for (const data_point& point : job.points)
+    {
+        regular_grid_.sum_control += point.control; // sum over the control signals
 
-    // the three vectors are returned in a matrix, we need to extract them
-    timestamps = result.row(0);
-    gear_error = result.row(1);
-    variances = result.row(2);
+        // the accumulated gear error is the control plus the residual error
+        regular_grid_.add(point.timestamp, regular_grid_.sum_control + point.measurement, point.variance);
+    }
+
+    // Drop the cells that end before the oldest raw point and the oldest
+    // cells beyond the size of the grid. The spectrum moves its window along,
+    // the GP removes the dropped cells from its factorization.
+    size_t num_cells = regular_grid_.timestamps.size();
+    size_t drop = 0;
+    while (drop < num_cells && regular_grid_.timestamps[drop] + 0.5 * GRID_INTERVAL <= job.data_start)
+    {
+        ++drop;
+    }
+    drop = std::max(drop, num_cells - std::min<size_t>(num_cells, REGULAR_BUFFER_SIZE));
+
+    if (drop > 0)
+    {
+        // Each shift adds round-off error, the spectrum is transformed anew
+        // once its whole window has been replaced.
+        int spectrum_size = period_spectrum_.size();
+        if (static_cast<int>(drop) >= spectrum_size || spectrum_shifts_ + static_cast<int>(drop) > REGULAR_BUFFER_SIZE)
+        {
+            period_spectrum_.clear();
+            spectrum_shifts_ = 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < drop; ++i)
+            {
+                period_spectrum_.remove_first(regular_grid_.timestamps[i], regular_grid_.gear_error[i]);
+            }
+            spectrum_shifts_ += static_cast<int>(drop);
+        }
+        regular_grid_.remove_front(drop);
+    }
 
 #if PRINT_TIMINGS_
-    end = std::clock();
+    clock_t end = std::clock();
     double time_regularize = double(end - begin) / CLOCKS_PER_SEC;
     begin = std::clock();
 #endif
 
-    // linear least squares regression for offset and drift to de-trend the data
-    Eigen::MatrixXd feature_matrix(2, timestamps.rows());
-    feature_matrix.row(0) = Eigen::MatrixXd::Ones(1, timestamps.rows()); // timestamps.pow(0)
-    feature_matrix.row(1) = timestamps.array(); // timestamps.pow(1)
-
-    // this is the inference for linear regression
-    Eigen::VectorXd weights = (feature_matrix*feature_matrix.transpose()
-    + 1e-3*Eigen::Matrix<double, 2, 2>::Identity()).ldlt().solve(feature_matrix*gear_error);
+    // the GP and the spectrum work on the grid directly, without copies
+    int grid_size = static_cast<int>(regular_grid_.timestamps.size());
+    Eigen::Map<const Eigen::VectorXd> timestamps(regular_grid_.timestamps.data(), grid_size);
+    Eigen::Map<const Eigen::VectorXd> gear_error(regular_grid_.gear_error.data(), grid_size);
+    Eigen::Map<const Eigen::VectorXd> variances(regular_grid_.variances.data(), grid_size);
 
-    // calculate the linear regression for all datapoints
-    linear_fit = weights.transpose()*feature_matrix;
+#if PRINT_TIMINGS_
+    end = std::clock();
+    double time_init = double(end - begin) / CLOCKS_PER_SEC;
+    begin = std::clock();
+#endif
 
-    // subtract polynomial fit from the data points
-    Eigen::VectorXd gear_error_detrend = gear_error - linear_fit;
+    // Update the spectrum with the new grid cells. A new grid is transformed
+    // at once, otherwise only the new cells are added.
+    if (period_spectrum_.size() == 0)
+    {
+        period_spectrum_.assign(timestamps, gear_error);
+        spectrum_shifts_ = 0;
+    }
+    else
+    {
+        for (int i = period_spectrum_.size(); i < grid_size; ++i)
+        {
+            period_spectrum_.add(timestamps(i), gear_error(i));
+        }
+    }
 
 #if PRINT_TIMINGS_
     end = std::clock();
-    double time_detrend = double(end - begin) / CLOCKS_PER_SEC;
+    double time_spectrum = double(end - begin) / CLOCKS_PER_SEC;
     begin = std::clock();
-    double time_fft = 0; // need to initialize in case the FFT isn't calculated
+    double time_fft = 0; // need to initialize in case the period isn't estimated
 #endif
 
     // calculate period length if we have enough points already
-    double period_length = GetGPHyperparameters()[PKPeriodLength];
-    if (GetBoolComputePeriod() && get_last_point().timestamp > parameters.min_periods_for_period_estimation_ * period_length)
+    double period_length = GetHyperparameters(gp_)(PKPeriodLength);
+    if (job.parameters.compute_period_
+        && job.last_timestamp > job.parameters.min_periods_for_period_estimation_ * period_length)
     {
-        // find periodicity parameter with FFT
-        period_length = EstimatePeriodLength(timestamps, gear_error_detrend);
+        // find periodicity parameter from the spectrum
+        period_length = EstimatePeriodLength();
         UpdatePeriodLength(period_length);
 
 #if PRINT_TIMINGS_
@@ -232,31 +316,133 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
     begin = std::clock();
 #endif
 
-    // inference of the GP with the new points, maximum accuracy should be reached around current time
-    gp_.inferSD(timestamps, gear_error, parameters.points_for_approximation_, variances, prediction_point);
+    // inference of the GP with the new points, maximum accuracy should be reached around current time.
+    // The GP reuses its factorization for the points that were already selected in the last step.
+    gp_.inferSD(timestamps, gear_error, job.parameters.points_for_approximation_, variances, job.prediction_point);
 
 #if PRINT_TIMINGS_
     end = std::clock();
     double time_gp = double(end - begin) / CLOCKS_PER_SEC;
 
-    printf("timings: init: %f, regularize: %f, detrend: %f, fft: %f, gp: %f, total: %f\n",
-           time_init, time_regularize, time_detrend, time_fft, time_gp,
-           time_init + time_regularize + time_detrend + time_fft + time_gp);
+    printf("timings: init: %f, regularize: %f, spectrum: %f, fft: %f, gp: %f, total: %f\n",
+           time_init, time_regularize, time_spectrum, time_fft, time_gp,
+           time_init + time_regularize + time_spectrum + time_fft + time_gp);
 #endif
 }
 
+void GaussianProcessGuider::SubmitUpdate(double prediction_point)
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    if (!update_pending_)
+    {
+        pending_update_.points.clear();
+    }
+
+    // The measurement of this step is complete now, only the new point is
+    // open. If the thread did not get to the last job, both are done at once.
+    CollectUpdate(prediction_point, get_second_last_point().timestamp, pending_update_);
+    update_pending_ = true;
+    update_requested_.notify_one();
+}
+
+bool GaussianProcessGuider::WaitForUpdate(double timeout)
+{
+    std::unique_lock<std::mutex> lock(update_mutex_);
+    auto idle = [this] { return !update_pending_ && !update_running_; };
+
+    if (timeout < 0.0)
+    {
+        update_finished_.wait(lock, idle);
+        return true;
+    }
+    return update_finished_.wait_for(lock, std::chrono::duration<double>(timeout), idle);
+}
+
+void GaussianProcessGuider::UpdateThread()
+{
+    std::unique_lock<std::mutex> lock(update_mutex_);
+    while (true)
+    {
+        update_requested_.wait(lock, [this] { return update_pending_ || stop_update_thread_; });
+        if (stop_update_thread_)
+        {
+            break;
+        }
+
+        std::swap(current_update_, pending_update_); // keeps the memory of both jobs
+        update_pending_ = false;
+        update_running_ = true;
+        lock.unlock();
+
+        RunUpdate(current_update_);
+        std::shared_ptr<const GP> model = std::make_shared<GP>(gp_);
+
+        lock.lock();
+        model_ = model;
+        update_running_ = false;
+        update_finished_.notify_all();
+    }
+}
+
+void GaussianProcessGuider::StartUpdateThread()
+{
+    if (update_thread_.joinable())
+    {
+        return;
+    }
+    PublishModel();
+    stop_update_thread_ = false;
+    update_thread_ = std::thread(&GaussianProcessGuider::UpdateThread, this);
+}
+
+void GaussianProcessGuider::StopUpdateThread()
+{
+    if (!update_thread_.joinable())
+    {
+        return;
+    }
+    WaitForUpdate(-1.0); // finish the data that was already submitted
+    {
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        stop_update_thread_ = true;
+    }
+    update_requested_.notify_one();
+    update_thread_.join();
+}
+
+void GaussianProcessGuider::PublishModel()
+{
+    std::shared_ptr<const GP> model = std::make_shared<GP>(gp_);
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    model_ = model;
+}
+
+std::shared_ptr<const GP> GaussianProcessGuider::GetModel() const
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    return model_;
+}
+
 double GaussianProcessGuider::PredictGearError(double prediction_location)
 {
     // in the first step of each sequence, use the current time stamp as last prediction end
     if (last_prediction_end_ < 0.0)
     {
-        last_prediction_end_ = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+        last_prediction_end_ = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count()
+            + dither_offset_;
     }
 
     // prediction from the last endpoint to the prediction point
-    Eigen::VectorXd next_location(2);
-    next_location << last_prediction_end_, prediction_location + dither_offset_;
-    Eigen::VectorXd prediction = gp_.predictProjected(next_location);
+    Eigen::Vector2d next_location(last_prediction_end_, prediction_location + dither_offset_);
+    Eigen::Vector2d prediction;
+    if (asynchronous_update_)
+    {
+        GetModel()->predictProjected(next_location, prediction);
+    }
+    else
+    {
+        gp_.predictProjected(next_location, prediction);
+    }
 
     double p1 = prediction(1);
     double p0 = prediction(0);
@@ -321,22 +507,34 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     }
     assert(std::abs(control_signal_) == 0.0 || std::abs(input) >= parameters.min_move_);
 
+    if (prediction_point < 0.0)
+    {
+        prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+    }
+
     // calculate GP prediction
-    if (get_number_of_measurements() > 10)
+    if (CanPredict())
     {
-        if (prediction_point < 0.0)
+        if (asynchronous_update_)
         {
-            prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+            // the model was updated in the background since the last step
+            if (!WaitForUpdate(update_time_budget_))
+            {
+                GPDebug->Log("PPEC: model update exceeds the time budget, using the previous model");
+            }
+        }
+        else
+        {
+            // the point of highest precision shoud be between now and the next step
+            UpdateGP(prediction_point + 0.5 * time_step);
         }
-        // the point of highest precision shoud be between now and the next step
-        UpdateGP(prediction_point + 0.5 * time_step);
 
         // the prediction should end after one time step
         prediction_ = PredictGearError(prediction_point + time_step);
         control_signal_ += parameters.prediction_gain_ * prediction_; // add the prediction
 
         // smoothly blend over between hysteresis and GP
-        period_length = GetGPHyperparameters()[PKPeriodLength];
+        period_length = GetPeriodLength();
         if (get_last_point().timestamp < parameters.min_periods_for_inference_ * period_length)
         {
             double percentage = get_last_point().timestamp / (parameters.min_periods_for_inference_ * period_length);
@@ -347,7 +545,7 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     }
     else
     {
-        period_length = GetGPHyperparameters()[PKPeriodLength]; // for logging
+        period_length = GetPeriodLength(); // for logging
     }
 
     // assert for the developers...
@@ -362,6 +560,12 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     add_one_point(); // add new point here, since the control is for the next point in time
     HandleControls(control_signal_); // already store control signal
 
+    if (asynchronous_update_ && CanPredict())
+    {
+        // the point of highest precision should be between the next step and the one after
+        SubmitUpdate(prediction_point + 1.5 * time_step);
+    }
+
     GPDebug->Log("PPEC rslt: input = %.2f, final = %.2f, react = %.2f, pred = %.2f, hyst = %.2f, hyst_pct = %.2f, period_length = %.2f",
         input, control_signal_, parameters.control_gain_ * input, parameters.prediction_gain_ * prediction_, hysteresis_control,
         hyst_percentage, period_length);
@@ -373,17 +577,29 @@ double GaussianProcessGuider::deduceResult(double time_step, double prediction_p
 {
     HandleDarkGuiding();
 
+    if (prediction_point < 0.0)
+    {
+        prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+    }
+
     control_signal_ = 0; // no measurement!
     // check if we are allowed to use the GP
-    if (get_number_of_measurements() > 10
-        && get_last_point().timestamp > parameters.min_periods_for_inference_ * GetGPHyperparameters()[PKPeriodLength])
+    if (CanPredict()
+        && get_last_point().timestamp > parameters.min_periods_for_inference_ * GetPeriodLength())
     {
-        if (prediction_point < 0.0)
+        if (asynchronous_update_)
+        {
+            // the model was updated in the background since the last step
+            if (!WaitForUpdate(update_time_budget_))
+            {
+                GPDebug->Log("PPEC: model update exceeds the time budget, using the previous model");
+            }
+        }
+        else
         {
-            prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+            // the point of highest precision should be between now and the next step
+            UpdateGP(prediction_point + 0.5 * time_step);
         }
-        // the point of highest precision should be between now and the next step
-        UpdateGP(prediction_point + 0.5 * time_step);
 
         // the prediction should end after one time step
         prediction_ = PredictGearError(prediction_point + time_step);
@@ -393,6 +609,12 @@ double GaussianProcessGuider::deduceResult(double time_step, double prediction_p
     add_one_point(); // add new point here, since the control is for the next point in time
     HandleControls(control_signal_); // already store control signal
 
+    if (asynchronous_update_ && CanPredict())
+    {
+        // the point of highest precision should be between the next step and the one after
+        SubmitUpdate(prediction_point + 1.5 * time_step);
+    }
+
     // assert for the developers...
     assert(!math_tools::isNaN(control_signal_));
 
@@ -407,9 +629,20 @@ double GaussianProcessGuider::deduceResult(double time_step, double prediction_p
 
 void GaussianProcessGuider::reset()
 {
+    WaitForUpdate(-1.0); // the update thread must not use the data we clear
+
     circular_buffer_data_.clear();
+    regular_grid_.clear();
+    period_spectrum_.clear();
+    spectrum_shifts_ = 0;
+    submitted_points_ = 0;
     gp_.clearData();
 
+    if (asynchronous_update_)
+    {
+        PublishModel();
+    }
+
     // We need to add a first data point because the measurements are always relative to the control.
     // For the first measurement, we therefore need to add a point with zero control.
     circular_buffer_data_.push_front(data_point()); // add first point
@@ -422,6 +655,194 @@ void GaussianProcessGuider::reset()
     dither_offset_ = 0.0;
     dither_steps_ = 0;
     dithering_active_ = false;
+    warm_started_ = false;
+}
+
+bool GaussianProcessGuider::GetModelState(model_state& state)
+{
+    WaitForUpdate(-1.0); // the update thread must not change the grid while we copy it
+
+    size_t cells = regular_grid_.timestamps.size();
+    if (cells * GRID_INTERVAL < GetPeriodLength())
+    {
+        return true; // not worth keeping
+    }
+
+    size_t first = cells > MAX_WARM_START_CELLS ? cells - MAX_WARM_START_CELLS : 0;
+    state.timestamps.assign(regular_grid_.timestamps.begin() + first, regular_grid_.timestamps.end());
+    state.gear_error.assign(regular_grid_.gear_error.begin() + first, regular_grid_.gear_error.end());
+    state.variances.assign(regular_grid_.variances.begin() + first, regular_grid_.variances.end());
+    state.hyperparameters = GetGPHyperparameters();
+
+    // the grid only holds complete cells, the last measurement can be later
+    state.end = regular_grid_.last_timestamp;
+    if (get_number_of_measurements() > 1)
+    {
+        state.end = std::max(state.end, get_second_last_point().timestamp);
+    }
+    return false;
+}
+
+double GaussianProcessGuider::AxisRotationGearTime(double from_axis_angle, double to_axis_angle)
+{
+    double hours = std::fmod(to_axis_angle - from_axis_angle, 24.0);
+    if (hours < -12.0)
+    {
+        hours += 24.0;
+    }
+    else if (hours >= 12.0)
+    {
+        hours -= 24.0;
+    }
+    return hours * SI_SECONDS_PER_SIDEREAL_HOUR;
+}
+
+bool GaussianProcessGuider::WarmStart(const model_state& state, double gear_time_elapsed)
+{
+    reset();
+
+    size_t cells = state.timestamps.size();
+    if (cells == 0 || state.gear_error.size() != cells || state.variances.size() != cells
+        || state.hyperparameters.size() != NumParameters || !(state.hyperparameters[PKPeriodLength] > 0.0))
+    {
+        return true;
+    }
+    for (size_t i = 1; i < cells; ++i)
+    {
+        if (std::abs(state.timestamps[i] - state.timestamps[i-1] - GRID_INTERVAL) > 1e-6)
+        {
+            return true; // not a contiguous grid
+        }
+    }
+
+    // The new measurements continue at gear time state.end + gear_time_elapsed,
+    // in general at a different phase than the end of the history. Dropping
+    // less than one period of cells from the end of the history moves its end
+    // to just before the same phase, so that the new data joins the history
+    // without a gap in the grid. The new data starts the remaining fraction
+    // of a cell after the end of the history.
+    double period_length = state.hyperparameters[PKPeriodLength];
+    double history_end = state.timestamps.back() + 0.5 * GRID_INTERVAL;
+    double drop = std::fmod(history_end - (state.end + gear_time_elapsed), period_length);
+    if (drop < 0.0)
+    {
+        drop += period_length;
+    }
+    size_t drop_cells = static_cast<size_t>(std::ceil(drop / GRID_INTERVAL));
+    double phase_offset = drop_cells * GRID_INTERVAL - drop; // in [0, GRID_INTERVAL)
+    if (drop_cells >= cells)
+    {
+        return true;
+    }
+
+    size_t keep = std::min<size_t>(cells - drop_cells, MAX_WARM_START_CELLS);
+    if (keep * GRID_INTERVAL < period_length)
+    {
+        return true; // less than a period of history left
+    }
+    size_t first = cells - drop_cells - keep;
+
+    // The history is moved to start at zero. The gear error of a new session
+    // starts at zero, so the history is shifted to end there.
+    double time_offset = state.timestamps[first] - 0.5 * GRID_INTERVAL;
+    double level = state.gear_error[first + keep - 1];
+    for (size_t i = first; i < first + keep; ++i)
+    {
+        regular_grid_.timestamps.push_back(state.timestamps[i] - time_offset);
+        regular_grid_.gear_error.push_back(state.gear_error[i] - level);
+        regular_grid_.variances.push_back(state.variances[i]);
+    }
+
+    // the first new cell starts where the history ends
+    double resume_time = keep * GRID_INTERVAL;
+    regular_grid_.last_cell_end = resume_time;
+    regular_grid_.last_timestamp = resume_time;
+    regular_grid_.last_gear_error = 0.0;
+    regular_grid_.last_variance = regular_grid_.variances.back();
+    dither_offset_ = resume_time + phase_offset; // the timestamps of the new measurements continue from here
+
+    SetWorkingHyperparameters(hyperparameter_vector::Map(state.hyperparameters.data()));
+    warm_started_ = true;
+
+    // infer the model from the history, so that the first step can predict
+    current_update_.points.clear();
+    CollectUpdate(0.0, dither_offset_, current_update_);
+    RunUpdate(current_update_);
+
+    if (asynchronous_update_)
+    {
+        PublishModel();
+    }
+
+    GPDebug->Log("PPEC: warm start with %d cells of history, %d dropped for phase alignment",
+        static_cast<int>(keep), static_cast<int>(drop_cells));
+
+    return false;
+}
+
+bool GaussianProcessGuider::model_state::write(std::ostream& out) const
+{
+    out.imbue(std::locale::classic());
+    out << std::setprecision(17);
+    out << "PPEC model state 1\n";
+    out << "end " << end << "\n";
+    out << "hyperparameters " << hyperparameters.size();
+    for (double h : hyperparameters)
+    {
+        out << " " << h;
+    }
+    out << "\n";
+    out << "cells " << timestamps.size() << "\n";
+    for (size_t i = 0; i < timestamps.size(); ++i)
+    {
+        out << timestamps[i] << " " << gear_error[i] << " " << variances[i] << "\n";
+    }
+    return !out;
+}
+
+bool GaussianProcessGuider::model_state::read(std::istream& in)
+{
+    in.imbue(std::locale::classic());
+
+    std::string header;
+    std::getline(in, header);
+    if (header != "PPEC model state 1" && header != "PPEC model state 1\r")
+    {
+        return true;
+    }
+
+    std::string key;
+    size_t count;
+    in >> key >> end;
+    if (!in || key != "end")
+    {
+        return true;
+    }
+
+    in >> key >> count;
+    if (!in || key != "hyperparameters" || count != NumParameters)
+    {
+        return true;
+    }
+    hyperparameters.resize(count);
+    for (double& h : hyperparameters)
+    {
+        in >> h;
+    }
+
+    in >> key >> count;
+    if (!in || key != "cells" || count > 4 * MAX_WARM_START_CELLS)
+    {
+        return true;
+    }
+    timestamps.resize(count);
+    gear_error.resize(count);
+    variances.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        in >> timestamps[i] >> gear_error[i] >> variances[i];
+    }
+    return !in;
 }
 
 void GaussianProcessGuider::GuidingDithered(double amt, double rate)
@@ -471,22 +892,54 @@ bool GaussianProcessGuider::SetBoolComputePeriod(bool active) {
 
 std::vector<double> GaussianProcessGuider::GetGPHyperparameters() const
 {
+    hyperparameter_vector hyperparameters = asynchronous_update_ ? GetHyperparameters(*GetModel())
+                                                                 : GetHyperparameters(gp_);
+    return std::vector<double>(hyperparameters.data(), hyperparameters.data() + NumParameters);
+}
+
+double GaussianProcessGuider::GetPeriodLength() const
+{
+    if (asynchronous_update_)
+    {
+        return GetHyperparameters(*GetModel())(PKPeriodLength);
+    }
+    return GetHyperparameters(gp_)(PKPeriodLength);
+}
+
+bool GaussianProcessGuider::SetGPHyperparameters(std::vector<double> const &hyperparameters)
+{
+    assert(hyperparameters.size() == NumParameters);
+
+    WaitForUpdate(-1.0); // the working model must not be in use by the update thread
+
+    SetWorkingHyperparameters(hyperparameter_vector::Map(&hyperparameters[0]));
+
+    if (asynchronous_update_)
+    {
+        PublishModel();
+    }
+    return false;
+}
+
+GaussianProcessGuider::hyperparameter_vector GaussianProcessGuider::GetHyperparameters(const GP& gp)
+{
+    // fixed-size vectors, so that this can be used in every step without allocating
+    Eigen::Matrix<double, NumParameters + 1, 1> hyperparameters_full;
+    gp.getHyperParameters(hyperparameters_full);
+
     // since the GP class works in log space, we have to exp() the parameters first.
-    Eigen::VectorXd hyperparameters_full = gp_.getHyperParameters().array().exp();
     // remove first parameter, which is unused here
-    Eigen::VectorXd hyperparameters = hyperparameters_full.tail(NumParameters);
+    hyperparameter_vector hyperparameters = hyperparameters_full.tail<NumParameters>().array().exp();
 
     // converts the length-scale of the periodic covariance from standard notation to natural units
     hyperparameters(PKLengthScale) = std::asin(hyperparameters(PKLengthScale)/4.0)*hyperparameters(PKPeriodLength)/M_PI;
 
-    // we need to map the Eigen::vector into a std::vector.
-    return std::vector<double>(hyperparameters.data(), // the first element is at the array address
-                               hyperparameters.data() + NumParameters);
+    return hyperparameters;
 }
 
-bool GaussianProcessGuider::SetGPHyperparameters(std::vector<double> const &hyperparameters)
+void GaussianProcessGuider::SetWorkingHyperparameters(const hyperparameter_vector& hyperparameters)
 {
-    Eigen::VectorXd hyperparameters_eig = Eigen::VectorXd::Map(&hyperparameters[0], hyperparameters.size());
+    hyperparameter_vector hyperparameters_eig = hyperparameters;
 
     // prevent length scales from becoming too small (makes GP unstable)
     hyperparameters_eig(SE0KLengthScale) = std::max(hyperparameters_eig(SE0KLengthScale), 1.0);
@@ -501,12 +954,12 @@ bool GaussianProcessGuider::SetGPHyperparameters(std::vector<double> const &hype
     hyperparameters_eig = hyperparameters_eig.array().max(1e-10);
 
     // need to convert to GP parameters
-    Eigen::VectorXd hyperparameters_full(NumParameters + 1); // the GP has one more parameter!
+    Eigen::Matrix<double, NumParameters + 1, 1> hyperparameters_full; // the GP has one more parameter!
     hyperparameters_full << 1.0, hyperparameters_eig;
 
     // the GP works in log space, therefore we need to convert
-    gp_.setHyperParameters(hyperparameters_full.array().log());
-    return false;
+    hyperparameters_full = hyperparameters_full.array().log();
+    gp_.setHyperParameters(hyperparameters_full);
 }
 
 double GaussianProcessGuider::GetMinMove() const {
@@ -523,7 +976,9 @@ int GaussianProcessGuider::GetNumPointsForApproximation() const {
 }
 
 bool GaussianProcessGuider::SetNumPointsForApproximation(int num_points) {
+    WaitForUpdate(-1.0); // the working model must not be in use by the update thread
     parameters.points_for_approximation_ = num_points;
+    gp_.reserve(REGULAR_BUFFER_SIZE, std::min(num_points, REGULAR_BUFFER_SIZE));
     return false;
 }
 
@@ -549,6 +1004,42 @@ double GaussianProcessGuider::GetPredictionGain() const {
     return parameters.prediction_gain_;
 }
 
+bool GaussianProcessGuider::GetAsynchronousUpdate() const {
+    return asynchronous_update_;
+}
+
+bool GaussianProcessGuider::SetAsynchronousUpdate(bool active) {
+    if (active == asynchronous_update_)
+    {
+        return false;
+    }
+    if (active)
+    {
+        StartUpdateThread();
+    }
+    else
+    {
+        StopUpdateThread(); // the working model is up to date afterwards
+    }
+    asynchronous_update_ = active;
+    return false;
+}
+
+double GaussianProcessGuider::GetUpdateTimeBudget() const {
+    return update_time_budget_;
+}
+
+bool GaussianProcessGuider::SetUpdateTimeBudget(double seconds) {
+    bool error = false;
+    if (seconds < 0.0)
+    {
+        seconds = DEFAULT_UPDATE_TIME_BUDGET;
+        error = true;
+    }
+    update_time_budget_ = seconds;
+    return error;
+}
+
 bool GaussianProcessGuider::SetPredictionGain(double prediction_gain) {
     parameters.prediction_gain_ = prediction_gain;
     return false;
@@ -566,22 +1057,26 @@ void GaussianProcessGuider::inject_data_point(double timestamp, double input, do
     HandleControls(control); // already store control signal
 }
 
-double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time, const Eigen::VectorXd& data) {
-    // compute Hamming window to reduce spectral leakage
-    Eigen::VectorXd windowed_data = data.array() * math_tools::hamming_window(data.rows()).array();
+double GaussianProcessGuider::EstimatePeriodLength() {
+    // The spectrum of the detrended data is kept up to date in UpdateGP. It is
+    // not windowed: a window over the whole history would change with every
+    // new sample and could not be updated incrementally.
+    // The spectrum is written to preallocated buffers, this runs in every step.
+    int num_bins = period_spectrum_.spectrum(spectrum_power_, spectrum_frequencies_);
 
-    // compute the spectrum
-    std::pair<Eigen::VectorXd, Eigen::VectorXd> result = math_tools::compute_spectrum(windowed_data, FFT_SIZE);
+    Eigen::Map<Eigen::ArrayXd> amplitudes(spectrum_power_.data(), num_bins);
+    Eigen::Map<Eigen::ArrayXd> frequencies(spectrum_frequencies_.data(), num_bins);
 
-    Eigen::ArrayXd amplitudes = result.first;
-    Eigen::ArrayXd frequencies = result.second;
+    if (amplitudes.size() == 0)
+    {
+        return GetHyperparameters(gp_)(PKPeriodLength); // not enough data yet
+    }
 
-    double dt = (time(time.rows()-1) - time(0))/(time.rows()-1); // (t_end - t_begin) / num_t
+    double dt = GRID_INTERVAL; // the regularized data has a fixed step width
 
     frequencies /= dt; // correct for the average time step width
 
-    Eigen::ArrayXd periods = 1/frequencies.array();
-    amplitudes = (periods > 1500.0).select(0,amplitudes); // set amplitudes to zero for too large periods
+    amplitudes = (1.0 / frequencies > 1500.0).select(0, amplitudes); // set amplitudes to zero for too large periods
 
     assert(amplitudes.size() == frequencies.size());
 
@@ -596,12 +1091,12 @@ double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time,
     {
         double spread = std::abs(frequencies(maxIndex - 1) - frequencies(maxIndex + 1));
 
-        Eigen::VectorXd interp_loc(3);
+        Eigen::Vector3d interp_loc;
         interp_loc << frequencies(maxIndex - 1), frequencies(maxIndex), frequencies(maxIndex + 1);
         interp_loc = interp_loc.array() - max_frequency; // centering for numerical stability
         interp_loc = interp_loc.array() / spread; // normalize for numerical stability
 
-        Eigen::VectorXd interp_dat(3);
+        Eigen::Vector3d interp_dat;
         interp_dat << amplitudes(maxIndex - 1), amplitudes(maxIndex), amplitudes(maxIndex + 1);
         interp_dat = interp_dat.array() / amplitudes(maxIndex); // normalize for numerical stability
 
@@ -614,13 +1109,13 @@ double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time,
 
 
         // building feature matrix
-        Eigen::MatrixXd phi(3,3);
+        Eigen::Matrix3d phi;
         phi.row(0) = interp_loc.array().pow(2);
         phi.row(1) = interp_loc.array().pow(1);
         phi.row(2) = interp_loc.array().pow(0);
 
         // standard equation for linear regression
-        Eigen::VectorXd w = (phi*phi.transpose()).ldlt().solve(phi*interp_dat);
+        Eigen::Vector3d w = (phi*phi.transpose()).ldlt().solve(phi*interp_dat);
 
         // recovering the maximum from the weights relative to the frequency of the maximum
         max_frequency = max_frequency - w(1)/(2*w(0))*spread; // note the de-normalization
@@ -628,6 +1123,7 @@ double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time,
 
 #if SAVE_FFT_DATA_
     {
+        Eigen::ArrayXd periods = 1 / frequencies;
         std::ofstream outfile;
         outfile.open("spectrum_data.csv", std::ios_base::out);
         if (outfile) {
@@ -649,7 +1145,8 @@ double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time,
 
 void GaussianProcessGuider::UpdatePeriodLength(double period_length)
 {
-    std::vector<double> hypers = GetGPHyperparameters();
+    // this runs on the update thread in asynchronous mode, so it works on the working model
+    hyperparameter_vector hypers = GetHyperparameters(gp_);
 
     // assert for the developers...
     assert(!math_tools::isNaN(period_length));
@@ -663,74 +1160,86 @@ void GaussianProcessGuider::UpdatePeriodLength(double period_length)
     // we just apply a simple learning rate to slow down parameter jumps
     hypers[PKPeriodLength] = (1 - learning_rate_) * hypers[PKPeriodLength] + learning_rate_ * period_length;
 
-    SetGPHyperparameters(hypers); // the setter function is needed to convert parameters
+    SetWorkingHyperparameters(hypers); // the setter function is needed to convert parameters
 }
 
 Eigen::MatrixXd GaussianProcessGuider::regularize_dataset(const Eigen::VectorXd& timestamps,
     const Eigen::VectorXd& gear_error, const Eigen::VectorXd& variances)
 {
     size_t N = get_number_of_measurements();
-    double grid_interval = GRID_INTERVAL;
-    double last_cell_end = -grid_interval;
-    double last_timestamp = -grid_interval;
-    double last_gear_error = 0.0;
-    double last_variance = 0.0;
-    double gear_error_sum = 0.0;
-    double variance_sum = 0.0;
-    int grid_size = static_cast<int>(std::ceil(timestamps(timestamps.size() - 1) / grid_interval)) + 1;
-    assert(grid_size > 0);
-    Eigen::VectorXd reg_timestamps(grid_size);
-    Eigen::VectorXd reg_gear_error(grid_size);
-    Eigen::VectorXd reg_variances(grid_size);
-    int j = 0;
+    regular_grid grid;
     for (size_t i = 0; i < N-1; ++i)
     {
-        if (timestamps(i) < last_cell_end + grid_interval)
-        {
-            gear_error_sum += (timestamps(i) - last_timestamp) * 0.5 * (last_gear_error + gear_error(i));
-            variance_sum += (timestamps(i) - last_timestamp) * 0.5 * (last_variance + variances(i));
-            last_timestamp = timestamps(i);
-        }
-        else
+        grid.add(timestamps(i), gear_error(i), variances(i));
+    }
+    int j = static_cast<int>(std::min<size_t>(grid.timestamps.size(), REGULAR_BUFFER_SIZE));
+
+    // We need to output 3 vectors. For simplicity, we join them into a matrix.
+    Eigen::MatrixXd result(3,j);
+    result.row(0) = Eigen::VectorXd::Map(grid.timestamps.data(), j);
+    result.row(1) = Eigen::VectorXd::Map(grid.gear_error.data(), j);
+    result.row(2) = Eigen::VectorXd::Map(grid.variances.data(), j);
+
+    return result;
+}
+
+void GaussianProcessGuider::regular_grid::clear()
+{
+    sum_control = 0.0;
+    last_cell_end = -GRID_INTERVAL;
+    last_timestamp = -GRID_INTERVAL;
+    last_gear_error = 0.0;
+    last_variance = 0.0;
+    gear_error_sum = 0.0;
+    variance_sum = 0.0;
+    timestamps.clear();
+    gear_error.clear();
+    variances.clear();
+}
+
+void GaussianProcessGuider::regular_grid::add(double point_timestamp, double point_gear_error, double point_variance)
+{
+    double grid_interval = GRID_INTERVAL;
+    if (point_timestamp < last_cell_end + grid_interval)
+    {
+        gear_error_sum += (point_timestamp - last_timestamp) * 0.5 * (last_gear_error + point_gear_error);
+        variance_sum += (point_timestamp - last_timestamp) * 0.5 * (last_variance + point_variance);
+        last_timestamp = point_timestamp;
+    }
+    else
+    {
+        while (point_timestamp >= last_cell_end + grid_interval)
         {
-            while (timestamps(i) >= last_cell_end + grid_interval)
-            {
-                double inter_timestamp = last_cell_end + grid_interval;
+            double inter_timestamp = last_cell_end + grid_interval;
 
-                double proportion = (inter_timestamp-last_timestamp)/(timestamps(i)-last_timestamp);
-                double inter_gear_error = proportion*gear_error(i) + (1-proportion)*last_gear_error;
-                double inter_variance = proportion*variances(i) + (1-proportion)*last_variance;
+            double proportion = (inter_timestamp-last_timestamp)/(point_timestamp-last_timestamp);
+            double inter_gear_error = proportion*point_gear_error + (1-proportion)*last_gear_error;
+            double inter_variance = proportion*point_variance + (1-proportion)*last_variance;
 
-                gear_error_sum += (inter_timestamp - last_timestamp) * 0.5 * (last_gear_error + inter_gear_error);
-                variance_sum += (inter_timestamp - last_timestamp) * 0.5 * (last_variance + inter_variance);
+            gear_error_sum += (inter_timestamp - last_timestamp) * 0.5 * (last_gear_error + inter_gear_error);
+            variance_sum += (inter_timestamp - last_timestamp) * 0.5 * (last_variance + inter_variance);
 
-                reg_timestamps(j) = last_cell_end + 0.5 * grid_interval;
-                reg_gear_error(j) = gear_error_sum / grid_interval;
-                reg_variances(j) = variance_sum / grid_interval;
+            timestamps.push_back(last_cell_end + 0.5 * grid_interval);
+            gear_error.push_back(gear_error_sum / grid_interval);
+            variances.push_back(variance_sum / grid_interval);
 
-                last_timestamp = inter_timestamp;
-                last_gear_error = inter_gear_error;
-                last_variance = inter_variance;
-                last_cell_end = inter_timestamp;
+            last_timestamp = inter_timestamp;
+            last_gear_error = inter_gear_error;
+            last_variance = inter_variance;
+            last_cell_end = inter_timestamp;
 
-                gear_error_sum = 0.0;
-                variance_sum = 0.0;
-                ++j;
-            }
+            gear_error_sum = 0.0;
+            variance_sum = 0.0;
         }
     }
-    if (j > REGULAR_BUFFER_SIZE)
-    {
-        j = REGULAR_BUFFER_SIZE;
-    }
-
-    // We need to output 3 vectors. For simplicity, we join them into a matrix.
-    Eigen::MatrixXd result(3,j);
-    result.row(0) = reg_timestamps.head(j);
-    result.row(1) = reg_gear_error.head(j);
-    result.row(2) = reg_variances.head(j);
+}
 
-    return result;
+void GaussianProcessGuider::regular_grid::remove_front(size_t count)
+{
+    count = std::min(count, timestamps.size());
+    timestamps.erase(timestamps.begin(), timestamps.begin() + count);
+    gear_error.erase(gear_error.begin(), gear_error.begin() + count);
+    variances.erase(variances.begin(), variances.begin() + count);
 }
 
 void GaussianProcessGuider::save_gp_data() const
@@ -771,7 +1280,8 @@ void GaussianProcessGuider::save_gp_data() const
     Eigen::VectorXd locations = Eigen::VectorXd::LinSpaced(M, 0, get_second_last_point().timestamp + 1500);
 
     Eigen::VectorXd vars(locations.size());
-    Eigen::VectorXd means = gp_.predictProjected(locations, &vars);
+    Eigen::VectorXd means = asynchronous_update_ ? GetModel()->predictProjected(locations, &vars)
+                                                 : gp_.predictProjected(locations, &vars);
     Eigen::VectorXd stds = vars.array().sqrt();
 
     {
@@ -802,6 +1312,7 @@ void GaussianProcessGuider::save_gp_data() const
 
 void GaussianProcessGuider::SetLearningRate(double learning_rate)
 {
+    WaitForUpdate(-1.0); // the update thread reads the learning rate
     learning_rate_ = learning_rate;
     return;
 }
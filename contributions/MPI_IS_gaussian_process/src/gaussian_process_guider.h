@@ -48,6 +48,11 @@
 #include "math_tools.h"
 
 #include <chrono>
+#include <condition_variable>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 enum Hyperparameters
 {
@@ -124,8 +129,93 @@ public:
 
     };
 
+    /**
+     * The recent regularized gear error history of a model together with its
+     * hyperparameters, everything that is needed to continue with the model
+     * in a later session. The factorization of the GP is not part of it, it
+     * is recomputed from the history in a single inference.
+     */
+    struct model_state
+    {
+        std::vector<double> timestamps; // centers of the grid cells, in gear time
+        std::vector<double> gear_error;
+        std::vector<double> variances;
+        std::vector<double> hyperparameters; // in the order of the Hyperparameters enum
+        double end; // gear time of the last measurement
+
+        model_state() : end(0.0) { }
+
+        /**
+         * Writes the state in a plain text format. Returns true on error.
+         */
+        bool write(std::ostream& out) const;
+
+        /**
+         * Reads a state that was written by write(). Returns true on error.
+         */
+        bool read(std::istream& in);
+    };
+
 private:
 
+    //! The hyperparameters in the guider's notation, see the Hyperparameters enum.
+    typedef Eigen::Matrix<double, NumParameters, 1> hyperparameter_vector;
+
+    /**
+     * The regularized dataset, built incrementally from the raw measurements.
+     * Only complete grid cells are stored, so the cells never change once
+     * they are created and each raw point only needs to be processed once.
+     * The gear error is accumulated over the whole session, so the cells
+     * stay valid when the oldest raw points leave the circular buffer.
+     */
+    struct regular_grid
+    {
+        double sum_control; // accumulated control signal of the consumed points
+        double last_cell_end;
+        double last_timestamp;
+        double last_gear_error;
+        double last_variance;
+        double gear_error_sum;
+        double variance_sum;
+        std::vector<double> timestamps;
+        std::vector<double> gear_error;
+        std::vector<double> variances;
+
+        regular_grid() { clear(); }
+
+        /**
+         * Removes all cells and resets the integration state.
+         */
+        void clear();
+
+        /**
+         * Integrates one raw data point and appends the grid cells it completes.
+         */
+        void add(double point_timestamp, double point_gear_error, double point_variance);
+
+        /**
+         * Removes the given number of cells from the front of the grid.
+         */
+        void remove_front(size_t count);
+    };
+
+    /**
+     * Everything a model update needs from the guiding step. The update only
+     * works on this copy, so it can run in the background while the guider
+     * continues with the next step. The jobs are reused from step to step,
+     * so that their memory is only allocated once.
+     */
+    struct update_job
+    {
+        std::vector<data_point> points; // raw data points completed since the last update
+        double data_start; // grid cells that end before this time are dropped
+        double prediction_point; // location of maximum accuracy for the approximation
+        double last_timestamp; // timestamp of the latest measurement
+        guide_parameters parameters;
+
+        update_job() : data_start(0.0), prediction_point(0.0), last_timestamp(0.0) { }
+    };
+
     std::chrono::system_clock::time_point start_time_; // reference time
     std::chrono::system_clock::time_point last_time_;
 
@@ -140,10 +230,38 @@ private:
     double dither_offset_;
 
     circular_buffer<data_point> circular_buffer_data_;
+    regular_grid regular_grid_;
+    math_tools::StreamingSpectrum period_spectrum_; // spectrum of the regularized dataset
+    int spectrum_shifts_; // cells removed from the spectrum since it was last transformed at once
+    Eigen::VectorXd spectrum_power_; // workspace for the period estimation
+    Eigen::VectorXd spectrum_frequencies_;
+    size_t submitted_points_; // number of raw data points handed to model updates
 
     covariance_functions::PeriodicSquareExponential2 covariance_function_; // for inference
     covariance_functions::PeriodicSquareExponential output_covariance_function_; // for prediction
-    GP gp_;
+    GP gp_; // the working model, owned by the update thread in asynchronous mode
+
+    /**
+     * In asynchronous mode, the model is updated by a background thread after
+     * each step and the guiding step only predicts from the latest completed
+     * model. The step waits at most update_time_budget_ seconds for a running
+     * update, so a slow update never delays the guide pulse.
+     */
+    bool asynchronous_update_;
+    double update_time_budget_;
+
+    //! the regularized dataset starts with the history of an earlier session
+    bool warm_started_;
+    std::thread update_thread_;
+    mutable std::mutex update_mutex_; // protects the members below
+    std::condition_variable update_requested_;
+    std::condition_variable update_finished_;
+    bool update_pending_;
+    bool update_running_;
+    bool stop_update_thread_;
+    update_job pending_update_;
+    update_job current_update_; // the job that is running, owned by the updating thread
+    std::shared_ptr<const GP> model_; // latest completed model, used for prediction
 
     /**
      * Learning rate for smooth parameter adaptation.
@@ -182,9 +300,79 @@ private:
     double CalculateVariance(double SNR);
 
     /**
-     * Estimates the main period length for a given dataset.
+     * Estimates the main period length from the spectrum of the regularized
+     * dataset.
+     */
+    double EstimatePeriodLength();
+
+    /**
+     * Appends the raw data points that were completed since the last update
+     * from the circular buffer to the job. If the dataset has to be rebuilt,
+     * the job is reset first.
      */
-    double EstimatePeriodLength(const Eigen::VectorXd& time, const Eigen::VectorXd& data);
+    void CollectUpdate(double prediction_point, double last_timestamp, update_job& job);
+
+    /**
+     * Adds the data of the job to the regularized dataset and its spectrum,
+     * estimates the period length and updates the GP.
+     */
+    void RunUpdate(const update_job& job);
+
+    /**
+     * Hands the data of the current step to the update thread. If the last
+     * job was not started yet, the new data is merged into it.
+     */
+    void SubmitUpdate(double prediction_point);
+
+    /**
+     * Waits until the update thread is idle, at most timeout seconds. A
+     * negative timeout waits without limit. Returns true if it is idle.
+     */
+    bool WaitForUpdate(double timeout);
+
+    /**
+     * Main loop of the update thread.
+     */
+    void UpdateThread();
+
+    void StartUpdateThread();
+    void StopUpdateThread();
+
+    /**
+     * Publishes a copy of the working model for prediction. The update
+     * thread must be idle.
+     */
+    void PublishModel();
+
+    /**
+     * The latest completed model of the update thread.
+     */
+    std::shared_ptr<const GP> GetModel() const;
+
+    /**
+     * Converts the parameters of a GP to the guider's notation.
+     */
+    static hyperparameter_vector GetHyperparameters(const GP& gp);
+
+    /**
+     * Converts the parameters to the GP's notation and sets them on the
+     * working model.
+     */
+    void SetWorkingHyperparameters(const hyperparameter_vector& hyperparameters);
+
+    /**
+     * The period length of the model that is used for prediction.
+     */
+    double GetPeriodLength() const;
+
+    /**
+     * The GP needs a few measurements before it can predict, unless it
+     * continues with the history of an earlier session.
+     */
+    bool CanPredict() const
+    {
+        return get_number_of_measurements() > 10 || warm_started_;
+    }
 
     /**
      * Calculates the difference in gear error for the time between the last
@@ -220,6 +408,12 @@ public:
     double GetPredictionGain() const;
     bool SetPredictionGain(double);
 
+    bool GetAsynchronousUpdate() const;
+    bool SetAsynchronousUpdate(bool active);
+
+    double GetUpdateTimeBudget() const;
+    bool SetUpdateTimeBudget(double seconds);
+
     GaussianProcessGuider(guide_parameters parameters);
     ~GaussianProcessGuider();
 
@@ -263,11 +457,37 @@ public:
      */
     void reset();
 
+    /**
+     * Stores the recent history of the model for a warm start in a later
+     * session. Returns true if there is less than one period of history.
+     */
+    bool GetModelState(model_state& state);
+
+    /**
+     * Resets the guider and continues with the model of an earlier session,
+     * so that the first guiding step already predicts the gear error.
+     * gear_time_elapsed is the gear time in seconds between state.end and the
+     * first new measurement, which determines the phase where the history
+     * continues; it only matters modulo the period length. Returns true if
+     * the state cannot be used, the guider is reset then.
+     */
+    bool WarmStart(const model_state& state, double gear_time_elapsed);
+
+    /**
+     * Gear time in seconds for turning the RA axis from one angle to another,
+     * both in hours, e.g. hour angle plus 12 hours on one side of the pier.
+     * One hour of axis angle is a sidereal hour of tracking. Whole turns of
+     * the axis are whole numbers of worm periods, so the shorter way around
+     * is returned, in [-12, 12) hours.
+     */
+    static double AxisRotationGearTime(double from_axis_angle, double to_axis_angle);
+
     /**
      * Runs the inference machinery on the GP. Gets the measurement data from
-     * the circular buffer and stores it in Eigen::Vectors. Detrends the data
-     * with linear regression. Calculates the main frequency with an FFT.
-     * Updates the GP accordingly with new data and parameter.
+     * the circular buffer and adds it to the regularized dataset and its
+     * spectrum. Calculates the main frequency from the detrended spectrum.
+     * Updates the GP accordingly with new data and parameter. This always
+     * runs in the calling thread, after a pending background update.
      */
     void UpdateGP(double prediction_point = std::numeric_limits<double>::quiet_NaN());
 
@@ -293,6 +513,11 @@ public:
 
     void add_one_point()
     {
+        // once the buffer is full, the oldest point is pushed out
+        if (circular_buffer_data_.size() == circular_buffer_data_.capacity() && submitted_points_ > 0)
+        {
+            --submitted_points_;
+        }
         circular_buffer_data_.push_front(data_point());
     }
 
@@ -0,0 +1,208 @@
+/*
+ *  ao_fastloop_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests for the AO fast loop, src/ao_fastloop.cpp, with a mount that can
+ * hold its moves until the test releases them.
+ */
+
+#include <gtest/gtest.h>
+#include "phd_stub.h"
+
+class StubMount : public Mount
+{
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    bool m_held = false;
+    std::vector<unsigned int> m_moves; // move options of the moves, in the order they started
+
+public:
+    enum
+    {
+        THROW_OPTION = 0x100, // the move throws like a failing driver
+    };
+
+    MOVE_RESULT MoveOffset(GuiderOffset *, unsigned int moveOptions) override
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_moves.push_back(moveOptions);
+        m_cond.notify_all();
+        m_cond.wait(lock, [this] { return !m_held; });
+        if (moveOptions & THROW_OPTION)
+            throw wxString("stub mount failure");
+        return MOVE_OK;
+    }
+
+    void Hold()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_held = true;
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_held = false;
+        m_cond.notify_all();
+    }
+
+    // waits until the given number of moves has started
+    bool WaitMoves(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        return m_cond.wait_for(lock, std::chrono::seconds(5), [&] { return m_moves.size() >= count; });
+    }
+
+    std::vector<unsigned int> Moves()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_moves;
+    }
+};
+
+class AOFastLoopTest : public ::testing::Test
+{
+public:
+    MyFrame frame;
+    StubMount mount;
+    GuiderOffset ofs;
+    AOFastLoop loop;
+
+    AOFastLoopTest() : loop(&frame) { }
+
+    // the completion events the loop sent to the frame, oldest first
+    std::vector<std::pair<unsigned int, Mount::MOVE_RESULT>> Completions()
+    {
+        std::vector<std::pair<unsigned int, Mount::MOVE_RESULT>> completions;
+        for (const auto& event : frame.TakeEvents())
+        {
+            const MoveCompleteEvent *move = dynamic_cast<const MoveCompleteEvent *>(event.get());
+            EXPECT_TRUE(move != nullptr);
+            if (move)
+            {
+                EXPECT_EQ(move->mount, &mount);
+                completions.emplace_back(move->moveOptions, move->result);
+            }
+        }
+        return completions;
+    }
+};
+
+TEST_F(AOFastLoopTest, moves_run_in_queue_order)
+{
+    ASSERT_EQ(loop.Run(), wxTHREAD_NO_ERROR);
+
+    // the first move holds the loop, so that the others queue up behind it
+    mount.Hold();
+    loop.EnqueueMove(&mount, ofs, 1);
+    ASSERT_TRUE(mount.WaitMoves(1));
+    for (unsigned int i = 2; i <= 5; i++)
+        loop.EnqueueMove(&mount, ofs, i);
+    mount.Release();
+
+    EXPECT_FALSE(loop.WaitIdle(5000));
+    loop.Stop();
+
+    EXPECT_EQ(mount.Moves(), (std::vector<unsigned int>{ 1, 2, 3, 4, 5 }));
+    auto completions = Completions();
+    ASSERT_EQ(completions.size(), 5u);
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(completions[i].first, i + 1);
+        EXPECT_EQ(completions[i].second, Mount::MOVE_OK);
+    }
+}
+
+TEST_F(AOFastLoopTest, wait_idle_times_out_on_a_running_move)
+{
+    ASSERT_EQ(loop.Run(), wxTHREAD_NO_ERROR);
+    EXPECT_FALSE(loop.WaitIdle(0)); // nothing queued
+
+    mount.Hold();
+    loop.EnqueueMove(&mount, ofs, 1);
+    ASSERT_TRUE(mount.WaitMoves(1));
+
+    wxStopWatch swatch;
+    EXPECT_TRUE(loop.WaitIdle(50));
+    EXPECT_GE(swatch.Time(), 50);
+    EXPECT_TRUE(Completions().empty());
+
+    mount.Release();
+    EXPECT_FALSE(loop.WaitIdle(5000));
+    loop.Stop();
+
+    auto completions = Completions();
+    ASSERT_EQ(completions.size(), 1u);
+    EXPECT_EQ(completions[0].second, Mount::MOVE_OK);
+}
+
+TEST_F(AOFastLoopTest, failed_move_completes_with_error)
+{
+    ASSERT_EQ(loop.Run(), wxTHREAD_NO_ERROR);
+
+    loop.EnqueueMove(&mount, ofs, StubMount::THROW_OPTION);
+    loop.EnqueueMove(&mount, ofs, 2);
+    EXPECT_FALSE(loop.WaitIdle(5000));
+    loop.Stop();
+
+    auto completions = Completions();
+    ASSERT_EQ(completions.size(), 2u);
+    EXPECT_EQ(completions[0].second, Mount::MOVE_ERROR);
+    EXPECT_EQ(completions[1].second, Mount::MOVE_OK);
+}
+
+TEST_F(AOFastLoopTest, stop_drains_pending_moves_with_error)
+{
+    // the thread never picks the moves up, as when guiding stops while the
+    // moves are still queued
+    loop.EnqueueMove(&mount, ofs, 1);
+    loop.EnqueueMove(&mount, ofs, 2);
+    loop.EnqueueMove(&mount, ofs, 3);
+    loop.Stop();
+
+    EXPECT_TRUE(mount.Moves().empty());
+    EXPECT_FALSE(loop.WaitIdle(0));
+    auto completions = Completions();
+    ASSERT_EQ(completions.size(), 3u);
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(completions[i].first, i + 1);
+        EXPECT_EQ(completions[i].second, Mount::MOVE_ERROR);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,372 @@
+/*
+ *  batch_evaluation.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef BATCH_EVALUATION_H_INCLUDED
+#define BATCH_EVALUATION_H_INCLUDED
+
+#include "gaussian_process_guider.h"
+#include "guide_performance_tools.h"
+#include "guide_log_replay.h"
+#include "parameter_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#else
+# include <dirent.h>
+# include <sys/stat.h>
+#endif
+
+/*
+ * Batch evaluation of the GP guider against Hysteresis.
+ *
+ * Every guiding section of a set of PHD2 guide logs is run through the GP
+ * guider and the Hysteresis replica with the telescope model of
+ * calculate_improvement(), on the RA axis only since that is the axis the
+ * GP guider is made for. The performance datasets are guide logs with a
+ * single section, for which the result is the one calculate_improvement()
+ * gives. The sections are spread over a pool of worker threads, each
+ * section with its own guider, and the per-section results are combined
+ * into statistics of the improvement and of the CPU time of a guiding step.
+ */
+
+struct EvaluationResult
+{
+    std::string filename;
+    int section;
+    int frames;
+    double exposure;
+    double hysteresis_rms;  // rms error with Hysteresis in the loop (px)
+    double gp_rms;          // rms error with the GP guider in the loop (px)
+    double improvement;     // 1 - gp_rms / hysteresis_rms
+    double hysteresis_us_per_step; // thread CPU time of one result() call
+    double gp_us_per_step;
+
+    EvaluationResult() : section(0), frames(0), exposure(0.0), hysteresis_rms(0.0), gp_rms(0.0), improvement(0.0),
+        hysteresis_us_per_step(0.0), gp_us_per_step(0.0) { }
+};
+
+struct EvaluationSummary
+{
+    int datasets;
+    int improved;           // datasets with a positive improvement
+    long steps;
+    double mean_improvement;
+    double median_improvement;
+    double stddev_improvement;
+    double min_improvement;
+    double max_improvement;
+    double hysteresis_us_per_step; // mean over all steps of all datasets
+    double gp_us_per_step;
+
+    EvaluationSummary() : datasets(0), improved(0), steps(0), mean_improvement(0.0), median_improvement(0.0),
+        stddev_improvement(0.0), min_improvement(0.0), max_improvement(0.0), hysteresis_us_per_step(0.0),
+        gp_us_per_step(0.0) { }
+
+    // half width of the 95% confidence interval of the mean improvement
+    double confidence95() const
+    {
+        return datasets > 1 ? 1.96 * stddev_improvement / std::sqrt(static_cast<double>(datasets)) : 0.0;
+    }
+};
+
+/*
+ * CPU time of the calling thread in seconds. Unlike wall clock time it does
+ * not depend on how many other workers share the cores.
+ */
+inline double thread_cpu_seconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+/*
+ * Appends the regular files of a directory to filenames, sorted by name so
+ * that the order of the results does not depend on the file system.
+ * Returns false if the directory cannot be read.
+ */
+inline bool list_directory(const std::string& dir, std::vector<std::string> *filenames)
+{
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA((dir + "\\*").c_str(), &fd);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    do
+    {
+        if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            names.push_back(dir + "\\" + fd.cFileName);
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+        return false;
+    while (dirent *e = readdir(d))
+    {
+        std::string path = dir + "/" + e->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+            names.push_back(path);
+    }
+    closedir(d);
+#endif
+    std::sort(names.begin(), names.end());
+    filenames->insert(filenames->end(), names.begin(), names.end());
+    return true;
+}
+
+inline bool is_directory(const std::string& path)
+{
+#ifdef _WIN32
+    DWORD attr = GetFileAttributesA(path.c_str());
+    return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+/*
+ * Converts the RA axis of a section to the rows of read_data_from_file():
+ * times, measurements, controls and SNRs. Like there, the RA shift of a
+ * dither is counted as a control of the first frame after it.
+ */
+inline Eigen::ArrayXXd section_data(const GuideLogSection& section)
+{
+    Eigen::ArrayXXd data(4, section.frames.size());
+    for (size_t i = 0; i < section.frames.size(); i++)
+    {
+        const GuideLogFrame& f = section.frames[i];
+        data(0, i) = f.time;
+        data(1, i) = f.ra_raw;
+        data(2, i) = f.ra_guide + f.dither_dx;
+        data(3, i) = f.snr;
+    }
+    return data;
+}
+
+/*
+ * Runs Hysteresis and the GP guider over a dataset read with
+ * read_data_from_file(). The closed loops are the ones of
+ * calculate_improvement(), including the GP guider being reset and given
+ * the logged data up to the current step before each result() call. Only
+ * the result() calls are timed, so the GP time is that of a step that
+ * starts from an empty model and includes regularizing the data.
+ */
+inline EvaluationResult evaluate_dataset(const Eigen::ArrayXXd& data, double exposure,
+                                         const GaussianProcessGuider::guide_parameters& parameters)
+{
+    EvaluationResult result;
+    result.exposure = exposure;
+
+    int steps = static_cast<int>(data.cols()) - 2;
+    if (steps < 1)
+        return result;
+
+    Eigen::ArrayXd times = data.row(0);
+    Eigen::ArrayXd measurements = data.row(1);
+    Eigen::ArrayXd controls = data.row(2);
+    Eigen::ArrayXd SNRs = data.row(3);
+
+    // Hysteresis runs on its own, since a single result() call is too short to time
+    GAHysteresis GAH;
+    double hysteresis_state = measurements(0);
+    double hysteresis_sum = 0.0;
+    double t0 = thread_cpu_seconds();
+    for (int i = 0; i < steps; ++i)
+    {
+        double control = GAH.result(hysteresis_state);
+        hysteresis_state += (measurements(i + 1) - (measurements(i) - controls(i))) - control;
+        hysteresis_sum += hysteresis_state * hysteresis_state;
+    }
+    double hysteresis_time = thread_cpu_seconds() - t0;
+
+    GaussianProcessGuider GPG(parameters);
+    double gp_state = measurements(0);
+    double gp_sum = 0.0;
+    double gp_time = 0.0;
+    for (int i = 0; i < steps; ++i)
+    {
+        GPG.reset();
+        for (int j = 0; j < i; ++j)
+        {
+            GPG.inject_data_point(times(j), measurements(j), SNRs(j), controls(j));
+        }
+        t0 = thread_cpu_seconds();
+        double control = GPG.result(gp_state, SNRs(i), exposure);
+        gp_time += thread_cpu_seconds() - t0;
+
+        gp_state += (measurements(i + 1) - (measurements(i) - controls(i))) - control;
+        gp_sum += gp_state * gp_state;
+    }
+
+    result.frames = steps;
+    result.hysteresis_rms = std::sqrt(hysteresis_sum / steps);
+    result.gp_rms = std::sqrt(gp_sum / steps);
+    if (result.hysteresis_rms > 0.0)
+        result.improvement = 1.0 - result.gp_rms / result.hysteresis_rms;
+    result.hysteresis_us_per_step = 1e6 * hysteresis_time / steps;
+    result.gp_us_per_step = 1e6 * gp_time / steps;
+
+    return result;
+}
+
+/*
+ * Evaluates every section of every log, spreading the sections over
+ * nthreads worker threads (0 = one per core). Sections guided with an AO
+ * are skipped, the mount only receives bump corrections there, as are
+ * sections too short for a single step. Results are returned in input
+ * order; logs that cannot be read are counted in *failed.
+ */
+inline std::vector<EvaluationResult> evaluate_logs(const std::vector<std::string>& filenames,
+                                                   const GaussianProcessGuider::guide_parameters& parameters,
+                                                   unsigned int nthreads, int *failed = nullptr)
+{
+    std::vector<std::vector<GuideLogSection>> sections(filenames.size());
+    std::vector<char> ok(filenames.size(), 0);
+
+    parallel_for(filenames.size(), nthreads, [&](size_t i) {
+        GuideLogReader reader;
+        ok[i] = reader.ReadFile(filenames[i], &sections[i]);
+    });
+
+    struct Task
+    {
+        size_t file;
+        size_t section;
+    };
+    std::vector<Task> tasks;
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        for (size_t s = 0; s < sections[i].size(); s++)
+        {
+            const std::vector<GuideLogFrame>& frames = sections[i][s].frames;
+            bool ao = std::any_of(frames.begin(), frames.end(), [](const GuideLogFrame& f) { return f.ao; });
+            if (!ao && frames.size() > 2)
+                tasks.push_back({ i, s });
+        }
+    }
+
+    std::vector<EvaluationResult> results(tasks.size());
+
+    // the long sections dominate the run time, so they are started first
+    std::vector<size_t> order(tasks.size());
+    for (size_t t = 0; t < tasks.size(); t++)
+        order[t] = t;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return sections[tasks[a].file][tasks[a].section].frames.size() >
+            sections[tasks[b].file][tasks[b].section].frames.size();
+    });
+
+    parallel_for(tasks.size(), nthreads, [&](size_t k) {
+        const Task& task = tasks[order[k]];
+        const GuideLogSection& section = sections[task.file][task.section];
+        double exposure = section.exposure > 0.0 ? section.exposure : 3.0; // default of get_exposure_from_file
+
+        EvaluationResult& r = results[order[k]];
+        r = evaluate_dataset(section_data(section), exposure, parameters);
+        r.filename = filenames[task.file];
+        r.section = static_cast<int>(task.section) + 1;
+    });
+
+    if (failed)
+        *failed = static_cast<int>(std::count(ok.begin(), ok.end(), 0));
+
+    return results;
+}
+
+inline EvaluationSummary summarize(const std::vector<EvaluationResult>& results)
+{
+    EvaluationSummary summary;
+    if (results.empty())
+        return summary;
+
+    std::vector<double> improvements;
+    double hysteresis_time = 0.0, gp_time = 0.0;
+    for (const EvaluationResult& r : results)
+    {
+        improvements.push_back(r.improvement);
+        summary.improved += r.improvement > 0.0;
+        summary.steps += r.frames;
+        hysteresis_time += r.hysteresis_us_per_step * r.frames;
+        gp_time += r.gp_us_per_step * r.frames;
+    }
+
+    size_t n = improvements.size();
+    summary.datasets = static_cast<int>(n);
+    summary.mean_improvement = std::accumulate(improvements.begin(), improvements.end(), 0.0) / n;
+    double ss = 0.0;
+    for (double x : improvements)
+        ss += (x - summary.mean_improvement) * (x - summary.mean_improvement);
+    summary.stddev_improvement = n > 1 ? std::sqrt(ss / (n - 1)) : 0.0;
+
+    std::sort(improvements.begin(), improvements.end());
+    summary.min_improvement = improvements.front();
+    summary.max_improvement = improvements.back();
+    summary.median_improvement = n % 2 ? improvements[n / 2] : 0.5 * (improvements[n / 2 - 1] + improvements[n / 2]);
+
+    if (summary.steps > 0)
+    {
+        summary.hysteresis_us_per_step = hysteresis_time / summary.steps;
+        summary.gp_us_per_step = gp_time / summary.steps;
+    }
+
+    return summary;
+}
+
+#endif // BATCH_EVALUATION_H_INCLUDED
@@ -0,0 +1,157 @@
+/*
+ *  batch_evaluation_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include "gaussian_process_guider.h"
+#include "batch_evaluation.h"
+
+#include <cstdio>
+
+class BatchEvaluationTest : public ::testing::Test
+{
+public:
+    GaussianProcessGuider::guide_parameters parameters;
+
+    BatchEvaluationTest()
+    {
+        parameters.control_gain_ = 0.6;
+        parameters.min_periods_for_inference_ = 2.0;
+        parameters.min_move_ = 0.2;
+        parameters.SE0KLengthScale_ = 700.0;
+        parameters.SE0KSignalVariance_ = 20.0;
+        parameters.PKLengthScale_ = 10.0;
+        parameters.PKPeriodLength_ = 200.0;
+        parameters.PKSignalVariance_ = 20.0;
+        parameters.SE1KLengthScale_ = 25.0;
+        parameters.SE1KSignalVariance_ = 10.0;
+        parameters.min_periods_for_period_estimation_ = 2.0;
+        parameters.points_for_approximation_ = 100;
+        parameters.prediction_gain_ = 0.5;
+        parameters.compute_period_ = true;
+    }
+};
+
+TEST_F(BatchEvaluationTest, matches_calculate_improvement)
+{
+    // dataset 01 contains dithers, dataset 02 does not
+    const char *filenames[] = { "performance_dataset01.txt", "performance_dataset02.txt" };
+
+    for (const char *filename : filenames)
+    {
+        GuideLogReader reader;
+        std::vector<GuideLogSection> sections;
+        ASSERT_TRUE(reader.ReadFile(filename, &sections)) << filename;
+
+        Eigen::ArrayXXd data = section_data(sections[0]);
+        Eigen::ArrayXXd reference_data = read_data_from_file(filename);
+        ASSERT_EQ(data.cols(), reference_data.cols()) << filename;
+        EXPECT_TRUE(data.isApprox(reference_data)) << filename;
+
+        EvaluationResult result = evaluate_dataset(data, sections[0].exposure, parameters);
+
+        GaussianProcessGuider GPG(parameters);
+        double reference = calculate_improvement(filename, GAHysteresis(), &GPG);
+
+        EXPECT_EQ(result.frames, data.cols() - 2) << filename;
+        EXPECT_NEAR(result.improvement, reference, 1e-5) << filename;
+        EXPECT_GT(result.gp_us_per_step, 0.0) << filename;
+    }
+}
+
+TEST_F(BatchEvaluationTest, parallel_evaluation_matches_serial)
+{
+    std::vector<std::string> filenames;
+    ASSERT_TRUE(list_directory(".", &filenames));
+    EXPECT_NE(std::find(filenames.begin(), filenames.end(), "./performance_dataset07.txt"), filenames.end());
+    EXPECT_TRUE(std::is_sorted(filenames.begin(), filenames.end()));
+
+    filenames = { "performance_dataset03.txt", "dataset01.csv", "performance_dataset07.txt",
+                  "performance_dataset08.txt", "no_such_log.txt" };
+
+    int failed_serial = 0, failed_parallel = 0;
+    std::vector<EvaluationResult> serial = evaluate_logs(filenames, parameters, 1, &failed_serial);
+    std::vector<EvaluationResult> parallel = evaluate_logs(filenames, parameters, 3, &failed_parallel);
+
+    // files that are not guide logs are skipped
+    EXPECT_EQ(failed_serial, 2);
+    EXPECT_EQ(failed_parallel, 2);
+    ASSERT_EQ(serial.size(), 3u);
+    ASSERT_EQ(parallel.size(), serial.size());
+
+    for (size_t i = 0; i < serial.size(); i++)
+    {
+        EXPECT_EQ(serial[i].filename, parallel[i].filename);
+        EXPECT_EQ(serial[i].section, 1);
+        EXPECT_EQ(serial[i].frames, parallel[i].frames);
+        EXPECT_DOUBLE_EQ(serial[i].hysteresis_rms, parallel[i].hysteresis_rms);
+        // the GP guider takes the prediction time from the clock, which adds a tiny jitter
+        EXPECT_NEAR(serial[i].gp_rms, parallel[i].gp_rms, 1e-5);
+    }
+    EXPECT_EQ(serial[1].filename, "performance_dataset07.txt");
+}
+
+TEST_F(BatchEvaluationTest, summary_statistics)
+{
+    std::vector<EvaluationResult> results(4);
+    const double improvements[] = { 0.1, -0.2, 0.3, 0.2 };
+    for (int i = 0; i < 4; i++)
+    {
+        results[i].improvement = improvements[i];
+        results[i].frames = 100 * (i + 1);
+        results[i].gp_us_per_step = 10.0 * (i + 1);
+        results[i].hysteresis_us_per_step = 0.1;
+    }
+
+    EvaluationSummary summary = summarize(results);
+    EXPECT_EQ(summary.datasets, 4);
+    EXPECT_EQ(summary.improved, 3);
+    EXPECT_EQ(summary.steps, 1000);
+    EXPECT_NEAR(summary.mean_improvement, 0.1, 1e-12);
+    EXPECT_NEAR(summary.median_improvement, 0.15, 1e-12);
+    EXPECT_NEAR(summary.stddev_improvement, std::sqrt(0.14 / 3), 1e-12);
+    EXPECT_NEAR(summary.confidence95(), 1.96 * std::sqrt(0.14 / 3) / 2.0, 1e-12);
+    EXPECT_DOUBLE_EQ(summary.min_improvement, -0.2);
+    EXPECT_DOUBLE_EQ(summary.max_improvement, 0.3);
+
+    // the step time is weighted by the number of steps
+    EXPECT_NEAR(summary.gp_us_per_step, 30.0, 1e-12);
+    EXPECT_NEAR(summary.hysteresis_us_per_step, 0.1, 1e-12);
+
+    EXPECT_EQ(summarize(std::vector<EvaluationResult>()).datasets, 0);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
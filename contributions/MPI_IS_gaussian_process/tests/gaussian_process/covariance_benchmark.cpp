@@ -0,0 +1,146 @@
+/*
+ *  covariance_benchmark.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Measures the cost of the covariance evaluations that dominate a GP guider
+ * step, with and without the grid cache of the covariance functions.
+ *
+ * usage: CovarianceBenchmark [repetitions]
+ */
+
+#include "gaussian_process.h"
+#include "covariance_functions.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    const int GridSize = 2048; // REGULAR_BUFFER_SIZE of the guider
+    const double GridInterval = 5.0; // GRID_INTERVAL of the guider
+    const int SelectedPoints = 100; // default number of points for the approximation
+
+    typedef covariance_functions::PeriodicSquareExponential2 Kernel;
+
+    Kernel make_kernel(double spacing)
+    {
+        Eigen::VectorXd hyperparameters(6);
+        hyperparameters << 700.0, 20.0, 10.0, 20.0, 25.0, 10.0;
+        Kernel kernel(hyperparameters.array().log());
+
+        Eigen::VectorXd period_length(1);
+        period_length << std::log(200.0);
+        kernel.setExtraParameters(period_length);
+        kernel.setGridSpacing(spacing);
+        return kernel;
+    }
+
+    // changes the period length slightly, like the period estimation of the guider does in every step
+    void change_period(Kernel& kernel, int i)
+    {
+        Eigen::VectorXd period_length(1);
+        period_length << std::log(200.0 + 0.01 * (i % 2));
+        kernel.setExtraParameters(period_length);
+    }
+
+    template<typename F>
+    void run(const char *name, int repetitions, F f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        double checksum = 0.0;
+        for (int i = 0; i < repetitions; ++i)
+        {
+            checksum += f(i);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-40s %10.1f us/call  (checksum %g)\n", name, 1e6 * elapsed / repetitions, checksum);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = argc > 1 ? std::stoi(argv[1]) : 200;
+
+    Eigen::VectorXd grid(GridSize);
+    for (int i = 0; i < GridSize; ++i)
+    {
+        grid(i) = (i + 0.5) * GridInterval; // cell centers, like the regularized dataset
+    }
+
+    // the selected points are spread over the whole dataset by the periodic kernel
+    Eigen::VectorXd selected(SelectedPoints);
+    for (int i = 0; i < SelectedPoints; ++i)
+    {
+        selected(i) = grid((i * 37) % GridSize);
+    }
+
+    Eigen::VectorXd prediction(1);
+    prediction << GridSize * GridInterval + 1.3;
+
+    Eigen::VectorXd gear_error = 5.0 * (grid.array() * 2 * M_PI / 200.0).sin();
+    Eigen::VectorXd variances = Eigen::VectorXd::Constant(GridSize, 0.1);
+
+    Kernel direct = make_kernel(0.0);
+    Kernel cached = make_kernel(GridInterval);
+
+    printf("covariance of %d selected grid points\n", SelectedPoints);
+    run("  direct", repetitions, [&](int) { return direct.evaluate(selected, selected)(1, 0); });
+    run("  cached, parameters change", repetitions, [&](int i) {
+        change_period(cached, i);
+        return cached.evaluate(selected, selected)(1, 0);
+    });
+    run("  cached, parameters fixed", repetitions, [&](int) { return cached.evaluate(selected, selected)(1, 0); });
+
+    printf("covariance of %d grid points and the prediction point\n", GridSize);
+    run("  direct", repetitions, [&](int) { return direct.evaluate(grid, prediction)(1, 0); });
+
+    printf("GP update with %d of %d grid points\n", SelectedPoints, GridSize);
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        Kernel kernel = make_kernel(mode == 0 ? 0.0 : GridInterval);
+        GP gp(kernel);
+        gp.enableExplicitTrend();
+        Eigen::VectorXd hyperparameters = gp.getHyperParameters();
+
+        run(mode == 0 ? "  direct" : "  cached", repetitions, [&](int i) {
+            hyperparameters(7) = std::log(200.0 + 0.01 * (i % 2)); // the period length
+            gp.setHyperParameters(hyperparameters);
+            gp.inferSD(grid, gear_error, SelectedPoints, variances, prediction(0));
+            return gp.predict(prediction)(0);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,276 @@
+/*
+ *  evaluate_batch.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Evaluates the GP guider against Hysteresis on a collection of datasets
+ * and PHD2 guide logs, the batch version of GuidePerformanceEval.
+ *
+ * usage: GuideBatchEval [-j threads] [-f csv|json] [-p name=value ...] path... | @listfile
+ *
+ * A path can be a log file or a directory, whose files are all evaluated;
+ * files that are not guide logs are skipped. Each guiding section is
+ * evaluated separately and the sections are spread over the threads. The
+ * GP guider uses the PHD2 default settings unless they are changed with -p.
+ *
+ * The report has one entry per section with the rms error of both
+ * algorithms, the improvement and the CPU time of a step, followed by the
+ * statistics over all sections. In CSV format the statistics go to stderr,
+ * in JSON format they are part of the document on stdout.
+ */
+
+#include "gaussian_process_guider.h"
+#include "batch_evaluation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+struct GuideParameter
+{
+    const char *name;
+    double value;
+};
+
+// the defaults of GuideAlgorithmGaussianProcess
+static GuideParameter Parameters[] = {
+    { "control_gain", 0.6 },
+    { "min_periods_for_inference", 2.0 },
+    { "min_move", 0.2 },
+    { "SE0KLengthScale", 700.0 },
+    { "SE0KSignalVariance", 20.0 },
+    { "PKLengthScale", 10.0 },
+    { "PKPeriodLength", 200.0 },
+    { "PKSignalVariance", 20.0 },
+    { "SE1KLengthScale", 25.0 },
+    { "SE1KSignalVariance", 10.0 },
+    { "min_periods_for_period_estimation", 2.0 },
+    { "points_for_approximation", 100.0 },
+    { "prediction_gain", 0.5 },
+};
+
+static void usage()
+{
+    std::cerr << "usage: GuideBatchEval [-j threads] [-f csv|json] [-p name=value ...] path... | @listfile" << std::endl;
+    std::cerr << "parameters (default):" << std::endl;
+    for (const GuideParameter& p : Parameters)
+        std::cerr << "  " << p.name << " " << p.value << std::endl;
+}
+
+static bool set_parameter(const std::string& arg)
+{
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos)
+        return false;
+
+    std::string name = arg.substr(0, eq);
+    for (GuideParameter& p : Parameters)
+    {
+        if (name == p.name)
+        {
+            p.value = std::atof(arg.substr(eq + 1).c_str());
+            return p.value >= 0.0;
+        }
+    }
+    return false;
+}
+
+static GaussianProcessGuider::guide_parameters make_parameters()
+{
+    GaussianProcessGuider::guide_parameters parameters;
+    parameters.control_gain_ = Parameters[0].value;
+    parameters.min_periods_for_inference_ = Parameters[1].value;
+    parameters.min_move_ = Parameters[2].value;
+    parameters.SE0KLengthScale_ = Parameters[3].value;
+    parameters.SE0KSignalVariance_ = Parameters[4].value;
+    parameters.PKLengthScale_ = Parameters[5].value;
+    parameters.PKPeriodLength_ = Parameters[6].value;
+    parameters.PKSignalVariance_ = Parameters[7].value;
+    parameters.SE1KLengthScale_ = Parameters[8].value;
+    parameters.SE1KSignalVariance_ = Parameters[9].value;
+    parameters.min_periods_for_period_estimation_ = Parameters[10].value;
+    parameters.points_for_approximation_ = static_cast<int>(std::floor(Parameters[11].value));
+    parameters.prediction_gain_ = Parameters[12].value;
+    parameters.compute_period_ = true;
+    return parameters;
+}
+
+static std::string json_string(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void write_csv(const std::vector<EvaluationResult>& results)
+{
+    std::cout << "log,section,frames,exposure,hysteresis_rms,gp_rms,improvement,hysteresis_us_per_step,gp_us_per_step"
+              << std::endl;
+
+    for (const EvaluationResult& r : results)
+    {
+        char buf[256];
+        snprintf(buf, sizeof(buf), "%d,%d,%.3f,%.4f,%.4f,%.4f,%.3f,%.1f", r.section, r.frames, r.exposure,
+                 r.hysteresis_rms, r.gp_rms, r.improvement, r.hysteresis_us_per_step, r.gp_us_per_step);
+        std::cout << "\"" << r.filename << "\"," << buf << std::endl;
+    }
+}
+
+static void write_json(const std::vector<EvaluationResult>& results, const EvaluationSummary& summary)
+{
+    char buf[512];
+
+    std::cout << "{" << std::endl << "  \"parameters\": {";
+    for (size_t i = 0; i < sizeof(Parameters) / sizeof(Parameters[0]); i++)
+        std::cout << (i ? ", " : "") << "\"" << Parameters[i].name << "\": " << Parameters[i].value;
+    std::cout << "}," << std::endl;
+
+    std::cout << "  \"datasets\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const EvaluationResult& r = results[i];
+        snprintf(buf, sizeof(buf), "\"section\": %d, \"frames\": %d, \"exposure\": %.3f, \"hysteresis_rms\": %.4f, "
+                 "\"gp_rms\": %.4f, \"improvement\": %.4f, \"hysteresis_us_per_step\": %.3f, \"gp_us_per_step\": %.1f",
+                 r.section, r.frames, r.exposure, r.hysteresis_rms, r.gp_rms, r.improvement, r.hysteresis_us_per_step,
+                 r.gp_us_per_step);
+        std::cout << (i ? "," : "") << std::endl << "    {\"log\": " << json_string(r.filename) << ", " << buf << "}";
+    }
+    std::cout << std::endl << "  ]," << std::endl;
+
+    snprintf(buf, sizeof(buf), "\"datasets\": %d, \"improved\": %d, \"steps\": %ld, \"mean_improvement\": %.4f, "
+             "\"confidence95\": %.4f, \"median_improvement\": %.4f, \"stddev_improvement\": %.4f, "
+             "\"min_improvement\": %.4f, \"max_improvement\": %.4f, \"hysteresis_us_per_step\": %.3f, "
+             "\"gp_us_per_step\": %.1f", summary.datasets, summary.improved, summary.steps, summary.mean_improvement,
+             summary.confidence95(), summary.median_improvement, summary.stddev_improvement, summary.min_improvement,
+             summary.max_improvement, summary.hysteresis_us_per_step, summary.gp_us_per_step);
+    std::cout << "  \"summary\": {" << buf << "}" << std::endl << "}" << std::endl;
+}
+
+static void write_summary(const EvaluationSummary& summary)
+{
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "improvement over Hysteresis: mean %.4f +/- %.4f (95%%), median %.4f, stddev %.4f, min %.4f, max %.4f\n"
+             "improved %d of %d sections, %ld steps\n"
+             "CPU time per step: Hysteresis %.3f us, GP %.1f us",
+             summary.mean_improvement, summary.confidence95(), summary.median_improvement, summary.stddev_improvement,
+             summary.min_improvement, summary.max_improvement, summary.improved, summary.datasets, summary.steps,
+             summary.hysteresis_us_per_step, summary.gp_us_per_step);
+    std::cerr << buf << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int nthreads = 0;
+    bool json = false;
+    std::vector<std::string> filenames;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-j" && i + 1 < argc)
+            nthreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if (arg == "-f" && i + 1 < argc)
+        {
+            std::string format(argv[++i]);
+            if (format != "csv" && format != "json")
+            {
+                usage();
+                return -1;
+            }
+            json = format == "json";
+        }
+        else if (arg == "-p" && i + 1 < argc)
+        {
+            if (!set_parameter(argv[++i]))
+            {
+                std::cerr << "invalid parameter " << argv[i] << std::endl;
+                return -1;
+            }
+        }
+        else if (arg[0] == '@')
+        {
+            if (!read_file_list(arg.substr(1), &filenames))
+            {
+                std::cerr << "cannot read " << arg.substr(1) << std::endl;
+                return -1;
+            }
+        }
+        else if (arg[0] == '-')
+        {
+            usage();
+            return -1;
+        }
+        else if (is_directory(arg))
+        {
+            if (!list_directory(arg, &filenames))
+            {
+                std::cerr << "cannot read " << arg << std::endl;
+                return -1;
+            }
+        }
+        else
+            filenames.push_back(arg);
+    }
+
+    if (filenames.empty())
+    {
+        usage();
+        return -1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int failed = 0;
+    std::vector<EvaluationResult> results = evaluate_logs(filenames, make_parameters(), nthreads, &failed);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    EvaluationSummary summary = summarize(results);
+    if (json)
+        write_json(results, summary);
+    else
+    {
+        write_csv(results);
+        write_summary(summary);
+    }
+
+    std::cerr << results.size() << " sections of " << filenames.size() - failed << " logs evaluated in " << secs << " s";
+    if (failed)
+        std::cerr << ", " << failed << " files skipped";
+    std::cerr << std::endl;
+
+    return results.empty() ? 1 : 0;
+}
@@ -220,6 +220,40 @@ TEST_F(GPTest, infer_prediction_clear_test)
     EXPECT_NEAR(prediction(1), 0, 1e-6);
 }
 
+TEST_F(GPTest, inferSD_incremental_test)
+{
+    // a sliding window over a regular grid, like the GP guider uses it
+    int N = 200;
+    int n = 30;
+    Eigen::VectorXd data_loc = Eigen::VectorXd::LinSpaced(N, 0, 0.1 * (N - 1));
+    Eigen::VectorXd data_out = data_loc.array().sin() + 0.1 * data_loc.array();
+    Eigen::VectorXd data_var = Eigen::VectorXd::Constant(N, 0.01);
+    data_var(N / 2) = 1.0; // one noisier point
+
+    Eigen::VectorXd prediction_location(3);
+
+    for (int end = n / 2; end <= N; ++end)
+    {
+        gp_.inferSD(data_loc.head(end), data_out.head(end), n, data_var.head(end));
+
+        // reference: the same subset of data, inferred from scratch
+        GP reference_gp(covariance_function_);
+        reference_gp.inferSD(data_loc.head(end), data_out.head(end), n, data_var.head(end));
+
+        prediction_location << data_loc(end - 1) - 0.5, data_loc(end - 1), data_loc(end - 1) + 0.3;
+        Eigen::VectorXd variances;
+        Eigen::VectorXd reference_variances;
+        Eigen::VectorXd prediction = gp_.predict(prediction_location, &variances);
+        Eigen::VectorXd reference = reference_gp.predict(prediction_location, &reference_variances);
+
+        for (int i = 0; i < prediction_location.rows(); ++i)
+        {
+            EXPECT_NEAR(prediction(i), reference(i), 1e-6);
+            EXPECT_NEAR(variances(i), reference_variances(i), 1e-6);
+        }
+    }
+}
+
 TEST_F(GPTest, squareDistanceTest)
 {
     Eigen::MatrixXd a(4, 3);
@@ -383,6 +417,44 @@ TEST_F(GPTest, CovarianceTest3)
     }
 }
 
+TEST_F(GPTest, GridCacheTest)
+{
+    Eigen::Matrix<double, 6, 1> hyperParams;
+    hyperParams << 10, 1, 1, 1, 100, 1;
+    hyperParams = hyperParams.array().log();
+
+    Eigen::VectorXd periodLength(1);
+    periodLength << std::log(80);
+
+    covariance_functions::PeriodicSquareExponential2 covFunc(hyperParams);
+    covFunc.setExtraParameters(periodLength);
+    covariance_functions::PeriodicSquareExponential2 cachedCovFunc(hyperParams);
+    cachedCovFunc.setExtraParameters(periodLength);
+    cachedCovFunc.setGridSpacing(5.0);
+
+    // a grid with gaps, like the selected points of the GP guider
+    Eigen::VectorXd grid(6), other_grid(3), off_grid(2);
+    grid << 2.5, 7.5, 27.5, 102.5, 107.5, 502.5;
+    other_grid << 1002.5, 17.5, 7.5;
+    off_grid << 3.0, 250.0;
+
+    EXPECT_TRUE(cachedCovFunc.evaluate(grid, grid).isApprox(covFunc.evaluate(grid, grid), 1e-12));
+    EXPECT_TRUE(cachedCovFunc.evaluate(grid, other_grid).isApprox(covFunc.evaluate(grid, other_grid), 1e-12));
+    EXPECT_TRUE(cachedCovFunc.evaluate(other_grid, grid).isApprox(covFunc.evaluate(other_grid, grid), 1e-12));
+    EXPECT_TRUE(cachedCovFunc.evaluate(grid, off_grid).isApprox(covFunc.evaluate(grid, off_grid), 1e-12));
+
+    // new hyperparameters invalidate the cache
+    periodLength << std::log(120);
+    covFunc.setExtraParameters(periodLength);
+    cachedCovFunc.setExtraParameters(periodLength);
+    EXPECT_TRUE(cachedCovFunc.evaluate(grid, other_grid).isApprox(covFunc.evaluate(grid, other_grid), 1e-12));
+
+    hyperParams(2) = std::log(2.0);
+    covFunc.setParameters(hyperParams);
+    cachedCovFunc.setParameters(hyperParams);
+    EXPECT_TRUE(cachedCovFunc.evaluate(grid, grid).isApprox(covFunc.evaluate(grid, grid), 1e-12));
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
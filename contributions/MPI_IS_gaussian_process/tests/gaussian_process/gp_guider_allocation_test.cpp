@@ -0,0 +1,201 @@
+/*
+ *  gp_guider_allocation_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include "gaussian_process_guider.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+// Counts the heap allocations of the current thread while counting is
+// enabled. On glibc, malloc itself is replaced, which also catches the
+// allocations of Eigen. Elsewhere, only operator new can be replaced.
+static thread_local bool s_counting = false;
+static long s_allocations = 0;
+
+static void count_allocation()
+{
+    if (s_counting)
+    {
+        ++s_allocations;
+    }
+}
+
+#if defined(__GLIBC__)
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+#else
+
+void *operator new(std::size_t size)
+{
+    count_allocation();
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
+
+class GPGuiderAllocationTest : public ::testing::Test
+{
+public:
+    GaussianProcessGuider *GPG;
+
+    GPGuiderAllocationTest() : GPG(0)
+    {
+        // the defaults of the guide algorithm
+        GaussianProcessGuider::guide_parameters parameters;
+        parameters.control_gain_ = 0.6;
+        parameters.min_periods_for_inference_ = 2.0;
+        parameters.min_move_ = 0.2;
+        parameters.SE0KLengthScale_ = 700.0;
+        parameters.SE0KSignalVariance_ = 20.0;
+        parameters.PKLengthScale_ = 10.0;
+        parameters.PKPeriodLength_ = 200.0;
+        parameters.PKSignalVariance_ = 20.0;
+        parameters.SE1KLengthScale_ = 25.0;
+        parameters.SE1KSignalVariance_ = 10.0;
+        parameters.min_periods_for_period_estimation_ = 2.0;
+        parameters.points_for_approximation_ = 100;
+        parameters.prediction_gain_ = 0.5;
+        parameters.compute_period_ = true;
+
+        GPG = new GaussianProcessGuider(parameters);
+    }
+
+    ~GPGuiderAllocationTest()
+    {
+        delete GPG;
+    }
+
+    /*
+     * Runs guiding steps on a periodic gear error, with a dark frame every
+     * tenth step. The timestamps are injected, so that the steps don't have
+     * to wait for the clock. Returns the allocations of the guiding thread
+     * from the given step on.
+     */
+    long run_steps(int first, int last, int count_from)
+    {
+        const double exposure = 3.0;
+        long allocations = 0;
+        for (int i = first; i < last; ++i)
+        {
+            double t = exposure * i;
+            double gear_error = 2.0 * std::sin(2 * M_PI * t / 200.0) + 0.3 * std::sin(0.37 * i);
+
+            s_allocations = 0;
+            s_counting = i >= count_from;
+            GPG->inject_data_point(t, gear_error, 50.0, 0.0);
+            if (i % 10 == 9)
+            {
+                GPG->deduceResult(exposure, t);
+            }
+            else
+            {
+                GPG->result(gear_error, 50.0, exposure, t);
+            }
+            s_counting = false;
+            allocations += s_allocations;
+        }
+        return allocations;
+    }
+};
+
+TEST_F(GPGuiderAllocationTest, guiding_step_does_not_allocate)
+{
+    // the first steps fill the buffers and grow the covariance cache
+    EXPECT_EQ(run_steps(0, 800, 600), 0);
+}
+
+TEST_F(GPGuiderAllocationTest, guiding_step_does_not_allocate_with_full_buffer)
+{
+    // once the raw data buffer is full, the oldest grid cells are dropped in every step
+    EXPECT_EQ(run_steps(0, 4300, 4200), 0);
+}
+
+TEST_F(GPGuiderAllocationTest, asynchronous_guiding_step_does_not_allocate)
+{
+    run_steps(0, 600, 600);
+    GPG->SetAsynchronousUpdate(true);
+
+    // only the guiding thread is counted, the update thread publishes copies of the model
+    EXPECT_EQ(run_steps(600, 800, 650), 0);
+
+    GPG->SetAsynchronousUpdate(false);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -217,6 +217,43 @@ TEST_F(GPGTest, gp_prediction_test)
     GPG->save_gp_data();
 }
 
+TEST_F(GPGTest, asynchronous_update_test)
+{
+    double period_length = 300;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    double prediction_length = 3.0;
+    Eigen::VectorXd locations(2);
+    Eigen::VectorXd predictions(2);
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin();
+    Eigen::VectorXd controls = 0*measurements;
+    Eigen::VectorXd SNRs = 100*Eigen::VectorXd::Ones(resolution + 1);
+
+    EXPECT_TRUE(GPG->SetUpdateTimeBudget(-1.0)); // invalid budget
+    EXPECT_FALSE(GPG->SetUpdateTimeBudget(10.0)); // always wait for the update, to be deterministic
+    EXPECT_FALSE(GPG->SetAsynchronousUpdate(true));
+    EXPECT_TRUE(GPG->GetAsynchronousUpdate());
+
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], SNRs[i], controls[i]);
+    }
+
+    // the first step hands the data to the update thread...
+    GPG->result(0.15, 2.0, prediction_length, max_time - prediction_length);
+
+    // ...and the second one predicts from the updated model
+    locations << max_time, max_time + prediction_length;
+    predictions = 50*(locations.array()*2*M_PI/period_length).sin();
+    EXPECT_NEAR(GPG->result(0.15, 2.0, prediction_length, max_time), predictions[1]-predictions[0], 2e-1);
+
+    // switching back waits for the last update, which includes the two constant steps
+    EXPECT_FALSE(GPG->SetAsynchronousUpdate(false));
+    EXPECT_FALSE(GPG->GetAsynchronousUpdate());
+    EXPECT_NEAR(GPG->GetGPHyperparameters()[PKPeriodLength], period_length, 5e0);
+}
+
 TEST_F(GPGTest, parameters_test)
 {
     EXPECT_NEAR(GPG->GetControlGain(), DefaultControlGain, 1e-6);
@@ -582,6 +619,178 @@ TEST_F(GPGTest, real_data_test_nan_issue)
     GPG->save_gp_data();
 }
 
+TEST_F(GPGTest, model_state_test)
+{
+    double period_length = 300;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin();
+
+    GaussianProcessGuider::model_state state;
+    EXPECT_TRUE(GPG->GetModelState(state)); // no history yet
+
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], 100.0, 0.0);
+    }
+    GPG->result(0.15, 100.0, 3.0, max_time);
+
+    ASSERT_FALSE(GPG->GetModelState(state));
+    EXPECT_EQ(state.timestamps.size(), 301u); // 5 s cells, from -5 s
+    EXPECT_EQ(state.hyperparameters.size(), static_cast<size_t>(NumParameters));
+    EXPECT_NEAR(state.end, max_time, 1.0);
+
+    std::stringstream stream;
+    ASSERT_FALSE(state.write(stream));
+    GaussianProcessGuider::model_state copy;
+    ASSERT_FALSE(copy.read(stream));
+    EXPECT_EQ(copy.timestamps, state.timestamps);
+    EXPECT_EQ(copy.gear_error, state.gear_error);
+    EXPECT_EQ(copy.variances, state.variances);
+    EXPECT_EQ(copy.hyperparameters, state.hyperparameters);
+    EXPECT_EQ(copy.end, state.end);
+
+    std::istringstream garbage("PPEC model state 1\nend 10\nhyperparameters 3 1 2 3\n");
+    EXPECT_TRUE(copy.read(garbage));
+}
+
+TEST_F(GPGTest, full_buffer_test)
+{
+    // A constant control accumulates to a gear error that grows with time.
+    // The buffer holds 8192 points, the later points push out the oldest.
+    int num_points = 9000;
+    for (int i = 0; i < num_points; ++i)
+    {
+        GPG->inject_data_point(i, 0.0, 100.0, 1.0);
+        if (i % 1000 == 999)
+        {
+            GPG->result(0.0, 100.0, 1.0, i);
+        }
+    }
+    GPG->result(0.0, 100.0, 1.0, num_points);
+
+    // The cells keep the gear error accumulated since the start of the
+    // session, the controls of the result() calls add a little to it. Had the
+    // dropped points been subtracted, it would be more than 800 lower.
+    GaussianProcessGuider::model_state state;
+    ASSERT_FALSE(GPG->GetModelState(state));
+    ASSERT_GT(state.timestamps.size(), 0u);
+    EXPECT_NEAR(state.timestamps.back(), num_points, 10.0);
+    for (size_t i = 0; i < state.timestamps.size(); ++i)
+    {
+        EXPECT_NEAR(state.gear_error[i], state.timestamps[i], 10.0);
+    }
+}
+
+TEST_F(GPGTest, warm_start_test)
+{
+    double period_length = 300;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    double prediction_length = 3.0;
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin();
+
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], 100.0, 0.0);
+    }
+    GPG->result(0.15, 100.0, prediction_length, max_time);
+
+    GaussianProcessGuider::model_state state;
+    ASSERT_FALSE(GPG->GetModelState(state));
+
+    // A later session that starts at a different phase of the gear error.
+    // Over longer gaps, the error of the estimated period adds to the phase error.
+    double elapsed = 100.0;
+    double start = state.end + elapsed;
+    Eigen::VectorXd locations(2);
+    locations << start, start + prediction_length;
+    Eigen::VectorXd predictions = 50*(locations.array()*2*M_PI/period_length).sin();
+
+    // without the history, the first step only has the reactive part
+    GPG->reset();
+    EXPECT_NEAR(GPG->result(0.15, 100.0, prediction_length, 0.0), 0.0, 1e-6);
+
+    // with the history, it predicts the gear error right away
+    ASSERT_FALSE(GPG->WarmStart(state, elapsed));
+    EXPECT_NEAR(GPG->result(0.15, 100.0, prediction_length, 0.0), predictions[1]-predictions[0], 3e-1);
+
+    // the same in the asynchronous mode
+    EXPECT_FALSE(GPG->SetAsynchronousUpdate(true));
+    ASSERT_FALSE(GPG->WarmStart(state, elapsed));
+    EXPECT_NEAR(GPG->result(0.15, 100.0, prediction_length, 0.0), predictions[1]-predictions[0], 3e-1);
+    EXPECT_FALSE(GPG->SetAsynchronousUpdate(false));
+
+    // a state with less than a period of history is not used
+    GaussianProcessGuider::model_state short_state = state;
+    short_state.timestamps.resize(10);
+    short_state.gear_error.resize(10);
+    short_state.variances.resize(10);
+    EXPECT_TRUE(GPG->WarmStart(short_state, elapsed));
+    EXPECT_NEAR(GPG->result(0.15, 100.0, prediction_length, 0.0), 0.0, 1e-6);
+}
+
+TEST_F(GPGTest, axis_rotation_gear_time_test)
+{
+    // one hour of axis angle is one sidereal hour of tracking
+    EXPECT_NEAR(GaussianProcessGuider::AxisRotationGearTime(1.0, 2.0), 3590.17, 1e-6);
+    EXPECT_NEAR(GaussianProcessGuider::AxisRotationGearTime(2.0, 1.0), -3590.17, 1e-6);
+    // the shorter way around, also across 0/24 hours
+    EXPECT_NEAR(GaussianProcessGuider::AxisRotationGearTime(23.5, 0.5), 3590.17, 1e-6);
+    EXPECT_NEAR(GaussianProcessGuider::AxisRotationGearTime(0.5, 23.5), -3590.17, 1e-6);
+    EXPECT_NEAR(GaussianProcessGuider::AxisRotationGearTime(3.0, 15.0), -12*3590.17, 1e-6);
+}
+
+TEST_F(GPGTest, warm_start_axis_angle_test)
+{
+    // The gear error is a function of the angle of the RA axis (hours) as in a
+    // worm gear, whose period divides the sidereal day.
+    const double sidereal_hour = 3600.0 * 0.99727;
+    const double period_length = 86164.09 / 288; // 299.18 s
+    auto gear_error = [&](double axis_angle) {
+        return 50*std::sin(axis_angle*sidereal_hour*2*M_PI/period_length);
+    };
+
+    // only the periodic kernel and the exact period, so that the test sees the phase
+    std::vector<double> parameters = GPG->GetGPHyperparameters();
+    parameters[SE0KSignalVariance] = 1e-10; // disable long-range SE kernel
+    parameters[SE1KSignalVariance] = 1e-10; // disable short-range SE kernel
+    parameters[PKPeriodLength] = period_length;
+    GPG->SetBoolComputePeriod(false);
+    GPG->SetGPHyperparameters(parameters);
+    GPG->SetNumPointsForApproximation(2000); // no approximation error
+
+    // the first session tracks from hour angle 1.3 on the west side of the pier
+    double axis_start = 1.3;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    double prediction_length = 3.0;
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], gear_error(axis_start + timestamps[i]/sidereal_hour), 100.0, 0.0);
+    }
+    GPG->result(0.15, 100.0, prediction_length, max_time);
+
+    GaussianProcessGuider::model_state state;
+    ASSERT_FALSE(GPG->GetModelState(state));
+    double saved_axis = axis_start + state.end/sidereal_hour;
+
+    // a meridian flip a little later turns the axis by 12 hours, and a restart
+    // later in the night continues at any other angle
+    for (double axis : { saved_axis + 12.0 + 0.05, saved_axis + 12.0 - 0.37, saved_axis + 5.21 })
+    {
+        double elapsed = GaussianProcessGuider::AxisRotationGearTime(saved_axis, axis);
+        double expected = gear_error(axis + prediction_length/sidereal_hour) - gear_error(axis);
+
+        ASSERT_FALSE(GPG->WarmStart(state, elapsed));
+        // a wrong hour to gear time conversion puts the model out of phase by far more
+        EXPECT_NEAR(GPG->result(0.15, 100.0, prediction_length, 0.0), expected, 3e-1) << "axis angle " << axis;
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,260 @@
+/*
+ *  guide_algorithms_performance_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Closed-loop guiding regression tests for the standard guide algorithms.
+ *
+ * Each test drives the simulated mount (PE, drift, backlash, seeing) through a
+ * full night on a virtual clock with a fixed seed and checks the RMS guiding
+ * error against a recorded baseline, and the time spent per guide step in the
+ * algorithm against a generous upper bound. The algorithms are the ones from
+ * src/, with their default settings.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "phd_stub.h"
+#include "simulated_mount.h"
+
+struct ClosedLoopResult
+{
+    double rms_ra; // arc-sec
+    double rms_dec; // arc-sec
+    double ns_per_step; // time spent in the algorithms per guide step, nanoseconds
+};
+
+/*
+ * An algorithm that never guides, for the unguided reference.
+ */
+class GANone
+{
+public:
+    double result(double) { return 0.0; }
+};
+
+/*
+ * Averages the offsets of several stars, skipping secondary stars whose
+ * offsets are far from the primary's, like GuiderMultiStar::RefineOffset.
+ */
+class MultiStarMeasurement
+{
+    int m_stars;
+    double m_sumSq;
+    int m_count;
+
+public:
+    explicit MultiStarMeasurement(int stars) : m_stars(stars), m_sumSq(0.0), m_count(0) { }
+
+    template<typename MeasureFn>
+    double Measure(MeasureFn measure)
+    {
+        double primary = measure();
+        if (m_stars == 1)
+            return primary;
+
+        m_sumSq += primary * primary;
+        ++m_count;
+        double primarySigma = std::sqrt(m_sumSq / m_count);
+
+        double sum = primary;
+        int used = 1;
+        for (int i = 1; i < m_stars; i++)
+        {
+            double ofs = measure();
+            if (m_count > 5 && std::fabs(ofs) > 2.5 * primarySigma)
+                continue;
+            sum += ofs;
+            ++used;
+        }
+        return sum / used;
+    }
+};
+
+static const int NightSteps = 8 * 3600 / 2; // 8 hours of 2-second exposures
+
+template<typename RAAlgo, typename DecAlgo>
+ClosedLoopResult run_closed_loop(RAAlgo& ra, DecAlgo& dec, const SimulatedMountParams& params, int steps = NightSteps,
+                                 int stars = 1)
+{
+    SimulatedMount mount(params);
+    MultiStarMeasurement raMeasurement(stars);
+    MultiStarMeasurement decMeasurement(stars);
+
+    double sumSqRA = 0.0;
+    double sumSqDec = 0.0;
+    std::chrono::steady_clock::duration elapsed(0);
+
+    for (int i = 0; i < steps; ++i)
+    {
+        mount.Expose();
+
+        double raOfs = raMeasurement.Measure([&]() { return mount.MeasureRA(); });
+        double decOfs = decMeasurement.Measure([&]() { return mount.MeasureDec(); });
+
+        auto start = std::chrono::steady_clock::now();
+        double raCorr = ra.result(raOfs);
+        double decCorr = dec.result(decOfs);
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        mount.Guide(raCorr, decCorr);
+
+        sumSqRA += mount.TrueRA() * mount.TrueRA();
+        sumSqDec += mount.TrueDec() * mount.TrueDec();
+    }
+
+    ClosedLoopResult result;
+    result.rms_ra = std::sqrt(sumSqRA / steps) * params.image_scale;
+    result.rms_dec = std::sqrt(sumSqDec / steps) * params.image_scale;
+    result.ns_per_step = std::chrono::duration<double, std::nano>(elapsed).count() / steps;
+    return result;
+}
+
+static void report(const std::string& name, const ClosedLoopResult& result)
+{
+    std::cout << name << ": RMS RA " << result.rms_ra << "\" Dec " << result.rms_dec << "\", " << result.ns_per_step
+              << " ns/step" << std::endl;
+}
+
+class GuideAlgorithmsPerformanceTest : public ::testing::Test
+{
+public:
+    static const double MaxNsPerStep; // upper bound for the time spent in the algorithms per guide step
+    static const double Tolerance; // allowed degradation of the RMS error relative to the baseline
+
+    Mount scope; // selects the config path of the algorithms
+    SimulatedMountParams params;
+
+    GuideAlgorithmsPerformanceTest()
+    {
+        params.seed = 20170310;
+    }
+};
+
+const double GuideAlgorithmsPerformanceTest::MaxNsPerStep = 20000.0;
+const double GuideAlgorithmsPerformanceTest::Tolerance = 1.1;
+
+// The RMS baselines below were recorded with this seed. Re-record them from the test output when an
+// algorithm or the mount model is changed on purpose.
+
+TEST_F(GuideAlgorithmsPerformanceTest, unguided_reference)
+{
+    GANone ra, dec;
+    ClosedLoopResult result = run_closed_loop(ra, dec, params);
+    report("Unguided", result);
+    // an unguided mount drifts 40 arc-minutes in Dec over the night
+    EXPECT_GT(result.rms_dec, 1000.0);
+}
+
+TEST_F(GuideAlgorithmsPerformanceTest, reproducible)
+{
+    GuideAlgorithmHysteresis ra1(&scope, GUIDE_RA), ra2(&scope, GUIDE_RA);
+    GuideAlgorithmResistSwitch dec1(&scope, GUIDE_DEC), dec2(&scope, GUIDE_DEC);
+    ClosedLoopResult r1 = run_closed_loop(ra1, dec1, params, 2000);
+    ClosedLoopResult r2 = run_closed_loop(ra2, dec2, params, 2000);
+    EXPECT_EQ(r1.rms_ra, r2.rms_ra);
+    EXPECT_EQ(r1.rms_dec, r2.rms_dec);
+}
+
+TEST_F(GuideAlgorithmsPerformanceTest, hysteresis_resistswitch)
+{
+    GuideAlgorithmHysteresis ra(&scope, GUIDE_RA);
+    GuideAlgorithmResistSwitch dec(&scope, GUIDE_DEC);
+    ClosedLoopResult result = run_closed_loop(ra, dec, params);
+    report("Hysteresis/ResistSwitch", result);
+    EXPECT_LT(result.rms_ra, 0.198 * Tolerance);
+    EXPECT_LT(result.rms_dec, 0.256 * Tolerance);
+    EXPECT_LT(result.ns_per_step, MaxNsPerStep);
+}
+
+TEST_F(GuideAlgorithmsPerformanceTest, lowpass_lowpass2)
+{
+    GuideAlgorithmLowpass ra(&scope, GUIDE_RA);
+    GuideAlgorithmLowpass2 dec(&scope, GUIDE_DEC);
+    ClosedLoopResult result = run_closed_loop(ra, dec, params);
+    report("Lowpass/Lowpass2", result);
+    EXPECT_LT(result.rms_ra, 0.271 * Tolerance);
+    EXPECT_LT(result.rms_dec, 0.288 * Tolerance);
+    EXPECT_LT(result.ns_per_step, MaxNsPerStep);
+}
+
+TEST_F(GuideAlgorithmsPerformanceTest, lowpass2_hysteresis)
+{
+    GuideAlgorithmLowpass2 ra(&scope, GUIDE_RA);
+    GuideAlgorithmHysteresis dec(&scope, GUIDE_DEC);
+    ClosedLoopResult result = run_closed_loop(ra, dec, params);
+    report("Lowpass2/Hysteresis", result);
+    EXPECT_LT(result.rms_ra, 0.252 * Tolerance);
+    EXPECT_LT(result.rms_dec, 0.207 * Tolerance);
+    EXPECT_LT(result.ns_per_step, MaxNsPerStep);
+}
+
+TEST_F(GuideAlgorithmsPerformanceTest, zfilter_resistswitch)
+{
+    GuideAlgorithmZFilter ra(&scope, GUIDE_RA);
+    GuideAlgorithmResistSwitch dec(&scope, GUIDE_DEC);
+    ClosedLoopResult result = run_closed_loop(ra, dec, params);
+    report("ZFilter/ResistSwitch", result);
+    EXPECT_LT(result.rms_ra, 0.332 * Tolerance);
+    EXPECT_LT(result.rms_dec, 0.256 * Tolerance);
+    EXPECT_LT(result.ns_per_step, MaxNsPerStep);
+}
+
+TEST_F(GuideAlgorithmsPerformanceTest, multistar)
+{
+    // centroid noise dominates with faint stars, averaging several stars should reduce the error
+    params.centroid_noise = 0.3;
+
+    GuideAlgorithmHysteresis ra1(&scope, GUIDE_RA);
+    GuideAlgorithmResistSwitch dec1(&scope, GUIDE_DEC);
+    ClosedLoopResult single = run_closed_loop(ra1, dec1, params, NightSteps, 1);
+    report("Hysteresis/ResistSwitch, 1 star", single);
+
+    GuideAlgorithmHysteresis ra9(&scope, GUIDE_RA);
+    GuideAlgorithmResistSwitch dec9(&scope, GUIDE_DEC);
+    ClosedLoopResult multi = run_closed_loop(ra9, dec9, params, NightSteps, 9);
+    report("Hysteresis/ResistSwitch, 9 stars", multi);
+
+    EXPECT_LT(multi.rms_ra, single.rms_ra);
+    EXPECT_LT(multi.rms_dec, single.rms_dec);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
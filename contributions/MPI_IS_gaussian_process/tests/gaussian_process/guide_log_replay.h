@@ -0,0 +1,513 @@
+/*
+ *  guide_log_replay.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef GUIDE_LOG_REPLAY_H_INCLUDED
+#define GUIDE_LOG_REPLAY_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "phd_stub.h"
+
+/*
+ * Offline replay of PHD2 guide logs.
+ *
+ * GuideLogReader splits a guide log into its guiding sections and keeps the
+ * per-frame mount data together with the dither and settling events that
+ * the guider logged in between. replay_section() then feeds one axis of a
+ * section through a guide algorithm twice:
+ *
+ *  - open loop: the algorithm sees the logged raw distances and its output is
+ *    compared with the correction that was actually issued (the logged guide
+ *    distance). Replaying the algorithm and settings that produced the log
+ *    should give a difference close to zero.
+ *
+ *  - closed loop: the logged corrections are removed from the measurements
+ *    and the algorithm's own corrections are applied instead, the same
+ *    simple telescope model used by calculate_improvement().
+ *
+ * Any GuideAlgorithm from src/ can be replayed, it runs with the default
+ * settings of the stand-in profile from phd_stub.h.
+ */
+
+struct GuideLogFrame
+{
+    int frame;
+    double time;            // seconds since the start of the section
+    bool ao;                // step from an AO rather than the mount
+    double dx, dy;          // camera offset (px)
+    double ra_raw, dec_raw; // mount offset (px)
+    double ra_guide, dec_guide; // correction issued by the guide algorithm (px)
+    double mass;
+    double snr;
+    int error;
+    bool settling;          // frame taken while settling after a dither
+    bool dithered;          // first frame after a dither or lock position change
+    double dither_dx, dither_dy; // lock position shift of the dithers before this frame (px)
+};
+
+struct GuideLogSection
+{
+    std::string begins;     // timestamp from the "Guiding Begins at" line
+    double exposure;        // seconds
+    double pixel_scale;     // arc-sec/px, 0 if unknown
+    std::string ra_algorithm;
+    std::string dec_algorithm;
+    std::vector<GuideLogFrame> frames;
+    int dropped_frames;
+    int dithers;
+    bool complete;          // the section has a "Guiding Ends" line
+
+    GuideLogSection() : exposure(0.0), pixel_scale(0.0), dropped_frames(0), dithers(0), complete(false) { }
+};
+
+class GuideLogReader
+{
+    enum Column
+    {
+        COL_FRAME,
+        COL_TIME,
+        COL_MOUNT,
+        COL_DX,
+        COL_DY,
+        COL_RA_RAW,
+        COL_DEC_RAW,
+        COL_RA_GUIDE,
+        COL_DEC_GUIDE,
+        COL_MASS,
+        COL_SNR,
+        COL_ERROR,
+        NUM_COLUMNS
+    };
+
+    int m_columns[NUM_COLUMNS];
+
+    static bool StartsWith(const std::string& s, const char *prefix)
+    {
+        return s.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+    }
+
+    // split a CSV row; quotes are only used around the mount name and the
+    // drop status, neither of which contain commas
+    static void SplitRow(const std::string& line, std::vector<std::string> *fields)
+    {
+        fields->clear();
+        size_t pos = 0;
+        while (true)
+        {
+            size_t end = line.find(',', pos);
+            std::string f = line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+            if (f.size() >= 2 && f.front() == '"' && f.back() == '"')
+                f = f.substr(1, f.size() - 2);
+            fields->push_back(f);
+            if (end == std::string::npos)
+                break;
+            pos = end + 1;
+        }
+    }
+
+    static double ToDouble(const std::string& s)
+    {
+        return s.empty() ? 0.0 : std::strtod(s.c_str(), nullptr);
+    }
+
+    const std::string& Field(const std::vector<std::string>& fields, Column col) const
+    {
+        static const std::string empty;
+        int idx = m_columns[col];
+        return idx >= 0 && idx < static_cast<int>(fields.size()) ? fields[idx] : empty;
+    }
+
+    void DefaultColumns()
+    {
+        // column layout written by GuidingLog::GuidingHeader
+        static const int defaults[NUM_COLUMNS] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 15, 16, 17 };
+        std::copy(defaults, defaults + NUM_COLUMNS, m_columns);
+    }
+
+    void MapColumns(const std::string& header)
+    {
+        static const char *names[NUM_COLUMNS] = {
+            "Frame", "Time", "mount", "dx", "dy", "RARawDistance", "DECRawDistance",
+            "RAGuideDistance", "DECGuideDistance", "StarMass", "SNR", "ErrorCode",
+        };
+        std::vector<std::string> fields;
+        SplitRow(header, &fields);
+        for (int col = 0; col < NUM_COLUMNS; col++)
+        {
+            std::vector<std::string>::const_iterator it = std::find(fields.begin(), fields.end(), names[col]);
+            m_columns[col] = it == fields.end() ? -1 : static_cast<int>(it - fields.begin());
+        }
+    }
+
+    // value following "<key> = " in a header line
+    static std::string HeaderValue(const std::string& line, const char *key)
+    {
+        std::string pat = std::string(key) + " = ";
+        size_t pos = line.find(pat);
+        if (pos == std::string::npos)
+            return std::string();
+        pos += pat.size();
+        size_t end = line.find(',', pos);
+        return line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    }
+
+public:
+    GuideLogReader() { DefaultColumns(); }
+
+    /*
+     * Appends the guiding sections found in the stream to sections.
+     * Calibration sections and everything outside a guiding section are
+     * skipped. Returns false if no guiding section was found.
+     */
+    bool Read(std::istream& in, std::vector<GuideLogSection> *sections)
+    {
+        size_t first = sections->size();
+        GuideLogSection *cur = nullptr;
+        bool settling = false;
+        bool dithered = false;
+        double dither_dx = 0.0, dither_dy = 0.0;
+        std::vector<std::string> fields;
+        std::string line;
+
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty())
+                continue;
+
+            if (StartsWith(line, "Guiding Begins at "))
+            {
+                sections->push_back(GuideLogSection());
+                cur = &sections->back();
+                cur->begins = line.substr(18);
+                settling = false;
+                dithered = false;
+                dither_dx = dither_dy = 0.0;
+                DefaultColumns();
+                continue;
+            }
+
+            if (!cur)
+                continue;
+
+            char c = line[0];
+            if (c >= '0' && c <= '9')
+            {
+                SplitRow(line, &fields);
+                const std::string& mount = Field(fields, COL_MOUNT);
+                if (mount == "DROP")
+                {
+                    ++cur->dropped_frames;
+                    continue;
+                }
+                if (mount != "Mount" && mount != "AO")
+                    continue;
+
+                GuideLogFrame f;
+                f.frame = std::atoi(Field(fields, COL_FRAME).c_str());
+                f.time = ToDouble(Field(fields, COL_TIME));
+                f.ao = mount == "AO";
+                f.dx = ToDouble(Field(fields, COL_DX));
+                f.dy = ToDouble(Field(fields, COL_DY));
+                f.ra_raw = ToDouble(Field(fields, COL_RA_RAW));
+                f.dec_raw = ToDouble(Field(fields, COL_DEC_RAW));
+                f.ra_guide = ToDouble(Field(fields, COL_RA_GUIDE));
+                f.dec_guide = ToDouble(Field(fields, COL_DEC_GUIDE));
+                f.mass = ToDouble(Field(fields, COL_MASS));
+                f.snr = ToDouble(Field(fields, COL_SNR));
+                f.error = std::atoi(Field(fields, COL_ERROR).c_str());
+                f.settling = settling;
+                f.dithered = dithered;
+                f.dither_dx = dither_dx;
+                f.dither_dy = dither_dy;
+                dithered = false;
+                dither_dx = dither_dy = 0.0;
+                cur->frames.push_back(f);
+            }
+            else if (StartsWith(line, "INFO: "))
+            {
+                if (StartsWith(line, "INFO: DITHER by "))
+                {
+                    // INFO: DITHER by <dx>, <dy>, new lock pos = <x>, <y>
+                    char *end;
+                    dither_dx += std::strtod(line.c_str() + 16, &end);
+                    if (*end == ',')
+                        dither_dy += std::strtod(end + 1, nullptr);
+                    ++cur->dithers;
+                    dithered = true;
+                }
+                else if (StartsWith(line, "INFO: SET LOCK POSITION"))
+                    dithered = true;
+                else if (StartsWith(line, "INFO: SETTLING STATE CHANGE, "))
+                    settling = line.find("Settling started") != std::string::npos;
+            }
+            else if (StartsWith(line, "Frame,Time,"))
+                MapColumns(line);
+            else if (StartsWith(line, "Guiding Ends at "))
+            {
+                cur->complete = true;
+                cur = nullptr;
+            }
+            else if (StartsWith(line, "Exposure = "))
+                cur->exposure = ToDouble(line.substr(11)) / 1000.0;
+            else if (StartsWith(line, "Pixel scale = "))
+                cur->pixel_scale = ToDouble(line.substr(14));
+            else if (StartsWith(line, "X guide algorithm = "))
+                cur->ra_algorithm = HeaderValue(line, "X guide algorithm");
+            else if (StartsWith(line, "Y guide algorithm = "))
+                cur->dec_algorithm = HeaderValue(line, "Y guide algorithm");
+        }
+
+        return sections->size() > first;
+    }
+
+    bool ReadFile(const std::string& filename, std::vector<GuideLogSection> *sections)
+    {
+        std::ifstream file(filename.c_str());
+        if (!file)
+            return false;
+        return Read(file, sections);
+    }
+};
+
+enum ReplayAxis
+{
+    REPLAY_RA,
+    REPLAY_DEC,
+};
+
+struct ReplayStats
+{
+    int frames;             // frames replayed (settling frames excluded)
+    double actual_rms;      // rms of the logged corrections
+    double predicted_rms;   // rms of the replayed corrections
+    double difference_rms;  // rms of predicted - actual
+    double max_difference;
+    double logged_error_rms;    // rms of the logged raw distance
+    double simulated_error_rms; // rms error with the replayed algorithm in the loop
+    double ns_per_step;     // mean time of one result() call
+
+    ReplayStats() : frames(0), actual_rms(0.0), predicted_rms(0.0), difference_rms(0.0), max_difference(0.0),
+        logged_error_rms(0.0), simulated_error_rms(0.0), ns_per_step(0.0) { }
+};
+
+/*
+ * Replays one axis of a section. When the section contains AO steps only
+ * the AO frames are replayed, since the mount rows are then bumps rather
+ * than guide steps. A dither or lock position change resets both algorithm
+ * instances, like GuideAlgorithm::GuidingDithered() does, and restarts the
+ * closed loop from the logged position.
+ */
+template<typename GA>
+ReplayStats replay_section(const GuideLogSection& section, ReplayAxis axis)
+{
+    typedef std::chrono::steady_clock clock;
+
+    ReplayStats stats;
+    Mount mount;
+    GuideAxis guide_axis = axis == REPLAY_RA ? GUIDE_RA : GUIDE_DEC;
+    GA open_loop(&mount, guide_axis);
+    GA closed_loop(&mount, guide_axis);
+
+    bool ao = std::any_of(section.frames.begin(), section.frames.end(),
+                          [](const GuideLogFrame& f) { return f.ao; });
+
+    double sum_actual = 0.0, sum_predicted = 0.0, sum_diff = 0.0;
+    double sum_logged = 0.0, sum_simulated = 0.0;
+    double state = 0.0;
+    double prev_measurement = 0.0;
+    double prev_control = 0.0;
+    bool have_prev = false;
+    int steps = 0;
+    clock::duration elapsed(0);
+
+    for (const GuideLogFrame& f : section.frames)
+    {
+        if (f.ao != ao)
+            continue;
+
+        double measurement = axis == REPLAY_RA ? f.ra_raw : f.dec_raw;
+        double actual = axis == REPLAY_RA ? f.ra_guide : f.dec_guide;
+
+        if (f.dithered)
+        {
+            open_loop.reset();
+            closed_loop.reset();
+            have_prev = false;
+        }
+
+        // closed loop: swap the logged correction for the replayed one
+        if (have_prev)
+            state += measurement - (prev_measurement - prev_control);
+        else
+            state = measurement;
+
+        clock::time_point t0 = clock::now();
+        double predicted = open_loop.result(measurement);
+        elapsed += clock::now() - t0;
+        ++steps;
+
+        double control = closed_loop.result(state);
+
+        if (!f.settling)
+        {
+            double diff = predicted - actual;
+            sum_actual += actual * actual;
+            sum_predicted += predicted * predicted;
+            sum_diff += diff * diff;
+            stats.max_difference = std::max(stats.max_difference, std::fabs(diff));
+            sum_logged += measurement * measurement;
+            sum_simulated += state * state;
+            ++stats.frames;
+        }
+
+        state -= control;
+        prev_measurement = measurement;
+        prev_control = actual;
+        have_prev = true;
+    }
+
+    if (stats.frames > 0)
+    {
+        double n = stats.frames;
+        stats.actual_rms = std::sqrt(sum_actual / n);
+        stats.predicted_rms = std::sqrt(sum_predicted / n);
+        stats.difference_rms = std::sqrt(sum_diff / n);
+        stats.logged_error_rms = std::sqrt(sum_logged / n);
+        stats.simulated_error_rms = std::sqrt(sum_simulated / n);
+    }
+    if (steps > 0)
+        stats.ns_per_step = std::chrono::duration<double, std::nano>(elapsed).count() / steps;
+
+    return stats;
+}
+
+typedef ReplayStats (*ReplayFunction)(const GuideLogSection&, ReplayAxis);
+
+struct ReplayAlgorithm
+{
+    std::string name;
+    ReplayFunction replay;
+};
+
+struct ReplayResult
+{
+    std::string filename;
+    int section;
+    ReplayAxis axis;
+    std::string algorithm;
+    std::string logged_algorithm;
+    ReplayStats stats;
+};
+
+/*
+ * Replays every section of every log through every algorithm on both axes,
+ * spreading the logs over nthreads worker threads (0 = one per core).
+ * Results are returned in input order regardless of the thread count; logs
+ * that cannot be read produce no results and are counted in *failed.
+ */
+inline std::vector<ReplayResult> replay_logs(const std::vector<std::string>& filenames,
+                                             const std::vector<ReplayAlgorithm>& algorithms,
+                                             unsigned int nthreads, int *failed = nullptr)
+{
+    std::vector<std::vector<ReplayResult>> per_file(filenames.size());
+    std::vector<char> ok(filenames.size(), 0);
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < filenames.size())
+        {
+            GuideLogReader reader;
+            std::vector<GuideLogSection> sections;
+            if (!reader.ReadFile(filenames[i], &sections))
+                continue;
+            ok[i] = 1;
+
+            for (size_t s = 0; s < sections.size(); s++)
+            {
+                for (int a = REPLAY_RA; a <= REPLAY_DEC; a++)
+                {
+                    ReplayAxis axis = static_cast<ReplayAxis>(a);
+                    for (const ReplayAlgorithm& alg : algorithms)
+                    {
+                        ReplayResult r;
+                        r.filename = filenames[i];
+                        r.section = static_cast<int>(s) + 1;
+                        r.axis = axis;
+                        r.algorithm = alg.name;
+                        r.logged_algorithm = axis == REPLAY_RA ? sections[s].ra_algorithm : sections[s].dec_algorithm;
+                        r.stats = alg.replay(sections[s], axis);
+                        per_file[i].push_back(r);
+                    }
+                }
+            }
+        }
+    };
+
+    if (nthreads == 0)
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    nthreads = static_cast<unsigned int>(std::min<size_t>(nthreads, std::max<size_t>(filenames.size(), 1)));
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < nthreads; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+
+    std::vector<ReplayResult> results;
+    int nfailed = 0;
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        if (!ok[i])
+            ++nfailed;
+        results.insert(results.end(), per_file[i].begin(), per_file[i].end());
+    }
+    if (failed)
+        *failed = nfailed;
+
+    return results;
+}
+
+#endif // GUIDE_LOG_REPLAY_H_INCLUDED
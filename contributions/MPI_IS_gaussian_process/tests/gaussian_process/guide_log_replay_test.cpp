@@ -0,0 +1,229 @@
+/*
+ *  guide_log_replay_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include "gaussian_process_guider.h"
+#include "guide_performance_tools.h" // read_data_from_file
+#include "guide_log_replay.h"
+#include "simulated_mount.h"
+
+#include <cstdio>
+
+class GuideLogReplayTest : public ::testing::Test
+{
+public:
+    static const int FramesPerSection = 200;
+
+    /*
+     * Writes a guide log in the GuidingLog format with two guiding sections,
+     * a dropped frame and a dither followed by settling. The RA corrections
+     * are produced by GuideAlgorithmHysteresis, the Dec corrections by
+     * GuideAlgorithmResistSwitch.
+     */
+    static std::string SyntheticLog()
+    {
+        std::ostringstream log;
+        log << "PHD2 version 2.6.3, Log version 2.5. Log enabled at 2017-03-10 20:20:00\r\n\r\n";
+        log << "Calibration Begins at 2017-03-10 20:20:10\r\n";
+        log << "West,0,1.000,1.000,0.000,0.000,0.000\r\n";
+        log << "Calibration complete, mount = Simulator.\r\n\r\n";
+
+        for (int section = 0; section < 2; section++)
+        {
+            Mount mount;
+            GuideAlgorithmHysteresis ra(&mount, GUIDE_RA);
+            GuideAlgorithmResistSwitch dec(&mount, GUIDE_DEC);
+            SimRandom rng(section + 1);
+
+            log << "Guiding Begins at 2017-03-10 2" << section << ":22:52\r\n";
+            log << "Pixel scale = 3.22 arc-sec/px, Binning = 1, Focal length = 240 mm\r\n";
+            log << "Exposure = 2000 ms\r\n";
+            log << "X guide algorithm = Hysteresis, Hysteresis = 0.100, Aggression = 0.700, Minimum move = 0.200\r\n";
+            log << "Y guide algorithm = Resist Switch, Minimum move = 0.200 Aggression = 100% FastSwitch = enabled\r\n";
+            log << "Frame,Time,mount,dx,dy,RARawDistance,DECRawDistance,RAGuideDistance,DECGuideDistance,"
+                   "RADuration,RADirection,DECDuration,DECDirection,XStep,YStep,StarMass,SNR,ErrorCode\r\n";
+
+            for (int i = 1; i <= FramesPerSection; i++)
+            {
+                if (i == 50)
+                {
+                    log << i << "," << 2.0 * i << ",\"DROP\",,,,,,,,,,,,,1500,20.00,1,\"Star lost\"\r\n";
+                    continue;
+                }
+                if (i == 100)
+                {
+                    log << "INFO: DITHER by -1.960, -4.850, new lock pos = 641.050, 517.300\r\n";
+                    log << "INFO: SETTLING STATE CHANGE, Settling started\r\n";
+                    ra.reset();
+                    dec.reset();
+                }
+                if (i == 110)
+                    log << "INFO: SETTLING STATE CHANGE, Settling complete\r\n";
+
+                double ra_raw = 0.6 * (rng.Uniform() - 0.5) + 0.3 * std::sin(i / 20.0);
+                double dec_raw = 0.6 * (rng.Uniform() - 0.5) + 0.2;
+                double ra_guide = ra.result(ra_raw);
+                double dec_guide = dec.result(dec_raw);
+
+                char buf[256];
+                snprintf(buf, sizeof(buf), "%d,%.3f,\"Mount\",%.3f,%.3f,%.6f,%.6f,%.6f,%.6f,%d,E,%d,N,,,1500,20.00,0\r\n",
+                         i, 2.0 * i, -ra_raw, -dec_raw, ra_raw, dec_raw, ra_guide, dec_guide,
+                         static_cast<int>(std::fabs(ra_guide) * 400), static_cast<int>(std::fabs(dec_guide) * 400));
+                log << buf;
+            }
+
+            log << "Guiding Ends at 2017-03-10 2" << section << ":50:29\r\n\r\n";
+        }
+
+        return log.str();
+    }
+};
+
+TEST_F(GuideLogReplayTest, reads_sections_and_events)
+{
+    std::istringstream in(SyntheticLog());
+    GuideLogReader reader;
+    std::vector<GuideLogSection> sections;
+
+    ASSERT_TRUE(reader.Read(in, &sections));
+    ASSERT_EQ(sections.size(), 2u);
+
+    for (const GuideLogSection& s : sections)
+    {
+        EXPECT_TRUE(s.complete);
+        EXPECT_DOUBLE_EQ(s.exposure, 2.0);
+        EXPECT_DOUBLE_EQ(s.pixel_scale, 3.22);
+        EXPECT_EQ(s.ra_algorithm, "Hysteresis");
+        EXPECT_EQ(s.dec_algorithm, "Resist Switch");
+        EXPECT_EQ(s.frames.size(), static_cast<size_t>(FramesPerSection - 1));
+        EXPECT_EQ(s.dropped_frames, 1);
+        EXPECT_EQ(s.dithers, 1);
+
+        int settling = 0, dithered = 0;
+        for (const GuideLogFrame& f : s.frames)
+        {
+            settling += f.settling;
+            dithered += f.dithered;
+            if (f.dithered)
+            {
+                EXPECT_EQ(f.frame, 100);
+            }
+        }
+        EXPECT_EQ(settling, 10);
+        EXPECT_EQ(dithered, 1);
+    }
+}
+
+TEST_F(GuideLogReplayTest, replay_reproduces_logged_algorithm)
+{
+    std::istringstream in(SyntheticLog());
+    GuideLogReader reader;
+    std::vector<GuideLogSection> sections;
+    ASSERT_TRUE(reader.Read(in, &sections));
+
+    ReplayStats ra = replay_section<GuideAlgorithmHysteresis>(sections[0], REPLAY_RA);
+    EXPECT_EQ(ra.frames, FramesPerSection - 1 - 10);
+    EXPECT_GT(ra.actual_rms, 0.05);
+    EXPECT_LT(ra.max_difference, 1e-5);
+
+    ReplayStats dec = replay_section<GuideAlgorithmResistSwitch>(sections[0], REPLAY_DEC);
+    EXPECT_LT(dec.max_difference, 1e-5);
+
+    // a different algorithm must not reproduce the log
+    ReplayStats other = replay_section<GuideAlgorithmZFilter>(sections[0], REPLAY_RA);
+    EXPECT_GT(other.difference_rms, 0.01);
+}
+
+TEST_F(GuideLogReplayTest, reads_dataset_logs)
+{
+    for (int i = 1; i <= 8; i++)
+    {
+        char filename[64];
+        snprintf(filename, sizeof(filename), "performance_dataset%02d.txt", i);
+
+        GuideLogReader reader;
+        std::vector<GuideLogSection> sections;
+        ASSERT_TRUE(reader.ReadFile(filename, &sections)) << filename;
+        ASSERT_EQ(sections.size(), 1u) << filename;
+        EXPECT_GT(sections[0].exposure, 0.0) << filename;
+
+        EXPECT_FALSE(sections[0].ra_algorithm.empty()) << filename;
+        EXPECT_FALSE(sections[0].dec_algorithm.empty()) << filename;
+
+        // same frames as the reader used by calculate_improvement
+        Eigen::ArrayXXd data = read_data_from_file(filename);
+        EXPECT_EQ(static_cast<long>(sections[0].frames.size()), static_cast<long>(data.cols())) << filename;
+    }
+}
+
+TEST_F(GuideLogReplayTest, parallel_replay_matches_serial)
+{
+    std::vector<std::string> filenames;
+    for (int i = 1; i <= 8; i++)
+    {
+        char filename[64];
+        snprintf(filename, sizeof(filename), "performance_dataset%02d.txt", i);
+        filenames.push_back(filename);
+    }
+    filenames.push_back("no_such_log.txt");
+
+    std::vector<ReplayAlgorithm> algorithms = {
+        { "Hysteresis", replay_section<GuideAlgorithmHysteresis> },
+        { "ZFilter", replay_section<GuideAlgorithmZFilter> },
+    };
+
+    int failed_serial = 0, failed_parallel = 0;
+    std::vector<ReplayResult> serial = replay_logs(filenames, algorithms, 1, &failed_serial);
+    std::vector<ReplayResult> parallel = replay_logs(filenames, algorithms, 4, &failed_parallel);
+
+    EXPECT_EQ(failed_serial, 1);
+    EXPECT_EQ(failed_parallel, 1);
+    ASSERT_EQ(serial.size(), 8u * 2 * 2);
+    ASSERT_EQ(parallel.size(), serial.size());
+
+    for (size_t i = 0; i < serial.size(); i++)
+    {
+        EXPECT_EQ(serial[i].filename, parallel[i].filename);
+        EXPECT_EQ(serial[i].axis, parallel[i].axis);
+        EXPECT_EQ(serial[i].algorithm, parallel[i].algorithm);
+        EXPECT_EQ(serial[i].stats.frames, parallel[i].stats.frames);
+        EXPECT_DOUBLE_EQ(serial[i].stats.difference_rms, parallel[i].stats.difference_rms);
+        EXPECT_DOUBLE_EQ(serial[i].stats.simulated_error_rms, parallel[i].stats.simulated_error_rms);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
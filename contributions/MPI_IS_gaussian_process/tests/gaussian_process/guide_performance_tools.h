@@ -150,6 +150,26 @@ inline Eigen::ArrayXXd read_data_from_file(std::string filename)
     return result;
 }
 
+/*
+ * Reads a text file with one file name per line, as used for @listfile
+ * arguments of the command line tools.
+ */
+inline bool read_file_list(const std::string& listfile, std::vector<std::string> *filenames)
+{
+    std::ifstream in(listfile.c_str());
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            filenames->push_back(line);
+    }
+    return true;
+}
+
 inline double get_exposure_from_file(std::string filename)
 {
     std::ifstream file(filename);
@@ -202,13 +222,12 @@ public:
 };
 
 /*
- * Calculates the improvement of the GP Guider over Hysteresis on a dataset.
+ * Calculates the improvement of the GP Guider over Hysteresis on a dataset
+ * that was read with read_data_from_file.
  */
-inline double calculate_improvement(std::string filename, GAHysteresis GAH, GaussianProcessGuider* GPG)
+inline double calculate_improvement(const Eigen::ArrayXXd& data, double exposure, GAHysteresis GAH,
+                                    GaussianProcessGuider* GPG)
 {
-    Eigen::ArrayXXd data = read_data_from_file(filename);
-    double exposure = get_exposure_from_file(filename);
-
     Eigen::ArrayXd times = data.row(0);
     Eigen::ArrayXd measurements = data.row(1);
     Eigen::ArrayXd controls = data.row(2);
@@ -247,3 +266,11 @@ inline double calculate_improvement(std::string filename, GAHysteresis GAH, Gaus
 
     return 1 - gp_guider_rms / hysteresis_rms;
 }
+
+/*
+ * Calculates the improvement of the GP Guider over Hysteresis on a dataset.
+ */
+inline double calculate_improvement(std::string filename, GAHysteresis GAH, GaussianProcessGuider* GPG)
+{
+    return calculate_improvement(read_data_from_file(filename), get_exposure_from_file(filename), GAH, GPG);
+}
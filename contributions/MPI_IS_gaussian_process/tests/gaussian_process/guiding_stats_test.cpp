@@ -0,0 +1,340 @@
+/*
+ *  guiding_stats_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests for the Guiding Assistant statistics in src/guiding_stats.cpp.
+ */
+
+#include <gtest/gtest.h>
+#include "guide_log_replay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+/*
+ * The interval scan GuidingAsstWin::GetMinMoveRecs used before the
+ * intervals were slid over the data: every interval is rebuilt from
+ * scratch. Kept as the reference for GetBestIntervalSigma.
+ */
+static double FullRecomputeBestSigma(const AxisStats& series, double intervalSecs, double *selSlope, double *selRSquared)
+{
+    AxisStats decVals;
+    double bestEstimate = 1000;
+    double slope = 0;
+    double intcpt = 0;
+    double rSquared = 0;
+    double correctedRMS;
+    const double windowAdjustment = intervalSecs / 2;
+
+    *selSlope = 0;
+    *selRSquared = 0;
+
+    int lastInx = series.GetCount() - 1;
+    StarDisplacement val = series.GetEntry(0);
+    double tStart = val.DeltaTime;
+    bool done = false;
+    int inx = 0;
+    while (!done)
+    {
+        val = series.GetEntry(inx);
+        decVals.AddGuideInfo(val.DeltaTime, val.StarPos, 0);
+        if (val.DeltaTime - tStart >= intervalSecs || (inx == lastInx && val.DeltaTime - tStart >= 0.8 * intervalSecs))
+        {
+            if (decVals.GetCount() > 1)
+            {
+                double simpleSigma = decVals.GetSigma();
+                rSquared = decVals.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
+                if (correctedRMS < simpleSigma)
+                {
+                    if (correctedRMS < bestEstimate)
+                    {
+                        bestEstimate = correctedRMS;
+                        *selRSquared = rSquared;
+                        *selSlope = slope;
+                    }
+                }
+                else
+                    bestEstimate = std::min(bestEstimate, simpleSigma);
+            }
+            double targetTime = val.DeltaTime - windowAdjustment;
+            while (series.GetEntry(inx).DeltaTime > targetTime)
+                inx--;
+            tStart = series.GetEntry(inx).DeltaTime;
+
+            decVals.ClearAll();
+        }
+        else
+        {
+            inx++;
+        }
+        done = (inx > lastInx);
+    }
+    return bestEstimate;
+}
+
+static const double IntervalSecs = 120.0; // MEASUREMENT_WINDOW_SIZE of the GA
+
+/*
+ * Reads the Dec axis of a recorded guide log as the GA would have seen it
+ * unguided: the logged corrections are added back to the raw distances.
+ * The series ends at the first gap longer than half an interval, which the
+ * full recompute cannot get past.
+ */
+static bool ReadUnguidedDec(const std::string& filename, AxisStats *series)
+{
+    GuideLogReader reader;
+    std::vector<GuideLogSection> sections;
+    if (!reader.ReadFile(filename, &sections) || sections.empty())
+        return false;
+
+    double corrections = 0.0;
+    for (const GuideLogFrame& f : sections[0].frames)
+    {
+        if (series->GetCount() > 0 && f.time - series->GetLastEntry().DeltaTime > IntervalSecs / 2)
+            break;
+        series->AddGuideInfo(f.time, f.dec_raw + corrections, 0);
+        corrections += f.dec_guide;
+    }
+    return true;
+}
+
+TEST(GuidingStatsTest, interval_sigma_matches_full_recompute)
+{
+    for (int i = 1; i <= 8; i++)
+    {
+        char filename[64];
+        snprintf(filename, sizeof(filename), "performance_dataset%02d.txt", i);
+
+        AxisStats series;
+        ASSERT_TRUE(ReadUnguidedDec(filename, &series)) << filename;
+        ASSERT_GT(series.GetLastEntry().DeltaTime - series.GetEntry(0).DeltaTime, 1.2 * IntervalSecs) << filename;
+
+        double refSlope, refRSquared;
+        double reference = FullRecomputeBestSigma(series, IntervalSecs, &refSlope, &refRSquared);
+
+        double slope, rSquared;
+        double estimate = GetBestIntervalSigma(series, IntervalSecs, &slope, &rSquared);
+
+        EXPECT_LT(reference, 1000.0) << filename;
+        EXPECT_NEAR(estimate, reference, 1e-9 * reference) << filename;
+        EXPECT_NEAR(slope, refSlope, 1e-9 + 1e-9 * std::fabs(refSlope)) << filename;
+        EXPECT_NEAR(rSquared, refRSquared, 1e-9) << filename;
+    }
+}
+
+TEST(GuidingStatsTest, linear_fit_sigma)
+{
+    // The GA min-move recommendations are calibrated on this statistic of the drift-removed residuals, keep it unchanged
+    AxisStats series;
+    ASSERT_TRUE(ReadUnguidedDec("performance_dataset01.txt", &series));
+
+    double slope, intcpt, sigma;
+    series.GetLinearFitResults(&slope, &intcpt, &sigma);
+
+    size_t n = series.GetCount();
+    double mean = 0.0;
+    double variance = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        StarDisplacement entry = series.GetEntry(i);
+        double residual = entry.StarPos - (entry.DeltaTime * slope + intcpt);
+        if (i == 0)
+            mean = residual;
+        else
+        {
+            double delta = residual - mean;
+            variance += delta * delta;
+            mean += delta / n;
+        }
+    }
+    EXPECT_NEAR(sigma, std::sqrt(variance / (n - 1)), 1e-12);
+}
+
+TEST(GuidingStatsTest, interval_sigma_with_gap)
+{
+    // A gap longer than half an interval would make the full recompute select the same interval forever
+    AxisStats series;
+    double t = 0.0;
+    for (int i = 0; i < 200; i++)
+    {
+        if (i == 100)
+            t += 3 * IntervalSecs;
+        series.AddGuideInfo(t, 0.01 * t + 0.3 * std::sin(i * 0.7), 0);
+        t += 2.0;
+    }
+
+    double slope, rSquared;
+    double estimate = GetBestIntervalSigma(series, IntervalSecs, &slope, &rSquared);
+
+    EXPECT_LT(estimate, 1000.0);
+    EXPECT_GT(estimate, 0.0);
+}
+
+/*
+ * The order statistics are checked against a sort of the values they hold.
+ * Values are drawn from a small set so that there are many duplicates.
+ */
+static double SmallValue(std::mt19937& rng, double offset)
+{
+    return offset + 0.25 * std::uniform_int_distribution<int>(0, 15)(rng);
+}
+
+TEST(GuidingStatsTest, order_statistics_match_sort)
+{
+    std::mt19937 rng(1);
+    OrderStatistics stats;
+    std::vector<double> values;
+
+    for (int i = 0; i < 3000; i++)
+    {
+        if (!values.empty() && std::uniform_int_distribution<int>(0, 2)(rng) == 0)
+        {
+            size_t victim = std::uniform_int_distribution<size_t>(0, values.size() - 1)(rng);
+            ASSERT_TRUE(stats.Remove(values[victim]));
+            values.erase(values.begin() + victim);
+        }
+        else
+        {
+            double val = SmallValue(rng, -2.0);
+            stats.Add(val);
+            values.push_back(val);
+        }
+
+        std::vector<double> sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+        ASSERT_EQ(stats.GetCount(), sorted.size());
+        for (size_t rank = 0; rank < sorted.size(); rank++)
+            ASSERT_EQ(stats.GetValue(rank), sorted[rank]) << "rank " << rank << " after " << i << " updates";
+    }
+
+    EXPECT_FALSE(stats.Remove(100.0));
+    EXPECT_EQ(stats.GetCount(), values.size());
+
+    stats.Clear();
+    EXPECT_EQ(stats.GetCount(), 0u);
+    stats.Add(1.5);
+    stats.Add(-1.5);
+    stats.Add(1.5);
+    EXPECT_EQ(stats.GetValue(0), -1.5);
+    EXPECT_EQ(stats.GetValue(1), 1.5);
+    EXPECT_EQ(stats.GetValue(2), 1.5);
+    EXPECT_TRUE(stats.Remove(1.5));
+    EXPECT_EQ(stats.GetCount(), 2u);
+    EXPECT_EQ(stats.GetValue(1), 1.5);
+}
+
+static double SortedMedian(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t ctr = values.size() / 2;
+    return values.size() % 2 == 1 ? values[ctr] : (values[ctr] + values[ctr - 1]) / 2.0;
+}
+
+// The largest delta between consecutive positions in the window.  The delta from the first entry of the dataset to the second
+// one is not counted, as it never has been
+static double WindowMaxDelta(const std::vector<double>& history, size_t start)
+{
+    double maxDelta = 0.;
+    for (size_t i = std::max<size_t>(start + 1, 2); i < history.size(); i++)
+        maxDelta = std::max(maxDelta, std::fabs(history[i] - history[i - 1]));
+    return maxDelta;
+}
+
+TEST(GuidingStatsTest, windowed_stats_match_sort)
+{
+    // All positions are negative, the maximum used to start from the smallest positive double
+    const unsigned int windowSize = 25;
+    std::mt19937 rng(2);
+    WindowedAxisStats stats(windowSize);
+    std::vector<double> history;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        // occasional large jumps so that the largest delta ages out of the window now and then
+        double val = std::uniform_int_distribution<int>(0, 40)(rng) == 0 ? SmallValue(rng, -60.0) : SmallValue(rng, -50.0);
+        stats.AddGuideInfo(i, val, 0);
+        history.push_back(val);
+
+        size_t start = history.size() > windowSize ? history.size() - windowSize : 0;
+        std::vector<double> window(history.begin() + start, history.end());
+
+        ASSERT_EQ(stats.GetCount(), window.size());
+        EXPECT_EQ(stats.GetMinDisplacement(), *std::min_element(window.begin(), window.end())) << "after " << i;
+        EXPECT_EQ(stats.GetMaxDisplacement(), *std::max_element(window.begin(), window.end())) << "after " << i;
+        EXPECT_EQ(stats.GetMedian(), SortedMedian(window)) << "after " << i;
+        if (window.size() > 1)
+            EXPECT_EQ(stats.GetMaxDelta(), WindowMaxDelta(history, start)) << "after " << i;
+    }
+}
+
+TEST(GuidingStatsTest, trimmed_stats_match_sort)
+{
+    // A self-managed window that grows and shrinks, as used for the Guiding Assistant intervals.  It keeps at least two entries,
+    // a delta added to a single entry is not counted
+    std::mt19937 rng(3);
+    WindowedAxisStats stats(0);
+    std::vector<double> history;
+    size_t start = 0;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        if (history.size() - start > 2 && std::uniform_int_distribution<int>(0, 2)(rng) == 0)
+        {
+            stats.RemoveOldestEntry();
+            ++start;
+        }
+        else
+        {
+            double val = SmallValue(rng, -3.0);
+            stats.AddGuideInfo(i, val, 0);
+            history.push_back(val);
+        }
+
+        std::vector<double> window(history.begin() + start, history.end());
+
+        ASSERT_EQ(stats.GetCount(), window.size());
+        EXPECT_EQ(stats.GetMinDisplacement(), *std::min_element(window.begin(), window.end())) << "after " << i;
+        EXPECT_EQ(stats.GetMaxDisplacement(), *std::max_element(window.begin(), window.end())) << "after " << i;
+        EXPECT_EQ(stats.GetMedian(), SortedMedian(window)) << "after " << i;
+        if (window.size() > 1)
+            EXPECT_EQ(stats.GetMaxDelta(), WindowMaxDelta(history, start)) << "after " << i;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
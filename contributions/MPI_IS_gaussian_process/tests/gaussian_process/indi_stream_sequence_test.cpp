@@ -0,0 +1,99 @@
+/*
+ *  indi_stream_sequence_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests for the frame sequencing of the INDI camera streaming guide mode,
+ * src/indi_stream_seq.h.
+ */
+
+#include <gtest/gtest.h>
+#include "indi_stream_seq.h"
+
+TEST(IndiStreamSequenceTest, skips_frame_exposing_during_move)
+{
+    StreamSequence seq;
+
+    // the stream is running, frame 1 has been decoded
+    seq.SetPublished(seq.Arrived());
+
+    // the mount moves, then the next capture is requested while frame 2 is
+    // still exposing
+    unsigned int minSeq = seq.CaptureMinSeq();
+
+    unsigned int during = seq.Arrived();
+    ASSERT_TRUE(seq.IsNewer(during));
+    seq.SetPublished(during);
+    EXPECT_FALSE(seq.IsUsable(minSeq)); // frame 2 was exposing during the move
+
+    unsigned int after = seq.Arrived();
+    ASSERT_TRUE(seq.IsNewer(after));
+    seq.SetPublished(after);
+    EXPECT_TRUE(seq.IsUsable(minSeq)); // frame 3 was exposed after the request
+}
+
+TEST(IndiStreamSequenceTest, frames_before_request_are_not_usable)
+{
+    StreamSequence seq;
+
+    // nothing published yet
+    EXPECT_FALSE(seq.IsUsable(seq.CaptureMinSeq()));
+
+    // a frame that arrived before the request and finishes decoding after it
+    unsigned int old = seq.Arrived();
+    unsigned int minSeq = seq.CaptureMinSeq();
+    seq.SetPublished(old);
+    EXPECT_FALSE(seq.IsUsable(minSeq));
+}
+
+TEST(IndiStreamSequenceTest, out_of_order_decode)
+{
+    StreamSequence seq;
+    unsigned int minSeq = seq.CaptureMinSeq();
+
+    unsigned int first = seq.Arrived();
+    unsigned int second = seq.Arrived();
+
+    // the second frame finishes decoding first
+    ASSERT_TRUE(seq.IsNewer(second));
+    seq.SetPublished(second);
+    EXPECT_TRUE(seq.IsUsable(minSeq));
+
+    // the older frame must not replace it
+    EXPECT_FALSE(seq.IsNewer(first));
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
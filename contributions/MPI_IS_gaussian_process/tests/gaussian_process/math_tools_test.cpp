@@ -208,6 +208,100 @@ TEST(MathToolsTest, StdTest)
     EXPECT_NEAR(math_tools::stdandard_deviation(data), matlab_result, 1e-3);
 }
 
+TEST(MathToolsTest, StreamingSpectrumTest)
+{
+    int N = 256;
+    int M = 100;
+    Eigen::VectorXd t = 5.0 * Eigen::VectorXd::LinSpaced(M, 0, M - 1).array() + 2.5;
+    Eigen::VectorXd x = (2 * M_PI * t.array() / 80.0).sin() + 0.02 * t.array() + 3.0;
+
+    math_tools::StreamingSpectrum streamed(N);
+    for (int i = 0; i < M; ++i)
+    {
+        streamed.add(t(i), x(i));
+    }
+    math_tools::StreamingSpectrum batch(N);
+    batch.assign(t, x);
+
+    // reference: detrend first, then transform
+    Eigen::MatrixXd phi(2, M);
+    phi.row(0) = Eigen::RowVectorXd::Ones(M);
+    phi.row(1) = t.transpose();
+    Eigen::VectorXd w = (phi * phi.transpose() + 1e-3 * Eigen::Matrix2d::Identity()).ldlt().solve(phi * x);
+    Eigen::VectorXd detrended = x - phi.transpose() * w;
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> expected = math_tools::compute_spectrum(detrended, N);
+
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> result = streamed.spectrum();
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> batch_result = batch.spectrum();
+
+    ASSERT_EQ(result.first.size(), expected.first.size());
+    ASSERT_EQ(batch_result.first.size(), expected.first.size());
+    for (int i = 0; i < expected.first.size(); ++i)
+    {
+        EXPECT_NEAR(result.first(i), expected.first(i), 1e-6 * expected.first.maxCoeff());
+        EXPECT_NEAR(batch_result.first(i), expected.first(i), 1e-6 * expected.first.maxCoeff());
+        EXPECT_DOUBLE_EQ(result.second(i), expected.second(i));
+    }
+}
+
+TEST(MathToolsTest, StreamingSpectrumWindowTest)
+{
+    int N = 256;
+    int M = 150;
+    int W = 100;
+    Eigen::VectorXd t = 5.0 * Eigen::VectorXd::LinSpaced(M, 0, M - 1).array() + 2.5;
+    Eigen::VectorXd x = (2 * M_PI * t.array() / 80.0).sin() + 0.02 * t.array() + 3.0;
+
+    // a window of W samples slides over the data
+    math_tools::StreamingSpectrum window(N);
+    window.assign(t.head(W), x.head(W));
+    for (int i = W; i < M; ++i)
+    {
+        window.remove_first(t(i - W), x(i - W));
+        window.add(t(i), x(i));
+    }
+    math_tools::StreamingSpectrum batch(N);
+    batch.assign(t.tail(W), x.tail(W));
+
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> result = window.spectrum();
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> expected = batch.spectrum();
+
+    ASSERT_EQ(window.size(), W);
+    ASSERT_EQ(result.first.size(), expected.first.size());
+    for (int i = 0; i < expected.first.size(); ++i)
+    {
+        EXPECT_NEAR(result.first(i), expected.first(i), 1e-6 * expected.first.maxCoeff());
+        EXPECT_DOUBLE_EQ(result.second(i), expected.second(i));
+    }
+}
+
+TEST(MathToolsTest, CholeskyUpdateTest)
+{
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(6, 6);
+    Eigen::MatrixXd K = A * A.transpose() + Eigen::MatrixXd::Identity(6, 6);
+
+    // build the factor of K one row and column at a time
+    Eigen::MatrixXd L(0, 0);
+    for (int i = 0; i < 6; ++i)
+    {
+        ASSERT_TRUE(math_tools::cholesky_append(L, K.block(0, i, i, 1), K(i, i)));
+    }
+    Eigen::MatrixXd expected = K.llt().matrixL();
+    EXPECT_TRUE(L.isApprox(expected, 1e-10));
+
+    // remove a point from the middle
+    math_tools::cholesky_remove(L, 2);
+    Eigen::MatrixXd K_removed(5, 5);
+    K_removed << K.block(0, 0, 2, 2), K.block(0, 3, 2, 3),
+                 K.block(3, 0, 3, 2), K.block(3, 3, 3, 3);
+    expected = K_removed.llt().matrixL();
+    EXPECT_TRUE(L.isApprox(expected, 1e-10));
+
+    // a matrix that is not positive definite is rejected
+    EXPECT_FALSE(math_tools::cholesky_append(L, K_removed.col(0), 0.0));
+    EXPECT_EQ(L.rows(), 5);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,320 @@
+/*
+ *  optimize_parameters.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Tunes the parameters of the GP guider on a set of performance datasets,
+ * the native replacement of tools/optimize_params.py.
+ *
+ * usage: GuideParameterOptimizer [-j threads] [-n evaluations] [-p population] [-s seed]
+ *                                [-b name=low:high ...] dataset... | @listfile
+ *
+ * Every candidate is scored by the improvement over Hysteresis on each
+ * dataset, as computed by GuidePerformanceEval. The datasets are read once
+ * and shared by all threads; each evaluation runs its own guider. Like the
+ * Python script, the score is the worst improvement if any dataset gets
+ * worse and the mean improvement otherwise, so that the result does not
+ * degrade guiding for anyone. The search is a CMA-ES in the log of the
+ * parameters; -b sets the range of a parameter, a range of zero width fixes
+ * it. The best settings are written to stdout.
+ */
+
+#include "gaussian_process_guider.h"
+#include "guide_performance_tools.h"
+#include "parameter_optimizer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+struct OptParameter
+{
+    const char *name;
+    double value; // default, used as the starting point of the search
+    double low;
+    double high;
+};
+
+// in the order of the command line of GuidePerformanceEval
+static OptParameter Parameters[] = {
+    { "control_gain", 0.7, 0.4, 1.0 },
+    { "min_periods_for_inference", 2.0, 2.0, 2.0 },
+    { "min_move", 0.2, 0.2, 0.2 },
+    { "SE0KLengthScale", 700.0, 200.0, 3000.0 },
+    { "SE0KSignalVariance", 20.0, 5.0, 100.0 },
+    { "PKLengthScale", 10.0, 3.0, 30.0 },
+    { "PKPeriodLength", 200.0, 200.0, 200.0 },
+    { "PKSignalVariance", 20.0, 5.0, 100.0 },
+    { "SE1KLengthScale", 25.0, 5.0, 100.0 },
+    { "SE1KSignalVariance", 10.0, 1.0, 50.0 },
+    { "min_periods_for_period_estimation", 2.0, 2.0, 2.0 },
+    { "points_for_approximation", 100.0, 100.0, 100.0 },
+    { "prediction_gain", 0.5, 0.2, 1.0 },
+};
+
+static const int NumOptParameters = sizeof(Parameters) / sizeof(Parameters[0]);
+
+struct Dataset
+{
+    std::string filename;
+    Eigen::ArrayXXd data;
+    double exposure;
+};
+
+static void usage()
+{
+    std::cerr << "usage: GuideParameterOptimizer [-j threads] [-n evaluations] [-p population] [-s seed]" << std::endl;
+    std::cerr << "                               [-b name=low:high ...] dataset... | @listfile" << std::endl;
+    std::cerr << "parameters (default low:high):" << std::endl;
+    for (const OptParameter& p : Parameters)
+        std::cerr << "  " << p.name << " " << p.value << " " << p.low << ":" << p.high << std::endl;
+}
+
+static bool set_bounds(const std::string& arg)
+{
+    size_t eq = arg.find('=');
+    size_t colon = arg.find(':', eq);
+    if (eq == std::string::npos || colon == std::string::npos)
+        return false;
+
+    std::string name = arg.substr(0, eq);
+    for (OptParameter& p : Parameters)
+    {
+        if (name == p.name)
+        {
+            p.low = std::atof(arg.substr(eq + 1, colon - eq - 1).c_str());
+            p.high = std::atof(arg.substr(colon + 1).c_str());
+            if (p.low <= 0.0 || p.high < p.low)
+                return false;
+            p.value = std::min(std::max(p.value, p.low), p.high);
+            return true;
+        }
+    }
+    return false;
+}
+
+static GaussianProcessGuider::guide_parameters make_parameters(const std::vector<double>& v)
+{
+    GaussianProcessGuider::guide_parameters parameters;
+    parameters.control_gain_ = v[0];
+    parameters.min_periods_for_inference_ = v[1];
+    parameters.min_move_ = v[2];
+    parameters.SE0KLengthScale_ = v[3];
+    parameters.SE0KSignalVariance_ = v[4];
+    parameters.PKLengthScale_ = v[5];
+    parameters.PKPeriodLength_ = v[6];
+    parameters.PKSignalVariance_ = v[7];
+    parameters.SE1KLengthScale_ = v[8];
+    parameters.SE1KSignalVariance_ = v[9];
+    parameters.min_periods_for_period_estimation_ = v[10];
+    parameters.points_for_approximation_ = static_cast<int>(std::floor(v[11]));
+    parameters.prediction_gain_ = v[12];
+    parameters.compute_period_ = true;
+    return parameters;
+}
+
+// maps a point of the unit box of the free parameters to parameter values, in log space
+static std::vector<double> to_values(const Eigen::VectorXd& u, const std::vector<int>& free)
+{
+    std::vector<double> v(NumOptParameters);
+    for (int i = 0; i < NumOptParameters; i++)
+        v[i] = Parameters[i].value;
+    for (size_t k = 0; k < free.size(); k++)
+    {
+        const OptParameter& p = Parameters[free[k]];
+        v[free[k]] = std::exp(std::log(p.low) + u(k) * (std::log(p.high) - std::log(p.low)));
+    }
+    return v;
+}
+
+static double combined_score(const std::vector<double>& improvements)
+{
+    double worst = *std::min_element(improvements.begin(), improvements.end());
+    if (std::isnan(worst) || worst < 0.0)
+        return worst; // make sure we pass regression tests
+    return std::accumulate(improvements.begin(), improvements.end(), 0.0) / improvements.size();
+}
+
+// scores all candidates on all datasets, one thread task per pair
+static std::vector<double> evaluate(const std::vector<std::vector<double>>& candidates,
+                                    const std::vector<Dataset>& datasets, unsigned int nthreads)
+{
+    std::vector<double> improvements(candidates.size() * datasets.size());
+
+    parallel_for(improvements.size(), nthreads, [&](size_t task) {
+        const std::vector<double>& values = candidates[task / datasets.size()];
+        const Dataset& dataset = datasets[task % datasets.size()];
+
+        GaussianProcessGuider GPG(make_parameters(values));
+        improvements[task] = calculate_improvement(dataset.data, dataset.exposure, GAHysteresis(), &GPG);
+    });
+
+    std::vector<double> scores(candidates.size());
+    for (size_t c = 0; c < candidates.size(); c++)
+    {
+        std::vector<double> per_dataset(improvements.begin() + c * datasets.size(),
+                                        improvements.begin() + (c + 1) * datasets.size());
+        scores[c] = combined_score(per_dataset);
+    }
+    return scores;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int nthreads = 0;
+    int max_evaluations = 200;
+    int population = 0;
+    unsigned int seed = 1;
+    std::vector<std::string> filenames;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-j" && i + 1 < argc)
+            nthreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if (arg == "-n" && i + 1 < argc)
+            max_evaluations = std::atoi(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc)
+            population = std::atoi(argv[++i]);
+        else if (arg == "-s" && i + 1 < argc)
+            seed = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if (arg == "-b" && i + 1 < argc)
+        {
+            if (!set_bounds(argv[++i]))
+            {
+                std::cerr << "invalid bounds " << argv[i] << std::endl;
+                return -1;
+            }
+        }
+        else if (arg[0] == '@')
+        {
+            if (!read_file_list(arg.substr(1), &filenames))
+            {
+                std::cerr << "cannot read " << arg.substr(1) << std::endl;
+                return -1;
+            }
+        }
+        else if (arg[0] == '-')
+        {
+            usage();
+            return -1;
+        }
+        else
+            filenames.push_back(arg);
+    }
+
+    if (filenames.empty())
+    {
+        usage();
+        return -1;
+    }
+
+    std::vector<Dataset> datasets(filenames.size());
+    parallel_for(datasets.size(), nthreads, [&](size_t i) {
+        datasets[i].filename = filenames[i];
+        datasets[i].data = read_data_from_file(filenames[i]);
+        datasets[i].exposure = get_exposure_from_file(filenames[i]);
+    });
+    for (const Dataset& d : datasets)
+    {
+        if (d.data.cols() < 3)
+        {
+            std::cerr << "no guiding data in " << d.filename << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<int> free;
+    Eigen::VectorXd start(NumOptParameters);
+    for (int i = 0; i < NumOptParameters; i++)
+    {
+        const OptParameter& p = Parameters[i];
+        if (p.high > p.low)
+        {
+            start(free.size()) = (std::log(p.value) - std::log(p.low)) / (std::log(p.high) - std::log(p.low));
+            free.push_back(i);
+        }
+    }
+    start.conservativeResize(free.size());
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    // the current settings are the reference
+    std::vector<double> best_values = to_values(start, free);
+    double best_score = evaluate({ best_values }, datasets, nthreads)[0];
+    std::cerr << "default settings: score " << best_score << std::endl;
+    int evaluations = 1;
+
+    if (!free.empty())
+    {
+        CMAESOptimizer optimizer(start, 0.3, population, seed);
+
+        while (evaluations + optimizer.Population() <= max_evaluations)
+        {
+            const std::vector<Eigen::VectorXd>& candidates = optimizer.Ask();
+            std::vector<std::vector<double>> values;
+            for (const Eigen::VectorXd& u : candidates)
+                values.push_back(to_values(u, free));
+
+            std::vector<double> scores = evaluate(values, datasets, nthreads);
+            optimizer.Tell(scores);
+            evaluations += static_cast<int>(candidates.size());
+
+            if (optimizer.BestScore() > best_score)
+            {
+                best_score = optimizer.BestScore();
+                best_values = to_values(optimizer.Best(), free);
+            }
+
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cerr << "generation " << optimizer.Generation() << ": best score " << best_score << ", step size "
+                      << optimizer.Sigma() << ", " << evaluations << " evaluations in " << secs << " s" << std::endl;
+        }
+    }
+
+    std::cout << "score = " << best_score << std::endl;
+    for (int i = 0; i < NumOptParameters; i++)
+        std::cout << Parameters[i].name << " = " << best_values[i] << std::endl;
+
+    // the arguments for GuidePerformanceEval and tools/optimize_params.py
+    char buf[32];
+    std::string args;
+    for (int i = 0; i < NumOptParameters; i++)
+    {
+        snprintf(buf, sizeof(buf), "%s%.2f", i ? " " : "", best_values[i]);
+        args += buf;
+    }
+    std::cout << "parameters: " << args << std::endl;
+
+    return 0;
+}
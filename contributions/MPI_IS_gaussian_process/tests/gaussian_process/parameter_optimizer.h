@@ -0,0 +1,213 @@
+/*
+ *  parameter_optimizer.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PARAMETER_OPTIMIZER_H_INCLUDED
+#define PARAMETER_OPTIMIZER_H_INCLUDED
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Black-box optimization of guide algorithm parameters.
+ *
+ * CMAESOptimizer is a covariance matrix adaptation evolution strategy
+ * (Hansen, "The CMA Evolution Strategy: A Tutorial") that maximizes a score
+ * in the unit box. Each generation is handed out as a whole by Ask() and
+ * scored by the caller, so the expensive evaluations can run in parallel;
+ * Tell() then adapts the search distribution. Candidates are clipped to the
+ * box, which is all the boundary handling the few, smooth parameters of the
+ * guide algorithms need.
+ */
+class CMAESOptimizer
+{
+    int m_dim;
+    int m_lambda;
+    int m_mu;
+    Eigen::VectorXd m_weights;
+    double m_mueff;
+    double m_cc, m_cs, m_c1, m_cmu, m_damps, m_chiN;
+
+    Eigen::VectorXd m_mean;
+    double m_sigma;
+    Eigen::MatrixXd m_C;
+    Eigen::MatrixXd m_B; // eigenvectors of C
+    Eigen::VectorXd m_D; // square roots of the eigenvalues of C
+    Eigen::VectorXd m_pc;
+    Eigen::VectorXd m_ps;
+    int m_generation;
+
+    std::mt19937 m_rng;
+    std::vector<Eigen::VectorXd> m_candidates;
+
+    Eigen::VectorXd m_best;
+    double m_bestScore;
+
+public:
+    /*
+     * start is the initial mean in the unit box, sigma the initial step size
+     * relative to the box and population the number of candidates per
+     * generation (0 = the default 4 + 3 ln(dim)).
+     */
+    CMAESOptimizer(const Eigen::VectorXd& start, double sigma, int population = 0, unsigned int seed = 1)
+        : m_dim(static_cast<int>(start.size())), m_mean(start), m_sigma(sigma), m_generation(0), m_rng(seed),
+          m_best(start), m_bestScore(-std::numeric_limits<double>::infinity())
+    {
+        double n = m_dim;
+        m_lambda = population > 0 ? population : 4 + static_cast<int>(3.0 * std::log(n));
+        m_mu = m_lambda / 2;
+
+        m_weights.resize(m_mu);
+        for (int i = 0; i < m_mu; i++)
+            m_weights(i) = std::log(m_mu + 0.5) - std::log(i + 1.0);
+        m_weights /= m_weights.sum();
+        m_mueff = 1.0 / m_weights.squaredNorm();
+
+        m_cc = (4.0 + m_mueff / n) / (n + 4.0 + 2.0 * m_mueff / n);
+        m_cs = (m_mueff + 2.0) / (n + m_mueff + 5.0);
+        m_c1 = 2.0 / ((n + 1.3) * (n + 1.3) + m_mueff);
+        m_cmu = std::min(1.0 - m_c1, 2.0 * (m_mueff - 2.0 + 1.0 / m_mueff) / ((n + 2.0) * (n + 2.0) + m_mueff));
+        m_damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((m_mueff - 1.0) / (n + 1.0)) - 1.0) + m_cs;
+        m_chiN = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+        m_C = Eigen::MatrixXd::Identity(m_dim, m_dim);
+        m_B = Eigen::MatrixXd::Identity(m_dim, m_dim);
+        m_D = Eigen::VectorXd::Ones(m_dim);
+        m_pc = Eigen::VectorXd::Zero(m_dim);
+        m_ps = Eigen::VectorXd::Zero(m_dim);
+    }
+
+    int Population() const { return m_lambda; }
+    int Generation() const { return m_generation; }
+    double Sigma() const { return m_sigma; }
+    const Eigen::VectorXd& Mean() const { return m_mean; }
+    const Eigen::VectorXd& Best() const { return m_best; }
+    double BestScore() const { return m_bestScore; }
+
+    // Samples the next generation of candidates.
+    const std::vector<Eigen::VectorXd>& Ask()
+    {
+        std::normal_distribution<double> normal;
+        m_candidates.assign(m_lambda, Eigen::VectorXd());
+        for (Eigen::VectorXd& x : m_candidates)
+        {
+            Eigen::VectorXd z(m_dim);
+            for (int i = 0; i < m_dim; i++)
+                z(i) = normal(m_rng);
+            x = (m_mean + m_sigma * m_B * m_D.cwiseProduct(z)).cwiseMax(0.0).cwiseMin(1.0);
+        }
+        return m_candidates;
+    }
+
+    // Adapts the distribution to the scores of the candidates of the last Ask(), higher is better.
+    void Tell(const std::vector<double>& scores)
+    {
+        std::vector<int> order(m_lambda);
+        std::iota(order.begin(), order.end(), 0);
+        // failed evaluations (NaN) rank last
+        auto key = [&](int i) { return std::isnan(scores[i]) ? -std::numeric_limits<double>::infinity() : scores[i]; };
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return key(a) > key(b); });
+
+        if (key(order[0]) > m_bestScore)
+        {
+            m_bestScore = key(order[0]);
+            m_best = m_candidates[order[0]];
+        }
+
+        Eigen::VectorXd old_mean = m_mean;
+        m_mean.setZero();
+        for (int i = 0; i < m_mu; i++)
+            m_mean += m_weights(i) * m_candidates[order[i]];
+        Eigen::VectorXd step = (m_mean - old_mean) / m_sigma;
+
+        // C^-1/2 * step
+        Eigen::VectorXd white = m_B * (m_B.transpose() * step).cwiseQuotient(m_D);
+        m_ps = (1.0 - m_cs) * m_ps + std::sqrt(m_cs * (2.0 - m_cs) * m_mueff) * white;
+
+        ++m_generation;
+        bool hsig = m_ps.norm() / std::sqrt(1.0 - std::pow(1.0 - m_cs, 2.0 * m_generation)) / m_chiN <
+            1.4 + 2.0 / (m_dim + 1.0);
+        m_pc = (1.0 - m_cc) * m_pc + (hsig ? std::sqrt(m_cc * (2.0 - m_cc) * m_mueff) : 0.0) * step;
+
+        Eigen::MatrixXd rank_mu = Eigen::MatrixXd::Zero(m_dim, m_dim);
+        for (int i = 0; i < m_mu; i++)
+        {
+            Eigen::VectorXd y = (m_candidates[order[i]] - old_mean) / m_sigma;
+            rank_mu += m_weights(i) * y * y.transpose();
+        }
+        m_C = (1.0 - m_c1 - m_cmu) * m_C +
+            m_c1 * (m_pc * m_pc.transpose() + (hsig ? 0.0 : m_cc * (2.0 - m_cc)) * m_C) + m_cmu * rank_mu;
+
+        m_sigma *= std::exp(m_cs / m_damps * (m_ps.norm() / m_chiN - 1.0));
+        m_sigma = std::min(m_sigma, 1.0); // larger steps than the box are pointless
+
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(m_C);
+        m_B = eig.eigenvectors();
+        m_D = eig.eigenvalues().cwiseMax(1e-20).cwiseSqrt();
+    }
+};
+
+/*
+ * Runs task(i) for i = 0 .. count-1 on nthreads threads (0 = one per core).
+ */
+template<typename Task>
+inline void parallel_for(size_t count, unsigned int nthreads, Task task)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < count)
+            task(i);
+    };
+
+    if (nthreads == 0)
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    nthreads = static_cast<unsigned int>(std::min<size_t>(nthreads, std::max<size_t>(count, 1)));
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < nthreads; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+}
+
+#endif // PARAMETER_OPTIMIZER_H_INCLUDED
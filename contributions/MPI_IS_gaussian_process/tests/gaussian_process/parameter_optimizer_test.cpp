@@ -0,0 +1,104 @@
+/*
+ *  parameter_optimizer_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+#include "parameter_optimizer.h"
+
+// a smooth test function with its maximum of zero at the given point
+static double score(const Eigen::VectorXd& x, const Eigen::VectorXd& optimum)
+{
+    Eigen::VectorXd d = x - optimum;
+    return -d.squaredNorm() - 0.5 * d(0) * d(1);
+}
+
+TEST(ParameterOptimizerTest, cmaes_finds_maximum)
+{
+    Eigen::VectorXd optimum(4);
+    optimum << 0.2, 0.7, 0.45, 0.9;
+
+    CMAESOptimizer optimizer(Eigen::VectorXd::Constant(4, 0.5), 0.3, 0, 42);
+    EXPECT_EQ(optimizer.Population(), 8);
+
+    for (int generation = 0; generation < 100; generation++)
+    {
+        const std::vector<Eigen::VectorXd>& candidates = optimizer.Ask();
+        std::vector<double> scores;
+        for (const Eigen::VectorXd& x : candidates)
+        {
+            EXPECT_GE(x.minCoeff(), 0.0);
+            EXPECT_LE(x.maxCoeff(), 1.0);
+            scores.push_back(score(x, optimum));
+        }
+        optimizer.Tell(scores);
+    }
+
+    EXPECT_LT((optimizer.Best() - optimum).norm(), 1e-3);
+    EXPECT_LT((optimizer.Mean() - optimum).norm(), 1e-3);
+    EXPECT_GT(optimizer.BestScore(), -1e-6);
+}
+
+TEST(ParameterOptimizerTest, cmaes_stays_in_box)
+{
+    // the maximum lies outside of the box, the search has to end on its boundary
+    Eigen::VectorXd optimum(2);
+    optimum << 1.5, 0.3;
+
+    CMAESOptimizer optimizer(Eigen::VectorXd::Constant(2, 0.5), 0.3, 0, 7);
+    for (int generation = 0; generation < 80; generation++)
+    {
+        const std::vector<Eigen::VectorXd>& candidates = optimizer.Ask();
+        std::vector<double> scores;
+        for (const Eigen::VectorXd& x : candidates)
+            scores.push_back(-(x - optimum).squaredNorm());
+        optimizer.Tell(scores);
+    }
+
+    EXPECT_NEAR(optimizer.Best()(0), 1.0, 1e-6);
+    EXPECT_NEAR(optimizer.Best()(1), 0.3, 1e-2);
+}
+
+TEST(ParameterOptimizerTest, parallel_for_runs_every_task_once)
+{
+    std::vector<int> counts(1000, 0);
+    parallel_for(counts.size(), 4, [&](size_t i) { counts[i]++; });
+
+    for (int count : counts)
+        EXPECT_EQ(count, 1);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,636 @@
+/*
+ *  phd_stub.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PHD_STUB_H_INCLUDED
+#define PHD_STUB_H_INCLUDED
+
+/*
+ * Minimal stand-in for src/phd.h that lets the unit tests compile and link
+ * the real guide algorithm sources (src/guide_algorithm*.cpp,
+ * src/guiding_stats.cpp, src/zfilterfactory.cpp) without wxWidgets.
+ *
+ * The sources include "phd.h" from their own directory, so this header is
+ * force-included ahead of them and claims the include guard of the real one.
+ *
+ * Only what those files touch is provided: a std::string based wxString,
+ * an in-memory profile for pConfig, a mount whose class name selects the
+ * config path, and inert controls for the config and graph panes, which
+ * the tests never create.
+ *
+ * The AO fast loop (src/ao_fastloop.cpp, src/pipeline_stats.cpp) also gets
+ * threads and locks on top of the standard library, and a frame that keeps
+ * the events queued to it. The POSIX serial port (src/serialport.cpp,
+ * src/serialport_posix.cpp) only needs the transfer history's clock, and the
+ * ROI manager (src/roi_manager.cpp) gets rectangles with the semantics of wxRect.
+ */
+
+#define PHD_H_INCLUDED
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef M_PI
+# define M_PI 3.14159265358979323846
+#endif
+
+class wxString : public std::string
+{
+    static const char *FormatArg(const wxString& s) { return s.c_str(); }
+    template<typename T>
+    static T FormatArg(T val) { return val; }
+
+public:
+    wxString() { }
+    wxString(const char *s) : std::string(s) { }
+    wxString(const std::string& s) : std::string(s) { }
+
+    const char *mb_str() const { return c_str(); }
+
+    template<typename... Args>
+    static wxString Format(const wxString& fmt, Args... args)
+    {
+        char buf[1024];
+        snprintf(buf, sizeof(buf), fmt.c_str(), FormatArg(args)...);
+        return wxString(buf);
+    }
+
+    wxString& Append(const wxString& s)
+    {
+        append(s);
+        return *this;
+    }
+};
+
+class wxArrayString : public std::vector<wxString>
+{
+public:
+    void Add(const wxString& s) { push_back(s); }
+};
+
+class ArrayOfDbl : public std::vector<double>
+{
+public:
+    size_t GetCount() const { return size(); }
+    void Add(double val) { push_back(val); }
+    void RemoveAt(size_t i) { erase(begin() + i); }
+    void Empty() { clear(); }
+};
+
+#define wxEmptyString wxString()
+#define _(s) wxString(s)
+#define _T(s) s
+#define wxT(s) s
+#define wxMin(a, b) ((a) < (b) ? (a) : (b))
+#define wxMax(a, b) ((a) > (b) ? (a) : (b))
+#define WXUNUSED(x)
+
+#define POSSIBLY_UNUSED(x) (void) (x)
+#define ERROR_INFO(s) (Debug.AddLine(wxString(s)))
+#define THROW_INFO(s) (Debug.AddLine(wxString(s)))
+
+typedef int wxWindowID;
+enum
+{
+    wxID_ANY = -1,
+    wxSP_ARROW_KEYS = 0x1000,
+    wxALIGN_RIGHT = 0x0200,
+};
+
+struct wxPoint
+{
+    wxPoint(int, int) { }
+};
+struct wxSize
+{
+    int x, y;
+
+    wxSize(int w, int h) : x(w), y(h) { }
+    int GetWidth() const { return x; }
+    int GetHeight() const { return y; }
+};
+
+// the rectangle operations of wxRect used by the ROI manager, with the same
+// inclusive right and bottom edges
+struct wxRect
+{
+    int x, y, width, height;
+
+    wxRect() : x(0), y(0), width(0), height(0) { }
+    wxRect(int x_, int y_, int w, int h) : x(x_), y(y_), width(w), height(h) { }
+    explicit wxRect(const wxSize& size) : x(0), y(0), width(size.x), height(size.y) { }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetRight() const { return x + width - 1; }
+    int GetBottom() const { return y + height - 1; }
+    bool IsEmpty() const { return width <= 0 || height <= 0; }
+
+    bool Contains(const wxRect& r) const
+    {
+        return r.x >= x && r.y >= y && r.GetRight() <= GetRight() && r.GetBottom() <= GetBottom();
+    }
+
+    wxRect& Inflate(int d)
+    {
+        x -= d;
+        y -= d;
+        width += 2 * d;
+        height += 2 * d;
+        return *this;
+    }
+
+    wxRect& Intersect(const wxRect& r)
+    {
+        int x2 = std::min(GetRight(), r.GetRight());
+        int y2 = std::min(GetBottom(), r.GetBottom());
+        x = std::max(x, r.x);
+        y = std::max(y, r.y);
+        width = x2 - x + 1;
+        height = y2 - y + 1;
+        if (width <= 0 || height <= 0)
+            *this = wxRect();
+        return *this;
+    }
+
+    wxRect Union(const wxRect& r) const
+    {
+        if (IsEmpty())
+            return r;
+        if (r.IsEmpty())
+            return *this;
+        int x1 = std::min(x, r.x);
+        int y1 = std::min(y, r.y);
+        return wxRect(x1, y1, std::max(GetRight(), r.GetRight()) - x1 + 1, std::max(GetBottom(), r.GetBottom()) - y1 + 1);
+    }
+
+    bool operator==(const wxRect& r) const { return x == r.x && y == r.y && width == r.width && height == r.height; }
+    bool operator!=(const wxRect& r) const { return !(*this == r); }
+};
+static const wxPoint wxDefaultPosition(-1, -1);
+
+struct wxSpinEvent { };
+struct wxSpinDoubleEvent { };
+enum wxEventType
+{
+    wxEVT_COMMAND_SPINCTRL_UPDATED,
+    wxEVT_COMMAND_SPINCTRLDOUBLE_UPDATED,
+};
+
+class wxWindow
+{
+public:
+    virtual ~wxWindow() { }
+    void Enable(bool) { }
+    void SetToolTip(const wxString&) { }
+    template<typename Method, typename Handler>
+    void Bind(wxEventType, Method, Handler) { }
+};
+
+class wxSpinCtrl : public wxWindow
+{
+    int m_value = 0;
+
+public:
+    int GetValue() const { return m_value; }
+    void SetValue(int val) { m_value = val; }
+};
+
+class wxSpinCtrlDouble : public wxWindow
+{
+    double m_value = 0.0;
+
+public:
+    double GetValue() const { return m_value; }
+    void SetValue(double val) { m_value = val; }
+    void SetDigits(int) { }
+};
+
+class wxCheckBox : public wxWindow
+{
+    bool m_value = false;
+
+public:
+    wxCheckBox(wxWindow *, wxWindowID, const wxString&) { }
+    bool GetValue() const { return m_value; }
+    void SetValue(bool val) { m_value = val; }
+};
+
+class ConfigDialogPane
+{
+protected:
+    wxWindow *m_pParent;
+
+public:
+    ConfigDialogPane(const wxString&, wxWindow *pParent) : m_pParent(pParent) { }
+    virtual ~ConfigDialogPane() { }
+
+    virtual void LoadValues() = 0;
+    virtual void UnloadValues() = 0;
+    virtual void OnImageScaleChange() { }
+    virtual void EnableDecControls(bool) { }
+
+protected:
+    void DoAdd(wxWindow *) { }
+    void DoAdd(wxWindow *, const wxString&) { }
+    void DoAdd(const wxString&, wxWindow *, const wxString&) { }
+    int StringWidth(const wxString& s) { return static_cast<int>(s.size()) * 8; }
+};
+
+class GraphControlPane : public wxWindow
+{
+public:
+    GraphControlPane(wxWindow *, const wxString&) { }
+    virtual void EnableDecControls(bool) { }
+
+protected:
+    void DoAdd(wxWindow *, const wxString&) { }
+    int StringWidth(const wxString& s) { return static_cast<int>(s.size()) * 8; }
+};
+
+class wxCriticalSection
+{
+    std::mutex m_mutex;
+
+public:
+    void Enter() { m_mutex.lock(); }
+    void Leave() { m_mutex.unlock(); }
+};
+
+class wxCriticalSectionLocker
+{
+    wxCriticalSection& m_cs;
+
+public:
+    explicit wxCriticalSectionLocker(wxCriticalSection& cs) : m_cs(cs) { m_cs.Enter(); }
+    ~wxCriticalSectionLocker() { m_cs.Leave(); }
+};
+
+class wxMutex
+{
+    friend class wxCondition;
+    std::mutex m_mutex;
+
+public:
+    void Lock() { m_mutex.lock(); }
+    void Unlock() { m_mutex.unlock(); }
+};
+
+class wxMutexLocker
+{
+    wxMutex& m_mutex;
+
+public:
+    explicit wxMutexLocker(wxMutex& mutex) : m_mutex(mutex) { m_mutex.Lock(); }
+    ~wxMutexLocker() { m_mutex.Unlock(); }
+};
+
+// the mutex has to be locked by the caller, like for wxCondition
+class wxCondition
+{
+    wxMutex& m_mutex;
+    std::condition_variable_any m_cond;
+
+public:
+    explicit wxCondition(wxMutex& mutex) : m_mutex(mutex) { }
+    void Wait() { m_cond.wait(m_mutex.m_mutex); }
+    void WaitTimeout(unsigned long ms) { m_cond.wait_for(m_mutex.m_mutex, std::chrono::milliseconds(ms)); }
+    void Signal() { m_cond.notify_one(); }
+    void Broadcast() { m_cond.notify_all(); }
+};
+
+class wxStopWatch
+{
+    std::chrono::steady_clock::time_point m_start;
+
+public:
+    wxStopWatch() : m_start(std::chrono::steady_clock::now()) { }
+    long Time() const
+    {
+        return static_cast<long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count());
+    }
+};
+
+enum wxThreadKind
+{
+    wxTHREAD_DETACHED,
+    wxTHREAD_JOINABLE,
+};
+
+enum wxThreadError
+{
+    wxTHREAD_NO_ERROR,
+    wxTHREAD_RUNNING,
+};
+
+// only joinable threads, which is all the fast loop uses
+class wxThread
+{
+public:
+    typedef void *ExitCode;
+
+private:
+    std::thread m_thread;
+    ExitCode m_exitCode;
+
+protected:
+    virtual ExitCode Entry() = 0;
+
+public:
+    explicit wxThread(wxThreadKind) : m_exitCode(nullptr) { }
+    virtual ~wxThread() { assert(!m_thread.joinable() && "the thread must be waited for"); }
+
+    wxThreadError Run()
+    {
+        if (m_thread.joinable())
+            return wxTHREAD_RUNNING;
+        m_thread = std::thread([this] { m_exitCode = Entry(); });
+        return wxTHREAD_NO_ERROR;
+    }
+
+    ExitCode Wait()
+    {
+        if (m_thread.joinable())
+            m_thread.join();
+        return m_exitCode;
+    }
+};
+
+class wxThreadEvent
+{
+public:
+    virtual ~wxThreadEvent() { }
+};
+
+// enough for the serial transfer history (src/serialport.cpp) and src/point.h
+typedef long long wxLongLong_t;
+
+class wxLongLong
+{
+    wxLongLong_t m_value;
+
+public:
+    wxLongLong(wxLongLong_t value = 0) : m_value(value) { }
+    wxLongLong_t GetValue() const { return m_value; }
+};
+
+inline wxLongLong wxGetUTCTimeMillis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+class wxDateTime
+{
+    wxLongLong m_ms;
+
+public:
+    explicit wxDateTime(wxLongLong ms) : m_ms(ms) { }
+    wxString Format(const char *) const { return wxString::Format("%lld", m_ms.GetValue()); }
+};
+
+class DebugLog
+{
+public:
+    wxString AddLine(const wxString& str) { return str; }
+    wxString Write(const wxString& str) { return str; }
+    void AddBytes(const wxString&, const unsigned char *, unsigned) { }
+};
+extern DebugLog Debug;
+
+/*
+ * In-memory profile; the algorithms read their parameters in the
+ * constructor and write them back from the setters, possibly from several
+ * replay threads at once.
+ */
+class PhdProfile
+{
+    std::mutex m_lock;
+    std::map<std::string, double> m_values;
+
+    double Get(const wxString& name, double defaultValue)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto it = m_values.find(name);
+        return it == m_values.end() ? defaultValue : it->second;
+    }
+    void Set(const wxString& name, double value)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_values[name] = value;
+    }
+
+public:
+    double GetDouble(const wxString& name, double defaultValue) { return Get(name, defaultValue); }
+    int GetInt(const wxString& name, int defaultValue) { return static_cast<int>(Get(name, defaultValue)); }
+    bool GetBoolean(const wxString& name, bool defaultValue) { return Get(name, defaultValue) != 0.0; }
+    void SetDouble(const wxString& name, double value) { Set(name, value); }
+    void SetInt(const wxString& name, int value) { Set(name, value); }
+    void SetBoolean(const wxString& name, bool value) { Set(name, value); }
+    void DeleteGroup(const wxString& group)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto it = m_values.begin(); it != m_values.end();)
+            it = it->first.compare(0, group.size(), group) == 0 ? m_values.erase(it) : std::next(it);
+    }
+};
+
+struct PhdConfig
+{
+    PhdProfile Profile;
+};
+extern PhdConfig *pConfig;
+
+enum GUIDE_ALGORITHM
+{
+    GUIDE_ALGORITHM_NONE = -1,
+    GUIDE_ALGORITHM_IDENTITY,
+    GUIDE_ALGORITHM_HYSTERESIS,
+    GUIDE_ALGORITHM_LOWPASS,
+    GUIDE_ALGORITHM_LOWPASS2,
+    GUIDE_ALGORITHM_RESIST_SWITCH,
+    GUIDE_ALGORITHM_GAUSSIAN_PROCESS,
+    GUIDE_ALGORITHM_ZFILTER,
+};
+
+enum DEC_GUIDE_MODE
+{
+    DEC_NONE = 0,
+    DEC_AUTO,
+    DEC_NORTH,
+    DEC_SOUTH
+};
+
+// the tests never look at the offsets of a move
+struct GuiderOffset
+{
+};
+
+class Mount
+{
+public:
+    enum MOVE_RESULT
+    {
+        MOVE_OK = 0, // move succeeded
+        MOVE_ERROR, // move failed for unspecified reason
+        MOVE_ERROR_SLEWING, // move failed due to scope slewing
+        MOVE_ERROR_AO_LIMIT_REACHED, // move failed due to AO limit
+    };
+
+    virtual ~Mount() { }
+    virtual wxString GetMountClassName() const { return "scope"; }
+    virtual MOVE_RESULT MoveOffset(GuiderOffset *, unsigned int) { return MOVE_OK; }
+};
+
+struct MOVE_REQUEST
+{
+    Mount *mount;
+    int duration;
+    bool axisMove;
+    unsigned int moveOptions;
+    Mount::MOVE_RESULT moveResult;
+    GuiderOffset ofs;
+};
+
+struct MoveCompleteEvent : public wxThreadEvent
+{
+    unsigned int moveOptions;
+    Mount::MOVE_RESULT result;
+    Mount *mount;
+
+    MoveCompleteEvent(const MOVE_REQUEST& move) : moveOptions(move.moveOptions), result(move.moveResult), mount(move.mount)
+    {
+    }
+};
+
+class Scope : public Mount
+{
+public:
+    DEC_GUIDE_MODE GetDecGuideMode() const { return DEC_AUTO; }
+};
+
+inline Scope *TheScope()
+{
+    return nullptr;
+}
+
+class AdvancedDialog
+{
+public:
+    int GetFocalLength() { return 0; }
+    double GetPixelSize() { return 0.0; }
+    int GetBinning() { return 1; }
+};
+
+class MyFrame
+{
+    std::mutex m_eventLock;
+    std::vector<std::unique_ptr<wxThreadEvent>> m_events; // queued events, oldest first
+
+public:
+    AdvancedDialog *pAdvancedDialog = nullptr;
+
+    void QueueEvent(wxThreadEvent *event)
+    {
+        std::lock_guard<std::mutex> lock(m_eventLock);
+        m_events.emplace_back(event);
+    }
+
+    std::vector<std::unique_ptr<wxThreadEvent>> TakeEvents()
+    {
+        std::lock_guard<std::mutex> lock(m_eventLock);
+        std::vector<std::unique_ptr<wxThreadEvent>> events;
+        events.swap(m_events);
+        return events;
+    }
+
+    int GetFocalLength() const { return 0; }
+    static double GetPixelScale(double pixelSizeMicrons, int focalLengthMm, int binning)
+    {
+        return focalLengthMm ? 206.265 * pixelSizeMicrons * binning / focalLengthMm : 1.0;
+    }
+
+    template<typename T>
+    void NotifyGuidingParam(const wxString&, T) { }
+
+    wxSpinCtrl *MakeSpinCtrl(wxWindow *, wxWindowID, const wxString&, const wxPoint&, const wxSize&, long, int, int,
+                             int, const wxString&)
+    {
+        return new wxSpinCtrl();
+    }
+    wxSpinCtrlDouble *MakeSpinCtrlDouble(wxWindow *, wxWindowID, const wxString&, const wxPoint&, const wxSize&, long,
+                                         double, double, double, double, const wxString&)
+    {
+        return new wxSpinCtrlDouble();
+    }
+};
+extern MyFrame *pFrame;
+
+inline void wxQueueEvent(MyFrame *frame, wxThreadEvent *event)
+{
+    frame->QueueEvent(event);
+}
+
+class GuideCamera
+{
+public:
+    unsigned int TotalBinning() const { return 1; }
+    double GetCameraPixelSize() const { return 0.0; }
+};
+extern GuideCamera *pCamera;
+
+#include "guiding_stats.h"
+#include "guide_algorithm.h"
+#include "guide_algorithm_hysteresis.h"
+#include "guide_algorithm_lowpass.h"
+#include "guide_algorithm_lowpass2.h"
+#include "guide_algorithm_resistswitch.h"
+#include "guide_algorithm_zfilter.h"
+#include "pipeline_stats.h"
+#include "ao_fastloop.h"
+#include "serialports.h"
+#include "point.h"
+#include "roi_manager.h"
+
+#endif // PHD_STUB_H_INCLUDED
@@ -0,0 +1,178 @@
+/*
+ *  roi_manager_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests for the readout window chosen for guide subframes, src/roi_manager.cpp.
+ */
+
+#include <gtest/gtest.h>
+#include "phd_stub.h"
+
+static const wxSize FullSize(1000, 800);
+static const int SearchRegion = 15;
+
+// the search region of a star at x,y, as GuiderMultiStar computes it
+static wxRect Region(int x, int y)
+{
+    return wxRect(x - SearchRegion, y - SearchRegion, 2 * SearchRegion + 1, 2 * SearchRegion + 1);
+}
+
+TEST(RoiManagerTest, min_slack_without_motion)
+{
+    RoiManager roi;
+    wxRect needed = Region(500, 400);
+    wxRect expected(needed);
+    expected.Inflate(RoiManager::MIN_SLACK_PX);
+
+    EXPECT_EQ(roi.Update(needed, FullSize, SearchRegion), expected);
+    EXPECT_EQ(roi.Roi(), expected);
+}
+
+TEST(RoiManagerTest, window_kept_while_stars_inside)
+{
+    RoiManager roi;
+    wxRect first = roi.Update(Region(500, 400), FullSize, SearchRegion);
+
+    // the star moves by less than the slack
+    EXPECT_EQ(roi.Update(Region(503, 397), FullSize, SearchRegion), first);
+
+    // the star's search region leaves the window, it is recomputed around the star
+    wxRect expected = Region(510, 400);
+    expected.Inflate(RoiManager::MIN_SLACK_PX);
+    EXPECT_EQ(roi.Update(Region(510, 400), FullSize, SearchRegion), expected);
+}
+
+TEST(RoiManagerTest, shrinks_when_much_larger_than_needed)
+{
+    RoiManager roi;
+
+    // a window covering two stars, then only one of them is needed
+    wxRect both = Region(500, 400).Union(Region(510, 400));
+    wxRect wide = roi.Update(both, FullSize, SearchRegion);
+
+    wxRect one = Region(500, 400);
+    ASSERT_TRUE(wide.Contains(one));
+
+    // still at least 1/SHRINK_RATIO of the window, kept
+    ASSERT_GE(one.GetWidth() * one.GetHeight() * RoiManager::SHRINK_RATIO, wide.GetWidth() * wide.GetHeight());
+    EXPECT_EQ(roi.Update(one, FullSize, SearchRegion), wide);
+
+    // less than that, recomputed
+    wxRect widest = roi.Update(Region(500, 400).Union(Region(540, 400)), FullSize, SearchRegion);
+    ASSERT_LT(one.GetWidth() * one.GetHeight() * RoiManager::SHRINK_RATIO, widest.GetWidth() * widest.GetHeight());
+    wxRect expected(one);
+    expected.Inflate(RoiManager::MIN_SLACK_PX);
+    EXPECT_EQ(roi.Update(one, FullSize, SearchRegion), expected);
+}
+
+TEST(RoiManagerTest, slack_follows_motion)
+{
+    RoiManager roi;
+    roi.AddPosition(PHD_Point(500, 400));
+    roi.AddPosition(PHD_Point(506, 400));
+    EXPECT_DOUBLE_EQ(roi.Motion(), 6.0);
+
+    // twice the motion
+    wxRect expected = Region(506, 400);
+    expected.Inflate(12);
+    EXPECT_EQ(roi.Update(Region(506, 400), FullSize, SearchRegion), expected);
+
+    // but never more than the search region
+    RoiManager fast;
+    fast.AddPosition(PHD_Point(500, 400));
+    fast.AddPosition(PHD_Point(530, 400));
+    expected = Region(530, 400);
+    expected.Inflate(SearchRegion);
+    EXPECT_EQ(fast.Update(Region(530, 400), FullSize, SearchRegion), expected);
+}
+
+TEST(RoiManagerTest, motion_decays)
+{
+    RoiManager roi;
+    roi.AddPosition(PHD_Point(500, 400));
+    roi.AddPosition(PHD_Point(510, 400));
+    ASSERT_DOUBLE_EQ(roi.Motion(), 10.0);
+
+    // a still star lets the peak decay
+    double expected = 10.0;
+    for (int i = 0; i < 20; i++)
+    {
+        roi.AddPosition(PHD_Point(510, 400));
+        expected *= RoiManager::MOTION_DECAY;
+        EXPECT_NEAR(roi.Motion(), expected, 1e-9);
+    }
+
+    // larger motion replaces the decayed peak at once
+    roi.AddPosition(PHD_Point(513, 404));
+    EXPECT_DOUBLE_EQ(roi.Motion(), 5.0);
+
+    // slack is back at the minimum once the motion has decayed below half of it
+    for (int i = 0; i < 100 && roi.Motion() * 2 > RoiManager::MIN_SLACK_PX; i++)
+        roi.AddPosition(PHD_Point(513, 404));
+    ASSERT_LE(roi.Motion() * 2, RoiManager::MIN_SLACK_PX);
+    wxRect region = Region(513, 404);
+    wxRect min(region);
+    min.Inflate(RoiManager::MIN_SLACK_PX);
+    EXPECT_EQ(roi.Update(region, FullSize, SearchRegion), min);
+
+    roi.Reset();
+    EXPECT_EQ(roi.Motion(), 0.0);
+    EXPECT_TRUE(roi.Roi().IsEmpty());
+}
+
+TEST(RoiManagerTest, clamped_to_frame)
+{
+    RoiManager roi;
+
+    // GuiderMultiStar clips the search region to the frame before asking for a window
+    wxRect corner = Region(10, 5);
+    corner.Intersect(wxRect(FullSize));
+    EXPECT_EQ(roi.Update(corner, FullSize, SearchRegion), wxRect(0, 0, 10 + SearchRegion + 1 + RoiManager::MIN_SLACK_PX,
+                                                                  5 + SearchRegion + 1 + RoiManager::MIN_SLACK_PX));
+
+    wxRect far = Region(995, 798);
+    far.Intersect(wxRect(FullSize));
+    wxRect result = roi.Update(far, FullSize, SearchRegion);
+    EXPECT_EQ(result.GetRight(), FullSize.GetWidth() - 1);
+    EXPECT_EQ(result.GetBottom(), FullSize.GetHeight() - 1);
+    EXPECT_EQ(result.x, 995 - SearchRegion - RoiManager::MIN_SLACK_PX);
+    EXPECT_EQ(result.y, 798 - SearchRegion - RoiManager::MIN_SLACK_PX);
+
+    EXPECT_EQ(RoiManager::MaxArea(FullSize), 1000 * 800 / 4);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+/*
+ *  serial_port_test.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests for the deadlines of the POSIX serial port, src/serialport_posix.cpp,
+ * with the port attached to the slave side of a pseudo-terminal. Connect()
+ * itself is not used since a pty has no modem control lines.
+ */
+
+#include <gtest/gtest.h>
+#include "phd_stub.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+class PtySerialPort : public SerialPortPosix
+{
+public:
+    using SerialPortPosix::ReadAll;
+    using SerialPortPosix::WaitFd;
+
+    void Attach(int fd) { m_fd = fd; }
+};
+
+static long long NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+class SerialPortTest : public ::testing::Test
+{
+protected:
+    int m_master = -1;
+    PtySerialPort m_port;
+
+    void SetUp() override
+    {
+        m_master = posix_openpt(O_RDWR | O_NOCTTY);
+        ASSERT_GE(m_master, 0);
+        ASSERT_EQ(grantpt(m_master), 0);
+        ASSERT_EQ(unlockpt(m_master), 0);
+
+        // opened the way Connect() opens a port
+        int fd = open(ptsname(m_master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        ASSERT_GE(fd, 0);
+
+        struct termios attr;
+        ASSERT_EQ(tcgetattr(fd, &attr), 0);
+        cfmakeraw(&attr);
+        attr.c_cc[VTIME] = 0;
+        attr.c_cc[VMIN] = 0;
+        ASSERT_EQ(tcsetattr(fd, TCSANOW, &attr), 0);
+
+        m_port.Attach(fd);
+    }
+
+    void TearDown() override
+    {
+        if (m_master >= 0)
+            close(m_master);
+    }
+
+    void Reply(const char *s) { ASSERT_EQ(write(m_master, s, strlen(s)), (ssize_t) strlen(s)); }
+
+    // waits until the bytes written by the master can be read from the slave
+    void WaitDelivered() { ASSERT_FALSE(m_port.WaitFd(POLLIN, NowMs() + 1000)); }
+};
+
+// no data: the wait ends at the deadline, not earlier and not much later
+TEST_F(SerialPortTest, wait_times_out_at_deadline)
+{
+    long long start = NowMs();
+    EXPECT_TRUE(m_port.WaitFd(POLLIN, start + 100));
+    long long elapsed = NowMs() - start;
+    EXPECT_GE(elapsed, 99);
+    EXPECT_LT(elapsed, 500);
+}
+
+// a deadline that has already passed polls once without waiting
+TEST_F(SerialPortTest, past_deadline_does_not_wait)
+{
+    long long start = NowMs();
+    EXPECT_TRUE(m_port.WaitFd(POLLIN, start - 1000));
+    EXPECT_LT(NowMs() - start, 50);
+
+    Reply("x");
+    WaitDelivered();
+    EXPECT_FALSE(m_port.WaitFd(POLLIN, NowMs() - 1000));
+}
+
+// the deadline covers the whole read, a partial reply fails at the deadline
+TEST_F(SerialPortTest, partial_read_fails_at_deadline)
+{
+    Reply("V1");
+    WaitDelivered();
+
+    unsigned char buf[4];
+    long long start = NowMs();
+    EXPECT_TRUE(m_port.ReadAll(buf, sizeof(buf), start + 100));
+    long long elapsed = NowMs() - start;
+    EXPECT_GE(elapsed, 99);
+    EXPECT_LT(elapsed, 500);
+}
+
+// bytes arriving in pieces before the deadline complete the read as soon as
+// the last one arrives
+TEST_F(SerialPortTest, read_completes_before_deadline)
+{
+    std::thread writer([this] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        Reply("V1");
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        Reply("23");
+    });
+
+    unsigned char buf[4];
+    long long start = NowMs();
+    bool err = m_port.ReadAll(buf, sizeof(buf), start + 2000);
+    long long elapsed = NowMs() - start;
+    writer.join();
+
+    EXPECT_FALSE(err);
+    EXPECT_EQ(memcmp(buf, "V123", 4), 0);
+    EXPECT_LT(elapsed, 1000);
+}
+
+// Receive() uses the timeout set by SetReceiveTimeout(), which also discards
+// input that arrived before the command
+TEST_F(SerialPortTest, receive_timeout_and_flush)
+{
+    Reply("stale");
+    WaitDelivered();
+    ASSERT_FALSE(m_port.SetReceiveTimeout(100));
+
+    unsigned char ch;
+    long long start = NowMs();
+    EXPECT_TRUE(m_port.Receive(&ch, 1));
+    EXPECT_GE(NowMs() - start, 99);
+
+    Reply("K");
+    EXPECT_FALSE(m_port.Receive(&ch, 1));
+    EXPECT_EQ(ch, 'K');
+}
+
+// a hangup ends the wait at once instead of at the deadline
+TEST_F(SerialPortTest, hangup_fails_immediately)
+{
+    close(m_master);
+    m_master = -1;
+
+    unsigned char ch;
+    long long start = NowMs();
+    EXPECT_TRUE(m_port.ReadAll(&ch, 1, start + 2000));
+    EXPECT_LT(NowMs() - start, 1000);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
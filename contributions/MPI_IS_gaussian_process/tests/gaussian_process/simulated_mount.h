@@ -0,0 +1,190 @@
+/*
+ *  simulated_mount.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef SIMULATED_MOUNT_H_INCLUDED
+#define SIMULATED_MOUNT_H_INCLUDED
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+/*
+ * Deterministic random source. std::mt19937 produces the same sequence on
+ * every standard library, unlike the std:: distributions, so the normal
+ * variates are generated here with Box-Muller.
+ */
+class SimRandom
+{
+    std::mt19937 m_gen;
+    bool m_haveSpare;
+    double m_spare;
+
+public:
+    explicit SimRandom(uint32_t seed) : m_gen(seed), m_haveSpare(false), m_spare(0.0) { }
+
+    // uniform in (0, 1]
+    double Uniform()
+    {
+        return (static_cast<double>(m_gen()) + 1.0) / 4294967296.0;
+    }
+
+    // normally distributed, sigma = 1
+    double Normal()
+    {
+        if (m_haveSpare)
+        {
+            m_haveSpare = false;
+            return m_spare;
+        }
+        double a = std::sqrt(-2.0 * std::log(Uniform()));
+        double p = 2.0 * M_PI * Uniform();
+        m_spare = a * std::sin(p);
+        m_haveSpare = true;
+        return a * std::cos(p);
+    }
+};
+
+/*
+ * Tracks the Dec gear position through a backlash dead band, same model as the
+ * camera simulator (gear_simulator.cpp).
+ */
+struct SimBacklash
+{
+    double cur;
+    double upper;
+    double amount;
+
+    explicit SimBacklash(double backlash_amount) : cur(0.0), upper(backlash_amount), amount(backlash_amount) { }
+
+    double val() const { return upper; }
+
+    void incr(double d)
+    {
+        cur += d;
+        if (d > 0.0)
+        {
+            if (cur > upper)
+                upper = cur;
+        }
+        else if (d < 0.0)
+        {
+            if (cur < upper - amount)
+                upper = cur + amount;
+        }
+    }
+};
+
+struct SimulatedMountParams
+{
+    double image_scale; // arc-sec per pixel
+    double exposure; // seconds per guide step
+    double pe_scale; // amplitude of the default PE curve, arc-sec
+    double seeing; // FWHM, arc-sec
+    double dec_drift; // arc-sec per minute
+    double dec_backlash; // arc-sec
+    double centroid_noise; // per-star centroid error, pixels (sigma)
+    uint32_t seed;
+
+    SimulatedMountParams()
+        : image_scale(1.0), exposure(2.0), pe_scale(5.0), seeing(2.0), dec_drift(5.0), dec_backlash(5.0),
+          centroid_noise(0.05), seed(1)
+    {
+    }
+};
+
+/*
+ * Closed-loop mount and sky model for guiding tests. Implements the periodic
+ * error, Dec drift, Dec backlash and seeing model of the camera simulator in
+ * pixel units, with a virtual clock that advances one exposure per step, so a
+ * full night of guiding runs in well under a second.
+ */
+class SimulatedMount
+{
+    SimulatedMountParams m_params;
+    SimRandom m_rand;
+    double m_time; // virtual time, seconds
+    double m_raOfs; // cumulative RA guide corrections, pixels
+    SimBacklash m_decOfs; // cumulative Dec guide corrections, pixels
+    double m_seeing[2]; // seeing displacement of the current frame, pixels
+
+public:
+    explicit SimulatedMount(const SimulatedMountParams& params)
+        : m_params(params), m_rand(params.seed), m_time(0.0), m_raOfs(0.0),
+          m_decOfs(params.dec_backlash / params.image_scale)
+    {
+        m_seeing[0] = m_seeing[1] = 0.0;
+    }
+
+    double Time() const { return m_time; }
+
+    // Periodic error at time t, pixels. Canned curve of the camera simulator.
+    double PeriodicError(double t) const
+    {
+        static const double period[] = { 230.5, 122.0, 49.4, 9.56, 76.84 };
+        static const double amp[] = { 2.02, 0.69, 0.22, 0.137, 0.14 };
+        static const double phase[] = { 0.0, 1.4, 98.8, 35.9, 150.4 };
+        static const double max_amp = 4.85;
+
+        double pe = 0.0;
+        for (int i = 0; i < 5; i++)
+            pe += amp[i] * std::cos((t - phase[i]) / period[i] * 2.0 * M_PI);
+        return pe * m_params.pe_scale / (max_amp * m_params.image_scale);
+    }
+
+    // Guide star position relative to the lock position excluding seeing, pixels
+    double TrueRA() const { return PeriodicError(m_time) + m_raOfs; }
+    double TrueDec() const { return m_time * m_params.dec_drift / (60.0 * m_params.image_scale) + m_decOfs.val(); }
+
+    // Advance the virtual clock by one exposure and draw the seeing for the new frame
+    void Expose()
+    {
+        m_time += m_params.exposure;
+        static const double seeing_adjustment = 2.345 * 1.4 * 2.4; // FWHM, geometry, empirical (gear_simulator.cpp)
+        double sigma = m_params.seeing / (seeing_adjustment * m_params.image_scale);
+        m_seeing[0] = sigma * m_rand.Normal();
+        m_seeing[1] = sigma * m_rand.Normal();
+    }
+
+    // Measured offset of a single star, including seeing and centroid noise
+    double MeasureRA() { return TrueRA() + m_seeing[0] + m_params.centroid_noise * m_rand.Normal(); }
+    double MeasureDec() { return TrueDec() + m_seeing[1] + m_params.centroid_noise * m_rand.Normal(); }
+
+    // Apply guide corrections, pixels. A correction moves the star towards the lock position.
+    void Guide(double ra, double dec)
+    {
+        m_raOfs -= ra;
+        m_decOfs.incr(-dec);
+    }
+};
+
+#endif // SIMULATED_MOUNT_H_INCLUDED
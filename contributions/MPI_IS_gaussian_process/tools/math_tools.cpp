@@ -45,6 +45,8 @@
 #include <stdexcept>
 #include <cmath>
 #include <cstdint>
+#include <cassert>
+#include <algorithm>
 
 namespace math_tools
 {
@@ -224,6 +226,240 @@ namespace math_tools
         return std::sqrt(centered.pow(2).sum()/(centered.size() - 1));
     }
 
+    StreamingSpectrum::StreamingSpectrum(int N) :
+        N_(N),
+        num_samples_(0),
+        twiddles_(N),
+        dft_data_(N / 2 + 1),
+        dft_ones_(N / 2 + 1),
+        dft_time_(N / 2 + 1)
+    {
+        assert(N > 1 && (N & (N - 1)) == 0 && "the DFT length must be a power of two");
+        for (int j = 0; j < N_; ++j)
+        {
+            twiddles_[j] = std::polar(1.0, -2 * M_PI * j / N_);
+        }
+        clear();
+    }
+
+    void StreamingSpectrum::clear()
+    {
+        num_samples_ = 0;
+        dft_data_.setZero();
+        dft_ones_.setZero();
+        dft_time_.setZero();
+        sum_t_ = 0.0;
+        sum_tt_ = 0.0;
+        sum_x_ = 0.0;
+        sum_tx_ = 0.0;
+    }
+
+    void StreamingSpectrum::add(double t, double x)
+    {
+        assert(num_samples_ < N_ && "the DFT would wrap around");
+        if (num_samples_ >= N_)
+        {
+            return;
+        }
+
+        // the contribution of sample n to bin k is x exp(-2 pi i n k / N), the
+        // twiddle index n k mod N is advanced incrementally
+        int n = num_samples_;
+        int j = 0;
+        for (int k = 0; k <= N_ / 2; ++k)
+        {
+            const std::complex<double>& w = twiddles_[j];
+            dft_data_(k) += x * w;
+            dft_ones_(k) += w;
+            dft_time_(k) += t * w;
+            j = (j + n) & (N_ - 1);
+        }
+
+        sum_t_ += t;
+        sum_tt_ += t * t;
+        sum_x_ += x;
+        sum_tx_ += t * x;
+        ++num_samples_;
+    }
+
+    void StreamingSpectrum::remove_first(double t, double x)
+    {
+        assert(num_samples_ > 0);
+        if (num_samples_ == 0)
+        {
+            return;
+        }
+
+        // the first sample contributes x to every bin, the remaining samples
+        // move from index n to n - 1, which multiplies bin k by exp(2 pi i k / N)
+        for (int k = 0; k <= N_ / 2; ++k)
+        {
+            std::complex<double> w = std::conj(twiddles_[k]);
+            dft_data_(k) = (dft_data_(k) - x) * w;
+            dft_ones_(k) = (dft_ones_(k) - 1.0) * w;
+            dft_time_(k) = (dft_time_(k) - t) * w;
+        }
+
+        sum_t_ -= t;
+        sum_tt_ -= t * t;
+        sum_x_ -= x;
+        sum_tx_ -= t * x;
+        --num_samples_;
+    }
+
+    void StreamingSpectrum::assign(const Eigen::Ref<const Eigen::VectorXd>& t, const Eigen::Ref<const Eigen::VectorXd>& x)
+    {
+        assert(t.rows() == x.rows() && t.rows() <= N_);
+        clear();
+
+        int M = std::min(static_cast<int>(x.rows()), N_);
+        fft_input_.assign(N_, 0.0);
+        fft_output_.resize(N_);
+
+        std::copy(x.data(), x.data() + M, fft_input_.begin());
+        fft_.fwd(&fft_output_[0], &fft_input_[0], N_);
+        dft_data_ = Eigen::Map<Eigen::VectorXcd>(&fft_output_[0], N_ / 2 + 1);
+
+        std::fill(fft_input_.begin(), fft_input_.begin() + M, 1.0);
+        fft_.fwd(&fft_output_[0], &fft_input_[0], N_);
+        dft_ones_ = Eigen::Map<Eigen::VectorXcd>(&fft_output_[0], N_ / 2 + 1);
+
+        std::copy(t.data(), t.data() + M, fft_input_.begin());
+        fft_.fwd(&fft_output_[0], &fft_input_[0], N_);
+        dft_time_ = Eigen::Map<Eigen::VectorXcd>(&fft_output_[0], N_ / 2 + 1);
+
+        sum_t_ = t.head(M).sum();
+        sum_tt_ = t.head(M).squaredNorm();
+        sum_x_ = x.head(M).sum();
+        sum_tx_ = t.head(M).dot(x.head(M));
+        num_samples_ = M;
+    }
+
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> StreamingSpectrum::spectrum() const
+    {
+        Eigen::VectorXd power(N_ / 2 + 1);
+        Eigen::VectorXd frequencies(N_ / 2 + 1);
+        int num_bins = spectrum(power, frequencies);
+        return std::make_pair(Eigen::VectorXd(power.head(num_bins)), Eigen::VectorXd(frequencies.head(num_bins)));
+    }
+
+    int StreamingSpectrum::spectrum(Eigen::Ref<Eigen::VectorXd> power, Eigen::Ref<Eigen::VectorXd> frequencies) const
+    {
+        int M = num_samples_;
+        if (M < 2)
+        {
+            return 0;
+        }
+
+        // linear least squares regression for offset and drift, with a small
+        // ridge for stability
+        Eigen::Matrix2d A;
+        A << M + 1e-3, sum_t_,
+             sum_t_, sum_tt_ + 1e-3;
+        Eigen::Vector2d b(sum_x_, sum_tx_);
+        Eigen::Vector2d w = A.ldlt().solve(b);
+
+        // the low_index is the lowest useful frequency, depending on the number of actual datapoints
+        int low_index = static_cast<int>(std::ceil(static_cast<double>(N_) / static_cast<double>(M)));
+        int num_bins = N_ / 2 - low_index + 1;
+
+        assert(power.rows() >= num_bins && frequencies.rows() >= num_bins);
+        for (int i = 0; i < num_bins; ++i)
+        {
+            int k = low_index + i;
+            // the DFT is linear, so the trend is removed by subtracting its DFT
+            std::complex<double> X = dft_data_(k) - w(0) * dft_ones_(k) - w(1) * dft_time_(k);
+            power(i) = std::norm(X);
+            frequencies(i) = static_cast<double>(k) / N_;
+        }
+
+        return num_bins;
+    }
+
+    bool cholesky_append(Eigen::MatrixXd& L, const Eigen::VectorXd& k, double kappa)
+    {
+        int n = static_cast<int>(L.rows());
+        L.conservativeResize(n + 1, n + 1);
+        if (!cholesky_append(L, n, k, kappa))
+        {
+            L.conservativeResize(n, n);
+            return false;
+        }
+        return true;
+    }
+
+    bool cholesky_append(Eigen::MatrixXd& L, int n, const Eigen::Ref<const Eigen::VectorXd>& k, double kappa)
+    {
+        assert(k.rows() == n && L.rows() > n && L.cols() > n);
+
+        // the new row l of the factor solves L l = k, the new diagonal element
+        // follows. The unused column n above the diagonal serves as workspace.
+        Eigen::MatrixXd::ColXpr::SegmentReturnType l = L.col(n).head(n);
+        l = k;
+        L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(l);
+        double d2 = kappa - l.squaredNorm();
+        if (!(d2 > 0.0))
+        {
+            l.setZero();
+            return false;
+        }
+
+        L.row(n).head(n) = l.transpose();
+        l.setZero();
+        L(n, n) = std::sqrt(d2);
+        return true;
+    }
+
+    void cholesky_remove(Eigen::MatrixXd& L, int i)
+    {
+        int n = static_cast<int>(L.rows());
+        cholesky_remove(L, n, i);
+        L.conservativeResize(n - 1, n - 1);
+    }
+
+    void cholesky_remove(Eigen::MatrixXd& L, int n, int i)
+    {
+        assert(i >= 0 && i < n && L.rows() >= n && L.cols() >= n);
+        int m = n - i - 1; // size of the trailing block
+
+        // the column below the removed diagonal element is folded into the
+        // trailing block: L33' L33'^T = L33 L33^T + x x^T. x is kept in the
+        // unused upper part of row i, which the shift below doesn't touch.
+        Eigen::MatrixXd::RowXpr::SegmentReturnType x = L.row(i).segment(i + 1, m);
+        x = L.col(i).segment(i + 1, m).transpose();
+
+        // shift the rows below i up and the columns right of i to the left
+        for (int c = 0; c < n - 1; ++c)
+        {
+            int src_c = c < i ? c : c + 1;
+            for (int r = std::max(c, i); r < n - 1; ++r)
+            {
+                L(r, c) = L(r + 1, src_c);
+            }
+        }
+
+        // rank-one update of the trailing block with Givens-like rotations
+        for (int k = 0; k < m; ++k)
+        {
+            int row = i + k;
+            double Lkk = L(row, row);
+            double r = std::sqrt(Lkk * Lkk + x(k) * x(k));
+            double c = r / Lkk;
+            double s = x(k) / Lkk;
+            L(row, row) = r;
+
+            int rest = m - k - 1;
+            if (rest > 0)
+            {
+                L.block(row + 1, row, rest, 1) = (L.block(row + 1, row, rest, 1) + s * x.segment(k + 1, rest).transpose()) / c;
+                x.segment(k + 1, rest) = c * x.segment(k + 1, rest) - s * L.block(row + 1, row, rest, 1).transpose();
+            }
+        }
+        x.setZero();
+        L.row(n - 1).head(n).setZero();
+        L.col(n - 1).head(n).setZero();
+    }
+
 
 }  // namespace math_tools
 
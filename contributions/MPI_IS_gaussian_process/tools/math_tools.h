@@ -156,6 +156,116 @@ namespace math_tools
      */
     double stdandard_deviation(Eigen::VectorXd& input);
 
+    /*!
+     * Extends the lower Cholesky factor L of a matrix K by one row and column,
+     * so that it becomes the factor of [K k; k^T kappa]. This costs O(n^2)
+     * instead of O(n^3) for a new factorization.
+     *
+     * Returns false and leaves L untouched if the extended matrix is not
+     * positive definite.
+     */
+    bool cholesky_append(Eigen::MatrixXd& L, const Eigen::VectorXd& k, double kappa);
+
+    /*!
+     * In-place variant of cholesky_append() for a factor that is stored in
+     * the leading n x n block of a larger matrix. The factor grows into row
+     * and column n, no memory is allocated.
+     */
+    bool cholesky_append(Eigen::MatrixXd& L, int n, const Eigen::Ref<const Eigen::VectorXd>& k, double kappa);
+
+    /*!
+     * Removes row and column i from the matrix factored by the lower Cholesky
+     * factor L. The rows below i are repaired with a rank-one update of the
+     * trailing block, which costs O(n^2).
+     */
+    void cholesky_remove(Eigen::MatrixXd& L, int i);
+
+    /*!
+     * In-place variant of cholesky_remove() for a factor that is stored in
+     * the leading n x n block of a larger matrix. The factor of the remaining
+     * rows and columns is left in the leading (n-1) x (n-1) block, no memory
+     * is allocated.
+     */
+    void cholesky_remove(Eigen::MatrixXd& L, int n, int i);
+
+    /*!
+     * Power spectrum of a linearly detrended data stream at the bins of an
+     * N-point, zero-padded DFT, which is updated sample by sample.
+     *
+     * Adding a sample costs O(N) instead of the O(N log N) of an FFT over the
+     * whole history. Besides the DFT of the data, the DFTs of a constant and of
+     * the sample times are accumulated. This way the linear trend of the
+     * complete history can be removed exactly when the spectrum is read,
+     * although the trend changes with every sample.
+     */
+    class StreamingSpectrum
+    {
+    public:
+        /*!
+         * The DFT length N has to be a power of two and at least as large as
+         * the number of samples.
+         */
+        explicit StreamingSpectrum(int N);
+
+        /*!
+         * Removes all samples.
+         */
+        void clear();
+
+        /*!
+         * Appends one sample with time t and value x.
+         */
+        void add(double t, double x);
+
+        /*!
+         * Removes the first sample, which had time t and value x. The other
+         * samples move up by one, so that their spectrum is the same as if
+         * they had been added without the first one. This costs O(N).
+         */
+        void remove_first(double t, double x);
+
+        /*!
+         * Replaces all samples. This uses FFTs and is cheaper than adding
+         * many samples one by one.
+         */
+        void assign(const Eigen::Ref<const Eigen::VectorXd>& t, const Eigen::Ref<const Eigen::VectorXd>& x);
+
+        /*!
+         * Returns the number of samples.
+         */
+        int size() const { return num_samples_; }
+
+        /*!
+         * Returns the spectrum of the detrended samples, in the same form as
+         * compute_spectrum(): the first vector holds the power, the second
+         * one the frequencies in cycles per sample. Empty for less than two
+         * samples.
+         */
+        std::pair<Eigen::VectorXd, Eigen::VectorXd> spectrum() const;
+
+        /*!
+         * Allocation-free variant of spectrum(): writes the power and the
+         * frequencies to the first elements of the given vectors, which must
+         * hold at least N / 2 + 1 elements, and returns the number of bins.
+         */
+        int spectrum(Eigen::Ref<Eigen::VectorXd> power, Eigen::Ref<Eigen::VectorXd> frequencies) const;
+
+    private:
+        int N_;
+        int num_samples_;
+        std::vector<std::complex<double> > twiddles_; // exp(-2 pi i j / N)
+        Eigen::VectorXcd dft_data_; // bins 0 to N/2
+        Eigen::VectorXcd dft_ones_;
+        Eigen::VectorXcd dft_time_;
+        double sum_t_;
+        double sum_tt_;
+        double sum_x_;
+        double sum_tx_;
+        Eigen::FFT<double> fft_; // keeps its plans, so that assign() doesn't allocate after the first call
+        std::vector<double> fft_input_;
+        std::vector<std::complex<double> > fft_output_;
+    };
+
 }  // namespace math_tools
 
 #endif  // define GP_MATH_TOOLS_H
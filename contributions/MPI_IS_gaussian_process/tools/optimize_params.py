@@ -12,6 +12,11 @@ stdin as a float.
 The scoring algorithm tries to never degrade performance (uses the worst value
 if it is negative) and averages the performance in all other cases. This way
 we achieve good average performance while not degrading performance for anyone.
+
+The native GuideParameterOptimizer binary (tests/gaussian_process/optimize_parameters.cpp)
+does the same search without spawning a process per evaluation, running the
+evaluations on all cores with a CMA-ES search, and prints the parameter list in
+the order used here.
 """
 
 import subprocess
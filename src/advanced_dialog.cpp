@@ -599,16 +599,17 @@ void AdvancedDialog::MakeImageScaleAdjustments()
     double guideSpeedX;
     Debug.Write("Image scale has changed via AD UI - step-size and algo adjustments will be made\n");
     Debug.Write(wxString::Format("New image scale properties:  fl= %d, px= %.3fu, bin= %d\n", pFrame->GetFocalLength(),
-                                 pCamera->GetCameraPixelSize(), pCamera->Binning));
+                                 pCamera->GetCameraPixelSize(), pCamera->TotalBinning()));
 
     // Determine a calibration step-size based on recommended distance and best estimator of mount guide speeds
     guideSpeedX = DetermineGuideSpeed();
     int calibrationStep;
-    int recDistance =
-        CalstepDialog::GetCalibrationDistance(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+    int recDistance = CalstepDialog::GetCalibrationDistance(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                                            pCamera->TotalBinning());
     int oldStepSize = TheScope()->GetCalibrationDuration();
-    CalstepDialog::GetCalibrationStepSize(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning,
-                                          guideSpeedX, CalstepDialog::DEFAULT_STEPS, 0, recDistance, nullptr, &calibrationStep);
+    CalstepDialog::GetCalibrationStepSize(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                          pCamera->TotalBinning(), guideSpeedX, CalstepDialog::DEFAULT_STEPS, 0,
+                                          recDistance, nullptr, &calibrationStep);
     TheScope()->SetCalibrationDuration(calibrationStep);
     Debug.Write(wxString::Format("Cal step-size changed from %d ms to %d ms\n", oldStepSize, calibrationStep));
     // Clear the calibration to force a new one and reset the min-move values
@@ -619,8 +620,8 @@ void AdvancedDialog::MakeImageScaleAdjustments()
             pSecondaryMount->ClearCalibration();
         Debug.Write("Calibrations cleared because of image scale change\n");
 
-        double defMinMove =
-            GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+        double defMinMove = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                                                pCamera->TotalBinning());
         Debug.Write(wxString::Format("Guide algo min moves reset to %.3fu\n", defMinMove));
         pMount->GetXGuideAlgorithm()->SetMinMove(defMinMove);
         pMount->GetYGuideAlgorithm()->SetMinMove(defMinMove);
@@ -0,0 +1,177 @@
+/*
+ *  ao_fastloop.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+AOFastLoop::AOFastLoop(MyFrame *pFrame)
+    : wxThread(wxTHREAD_JOINABLE), m_pFrame(pFrame), m_workCond(m_lock), m_idleCond(m_lock), m_busy(false), m_stop(false)
+{
+}
+
+AOFastLoop::~AOFastLoop() { }
+
+bool AOFastLoop::IsEnabled()
+{
+    return pConfig->Profile.GetBoolean("/stepguider/FastLoop", false);
+}
+
+void AOFastLoop::SetEnabled(bool enable)
+{
+    pConfig->Profile.SetBoolean("/stepguider/FastLoop", enable);
+}
+
+void AOFastLoop::EnqueueMove(Mount *mount, const GuiderOffset& ofs, unsigned int moveOptions)
+{
+    MOVE_REQUEST req = {};
+    req.mount = mount;
+    req.axisMove = false;
+    req.moveOptions = moveOptions;
+    req.moveResult = Mount::MOVE_OK;
+    req.ofs = ofs;
+
+    wxMutexLocker lck(m_lock);
+    m_queue.emplace_back(req, PipelineStats::NowUs());
+    m_workCond.Signal();
+}
+
+bool AOFastLoop::WaitIdle(long timeoutMs)
+{
+    wxStopWatch swatch;
+    wxMutexLocker lck(m_lock);
+
+    while (m_busy || !m_queue.empty())
+    {
+        long remaining = timeoutMs - swatch.Time();
+        if (remaining <= 0)
+        {
+            Debug.Write("AOFastLoop: timed-out waiting for AO moves to complete\n");
+            return true;
+        }
+        m_idleCond.WaitTimeout(remaining);
+    }
+
+    return false;
+}
+
+void AOFastLoop::Stop()
+{
+    {
+        wxMutexLocker lck(m_lock);
+        m_stop = true;
+        m_workCond.Signal();
+    }
+
+    Wait();
+
+    {
+        // keep the mounts' request counts balanced for anything that did not run
+        wxMutexLocker lck(m_lock);
+        while (!m_queue.empty())
+        {
+            MOVE_REQUEST& req = m_queue.front().first;
+            req.moveResult = Mount::MOVE_ERROR;
+            wxQueueEvent(m_pFrame, new MoveCompleteEvent(req));
+            m_queue.pop_front();
+        }
+        m_idleCond.Broadcast();
+    }
+
+    LogStats();
+}
+
+void AOFastLoop::LogStats()
+{
+    wxMutexLocker lck(m_lock);
+
+    if (!m_totalLatency.Count())
+        return;
+
+    Debug.Write(wxString::Format("AOFastLoop: queue latency %s\n", m_queueLatency.Summary()));
+    Debug.Write(wxString::Format("AOFastLoop: step latency %s\n", m_stepLatency.Summary()));
+    Debug.Write(wxString::Format("AOFastLoop: total latency %s\n", m_totalLatency.Summary()));
+
+    m_queueLatency.Reset();
+    m_stepLatency.Reset();
+    m_totalLatency.Reset();
+}
+
+wxThread::ExitCode AOFastLoop::Entry()
+{
+    Debug.Write("AOFastLoop: thread starts\n");
+
+    while (true)
+    {
+        MOVE_REQUEST req;
+        long long queued;
+        {
+            wxMutexLocker lck(m_lock);
+            m_busy = false;
+            if (m_queue.empty())
+                m_idleCond.Broadcast();
+            while (!m_stop && m_queue.empty())
+                m_workCond.Wait();
+            if (m_stop)
+                break;
+            req = m_queue.front().first;
+            queued = m_queue.front().second;
+            m_queue.pop_front();
+            m_busy = true;
+        }
+
+        long long start = PipelineStats::NowUs();
+        PipelineTiming.Add(PIPELINE_DISPATCH, start - queued);
+
+        try
+        {
+            req.moveResult = req.mount->MoveOffset(&req.ofs, req.moveOptions);
+        }
+        catch (const wxString& Msg)
+        {
+            POSSIBLY_UNUSED(Msg);
+            req.moveResult = Mount::MOVE_ERROR;
+        }
+
+        long long end = PipelineStats::NowUs();
+
+        wxQueueEvent(m_pFrame, new MoveCompleteEvent(req));
+
+        wxMutexLocker lck(m_lock);
+        m_queueLatency.Add(start - queued);
+        m_stepLatency.Add(end - start);
+        m_totalLatency.Add(end - queued);
+    }
+
+    Debug.Write("AOFastLoop: thread ends\n");
+
+    return (wxThread::ExitCode) 0;
+}
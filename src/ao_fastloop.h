@@ -0,0 +1,91 @@
+/*
+ *  ao_fastloop.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef AO_FASTLOOP_H_INCLUDED
+#define AO_FASTLOOP_H_INCLUDED
+
+#include <deque>
+
+/*
+ * The AO fast loop runs step guider moves on a dedicated thread instead of
+ * the primary worker thread's request queue. A guide step computed from the
+ * latest centroid is handed straight to this thread, so the AO starts moving
+ * while the primary worker is still dealing with the next exposure request
+ * (exposure delay, camera setup). The primary worker waits for the AO to
+ * finish moving before the camera starts integrating, so every frame still
+ * sees the completed correction.
+ *
+ * Mount bumps requested by the AO are unchanged: they go to the secondary
+ * worker thread and run concurrently with AO steps.
+ *
+ * The loop keeps histograms of queue latency (guide step computed to AO step
+ * started), device latency (AO step round trip) and total latency, and writes
+ * them to the debug log when guiding stops.
+ */
+class AOFastLoop : public wxThread
+{
+    MyFrame *m_pFrame;
+
+    wxMutex m_lock;
+    wxCondition m_workCond; // signaled when a request is queued or on stop
+    wxCondition m_idleCond; // signaled when the queue drains
+    std::deque<std::pair<MOVE_REQUEST, long long>> m_queue; // request and time queued (us)
+    bool m_busy;
+    bool m_stop;
+
+    LatencyHistogram m_queueLatency;
+    LatencyHistogram m_stepLatency;
+    LatencyHistogram m_totalLatency;
+
+    ExitCode Entry() override;
+
+public:
+    AOFastLoop(MyFrame *pFrame);
+    ~AOFastLoop();
+
+    static bool IsEnabled();
+    static void SetEnabled(bool enable);
+
+    void EnqueueMove(Mount *mount, const GuiderOffset& ofs, unsigned int moveOptions);
+
+    // Wait until all queued AO moves have completed. Returns true if the
+    // moves were still running after timeoutMs.
+    bool WaitIdle(long timeoutMs);
+
+    // Stop the thread. Requests still queued complete with MOVE_ERROR.
+    void Stop();
+
+    void LogStats();
+};
+
+#endif // AO_FASTLOOP_H_INCLUDED
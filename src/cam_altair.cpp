@@ -139,7 +139,7 @@ struct AltairCamera : public GuideCamera
     int m_maxGain;
     double m_devicePixelSize;
     HAltaircam m_handle;
-    volatile bool m_frameReady;
+    ExposureCompletion m_frameReady;
     bool m_reduceResolution;
     unsigned int m_framesToDiscard;
 
@@ -515,7 +515,7 @@ void __stdcall CameraCallback(unsigned int event, void *pCallbackCtx)
     if (event == ALTAIRCAM_EVENT_IMAGE)
     {
         AltairCamera *cam = (AltairCamera *) pCallbackCtx;
-        cam->m_frameReady = true;
+        cam->m_frameReady.Signal();
     }
 }
 
@@ -575,7 +575,7 @@ bool AltairCamera::Capture(int duration, usImage& img, int options, const wxRect
     if (!m_capturing)
     {
         Debug.AddLine("Altair: startcapture");
-        m_frameReady = false;
+        m_frameReady.Reset();
         HRESULT result = m_sdk.StartPullModeWithCallback(m_handle, CameraCallback, this);
         if (result != 0)
         {
@@ -588,8 +588,6 @@ bool AltairCamera::Capture(int duration, usImage& img, int options, const wxRect
 
     int frameSize = frame.GetWidth() * frame.GetHeight();
 
-    int poll = wxMin(duration, 100);
-
     while (true) // frame discard loop
     {
         CameraWatchdog watchdog(duration, duration + GetTimeoutMs() + 10000); // total timeout is 2 * duration + 15s (typically)
@@ -603,20 +601,19 @@ bool AltairCamera::Capture(int duration, usImage& img, int options, const wxRect
 
         while (true) // PullImage retry loop
         {
-            if (m_frameReady)
+            ExposureCompletion::Result res = m_frameReady.Wait(watchdog);
+            if (res == ExposureCompletion::COMPLETED)
             {
-                m_frameReady = false;
-
                 if (SUCCEEDED(m_sdk.PullImage(m_handle, m_buffer, 8, &width, &height)))
                     break;
+                continue;
             }
-            WorkerThread::MilliSleep(poll, WorkerThread::INT_ANY);
-            if (WorkerThread::InterruptRequested())
+            if (res == ExposureCompletion::INTERRUPTED)
             {
                 StopCapture();
                 return true;
             }
-            if (watchdog.Expired())
+            else // timed out
             {
                 Debug.AddLine("Altair: getimagedata failed");
                 StopCapture();
@@ -43,11 +43,16 @@
 # include "config_indi.h"
 # include "image_math.h"
 # include "indi_gui.h"
+# include "indi_stream_seq.h"
 # include <libindi/baseclient.h>
 
 # include <libindi/basedevice.h>
 # include <libindi/indiproperty.h>
 
+# include <zlib.h>
+
+struct SimpleFitsImage;
+
 class CapturedFrame
 {
 public:
@@ -83,6 +88,65 @@ public:
     }
 };
 
+// Decodes streamed frames on a small pool of background threads so the INDI
+// client thread is never held up by decompression. Only the newest frame
+// matters for guiding: a blob that arrives while an older one is still
+// waiting for a decoder replaces it, and a decoded frame is only published
+// if it is newer than any frame published before it.
+class StreamDecoder
+{
+    enum
+    {
+        MAX_THREADS = 3,
+    };
+
+    class Worker : public wxThread
+    {
+        StreamDecoder *m_decoder;
+
+    public:
+        Worker(StreamDecoder *decoder) : wxThread(wxTHREAD_JOINABLE), m_decoder(decoder) { }
+        ExitCode Entry() override
+        {
+            m_decoder->Run();
+            return nullptr;
+        }
+    };
+
+    wxMutex m_lock;
+    wxCondition m_cond;
+    std::vector<Worker *> m_workers;
+    volatile bool m_active;
+    bool m_stop;
+    wxSize m_rawSize; // frame size of headerless .stream blobs
+    CapturedFrame *m_pending; // newest blob not yet picked up by a worker
+    unsigned int m_pendingSeq;
+    StreamSequence m_seq;
+    usImage m_decoded; // newest decoded frame, if m_haveDecoded
+    bool m_haveDecoded;
+    unsigned int m_dropped;
+    ExposureCompletion *m_ready;
+
+    void Run();
+
+public:
+    StreamDecoder(ExposureCompletion *ready);
+    ~StreamDecoder();
+
+    void Start(const wxSize& rawSize);
+    void Stop();
+    bool IsActive() const { return m_active; }
+
+    // Queue a blob for decoding, taking ownership of its data
+    void Submit(IBLOB *bp);
+    // Oldest sequence number a capture requested now may use, see
+    // StreamSequence::CaptureMinSeq()
+    unsigned int CaptureMinSeq();
+    // Move the newest decoded frame into img if it was submitted at or after
+    // minSeq. Returns true if a frame was taken.
+    bool TakeFrame(unsigned int minSeq, usImage& img);
+};
+
 class CameraINDI : public GuideCamera, public INDI::BaseClient
 {
 private:
@@ -99,6 +163,7 @@ private:
     INumber *binning_x;
     INumber *binning_y;
     ISwitchVectorProperty *video_prop;
+    INumberVectorProperty *stream_exposure_prop;
     ITextVectorProperty *camera_port;
     INDI::BaseDevice camera_device;
     INumberVectorProperty *pulseGuideNS_prop;
@@ -116,12 +181,14 @@ private:
     IndiGui *m_gui;
 
     wxMutex m_lastFrame_lock;
-    wxCondition m_lastFrame_cond;
     CapturedFrame *m_lastFrame;
+    ExposureCompletion m_frameReady; // signaled when a frame is received or stacked
+    ExposureCompletion m_exposeUpdated; // signaled when the exposure property changes
+    StreamDecoder m_decoder;
 
     usImage *StackImg;
     int StackFrames;
-    volatile bool stacking; // TODO: use a wxCondition to signal completion
+    volatile bool stacking;
     bool has_blob;
     bool has_old_videoprop;
     bool first_frame;
@@ -142,6 +209,7 @@ private:
     wxString INDICameraBlobName;
     bool INDICameraForceVideo;
     bool INDICameraForceExposure;
+    bool INDICameraStreaming;
     wxRect m_roi;
 
     bool ConnectToDriver(RunInBg *ctx);
@@ -151,15 +219,18 @@ private:
     void CameraDialog();
     void CameraSetup();
     bool ReadFITS(CapturedFrame *cf, usImage& img, bool takeSubframe, const wxRect& subframe);
+    bool ReadSimpleFITS(const SimpleFitsImage& fits, usImage& img, bool takeSubframe, const wxRect& subframe);
     bool StackStream(CapturedFrame *cf);
+    void SetVideoStream(bool on);
+    bool CaptureStream(int duration, usImage& img, int options);
     void SendBinning();
 
     // Update the last frame, discarding any missed frame
     void updateLastFrame(IBLOB *bp);
 
-    // Wait until a frame was acquired, for limited amout of time.
+    // Take the frame signaled by m_frameReady, if any.
     // If non null is returned, caller is responsible for deletion
-    CapturedFrame *waitFrame(unsigned long waitTime);
+    CapturedFrame *takeFrame();
 
 protected:
     void newDevice(INDI::BaseDevice dp) override;
@@ -187,7 +258,7 @@ public:
     bool ST4HasNonGuiMove() override;
 };
 
-CameraINDI::CameraINDI() : sync_cond(sync_lock), m_lastFrame_cond(m_lastFrame_lock), m_gui(nullptr)
+CameraINDI::CameraINDI() : sync_cond(sync_lock), m_gui(nullptr), m_decoder(&m_frameReady)
 {
     m_lastFrame = nullptr;
     ClearStatus();
@@ -198,6 +269,7 @@ CameraINDI::CameraINDI() : sync_cond(sync_lock), m_lastFrame_cond(m_lastFrame_lo
     INDICameraCCD = pConfig->Profile.GetLong("/indi/INDIcam_ccd", 0);
     INDICameraForceVideo = pConfig->Profile.GetBoolean("/indi/INDIcam_forcevideo", false);
     INDICameraForceExposure = pConfig->Profile.GetBoolean("/indi/INDIcam_forceexposure", false);
+    INDICameraStreaming = pConfig->Profile.GetBoolean("/indi/INDIcam_streaming", false);
     Name = wxString::Format("INDI Camera [%s]", INDICameraName);
     SetCCDdevice();
     PropertyDialogType = PROPDLG_ANY;
@@ -224,6 +296,7 @@ void CameraINDI::ClearStatus()
     ccdinfo_prop = nullptr;
     binning_prop = nullptr;
     video_prop = nullptr;
+    stream_exposure_prop = nullptr;
     camera_port = nullptr;
     pulseGuideNS_prop = nullptr;
     pulseGuideEW_prop = nullptr;
@@ -235,27 +308,18 @@ void CameraINDI::ClearStatus()
     PixSize = PixSizeX = PixSizeY = 0.0;
 
     updateLastFrame(nullptr);
+    m_decoder.Stop();
 
     guide_active = false;
     sync_cond.Broadcast(); // just in case worker thread was blocked waiting for guide pulse to complete
 }
 
-CapturedFrame *CameraINDI::waitFrame(unsigned long waitTime)
+CapturedFrame *CameraINDI::takeFrame()
 {
     wxMutexLocker lck(m_lastFrame_lock);
-    if (!m_lastFrame)
-    {
-        m_lastFrame_cond.WaitTimeout(waitTime);
-    }
-
-    if (m_lastFrame)
-    {
-        auto ret = m_lastFrame;
-        m_lastFrame = nullptr;
-        return ret;
-    }
-
-    return nullptr;
+    auto ret = m_lastFrame;
+    m_lastFrame = nullptr;
+    return ret;
 }
 
 void CameraINDI::updateLastFrame(IBLOB *blob)
@@ -278,7 +342,7 @@ void CameraINDI::updateLastFrame(IBLOB *blob)
     if (notify)
     {
         Debug.Write(wxString::Format("lastFrame signaled Camera is ready\n"));
-        m_lastFrame_cond.Broadcast();
+        m_frameReady.Signal();
     }
 }
 
@@ -348,6 +412,9 @@ void CameraINDI::updateProperty(INDI::Property property)
     {
         auto nvp = property.getNumber();
 
+        if (nvp == expose_prop)
+            m_exposeUpdated.Signal();
+
         if (INDIConfig::Verbose())
         {
             if (strcmp(nvp->name, "CCD_EXPOSURE") == 0)
@@ -431,7 +498,15 @@ void CameraINDI::updateProperty(INDI::Property property)
         if (INDIConfig::Verbose())
             Debug.Write(wxString::Format("INDI Camera Received BLOB %s len=%d size=%d\n", bp->name, bp->bloblen, bp->size));
 
-        if (expose_prop && !INDICameraForceVideo)
+        if (m_decoder.IsActive())
+        {
+            // streaming guide mode, frames are decoded in the background
+            if (bp->name == INDICameraBlobName)
+            {
+                m_decoder.Submit(bp);
+            }
+        }
+        else if (expose_prop && !INDICameraForceVideo)
         {
             if (bp->name == INDICameraBlobName)
             {
@@ -557,6 +632,13 @@ void CameraINDI::newProperty(INDI::Property property)
         video_prop = property.getSwitch();
         has_old_videoprop = true;
     }
+    else if (PropName == "STREAMING_EXPOSURE" && Proptype == INDI_NUMBER)
+    {
+        if (INDIConfig::Verbose())
+            Debug.Write(wxString::Format("INDI Camera Found STREAMING_EXPOSURE for %s\n", property.getDeviceName()));
+
+        stream_exposure_prop = property.getNumber();
+    }
     else if (PropName == "DEVICE_PORT" && Proptype == INDI_TEXT)
     {
         if (INDIConfig::Verbose())
@@ -795,6 +877,7 @@ void CameraINDI::CameraSetup()
     indiDlg.INDIDevCCD = INDICameraCCD;
     indiDlg.INDIForceVideo = INDICameraForceVideo;
     indiDlg.INDIForceExposure = INDICameraForceExposure;
+    indiDlg.INDIStreaming = INDICameraStreaming;
     // initialize with actual values
     indiDlg.SetSettings();
     // try to connect to server
@@ -809,12 +892,14 @@ void CameraINDI::CameraSetup()
         INDICameraCCD = indiDlg.INDIDevCCD;
         INDICameraForceVideo = indiDlg.INDIForceVideo;
         INDICameraForceExposure = indiDlg.INDIForceExposure;
+        INDICameraStreaming = indiDlg.INDIStreaming;
         pConfig->Profile.SetString("/indi/INDIhost", INDIhost);
         pConfig->Profile.SetLong("/indi/INDIport", INDIport);
         pConfig->Profile.SetString("/indi/INDIcam", INDICameraName);
         pConfig->Profile.SetLong("/indi/INDIcam_ccd", INDICameraCCD);
         pConfig->Profile.SetBoolean("/indi/INDIcam_forcevideo", INDICameraForceVideo);
         pConfig->Profile.SetBoolean("/indi/INDIcam_forceexposure", INDICameraForceExposure);
+        pConfig->Profile.SetBoolean("/indi/INDIcam_streaming", INDICameraStreaming);
         Name = INDICameraName;
         SetCCDdevice();
     }
@@ -835,8 +920,525 @@ void CameraINDI::SetCCDdevice()
     }
 }
 
+// A single-HDU, uncompressed 8- or 16-bit FITS image that can be decoded
+// straight from the BLOB without going through CFITSIO
+struct SimpleFitsImage
+{
+    int bitpix;
+    int width;
+    int height;
+    const unsigned char *data;
+};
+
+enum
+{
+    FITS_BLOCK = 2880,
+    FITS_CARD = 80,
+};
+
+static bool FitsCardIs(const char *card, const char *key)
+{
+    size_t len = strlen(key);
+    if (memcmp(card, key, len) != 0)
+        return false;
+    for (size_t i = len; i < 8; i++)
+        if (card[i] != ' ')
+            return false;
+    return true;
+}
+
+static bool FitsCardLong(const char *card, long *val)
+{
+    if (card[8] != '=' || card[9] != ' ')
+        return false;
+    char buf[FITS_CARD - 9];
+    memcpy(buf, card + 10, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    char *end;
+    *val = strtol(buf, &end, 10);
+    if (end == buf)
+        return false;
+    // allow trailing blanks or a comment, but not a fractional value
+    while (*end == ' ')
+        ++end;
+    return *end == 0 || *end == '/';
+}
+
+static bool FitsCardDouble(const char *card, double *val)
+{
+    if (card[8] != '=' || card[9] != ' ')
+        return false;
+    char buf[FITS_CARD - 9];
+    memcpy(buf, card + 10, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    char *end;
+    *val = strtod(buf, &end);
+    return end != buf;
+}
+
+// Scan the primary header of a FITS blob. Returns true if the blob holds
+// only a 2-D image in a layout the fast path handles: BITPIX 8, or BITPIX
+// 16 with the standard unsigned offset (BZERO 32768), BSCALE 1 and no
+// extensions. Anything else (RGB cubes, tile compression, floating point,
+// extra HDUs, ...) is left to CFITSIO.
+static bool ParseSimpleFITS(const void *blob, size_t size, SimpleFitsImage *fits)
+{
+    const char *hdr = static_cast<const char *>(blob);
+
+    if (size < FITS_BLOCK || !FitsCardIs(hdr, "SIMPLE") || hdr[8] != '=' || hdr[29] != 'T')
+        return false;
+
+    long bitpix = 0, naxis = -1, naxis1 = 0, naxis2 = 0;
+    double bzero = 0.0, bscale = 1.0;
+    size_t pos = FITS_CARD;
+    bool end = false;
+
+    for (; pos + FITS_CARD <= size; pos += FITS_CARD)
+    {
+        const char *card = hdr + pos;
+
+        if (FitsCardIs(card, "END"))
+        {
+            end = true;
+            break;
+        }
+
+        bool ok = true;
+        if (FitsCardIs(card, "BITPIX"))
+            ok = FitsCardLong(card, &bitpix);
+        else if (FitsCardIs(card, "NAXIS"))
+            ok = FitsCardLong(card, &naxis);
+        else if (FitsCardIs(card, "NAXIS1"))
+            ok = FitsCardLong(card, &naxis1);
+        else if (FitsCardIs(card, "NAXIS2"))
+            ok = FitsCardLong(card, &naxis2);
+        else if (FitsCardIs(card, "BZERO"))
+            ok = FitsCardDouble(card, &bzero);
+        else if (FitsCardIs(card, "BSCALE"))
+            ok = FitsCardDouble(card, &bscale);
+        else if (FitsCardIs(card, "BLANK"))
+            ok = false; // let CFITSIO deal with null values
+
+        if (!ok)
+            return false;
+    }
+
+    if (!end || naxis != 2 || naxis1 <= 0 || naxis2 <= 0 || bscale != 1.0)
+        return false;
+
+    if (!(bitpix == 8 && bzero == 0.0) && !(bitpix == 16 && bzero == 32768.0))
+        return false;
+
+    size_t dataOffset = (pos / FITS_BLOCK + 1) * FITS_BLOCK;
+    size_t dataBytes = (size_t) naxis1 * naxis2 * (bitpix / 8);
+
+    if (dataOffset + dataBytes > size)
+        return false;
+
+    // anything past the padded data unit is another HDU, which the CFITSIO
+    // path reports as unsupported
+    size_t hduEnd = dataOffset + (dataBytes + FITS_BLOCK - 1) / FITS_BLOCK * FITS_BLOCK;
+    if (size > hduEnd)
+        return false;
+
+    fits->bitpix = bitpix;
+    fits->width = naxis1;
+    fits->height = naxis2;
+    fits->data = reinterpret_cast<const unsigned char *>(hdr) + dataOffset;
+
+    return true;
+}
+
+// Convert one row of FITS pixels to native unsigned shorts. 16-bit data is
+// big-endian two's complement with BZERO 32768, so flipping the sign bit after
+// the byte swap yields the unsigned value. The loop is written so compilers
+// vectorize it into byte shuffles.
+static void FitsRowToUShort(unsigned short *dst, const unsigned char *src, int count, int bitpix)
+{
+    if (bitpix == 8)
+    {
+        for (int i = 0; i < count; i++)
+            dst[i] = src[i];
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+            dst[i] = (unsigned short) (((src[2 * i] << 8) | src[2 * i + 1]) ^ 0x8000);
+    }
+}
+
+bool CameraINDI::ReadSimpleFITS(const SimpleFitsImage& fits, usImage& img, bool takeSubframe, const wxRect& subframe)
+{
+    if (takeSubframe)
+    {
+        if (FullSize == UNDEFINED_FRAME_SIZE)
+        {
+            // should never happen since we arranged not to take a subframe
+            // unless full frame size is known
+            Debug.Write("internal error: taking subframe before full frame\n");
+            return true;
+        }
+        if (fits.width * fits.height < subframe.width * subframe.height)
+        {
+            pFrame->Alert(_("Error reading data"));
+            return true;
+        }
+        if (img.Init(FullSize))
+        {
+            pFrame->Alert(_("Memory allocation error"));
+            return true;
+        }
+
+        img.Clear();
+        img.Subframe = subframe;
+
+        // the driver sends just the subframe, decode it row by row into place;
+        // rows are laid out with the subframe width as the CFITSIO path does
+        const unsigned char *src = fits.data;
+        size_t subRowBytes = (size_t) subframe.width * (fits.bitpix / 8);
+        for (int y = 0; y < subframe.height; y++)
+        {
+            unsigned short *dataptr = img.ImageData + (y + subframe.y) * img.Size.GetWidth() + subframe.x;
+            FitsRowToUShort(dataptr, src, subframe.width, fits.bitpix);
+            src += subRowBytes;
+        }
+    }
+    else
+    {
+        FullSize.Set(fits.width, fits.height);
+
+        if (img.Init(FullSize))
+        {
+            pFrame->Alert(_("Memory allocation error"));
+            return true;
+        }
+
+        size_t rowBytes = (size_t) fits.width * (fits.bitpix / 8);
+        const unsigned char *src = fits.data;
+        unsigned short *dst = img.ImageData;
+        for (int y = 0; y < fits.height; y++)
+        {
+            FitsRowToUShort(dst, src, fits.width, fits.bitpix);
+            src += rowBytes;
+            dst += fits.width;
+        }
+    }
+
+    return false;
+}
+
+// Decode a FITS blob into img. Plain images use the fast path, anything
+// else, including tile-compressed (fpack) files, goes through CFITSIO.
+// Returns true on error.
+static bool DecodeFITSBlob(const void *data, size_t size, usImage& img)
+{
+    SimpleFitsImage simple;
+    if (ParseSimpleFITS(data, size, &simple))
+    {
+        if (img.Init(simple.width, simple.height))
+            return true;
+
+        size_t rowBytes = (size_t) simple.width * (simple.bitpix / 8);
+        const unsigned char *src = simple.data;
+        unsigned short *dst = img.ImageData;
+        for (int y = 0; y < simple.height; y++)
+        {
+            FitsRowToUShort(dst, src, simple.width, simple.bitpix);
+            src += rowBytes;
+            dst += simple.width;
+        }
+        return false;
+    }
+
+    void *mem = const_cast<void *>(data);
+    size_t memsize = size;
+    fitsfile *fptr;
+    int status = 0;
+
+    if (fits_open_memfile(&fptr, "", READONLY, &mem, &memsize, 0, nullptr, &status))
+        return true;
+
+    int naxis = 0;
+    fits_get_img_dim(fptr, &naxis, &status);
+    if (naxis == 0)
+    {
+        // fpack leaves the primary HDU empty and stores the image in the first extension
+        int hdutype;
+        fits_movabs_hdu(fptr, 2, &hdutype, &status);
+        fits_get_img_dim(fptr, &naxis, &status);
+    }
+
+    long fits_size[2] = { 0, 0 };
+    fits_get_img_size(fptr, 2, fits_size, &status);
+
+    long fpixel[2] = { 1, 1 };
+    bool err = status || naxis != 2 || img.Init((int) fits_size[0], (int) fits_size[1]) ||
+        fits_read_pix(fptr, TUSHORT, fpixel, img.NPixels, nullptr, img.ImageData, nullptr, &status);
+
+    PHD_fits_close_file(fptr);
+    return err;
+}
+
+// Inflate a zlib-compressed blob. Returns true on error.
+static bool InflateBlob(const void *data, size_t size, std::vector<unsigned char> *out)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK)
+        return true;
+
+    zs.next_in = static_cast<Bytef *>(const_cast<void *>(data));
+    zs.avail_in = (uInt) size;
+
+    out->resize(size * 4 + 65536);
+
+    int ret;
+    do
+    {
+        if (zs.total_out == out->size())
+            out->resize(out->size() * 2);
+        zs.next_out = out->data() + zs.total_out;
+        zs.avail_out = (uInt) (out->size() - zs.total_out);
+        ret = inflate(&zs, Z_NO_FLUSH);
+    } while (ret == Z_OK);
+
+    size_t len = zs.total_out;
+    inflateEnd(&zs);
+
+    if (ret != Z_STREAM_END)
+        return true;
+
+    out->resize(len);
+    return false;
+}
+
+// Decode a streamed blob of any supported format into img. Blobs the driver
+// compressed with zlib carry a ".z" suffix on their format. Headerless
+// ".stream" frames are 8- or 16-bit mono at rawSize. Returns true on error.
+static bool DecodeStreamFrame(const CapturedFrame& cf, const wxSize& rawSize, usImage& img)
+{
+    wxString format(cf.m_format);
+    const void *data = cf.m_data;
+    size_t size = cf.m_size;
+
+    std::vector<unsigned char> inflated;
+    wxString base;
+    if (format.EndsWith(".z", &base))
+    {
+        if (InflateBlob(data, size, &inflated))
+        {
+            Debug.Write(wxString::Format("INDI Camera: could not inflate %s blob\n", format));
+            return true;
+        }
+        data = inflated.data();
+        size = inflated.size();
+        format = base;
+    }
+
+    if (format == ".fits" || format == ".fits.fz" || format == ".fz")
+    {
+        if (DecodeFITSBlob(data, size, img))
+        {
+            Debug.Write(wxString::Format("INDI Camera: could not decode %s blob\n", format));
+            return true;
+        }
+        return false;
+    }
+
+    if (format == ".stream")
+    {
+        if (img.Init(rawSize) || !img.NPixels)
+            return true;
+
+        if (size == img.NPixels)
+        {
+            const unsigned char *src = static_cast<const unsigned char *>(data);
+            for (unsigned int i = 0; i < img.NPixels; i++)
+                img.ImageData[i] = src[i];
+            return false;
+        }
+        if (size == img.NPixels * sizeof(unsigned short))
+        {
+            memcpy(img.ImageData, data, size);
+            return false;
+        }
+
+        Debug.Write(wxString::Format("INDI Camera: stream frame size %lu does not match %dx%d\n", (unsigned long) size,
+                                     rawSize.x, rawSize.y));
+        return true;
+    }
+
+    Debug.Write(wxString::Format("INDI Camera: unsupported stream format %s\n", format));
+    return true;
+}
+
+StreamDecoder::StreamDecoder(ExposureCompletion *ready)
+    : m_cond(m_lock), m_active(false), m_stop(false), m_pending(nullptr), m_pendingSeq(0), m_haveDecoded(false), m_dropped(0),
+      m_ready(ready)
+{
+}
+
+StreamDecoder::~StreamDecoder()
+{
+    Stop();
+}
+
+void StreamDecoder::Start(const wxSize& rawSize)
+{
+    wxMutexLocker lck(m_lock);
+
+    m_rawSize = rawSize;
+
+    if (!m_workers.empty())
+        return;
+
+    int ncpu = wxThread::GetCPUCount();
+    int nthreads = wxMax(1, wxMin(ncpu - 1, (int) MAX_THREADS));
+
+    Debug.Write(wxString::Format("INDI Camera: starting %d stream decoder threads\n", nthreads));
+
+    for (int i = 0; i < nthreads; i++)
+    {
+        Worker *worker = new Worker(this);
+        if (worker->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete worker;
+            break;
+        }
+        m_workers.push_back(worker);
+    }
+
+    m_active = !m_workers.empty();
+}
+
+void StreamDecoder::Stop()
+{
+    std::vector<Worker *> workers;
+    {
+        wxMutexLocker lck(m_lock);
+        m_active = false;
+        m_stop = true;
+        workers.swap(m_workers);
+        m_cond.Broadcast();
+    }
+
+    for (Worker *worker : workers)
+    {
+        worker->Wait();
+        delete worker;
+    }
+
+    wxMutexLocker lck(m_lock);
+    m_stop = false;
+    delete m_pending;
+    m_pending = nullptr;
+    m_haveDecoded = false;
+    if (m_dropped)
+    {
+        Debug.Write(wxString::Format("INDI Camera: stream decoder dropped %u stale frames\n", m_dropped));
+        m_dropped = 0;
+    }
+}
+
+void StreamDecoder::Submit(IBLOB *bp)
+{
+    wxMutexLocker lck(m_lock);
+
+    if (!m_active)
+        return;
+
+    if (m_pending)
+    {
+        // decoders are busy, the older frame is stale now
+        delete m_pending;
+        ++m_dropped;
+    }
+
+    m_pending = new CapturedFrame();
+    m_pending->steal(bp);
+    m_pendingSeq = m_seq.Arrived();
+
+    m_cond.Signal();
+}
+
+unsigned int StreamDecoder::CaptureMinSeq()
+{
+    wxMutexLocker lck(m_lock);
+    return m_seq.CaptureMinSeq();
+}
+
+bool StreamDecoder::TakeFrame(unsigned int minSeq, usImage& img)
+{
+    wxMutexLocker lck(m_lock);
+
+    if (!m_haveDecoded || !m_seq.IsUsable(minSeq))
+        return false;
+
+    if (img.Init(m_decoded.Size))
+        return false;
+    img.SwapImageData(m_decoded);
+    m_haveDecoded = false;
+
+    return true;
+}
+
+void StreamDecoder::Run()
+{
+    usImage work;
+
+    while (true)
+    {
+        CapturedFrame *frame;
+        unsigned int seq;
+        wxSize rawSize;
+        {
+            wxMutexLocker lck(m_lock);
+            while (!m_stop && !m_pending)
+                m_cond.Wait();
+            if (m_stop)
+                break;
+            frame = m_pending;
+            m_pending = nullptr;
+            seq = m_pendingSeq;
+            rawSize = m_rawSize;
+        }
+
+        bool err = DecodeStreamFrame(*frame, rawSize, work);
+        delete frame;
+        if (err)
+            continue;
+
+        bool published = false;
+        {
+            wxMutexLocker lck(m_lock);
+            // another worker may have finished a newer frame first
+            if (m_seq.IsNewer(seq) && !m_decoded.Init(work.Size))
+            {
+                m_decoded.SwapImageData(work);
+                m_seq.SetPublished(seq);
+                m_haveDecoded = true;
+                published = true;
+            }
+            else
+                ++m_dropped;
+        }
+
+        if (published)
+            m_ready->Signal();
+    }
+}
+
 bool CameraINDI::ReadFITS(CapturedFrame *frame, usImage& img, bool takeSubframe, const wxRect& subframe)
 {
+    // decode plain images in place, skipping the CFITSIO memfile and
+    // intermediate buffers
+    SimpleFitsImage simple;
+    if (ParseSimpleFITS(frame->m_data, frame->m_size, &simple))
+        return ReadSimpleFITS(simple, img, takeSubframe, subframe);
+
+    if (INDIConfig::Verbose())
+        Debug.Write("INDI Camera: using CFITSIO to read blob\n");
+
     fitsfile *fptr; // FITS file pointer
     int status = 0; // CFITSIO status value MUST be initialized to zero!
 
@@ -971,6 +1573,8 @@ bool CameraINDI::StackStream(CapturedFrame *cf)
 
     stacking = false;
 
+    m_frameReady.Signal();
+
     return false;
 }
 
@@ -991,6 +1595,16 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
     bool takeSubframe = UseSubframes;
     wxRect subframe(subframeArg);
 
+    if (INDICameraStreaming && video_prop && !INDICameraForceExposure)
+    {
+        return CaptureStream(duration, img, options);
+    }
+    else if (m_decoder.IsActive())
+    {
+        // streaming mode was turned off
+        m_decoder.Stop();
+    }
+
     // we can set the exposure time directly in the camera
     if (expose_prop && !INDICameraForceVideo)
     {
@@ -1051,16 +1665,15 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
                 Debug.Write(wxString::Format("INDI Camera Exposure is busy. Waiting\n"));
 
             CameraWatchdog watchdog(duration, GetTimeoutMs());
-            while (true)
+            m_exposeUpdated.Reset();
+            while (expose_prop->s == IPS_BUSY)
             {
-                wxMilliSleep(10);
-                if (expose_prop->s != IPS_BUSY)
-                    break;
+                ExposureCompletion::Result res = m_exposeUpdated.Wait(watchdog, WorkerThread::INT_TERMINATE);
 
-                if (WorkerThread::TerminateRequested())
+                if (res == ExposureCompletion::INTERRUPTED)
                     return true;
 
-                if (watchdog.Expired())
+                if (res == ExposureCompletion::TIMED_OUT)
                 {
                     first_frame = false;
                     DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
@@ -1074,22 +1687,22 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
 
         // Discard any "in between" frames...
         updateLastFrame(nullptr);
+        m_frameReady.Reset();
 
         // set the exposure time, this immediately start the exposure
         expose_prop->np->value = (double) duration / 1000;
         sendNewNumber(expose_prop);
 
-        // responsiveness for ui. Frame availability will be notified immediately
-        unsigned long loopwait = 100;
-
         CameraWatchdog watchdog(duration, GetTimeoutMs());
 
+        // frame arrival and termination requests both wake us immediately
         CapturedFrame *frame = nullptr;
-        while (!(frame = waitFrame(loopwait)))
+        while (!(frame = takeFrame()))
         {
-            if (WorkerThread::TerminateRequested())
+            ExposureCompletion::Result res = m_frameReady.Wait(watchdog, WorkerThread::INT_TERMINATE);
+            if (res == ExposureCompletion::INTERRUPTED)
                 return true;
-            if (watchdog.Expired())
+            if (res == ExposureCompletion::TIMED_OUT)
             {
                 if (first_frame && video_prop && !INDICameraForceExposure)
                 {
@@ -1172,55 +1785,39 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
         img.Clear();
         StackImg = &img;
 
-        // Find INDI switch
-        ISwitch *v_on;
-        ISwitch *v_off;
-        if (has_old_videoprop)
-        {
-            v_on = IUFindSwitch(video_prop, "ON");
-            v_off = IUFindSwitch(video_prop, "OFF");
-        }
-        else
-        {
-            v_on = IUFindSwitch(video_prop, "STREAM_ON");
-            v_off = IUFindSwitch(video_prop, "STREAM_OFF");
-        }
-
         // start streaming if not already active, every video frame is received as a blob
-        if (v_on->s != ISS_ON)
-        {
-            v_on->s = ISS_ON;
-            v_off->s = ISS_OFF;
-            sendNewSwitch(video_prop);
-        }
+        SetVideoStream(true);
 
+        m_frameReady.Reset();
         modal = true;
         stacking = false;
         StackFrames = 0;
 
-        unsigned long loopwait = duration > 100 ? 10 : 1;
         wxStopWatch swatch;
         swatch.Start();
 
-        // wait the required time
+        // wait the required time, re-checking the frame count as each frame is stacked
         while (modal)
         {
-            wxMilliSleep(loopwait);
+            long remaining = duration - swatch.Time();
             // test exposure complete
-            if (swatch.Time() >= duration && StackFrames > 2)
+            if (remaining <= 0 && StackFrames > 2)
+            {
                 modal = false;
+                break;
+            }
             // test termination request, stop streaming before to return
-            if (WorkerThread::TerminateRequested())
+            if (m_frameReady.Wait(remaining > 0 ? remaining : 1000, WorkerThread::INT_TERMINATE) ==
+                ExposureCompletion::INTERRUPTED)
+            {
                 modal = false;
+            }
         }
 
         if (WorkerThread::StopRequested() || WorkerThread::TerminateRequested())
         {
             // Stop video streaming when Stop button is pressed or exiting the program
-            v_on->s = ISS_OFF;
-            v_off->s = ISS_ON;
-            if (video_prop) // can get cleared asynchronously if server disconnects
-                sendNewSwitch(video_prop);
+            SetVideoStream(false);
         }
 
         if (WorkerThread::TerminateRequested())
@@ -1229,7 +1826,7 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
         // wait current frame is processed
         while (stacking)
         {
-            wxMilliSleep(loopwait);
+            m_frameReady.Wait(10, 0);
         }
 
         pFrame->StatusMsg(wxString::Format(_("%d frames"), StackFrames));
@@ -1255,6 +1852,104 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
     }
 }
 
+void CameraINDI::SetVideoStream(bool on)
+{
+    if (!video_prop) // can get cleared asynchronously if server disconnects
+        return;
+
+    // Find INDI switch
+    ISwitch *v_on;
+    ISwitch *v_off;
+    if (has_old_videoprop)
+    {
+        v_on = IUFindSwitch(video_prop, "ON");
+        v_off = IUFindSwitch(video_prop, "OFF");
+    }
+    else
+    {
+        v_on = IUFindSwitch(video_prop, "STREAM_ON");
+        v_off = IUFindSwitch(video_prop, "STREAM_OFF");
+    }
+
+    if ((v_on->s == ISS_ON) != on)
+    {
+        v_on->s = on ? ISS_ON : ISS_OFF;
+        v_off->s = on ? ISS_OFF : ISS_ON;
+        sendNewSwitch(video_prop);
+    }
+}
+
+// Streaming guide mode: the driver sends frames back-to-back at a rate set by
+// the exposure duration, and each capture returns the newest frame that was
+// exposed entirely after the capture was requested, so frames that were
+// exposing while the mount was moving are skipped.
+bool CameraINDI::CaptureStream(int duration, usImage& img, int options)
+{
+    first_frame = false;
+
+    if (binning_prop && Binning != m_curBinning)
+    {
+        SendBinning();
+    }
+
+    // streamed frames are always full frames
+    FullSize.Set(m_maxSize.x / Binning, m_maxSize.y / Binning);
+
+    if (stream_exposure_prop)
+    {
+        INumber *exp = IUFindNumber(stream_exposure_prop, "STREAMING_EXPOSURE_VALUE");
+        double secs = (double) duration / 1000.;
+        if (exp && fabs(exp->value - secs) > 1e-4)
+        {
+            if (INDIConfig::Verbose())
+                Debug.Write(wxString::Format("INDI Camera setting stream exposure to %.3fs\n", secs));
+            exp->value = secs;
+            sendNewNumber(stream_exposure_prop);
+        }
+    }
+
+    m_decoder.Start(FullSize);
+    unsigned int minSeq = m_decoder.CaptureMinSeq();
+
+    SetVideoStream(true);
+
+    CameraWatchdog watchdog(duration, GetTimeoutMs());
+
+    while (!m_decoder.TakeFrame(minSeq, img))
+    {
+        ExposureCompletion::Result res = m_frameReady.Wait(watchdog);
+        if (res == ExposureCompletion::INTERRUPTED)
+        {
+            // Stop video streaming when Stop button is pressed or exiting the program
+            SetVideoStream(false);
+            m_decoder.Stop();
+            return true;
+        }
+        if (res == ExposureCompletion::TIMED_OUT)
+        {
+            SetVideoStream(false);
+            m_decoder.Stop();
+            DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
+            return true;
+        }
+    }
+
+    if (img.Size != FullSize)
+        FullSize = img.Size;
+
+    if (options & CAPTURE_SUBTRACT_DARK)
+        SubtractDark(img);
+    if (HasBayer && Binning == 1 && (options & CAPTURE_RECON))
+        QuickLRecon(img);
+    if (options & CAPTURE_RECON)
+    {
+        if (PixSizeX != PixSizeY)
+            SquarePixels(img, PixSizeX, PixSizeY);
+    }
+
+    return false;
+}
+
 bool CameraINDI::HasNonGuiCapture()
 {
     return true;
@@ -62,10 +62,10 @@ struct OgmaCam
     wxByte m_curBin;
     bool m_started;
     unsigned int m_captureResult;
-    wxMutex m_lock;
-    wxCondition m_cond;
+    wxMutex m_lock; // protects m_captureResult
+    ExposureCompletion m_captureDone;
 
-    OgmaCam() : m_h(nullptr), m_buffer(nullptr), m_tmpbuf(nullptr), m_started(false), m_cond(m_lock) { }
+    OgmaCam() : m_h(nullptr), m_buffer(nullptr), m_tmpbuf(nullptr), m_started(false) { }
 
     ~OgmaCam()
     {
@@ -106,7 +106,7 @@ struct OgmaCam
                 wxMutexLocker lck(cam->m_lock);
                 cam->m_captureResult = event;
             }
-            cam->m_cond.Broadcast();
+            cam->m_captureDone.Signal();
             break;
         default:
             // ignore other events
@@ -579,6 +579,7 @@ bool CameraOgma::Capture(int duration, usImage& img, int options, const wxRect&
         wxMutexLocker lck(m_cam.m_lock);
         m_cam.m_captureResult = 0;
     }
+    m_cam.m_captureDone.Reset();
 
     m_cam.StartCapture();
 
@@ -589,13 +590,8 @@ bool CameraOgma::Capture(int duration, usImage& img, int options, const wxRect&
     // "The timeout is recommended for not less than (Exposure Time * 102% + 8 Seconds)."
     CameraWatchdog watchdog(duration * 102 / 100, GetTimeoutMs());
 
-    { // lock scope
-        wxMutexLocker lck(m_cam.m_lock);
-        while (m_cam.m_captureResult == 0 && !WorkerThread::InterruptRequested() && !watchdog.Expired())
-        {
-            m_cam.m_cond.WaitTimeout(200);
-        }
-    } // lock scope
+    // the callback stores m_captureResult before signaling
+    m_cam.m_captureDone.Wait(watchdog);
 
     if (m_cam.m_captureResult != OGMACAM_EVENT_IMAGE)
     {
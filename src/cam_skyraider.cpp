@@ -51,7 +51,7 @@ struct SkyraiderCamera : public GuideCamera
     int m_minGain;
     int m_maxGain;
     int m_defaultGainPct;
-    volatile bool m_frameReady;
+    ExposureCompletion m_frameReady;
     int m_cameraId;
     wxRect m_maxSize;
     MallincamGuider m_Guider;
@@ -228,7 +228,7 @@ bool SkyraiderCamera::Capture(int duration, usImage& img, int options, const wxR
     if (!m_capturing)
     {
         Debug.Write("SKYRAIDER: startcapture\n");
-        m_frameReady = false;
+        m_frameReady.Reset();
 # ifdef USE_PUSH_MODE
         m_Guider.Mallincam_StartPushMode(m_Guider.m_Hmallincam, CameraPushDataCallback, this);
 # else
@@ -237,8 +237,6 @@ bool SkyraiderCamera::Capture(int duration, usImage& img, int options, const wxR
         m_capturing = true;
     }
 
-    int poll = wxMin(duration, 100);
-
     CameraWatchdog watchdog(duration, duration + GetTimeoutMs() + 10000); // total timeout is 2 * duration + 15s (typically)
 
     // do not wait here, as we will miss a frame most likely, leading to poor flow of frames.
@@ -250,26 +248,26 @@ bool SkyraiderCamera::Capture(int duration, usImage& img, int options, const wxR
 
     while (true)
     {
-        if (m_frameReady)
+        ExposureCompletion::Result res = m_frameReady.Wait(watchdog);
+        if (res == ExposureCompletion::COMPLETED)
         {
             if (verbose)
                 Debug.Write("SKYRAIDER: frame is ready, pull image\n");
-            m_frameReady = false;
             int result = m_Guider.Mallincam_PullImage(m_Guider.m_Hmallincam, m_buffer, 8, &width, &height);
             if (verbose)
-                Debug.Write(wxString::Format("SKYRAIDER: pull image ret %d\n", res));
+                Debug.Write(wxString::Format("SKYRAIDER: pull image ret %d\n", result));
             if (result == MC_SUCCESS)
                 break;
+            continue;
         }
-        WorkerThread::MilliSleep(poll, WorkerThread::INT_ANY);
-        if (WorkerThread::InterruptRequested())
+        if (res == ExposureCompletion::INTERRUPTED)
         {
             if (verbose)
                 Debug.Write("SKYRAIDER: interrupt requested\n");
             StopCapture();
             return true;
         }
-        if (watchdog.Expired())
+        else // timed out
         {
             Debug.Write("SKYRAIDER: watchdog expired\n");
             StopCapture();
@@ -302,7 +300,7 @@ void SkyraiderCamera::FrameReady()
 {
     if (verbose)
         Debug.Write("SKYRAIDER: frameready callback\n");
-    m_frameReady = true;
+    m_frameReady.Signal();
 }
 
 wxByte SkyraiderCamera::BitsPerPixel()
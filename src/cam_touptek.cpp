@@ -63,10 +63,10 @@ struct ToupCam
     wxByte m_curBin;
     bool m_started;
     unsigned int m_captureResult;
-    wxMutex m_lock;
-    wxCondition m_cond;
+    wxMutex m_lock; // protects m_captureResult
+    ExposureCompletion m_captureDone;
 
-    ToupCam() : m_h(nullptr), m_buffer(nullptr), m_tmpbuf(nullptr), m_started(false), m_cond(m_lock) { }
+    ToupCam() : m_h(nullptr), m_buffer(nullptr), m_tmpbuf(nullptr), m_started(false) { }
 
     ~ToupCam()
     {
@@ -107,7 +107,7 @@ struct ToupCam
                 wxMutexLocker lck(cam->m_lock);
                 cam->m_captureResult = event;
             }
-            cam->m_cond.Broadcast();
+            cam->m_captureDone.Signal();
             break;
         default:
             // ignore other events
@@ -580,6 +580,7 @@ bool CameraToupTek::Capture(int duration, usImage& img, int options, const wxRec
         wxMutexLocker lck(m_cam.m_lock);
         m_cam.m_captureResult = 0;
     }
+    m_cam.m_captureDone.Reset();
 
     m_cam.StartCapture();
 
@@ -590,13 +591,8 @@ bool CameraToupTek::Capture(int duration, usImage& img, int options, const wxRec
     // "The timeout is recommended for not less than (Exposure Time * 102% + 8 Seconds)."
     CameraWatchdog watchdog(duration * 102 / 100, GetTimeoutMs());
 
-    { // lock scope
-        wxMutexLocker lck(m_cam.m_lock);
-        while (m_cam.m_captureResult == 0 && !WorkerThread::InterruptRequested() && !watchdog.Expired())
-        {
-            m_cam.m_cond.WaitTimeout(200);
-        }
-    } // lock scope
+    // the callback stores m_captureResult before signaling
+    m_cam.m_captureDone.Wait(watchdog);
 
     if (m_cam.m_captureResult != TOUPCAM_EVENT_IMAGE)
     {
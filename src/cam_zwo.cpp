@@ -883,7 +883,7 @@ bool Camera_ZWO::Capture(int duration, usImage& img, int options, const wxRect&
                     break; // failed, retry exposure
                 }
                 // ASI_EXP_WORKING
-                wxMilliSleep(poll);
+                WorkerThread::MilliSleep(poll, WorkerThread::INT_ANY);
                 if (WorkerThread::InterruptRequested())
                 {
                     StopExposure();
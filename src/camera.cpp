@@ -44,6 +44,7 @@
 static const int DefaultGuideCameraGain = 95;
 static const int DefaultGuideCameraTimeoutMs = 15000;
 static const bool DefaultUseSubframes = false;
+static const int MaxSoftwareBinning = 4;
 static const int DefaultReadDelay = 150;
 
 const double GuideCamera::UnknownPixelSize = 0.0;
@@ -223,6 +224,13 @@ GuideCamera::GuideCamera()
     m_pixelSize = GetProfilePixelSize();
     MaxBinning = 1;
     Binning = pConfig->Profile.GetInt("/camera/binning", 1);
+    SoftwareBinning = wxMax(1, wxMin(pConfig->Profile.GetInt("/camera/SoftwareBinning", 1), MaxSoftwareBinning));
+    SoftwareBinningMedian = pConfig->Profile.GetBoolean("/camera/SoftwareBinningMedian", false);
+    int debayer = pConfig->Profile.GetInt("/camera/DebayerMethod", DEBAYER_SLIDING_2X2);
+    Debayer =
+        debayer >= DEBAYER_SLIDING_2X2 && debayer <= DEBAYER_SUPERPIXEL ? (DebayerMethod) debayer : DEBAYER_SLIDING_2X2;
+    int pattern = pConfig->Profile.GetInt("/camera/BayerPattern", BAYER_RGGB);
+    Pattern = pattern >= BAYER_RGGB && pattern <= BAYER_GBRG ? (BayerPattern) pattern : BAYER_RGGB;
     CurrentDarkFrame = nullptr;
     CurrentDefectMap = nullptr;
 }
@@ -708,6 +716,30 @@ bool GuideCamera::SetBinning(int binning)
     return false;
 }
 
+bool GuideCamera::SetSoftwareBinning(int binning, bool median)
+{
+    binning = wxMax(1, wxMin(binning, MaxSoftwareBinning));
+
+    Debug.Write(wxString::Format("camera: set software binning = %d%s\n", binning, median ? " (median)" : ""));
+
+    SoftwareBinning = binning;
+    SoftwareBinningMedian = median;
+    pConfig->Profile.SetInt("/camera/SoftwareBinning", binning);
+    pConfig->Profile.SetBoolean("/camera/SoftwareBinningMedian", median);
+
+    return false;
+}
+
+void GuideCamera::SetDebayer(DebayerMethod method, BayerPattern pattern)
+{
+    Debug.Write(wxString::Format("camera: set debayer method = %d, pattern = %d\n", method, pattern));
+
+    Debayer = method;
+    Pattern = pattern;
+    pConfig->Profile.SetInt("/camera/DebayerMethod", method);
+    pConfig->Profile.SetInt("/camera/BayerPattern", pattern);
+}
+
 void GuideCamera::SetTimeoutMs(int ms)
 {
     static const int MIN_TIMEOUT_MS = 5000;
@@ -842,6 +874,8 @@ void CameraConfigDialogPane::LayoutControls(GuideCamera *pCamera, BrainCtrlIdMap
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szGain));
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szCameraTimeout));
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szBinning));
+        pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szSoftwareBinning));
+        pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szDebayer));
         pDetailsSizer->Add(GetSingleCtrl(CtrlMap, AD_cbUseSubFrames), wxSizerFlags().Border(wxTOP, 3));
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szCooler));
         if (pCamera->HasDelayParam)
@@ -924,6 +958,55 @@ CameraConfigDialogCtrlSet::CameraConfigDialogCtrlSet(wxWindow *pParent, GuideCam
     m_binning = new wxChoice(GetParentWindow(AD_szBinning), wxID_ANY, wxDefaultPosition, wxSize(width + 35, -1), opts);
     AddLabeledCtrl(CtrlMap, AD_szBinning, _("Binning"), m_binning, _("Camera pixel binning"));
 
+    // Software binning
+    parent = GetParentWindow(AD_szSoftwareBinning);
+    wxArrayString swOpts;
+    swOpts.Add(_("None"));
+    for (int i = 2; i <= MaxSoftwareBinning; i++)
+        swOpts.Add(wxString::Format("%dx%d", i, i));
+    width = StringArrayWidth(swOpts);
+    m_swBinning = new wxChoice(parent, wxID_ANY, wxDefaultPosition, wxSize(width + 35, -1), swOpts);
+    m_swBinning->SetToolTip(_("Bin the camera frames in PHD2. This works with any camera and reduces the "
+                              "processing time for very high resolution guide cameras. It is applied on top of "
+                              "the camera binning."));
+    m_swBinningMedian = new wxCheckBox(parent, wxID_ANY, _("Median"));
+    m_swBinningMedian->SetToolTip(_("Use the median of each block of pixels instead of the mean. Slower, but "
+                                    "suppresses hot pixels and cosmic ray hits."));
+    sizer = new wxBoxSizer(wxHORIZONTAL);
+    sizer->Add(new wxStaticText(parent, wxID_ANY, _("Software binning") + _(": ")),
+               wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL));
+    sizer->Add(m_swBinning, wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL));
+    sizer->Add(m_swBinningMedian, wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL).Border(wxLEFT));
+    AddGroup(CtrlMap, AD_szSoftwareBinning, sizer);
+
+    // Debayer, order of the choices matches enum DebayerMethod and enum BayerPattern
+    parent = GetParentWindow(AD_szDebayer);
+    wxArrayString debayerOpts;
+    debayerOpts.Add(_("2x2 average"));
+    debayerOpts.Add(_("Bilinear"));
+    debayerOpts.Add(_("Superpixel"));
+    width = StringArrayWidth(debayerOpts);
+    m_debayer = new wxChoice(parent, wxID_ANY, wxDefaultPosition, wxSize(width + 35, -1), debayerOpts);
+    m_debayer->SetToolTip(_("How a color camera's image is converted to luminance. Bilinear keeps the star profiles "
+                            "sharpest, Superpixel has the lowest noise, 2x2 average is the default and the method used "
+                            "by earlier versions of PHD2. The 2x2 mean noise reduction option always uses the 2x2 "
+                            "average, whatever is selected here."));
+    wxArrayString patternOpts;
+    patternOpts.Add("RGGB");
+    patternOpts.Add("BGGR");
+    patternOpts.Add("GRBG");
+    patternOpts.Add("GBRG");
+    width = StringArrayWidth(patternOpts);
+    m_bayerPattern = new wxChoice(parent, wxID_ANY, wxDefaultPosition, wxSize(width + 35, -1), patternOpts);
+    m_bayerPattern->SetToolTip(_("Color filter layout of the sensor, as given in the camera specifications. Only "
+                                 "used by the Bilinear method."));
+    sizer = new wxBoxSizer(wxHORIZONTAL);
+    sizer->Add(new wxStaticText(parent, wxID_ANY, _("Debayer") + _(": ")),
+               wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL));
+    sizer->Add(m_debayer, wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL));
+    sizer->Add(m_bayerPattern, wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL).Border(wxLEFT));
+    AddGroup(CtrlMap, AD_szDebayer, sizer);
+
     // Delay parameter
     if (m_pCamera->HasDelayParam)
     {
@@ -1032,6 +1115,17 @@ void CameraConfigDialogCtrlSet::LoadValues()
     else
         m_binning->Enable(false);
 
+    m_swBinning->Select(m_pCamera->SoftwareBinning - 1);
+    m_swBinningMedian->SetValue(m_pCamera->SoftwareBinningMedian);
+    // the dark library and defect map are at the binned scale, so like the camera
+    // binning this cannot change during calibration or guiding
+    bool swBinEnable = !pFrame->pGuider || !pFrame->pGuider->IsCalibratingOrGuiding();
+    m_swBinning->Enable(swBinEnable);
+    m_swBinningMedian->Enable(swBinEnable);
+
+    m_debayer->Select(m_pCamera->Debayer);
+    m_bayerPattern->Select(m_pCamera->Pattern);
+
     m_timeoutVal->SetValue(m_pCamera->GetTimeoutMs() / 1000);
 
     bool saturationByADU = m_pCamera->IsSaturationByADU();
@@ -1203,6 +1297,13 @@ void CameraConfigDialogCtrlSet::UnloadValues()
         m_pCamera->SetBinning(m_binning->GetSelection() + 1);
     }
 
+    int swBin = m_swBinning->GetSelection() + 1;
+    if (swBin != m_pCamera->SoftwareBinning)
+        pFrame->pAdvancedDialog->FlagImageScaleChange();
+    m_pCamera->SetSoftwareBinning(swBin, m_swBinningMedian->GetValue());
+
+    m_pCamera->SetDebayer((DebayerMethod) m_debayer->GetSelection(), (BayerPattern) m_bayerPattern->GetSelection());
+
     m_pCamera->SetTimeoutMs(m_timeoutVal->GetValue() * 1000);
 
     if (m_pCamera->HasDelayParam)
@@ -1287,15 +1388,19 @@ void CameraConfigDialogCtrlSet::SetPixelSize(double val)
     m_pPixelSize->SetValue(val);
 }
 
+// binning values exchanged with the rest of the advanced dialog are the total
+// (hardware times software) binning, as that is what determines the image scale
 int CameraConfigDialogCtrlSet::GetBinning()
 {
-    return m_binning ? m_binning->GetSelection() + 1 : 1;
+    int hwBin = m_binning ? m_binning->GetSelection() + 1 : 1;
+    return hwBin * (m_swBinning->GetSelection() + 1);
 }
 
 void CameraConfigDialogCtrlSet::SetBinning(int binning)
 {
+    int swBin = m_swBinning->GetSelection() + 1;
     if (m_binning)
-        m_binning->Select(binning - 1);
+        m_binning->Select(wxMin(wxMax(binning / swBin, 1), (int) m_binning->GetCount()) - 1);
 }
 
 void GuideCamera::GetBinningOpts(int maxBin, wxArrayString *opts)
@@ -1320,11 +1425,15 @@ wxString GuideCamera::GetSettingsSummary()
     else
         pixelSizeStr = wxString::Format(_("%0.1f um"), m_pixelSize);
 
-    return wxString::Format("Camera = %s%s%s%s, full size = %d x %d, %s, %s, pixel size = %s\n", Name,
+    return wxString::Format("Camera = %s%s%s%s, full size = %d x %d%s, %s, %s, pixel size = %s\n", Name,
                             HasGainControl ? wxString::Format(", gain = %d", GuideCameraGain) : "",
                             HasDelayParam ? wxString::Format(", delay = %d", ReadDelay) : "",
                             HasPortNum ? wxString::Format(", port = 0x%hx", Port) : "", FullSize.GetWidth(),
-                            FullSize.GetHeight(), darkDur ? wxString::Format("have dark, dark dur = %d", darkDur) : "no dark",
+                            FullSize.GetHeight(),
+                            SoftwareBinning > 1 ? wxString::Format(", software binning = %d%s", SoftwareBinning,
+                                                                   SoftwareBinningMedian ? " median" : "")
+                                                : "",
+                            darkDur ? wxString::Format("have dark, dark dur = %d", darkDur) : "no dark",
                             CurrentDefectMap ? "defect map in use" : "no defect map", pixelSizeStr);
 }
 
@@ -1423,6 +1532,8 @@ void GuideCamera::ClearDarks()
 
 void GuideCamera::SubtractDark(usImage& img)
 {
+    PipelineTimer timer(PIPELINE_DARK);
+
     // dark subtraction is done in the camera worker thread, so we need to acquire the
     // DarkFrameLock to protect against the dark frame disappearing when the main
     // thread does "Load Darks" or "Clear Darks"
@@ -1507,10 +1618,48 @@ bool GuideCamera::Capture(GuideCamera *camera, int duration, usImage& img, int c
     img.InitImgStartTime();
     img.BitsPerPixel = camera->BitsPerPixel();
     img.ImgExpDur = duration;
-    bool err = camera->Capture(duration, img, captureOptions, subframe);
+    unsigned int const swBin = camera->SoftwareBinning;
+    bool err = swBin > 1 ? camera->CaptureBinned(swBin, duration, img, captureOptions, subframe)
+                         : camera->Capture(duration, img, captureOptions, subframe);
     return err;
 }
 
+// Software binning stage: the driver captures at its own resolution into a scratch frame
+// which is then binned into img. The subframe is scaled up for the driver and back down
+// by the binning. Dark subtraction and defect removal are deferred until after binning
+// because the dark library and defect map are built from binned frames.
+bool GuideCamera::CaptureBinned(unsigned int binning, int duration, usImage& img, int captureOptions,
+                                const wxRect& subframe)
+{
+    usImage& raw = m_unbinnedFrame;
+    raw.ImgStartTime = img.ImgStartTime;
+    raw.BitsPerPixel = img.BitsPerPixel;
+    raw.ImgExpDur = duration;
+    raw.ImgStackCnt = 1;
+    raw.Pedestal = 0;
+
+    wxRect rawSubframe(0, 0, 0, 0);
+    if (!subframe.IsEmpty())
+    {
+        rawSubframe =
+            wxRect(subframe.x * binning, subframe.y * binning, subframe.width * binning, subframe.height * binning);
+    }
+
+    if (Capture(duration, raw, captureOptions & ~CAPTURE_SUBTRACT_DARK, rawSubframe))
+        return true;
+
+    if (BinImage(img, raw, binning, SoftwareBinningMedian))
+    {
+        DisconnectWithAlert(CAPT_FAIL_MEMORY);
+        return true;
+    }
+
+    if (captureOptions & CAPTURE_SUBTRACT_DARK)
+        SubtractDark(img);
+
+    return false;
+}
+
 bool GuideCamera::ST4HasGuideOutput()
 {
     return m_hasGuideOutput;
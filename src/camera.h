@@ -72,6 +72,10 @@ class CameraConfigDialogCtrlSet : public ConfigDialogCtrlSet
     wxSpinCtrl *m_pDelay;
     wxSpinCtrlDouble *m_pPixelSize;
     wxChoice *m_binning;
+    wxChoice *m_swBinning;
+    wxCheckBox *m_swBinningMedian;
+    wxChoice *m_debayer;
+    wxChoice *m_bayerPattern;
     wxCheckBox *m_coolerOn;
     wxSpinCtrl *m_coolerSetpt;
     wxTextCtrl *m_camSaturationADU;
@@ -104,12 +108,32 @@ enum CaptureOptionBits
     CAPTURE_BPM_REVIEW = CAPTURE_SUBTRACT_DARK,
 };
 
+// color filter array layout, named by the top-left 2x2 cell of the sensor
+enum BayerPattern
+{
+    BAYER_RGGB,
+    BAYER_BGGR,
+    BAYER_GRBG,
+    BAYER_GBRG,
+};
+
+// how luminance is reconstructed from a color sensor
+enum DebayerMethod
+{
+    DEBAYER_SLIDING_2X2, // mean of a sliding 2x2 window, the original PHD2 method
+    DEBAYER_BILINEAR, // bilinear color interpolation, keeps full resolution
+    DEBAYER_SUPERPIXEL, // mean of each 2x2 cell, lowest noise
+};
+
 class GuideCamera : public wxMessageBoxProxy, public OnboardST4
 {
     friend class CameraConfigDialogPane;
     friend class CameraConfigDialogCtrlSet;
 
     double m_pixelSize;
+    usImage m_unbinnedFrame; // frame from the driver awaiting software binning
+
+    bool CaptureBinned(unsigned int binning, int duration, usImage& img, int captureOptions, const wxRect& subframe);
 
 protected:
     bool m_hasGuideOutput;
@@ -137,6 +161,10 @@ public:
     bool ShutterClosed; // false=light, true=dark
     bool UseSubframes;
     bool HasCooler;
+    wxByte SoftwareBinning; // binning done by PHD2 on the frames the driver delivers, 1 = none
+    bool SoftwareBinningMedian; // software binning takes the median of each block instead of the mean
+    DebayerMethod Debayer; // luminance reconstruction used for color sensors
+    BayerPattern Pattern; // color filter layout, drivers do not report it so it is a profile setting
 
     wxCriticalSection DarkFrameLock; // dark frames can be accessed in the main thread or the camera worker thread
     usImage *CurrentDarkFrame;
@@ -181,6 +209,10 @@ public:
     static void GetBinningOpts(int maxBin, wxArrayString *opts);
     void GetBinningOpts(wxArrayString *opts);
     bool SetBinning(int binning);
+    bool SetSoftwareBinning(int binning, bool median);
+    void SetDebayer(DebayerMethod method, BayerPattern pattern);
+    unsigned int TotalBinning() const;
+    wxSize FrameSize() const;
 
     virtual void ShowPropertyDialog() { return; }
     bool SetCameraPixelSize(double pixel_size);
@@ -202,7 +234,9 @@ public:
     void SubtractDark(usImage& img);
     void GetDarklibProperties(int *pNumDarks, double *pMinExp, double *pMaxExp);
 
-    virtual const wxSize& DarkFrameSize() { return FullSize; }
+    // size of the raw frames the driver delivers, before any software binning
+    virtual wxSize NativeDarkFrameSize() const { return FullSize; }
+    wxSize DarkFrameSize() const;
 
     static double GetProfilePixelSize();
 
@@ -246,6 +280,29 @@ inline void GuideCamera::GetBinningOpts(wxArrayString *opts)
     GetBinningOpts(MaxBinning, opts);
 }
 
+// binning factor relating guide frame pixels to sensor pixels, hardware and software combined
+inline unsigned int GuideCamera::TotalBinning() const
+{
+    return (unsigned int) Binning * SoftwareBinning;
+}
+
+// size of the guide frames, after any software binning
+inline wxSize GuideCamera::FrameSize() const
+{
+    if (SoftwareBinning > 1)
+        return wxSize(FullSize.GetWidth() / SoftwareBinning, FullSize.GetHeight() / SoftwareBinning);
+    return FullSize;
+}
+
+// size of the dark frames, which go through the same software binning as the guide frames
+inline wxSize GuideCamera::DarkFrameSize() const
+{
+    wxSize size = NativeDarkFrameSize();
+    if (SoftwareBinning > 1)
+        return wxSize(size.GetWidth() / SoftwareBinning, size.GetHeight() / SoftwareBinning);
+    return size;
+}
+
 inline double GuideCamera::GetCameraPixelSize() const
 {
     return m_pixelSize;
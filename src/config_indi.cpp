@@ -131,6 +131,7 @@ INDIConfig::INDIConfig(wxWindow *parent, const wxString& title, IndiDevType devt
 
     forcevideo = nullptr;
     forceexposure = nullptr;
+    streaming = nullptr;
     if (dev_type == INDI_TYPE_CAMERA)
     {
         ++pos;
@@ -143,6 +144,12 @@ INDIConfig::INDIConfig(wxWindow *parent, const wxString& title, IndiDevType devt
         forceexposure = new wxCheckBox(this, wxID_ANY, _("Camera does not support streaming"));
         forceexposure->SetToolTip(_("Force the use of exposure time for cameras that do not support streaming."));
         gbs->Add(forceexposure, POS(pos, 0), SPAN(1, 2), sizerTextFlags, border);
+
+        ++pos;
+        streaming = new wxCheckBox(this, wxID_ANY, _("Stream frames continuously"));
+        streaming->SetToolTip(_("Keep the camera streaming and guide on the newest frame instead of requesting an "
+                                "exposure for each frame. Reduces latency for cameras on a remote INDI server."));
+        gbs->Add(streaming, POS(pos, 0), SPAN(1, 2), sizerTextFlags, border);
     }
 
     ++pos;
@@ -196,6 +203,8 @@ void INDIConfig::UpdateControlStates()
             forcevideo->Enable(true);
             forceexposure->SetValue(INDIForceExposure);
             forceexposure->Enable(!INDIForceVideo);
+            streaming->SetValue(INDIStreaming);
+            streaming->Enable(true);
         }
         guiBtn->Enable(true);
 
@@ -219,6 +228,8 @@ void INDIConfig::UpdateControlStates()
             forcevideo->Enable(false);
             forceexposure->SetValue(false);
             forceexposure->Enable(false);
+            streaming->SetValue(false);
+            streaming->Enable(false);
         }
         guiBtn->Enable(false);
         okBtn->Enable(false);
@@ -450,6 +461,7 @@ void INDIConfig::SaveSettings()
     {
         INDIForceVideo = forcevideo->GetValue();
         INDIForceExposure = forceexposure->GetValue();
+        INDIStreaming = streaming->GetValue();
         INDIDevCCD = ccd->GetSelection();
     }
 }
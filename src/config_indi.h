@@ -68,6 +68,7 @@ class INDIConfig : public wxDialog, public INDI::BaseClient
     wxComboBox *ccd;
     wxCheckBox *forcevideo;
     wxCheckBox *forceexposure;
+    wxCheckBox *streaming;
     wxButton *guiBtn;
     wxButton *okBtn;
 
@@ -84,6 +85,7 @@ public:
     long INDIDevCCD;
     bool INDIForceVideo;
     bool INDIForceExposure;
+    bool INDIStreaming;
 
     void Connect();
     void Disconnect();
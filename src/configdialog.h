@@ -72,6 +72,8 @@ enum BRAIN_CTRL_IDS
     AD_szDelay,
     AD_szPort,
     AD_szBinning,
+    AD_szSoftwareBinning,
+    AD_szDebayer,
     AD_szCooler,
     AD_CAMERA_TAB_BOUNDARY, // ------ end of camera tab controls
 
@@ -102,6 +104,7 @@ enum BRAIN_CTRL_IDS
     AD_szBumpPercentage,
     AD_szBumpSteps,
     AD_cbBumpOnDither,
+    AD_cbAOFastLoop,
     AD_szBumpBLCompCtrls,
     AD_cbClearAOCalibration,
     AD_cbEnableAOGuiding,
@@ -1691,7 +1691,7 @@ static void get_camera_binning(JObj& response, const json_value *params)
 {
     if (pCamera && pCamera->Connected)
     {
-        int binning = pCamera->Binning;
+        int binning = pCamera->TotalBinning();
         response << jrpc_result(binning);
     }
     else
@@ -1702,7 +1702,7 @@ static void get_camera_frame_size(JObj& response, const json_value *params)
 {
     if (pCamera && pCamera->Connected)
     {
-        response << jrpc_result(pCamera->FullSize);
+        response << jrpc_result(pCamera->FrameSize());
     }
     else
         response << jrpc_error(1, "camera not connected");
@@ -1914,6 +1914,39 @@ static void get_variable_delay_settings(JObj& response, const json_value *params
     response << jrpc_result(rslt);
 }
 
+static void get_pipeline_stats(JObj& response, const json_value *params)
+{
+    Params p("reset", params);
+    const json_value *val = p.param("reset");
+    bool reset = false;
+    if (val && !bool_param(val, &reset))
+    {
+        response << jrpc_error(JSONRPC_INVALID_PARAMS, "expected reset boolean param");
+        return;
+    }
+
+    // times are in microseconds; percentiles are the upper bounds of power-of-two buckets
+    JObj stages;
+    for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+    {
+        PipelineStats::StageSummary s = PipelineTiming.GetSummary((PipelineStage) i);
+        JObj stage;
+        stage << NV("count", s.count) << NV("last_us", (double) s.lastUs, 0) << NV("mean_us", s.meanUs, 0)
+              << NV("p50_us", (double) s.p50Us, 0) << NV("p90_us", (double) s.p90Us, 0)
+              << NV("p99_us", (double) s.p99Us, 0) << NV("max_us", (double) s.maxUs, 0);
+        stages << NV(PipelineStats::StageName((PipelineStage) i), stage);
+    }
+
+    JObj rslt;
+    rslt << NV("frames", PipelineTiming.FrameCount()) << NV("spikes", PipelineTiming.SpikeCount())
+         << NV("stages", stages);
+
+    if (reset)
+        PipelineTiming.Reset();
+
+    response << jrpc_result(rslt);
+}
+
 // set_variable_delay values are in units of seconds to match the UI convention in the Advanced Settings dialog
 static void set_variable_delay_settings(JObj& response, const json_value *params)
 {
@@ -2412,7 +2445,8 @@ static bool handle_request(JRpcCall& call)
                         &export_config_settings,
                     },
                     { "get_variable_delay_settings", &get_variable_delay_settings },
-                    { "set_variable_delay_settings", &set_variable_delay_settings } };
+                    { "set_variable_delay_settings", &set_variable_delay_settings },
+                    { "get_pipeline_stats", &get_pipeline_stats } };
 
     for (unsigned int i = 0; i < WXSIZEOF(methods); i++)
     {
@@ -51,6 +51,10 @@
 # include <wx/txtstrm.h>
 # include <wx/tokenzr.h>
 
+# include <algorithm>
+# include <functional>
+# include <vector>
+
 # define SIMMODE 3 // 1=FITS, 2=BMP, 3=Generate
 // #define SIMDEBUG
 
@@ -86,6 +90,9 @@ struct SimCamParams
     static double comet_rate_y;
     static bool allow_async_st4;
     static unsigned int frame_download_ms;
+    static unsigned int seed;
+    static bool virtual_clock;
+    static unsigned int render_threads;
 };
 
 unsigned int SimCamParams::width = 752; // simulated camera image width
@@ -116,6 +123,9 @@ double SimCamParams::comet_rate_x;
 double SimCamParams::comet_rate_y;
 bool SimCamParams::allow_async_st4 = true;
 unsigned int SimCamParams::frame_download_ms; // frame download time, ms
+unsigned int SimCamParams::seed; // random seed for noise and seeing, 0 = seed from the clock
+bool SimCamParams::virtual_clock; // advance simulated time by exposure time instead of sleeping
+unsigned int SimCamParams::render_threads; // threads used to render large frames, 0 = one per cpu
 
 // Note: these are all in units appropriate for the UI
 # define NR_STARS_DEFAULT 20
@@ -146,6 +156,14 @@ unsigned int SimCamParams::frame_download_ms; // frame download time, ms
 # define COMET_RATE_X_DEFAULT 555.0 // pixels per hour
 # define COMET_RATE_Y_DEFAULT -123.4 // pixels per hour
 # define SIM_FILE_DISPLACEMENTS_DEFAULT "star_displacements.csv"
+# define SENSOR_WIDTH_DEFAULT 752
+# define SENSOR_HEIGHT_DEFAULT 580
+# define SENSOR_SIZE_MIN 128
+# define SENSOR_SIZE_MAX 12000
+# define SENSOR_PIXELS_MAX 60000000 // 60 MP
+# define SEED_DEFAULT 0
+# define VIRTUAL_CLOCK_DEFAULT false
+# define RENDER_THREADS_DEFAULT 0
 
 // Needed to handle legacy registry values that may no longer be in correct units or range
 static double range_check(double thisval, double minval, double maxval)
@@ -189,6 +207,17 @@ static void load_sim_params()
     SimCamParams::comet_rate_y = pConfig->Profile.GetDouble("/SimCam/comet_rate_y", COMET_RATE_Y_DEFAULT);
 
     SimCamParams::frame_download_ms = pConfig->Profile.GetInt("/SimCam/frame_download_ms", 50);
+
+    SimCamParams::width = (unsigned int) range_check(pConfig->Profile.GetInt("/SimCam/width", SENSOR_WIDTH_DEFAULT),
+                                                     SENSOR_SIZE_MIN, SENSOR_SIZE_MAX);
+    SimCamParams::height = (unsigned int) range_check(pConfig->Profile.GetInt("/SimCam/height", SENSOR_HEIGHT_DEFAULT),
+                                                      SENSOR_SIZE_MIN, SENSOR_SIZE_MAX);
+    if ((double) SimCamParams::width * SimCamParams::height > SENSOR_PIXELS_MAX)
+        SimCamParams::height = SENSOR_PIXELS_MAX / SimCamParams::width;
+    SimCamParams::seed = (unsigned int) pConfig->Profile.GetInt("/SimCam/seed", SEED_DEFAULT);
+    SimCamParams::virtual_clock = pConfig->Profile.GetBoolean("/SimCam/virtual_clock", VIRTUAL_CLOCK_DEFAULT);
+    SimCamParams::render_threads =
+        (unsigned int) range_check(pConfig->Profile.GetInt("/SimCam/render_threads", RENDER_THREADS_DEFAULT), 0, 64);
 }
 
 static void save_sim_params()
@@ -214,6 +243,11 @@ static void save_sim_params()
     pConfig->Profile.SetDouble("/SimCam/comet_rate_x", SimCamParams::comet_rate_x);
     pConfig->Profile.SetDouble("/SimCam/comet_rate_y", SimCamParams::comet_rate_y);
     pConfig->Profile.SetInt("/SimCam/frame_download_ms", SimCamParams::frame_download_ms);
+    pConfig->Profile.SetInt("/SimCam/width", SimCamParams::width);
+    pConfig->Profile.SetInt("/SimCam/height", SimCamParams::height);
+    pConfig->Profile.SetInt("/SimCam/seed", SimCamParams::seed);
+    pConfig->Profile.SetBoolean("/SimCam/virtual_clock", SimCamParams::virtual_clock);
+    pConfig->Profile.SetInt("/SimCam/render_threads", SimCamParams::render_threads);
 }
 
 # ifdef STEPGUIDER_SIMULATOR
@@ -536,6 +570,110 @@ struct Cooler
     }
 };
 
+// Small, fast PRNG (splitmix64). Each simulated frame gets its own stream derived from the
+// session seed and the frame number so that runs with a fixed seed are reproducible.
+struct SimRng
+{
+    unsigned long long state;
+
+    SimRng(unsigned long long seed) : state(seed) { }
+
+    unsigned long long Next()
+    {
+        unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // uniform in (0, 1]
+    double Uniform() { return ((Next() >> 11) + 1) * (1.0 / 9007199254740992.0); }
+
+    // uniform integer in [0, n)
+    unsigned int Below(unsigned int n) { return (unsigned int) (((Next() >> 32) * n) >> 32); }
+};
+
+// Stateless per-pixel hash used for the noise fields. Since the value depends only on the frame key
+// and the pixel index, the loops have no carried state and the compiler can vectorize them, and the
+// result does not depend on how the rows are split between render threads.
+inline static unsigned int pixel_hash(unsigned int key, unsigned int idx)
+{
+    unsigned int x = key ^ (idx * 0x9e3779b9U);
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// uniform integer in [0, range), range must be < 65536
+inline static unsigned int pixel_noise(unsigned int key, unsigned int idx, unsigned int range)
+{
+    return ((pixel_hash(key, idx) >> 16) * range) >> 16;
+}
+
+struct RowBandThread : public wxThread
+{
+    std::function<void(int, int)> fn;
+    int row0;
+    int row1;
+
+    RowBandThread(const std::function<void(int, int)>& fn_, int row0_, int row1_)
+        : wxThread(wxTHREAD_JOINABLE), fn(fn_), row0(row0_), row1(row1_)
+    {
+    }
+
+    ExitCode Entry() override
+    {
+        fn(row0, row1);
+        return 0;
+    }
+};
+
+// Invoke fn(row_begin, row_end) over [0, nrows), splitting large frames into bands rendered in parallel
+static void for_each_row_band(int nrows, int npixels, const std::function<void(int, int)>& fn)
+{
+    enum
+    {
+        MIN_PIXELS_PER_THREAD = 512 * 1024,
+    };
+
+    int nthreads = SimCamParams::render_threads ? SimCamParams::render_threads : wxThread::GetCPUCount();
+    nthreads = wxMin(nthreads, npixels / MIN_PIXELS_PER_THREAD);
+    nthreads = wxMin(nthreads, nrows);
+
+    if (nthreads <= 1)
+    {
+        fn(0, nrows);
+        return;
+    }
+
+    std::vector<RowBandThread *> threads;
+    int const band = (nrows + nthreads - 1) / nthreads;
+    for (int row0 = band; row0 < nrows; row0 += band)
+    {
+        RowBandThread *thread = new RowBandThread(fn, row0, wxMin(row0 + band, nrows));
+        if (thread->Run() != wxTHREAD_NO_ERROR)
+        {
+            // could not start a thread, render the band here instead
+            delete thread;
+            fn(row0, wxMin(row0 + band, nrows));
+            continue;
+        }
+        threads.push_back(thread);
+    }
+
+    // the calling thread renders the first band
+    fn(0, wxMin(band, nrows));
+
+    for (RowBandThread *thread : threads)
+    {
+        thread->Wait();
+        delete thread;
+    }
+}
+
 struct SimCamState
 {
     unsigned int width;
@@ -549,6 +687,11 @@ struct SimCamState
     long last_exposure_time; // last exposure time, milliseconds
     Cooler cooler; // simulated cooler
     StictionSim stictionSim;
+    unsigned long long seed; // seed for the per-frame random streams
+    unsigned long long frame_count; // frames rendered since Initialize
+    bool virtual_clock; // time advances with simulated exposures and guide pulses instead of the wall clock
+    long long virtual_time_ms; // current simulated time when using the virtual clock
+    wxCriticalSection clock_lock; // guide pulses can advance the virtual clock from the mount worker thread
 
 # ifdef SIMDEBUG
     wxFFile DebugFile;
@@ -570,9 +713,36 @@ struct SimCamState
 # endif
 
     void Initialize();
-    void FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset);
+    void FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset, unsigned int frame_key);
+    unsigned int NextFrameKey();
+    long Now();
+    void AdvanceClock(long ms);
 };
 
+// Derive the random stream key for the next frame
+unsigned int SimCamState::NextFrameKey()
+{
+    SimRng rng(seed ^ (frame_count++ * 0xd1b54a32d192ed03ULL));
+    return (unsigned int) rng.Next();
+}
+
+// Current simulated time, milliseconds
+long SimCamState::Now()
+{
+    if (virtual_clock)
+    {
+        wxCriticalSectionLocker lck(clock_lock);
+        return (long) virtual_time_ms;
+    }
+    return timer.Time();
+}
+
+void SimCamState::AdvanceClock(long ms)
+{
+    wxCriticalSectionLocker lck(clock_lock);
+    virtual_time_ms += ms;
+}
+
 void SimCamState::Initialize()
 {
     width = SimCamParams::width;
@@ -582,13 +752,13 @@ void SimCamState::Initialize()
     stars.resize(nr_stars);
     unsigned int const border = SimCamParams::border;
 
-    srand(2); // always generate the same stars
+    SimRng layout(2); // always generate the same stars
     for (unsigned int i = 0; i < nr_stars; i++)
     {
         // generate stars in ra/dec coordinates
-        stars[i].pos.x = (double) (rand() % (width - 2 * border)) - 0.5 * width;
-        stars[i].pos.y = (double) (rand() % (height - 2 * border)) - 0.5 * height;
-        double r = (double) (rand() % 90) / 3.0; // 0..30
+        stars[i].pos.x = (double) layout.Below(width - 2 * border) - 0.5 * width;
+        stars[i].pos.y = (double) layout.Below(height - 2 * border) - 0.5 * height;
+        double r = (double) layout.Below(90) / 3.0; // 0..30
         if (i == 10)
             stars[i].inten = 30.1; // Always have one saturated star
         else
@@ -608,14 +778,17 @@ void SimCamState::Initialize()
     hotpx.resize(nr_hot);
     for (unsigned int i = 0; i < nr_hot; i++)
     {
-        hotpx[i].x = rand() % width;
-        hotpx[i].y = rand() % height;
+        hotpx[i].x = layout.Below(width);
+        hotpx[i].y = layout.Below(height);
     }
-    srand(clock());
+    seed = SimCamParams::seed ? SimCamParams::seed : (unsigned long long) wxGetUTCTimeMillis().GetValue();
+    frame_count = 0;
     ra_ofs = 0.;
     dec_ofs = BacklashVal(SimCamParams::dec_backlash);
     cum_dec_drift = 0.;
-    last_exposure_time = 0;
+    virtual_clock = SimCamParams::virtual_clock;
+    virtual_time_ms = 0;
+    last_exposure_time = Now();
 
 # if SIMMODE == 1
     dirStarted = false;
@@ -774,10 +947,10 @@ bool SimCamState::ReadNextImage(usImage& img, const wxRect& subframe)
 # endif // SIMMODE == 1
 
 // get a pair of normally-distributed independent random values - Box-Muller algorithm, sigma=1
-static void rand_normal(double r[2])
+static void rand_normal(SimRng& rng, double r[2])
 {
-    double u = (double) rand() / RAND_MAX;
-    double v = (double) rand() / RAND_MAX;
+    double u = rng.Uniform();
+    double v = rng.Uniform();
     double const a = sqrt(-2.0 * log(u));
     double const p = 2 * M_PI * v;
     r[0] = a * cos(p);
@@ -982,21 +1155,28 @@ static void render_star(usImage& img, int binning, const wxRect& subframe, const
     }
 }
 
-static void render_clouds(usImage& img, const wxRect& subframe, int exptime, int gain, int offset)
+static void render_clouds(usImage& img, const wxRect& subframe, int exptime, int gain, int offset, unsigned int key)
 {
-    unsigned short cloud_amt;
-    unsigned short *p0 = &img.Pixel(subframe.GetLeft(), subframe.GetTop());
-    for (int r = 0; r < subframe.GetHeight(); r++, p0 += img.Size.GetWidth())
-    {
-        unsigned short *const end = p0 + subframe.GetWidth();
-        for (unsigned short *p = p0; p < end; p++)
+    float const base = (float) gain / 10.0f * offset * exptime / 100.0f;
+    float const inten = (float) SimCamParams::clouds_inten;
+    float const opacity = (float) SimCamParams::clouds_opacity;
+    unsigned int const range = gain * 100;
+    int const stride = img.Size.GetWidth();
+
+    for_each_row_band(subframe.GetHeight(), subframe.GetWidth() * subframe.GetHeight(), [&](int row0, int row1) {
+        for (int r = row0; r < row1; r++)
         {
-            // Compute a randomized brightness contribution from clouds, then overlay that on the guide frame
-            cloud_amt = (unsigned short) (SimCamParams::clouds_inten *
-                                          ((double) gain / 10.0 * offset * exptime / 100.0 + ((rand() % (gain * 100)) / 30.0)));
-            *p = (unsigned short) (SimCamParams::clouds_opacity * cloud_amt + (1 - SimCamParams::clouds_opacity) * *p);
+            unsigned int const idx0 = (unsigned int) ((subframe.GetTop() + r) * stride + subframe.GetLeft());
+            unsigned short *const p = &img.ImageData[idx0];
+            for (int c = 0; c < subframe.GetWidth(); c++)
+            {
+                // Compute a randomized brightness contribution from clouds, then overlay that on the guide frame
+                float cloud_amt = inten * (base + (float) pixel_noise(key, idx0 + c, range) / 30.0f);
+                cloud_amt = std::min(cloud_amt, 65535.0f);
+                p[c] = (unsigned short) (opacity * (float) (unsigned short) cloud_amt + (1.0f - opacity) * p[c]);
+            }
         }
-    }
+    });
 }
 
 # ifdef SIM_FILE_DISPLACEMENTS
@@ -1051,9 +1231,10 @@ void SimCamState::ReadDisplacements(double& incX, double& incY)
 }
 # endif
 
-void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset)
+void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset, unsigned int frame_key)
 {
     unsigned int const nr_stars = stars.size();
+    SimRng rng(frame_key);
 
 # ifdef SIMDEBUG
     static int CountUp(0);
@@ -1094,7 +1275,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
 
 # else // SIM_FILE_DISPLACEMENTS
 
-    long const cur_time = timer.Time();
+    long const cur_time = Now();
     long const delta_time_ms = last_exposure_time - cur_time;
     last_exposure_time = cur_time;
 
@@ -1158,7 +1339,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
     // simulate seeing
     if (SimCamParams::seeing_scale > 0.0)
     {
-        rand_normal(seeing);
+        rand_normal(rng, seeing);
         static const double seeing_adjustment = (2.345 * 1.4 * 2.4); // FWHM, geometry, empirical
         double sigma = SimCamParams::seeing_scale / (seeing_adjustment * SimCamParams::image_scale);
         seeing[0] *= sigma;
@@ -1236,7 +1417,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
         {
             double star = stars[i].inten * exptime * gain;
             double dark = (double) gain / 10.0 * offset * exptime / 100.0;
-            double noise = (double) (rand() % (gain * 100));
+            double noise = (double) rng.Below(gain * 100);
             double inten = star + dark + noise;
 
             render_star(img, pCamera->Binning, subframe, cc[i], inten);
@@ -1253,7 +1434,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
             double inten = 3.0;
             double star = inten * exptime * gain;
             double dark = (double) gain / 10.0 * offset * exptime / 100.0;
-            double noise = (double) (rand() % (gain * 100));
+            double noise = (double) rng.Below(gain * 100);
             inten = star + dark + noise;
 
             render_comet(img, pCamera->Binning, subframe, wxRealPoint(cx, cy), inten);
@@ -1262,7 +1443,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
     }
 
     if (SimCamParams::clouds_opacity > 0)
-        render_clouds(img, subframe, exptime, gain, offset);
+        render_clouds(img, subframe, exptime, gain, offset, frame_key ^ 0x5bd1e995U);
 
     // render hot pixels
     for (unsigned int i = 0; i < hotpx.size(); i++)
@@ -1407,16 +1588,25 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
 # endif
 
 # if SIMMODE == 3
-static void fill_noise(usImage& img, const wxRect& subframe, int exptime, int gain, int offset)
+static void fill_noise(usImage& img, const wxRect& subframe, int exptime, int gain, int offset, unsigned int key)
 {
-    unsigned short *p0 = &img.Pixel(subframe.GetLeft(), subframe.GetTop());
-    for (int r = 0; r < subframe.GetHeight(); r++, p0 += img.Size.GetWidth())
-    {
-        unsigned short *const end = p0 + subframe.GetWidth();
-        for (unsigned short *p = p0; p < end; p++)
-            *p = (unsigned short) (SimCamParams::noise_multiplier *
-                                   ((double) gain / 10.0 * offset * exptime / 100.0 + (rand() % (gain * 100))));
-    }
+    float const mult = (float) SimCamParams::noise_multiplier;
+    float const dark = (float) gain / 10.0f * offset * exptime / 100.0f;
+    unsigned int const range = gain * 100;
+    int const stride = img.Size.GetWidth();
+
+    for_each_row_band(subframe.GetHeight(), subframe.GetWidth() * subframe.GetHeight(), [&](int row0, int row1) {
+        for (int r = row0; r < row1; r++)
+        {
+            unsigned int const idx0 = (unsigned int) ((subframe.GetTop() + r) * stride + subframe.GetLeft());
+            unsigned short *const p = &img.ImageData[idx0];
+            for (int c = 0; c < subframe.GetWidth(); c++)
+            {
+                float val = mult * (dark + (float) pixel_noise(key, idx0 + c, range));
+                p[c] = (unsigned short) std::min(val, 65535.0f);
+            }
+        }
+    });
 }
 # endif // SIMMODE == 3
 
@@ -1428,7 +1618,12 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
     // sleep before rendering the image so that any changes made in the middle of a long exposure (e.g. manual guide pulse)
     // shows up in the image
 
-    if (duration > 5)
+    if (sim.virtual_clock)
+    {
+        // no waiting, the exposure takes no wall-clock time
+        sim.AdvanceClock(duration);
+    }
+    else if (duration > 5)
     {
         if (WorkerThread::MilliSleep(duration - 5, WorkerThread::INT_ANY))
             return true;
@@ -1474,9 +1669,11 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
     if (usingSubframe)
         img.Clear();
 
-    fill_noise(img, subframe, exptime, gain, offset);
+    unsigned int const frame_key = sim.NextFrameKey();
+
+    fill_noise(img, subframe, exptime, gain, offset, frame_key);
 
-    sim.FillImage(img, subframe, exptime, gain, offset);
+    sim.FillImage(img, subframe, exptime, gain, offset, frame_key);
 
     if (usingSubframe)
         img.Subframe = subframe;
@@ -1486,6 +1683,12 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
 
 # endif // SIMMODE == 1
 
+    if (sim.virtual_clock)
+    {
+        sim.AdvanceClock(SimCamParams::frame_download_ms);
+        return false;
+    }
+
     unsigned int tot_dur = duration + SimCamParams::frame_download_ms;
     long elapsed = watchdog.Time();
     if (elapsed < tot_dur)
@@ -1552,7 +1755,10 @@ bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
     default:
         return true;
     }
-    WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
+    if (sim.virtual_clock)
+        sim.AdvanceClock(duration);
+    else
+        WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
     return false;
 }
 
@@ -1701,6 +1907,9 @@ struct SimCamDialog : public wxDialog
     wxSlider *pHotpxSlider;
     wxSlider *pNoiseSlider;
     wxSlider *pCloudSlider;
+    wxSpinCtrl *pWidthSpin;
+    wxSpinCtrl *pHeightSpin;
+    wxCheckBox *pVirtualClock;
     wxSpinCtrlDouble *pBacklashSpin;
     wxSpinCtrlDouble *pDriftSpin;
     wxSpinCtrlDouble *pGuideRateSpin;
@@ -1759,6 +1968,15 @@ static wxSpinCtrlDouble *NewSpinner(wxWindow *parent, double val, double minval,
     return pNewCtrl;
 }
 
+static wxSpinCtrl *NewSpinnerInt(wxWindow *parent, int val, int minval, int maxval, const wxString& tooltip)
+{
+    wxSize sz = pFrame->GetTextExtent(wxString::Format("%d", maxval * 10));
+    wxSpinCtrl *pNewCtrl = pFrame->MakeSpinCtrl(parent, wxID_ANY, wxEmptyString, wxDefaultPosition, sz, wxSP_ARROW_KEYS,
+                                                minval, maxval, val);
+    pNewCtrl->SetToolTip(tooltip);
+    return pNewCtrl;
+}
+
 static wxCheckBox *NewCheckBox(wxWindow *parent, bool val, const wxString& label, const wxString& tooltip)
 {
     wxCheckBox *pNewCtrl = new wxCheckBox(parent, wxID_ANY, label);
@@ -1800,6 +2018,9 @@ static void SetControlStates(SimCamDialog *dlg, bool captureActive)
 {
     bool enable = !captureActive;
 
+    dlg->pWidthSpin->Enable(enable);
+    dlg->pHeightSpin->Enable(enable);
+    dlg->pVirtualClock->Enable(enable);
     dlg->pBacklashSpin->Enable(enable);
     dlg->pGuideRateSpin->Enable(enable);
     dlg->pCameraAngleSpin->Enable(enable);
@@ -1852,6 +2073,13 @@ void SimCamDialog::OnOkClick(wxCommandEvent& evt)
         }
     }
 
+    if (bOk && (double) pWidthSpin->GetValue() * pHeightSpin->GetValue() > SENSOR_PIXELS_MAX)
+    {
+        wxMessageBox(wxString::Format(_("Sensor size is limited to %d megapixels"), SENSOR_PIXELS_MAX / 1000000), "Error",
+                     wxOK | wxICON_ERROR);
+        bOk = false;
+    }
+
     if (bOk)
         wxDialog::EndModal(wxID_OK);
 }
@@ -1865,7 +2093,7 @@ SimCamDialog::SimCamDialog(wxWindow *parent) : wxDialog(parent, wxID_ANY, _("Cam
 
     // Camera group controls
     wxStaticBoxSizer *pCamGroup = new wxStaticBoxSizer(wxVERTICAL, this, _("Camera"));
-    wxFlexGridSizer *pCamTable = new wxFlexGridSizer(1, 6, 15, 15);
+    wxFlexGridSizer *pCamTable = new wxFlexGridSizer(2, 6, 15, 15);
     pStarsSlider = NewSlider(this, SimCamParams::nr_stars, 1, 100, _("Number of simulated stars"));
     AddTableEntryPair(this, pCamTable, _("Stars"), pStarsSlider);
     pHotpxSlider = NewSlider(this, SimCamParams::nr_hot_pixels, 0, 50, _("Number of hot pixels"));
@@ -1873,7 +2101,15 @@ SimCamDialog::SimCamDialog(wxWindow *parent) : wxDialog(parent, wxID_ANY, _("Cam
     pNoiseSlider = NewSlider(this, (int) floor(SimCamParams::noise_multiplier * 100 / NOISE_MAX), 0, 100,
                              /* xgettext:no-c-format */ _("% Simulated noise"));
     AddTableEntryPair(this, pCamTable, _("Noise"), pNoiseSlider);
+    pWidthSpin = NewSpinnerInt(this, SimCamParams::width, SENSOR_SIZE_MIN, SENSOR_SIZE_MAX, _("Sensor width, pixels"));
+    AddTableEntryPair(this, pCamTable, _("Width"), pWidthSpin);
+    pHeightSpin = NewSpinnerInt(this, SimCamParams::height, SENSOR_SIZE_MIN, SENSOR_SIZE_MAX, _("Sensor height, pixels"));
+    AddTableEntryPair(this, pCamTable, _("Height"), pHeightSpin);
     pCamGroup->Add(pCamTable);
+    pVirtualClock = NewCheckBox(this, SimCamParams::virtual_clock, _("Virtual clock"),
+                                _("Advance simulated time by the exposure and guide pulse durations instead of waiting for "
+                                  "them. Frames are produced as fast as they can be rendered."));
+    pCamGroup->Add(pVirtualClock, wxSizerFlags().Border(wxALL, 5));
 
     // Mount group controls
     wxStaticBoxSizer *pMountGroup = new wxStaticBoxSizer(wxVERTICAL, this, _("Mount"));
@@ -1984,6 +2220,9 @@ void SimCamDialog::OnReset(wxCommandEvent& event)
     pStarsSlider->SetValue(NR_STARS_DEFAULT);
     pHotpxSlider->SetValue(NR_HOT_PIXELS_DEFAULT);
     pNoiseSlider->SetValue((int) floor(NOISE_DEFAULT * 100.0 / NOISE_MAX));
+    pWidthSpin->SetValue(SENSOR_WIDTH_DEFAULT);
+    pHeightSpin->SetValue(SENSOR_HEIGHT_DEFAULT);
+    pVirtualClock->SetValue(VIRTUAL_CLOCK_DEFAULT);
     pBacklashSpin->SetValue(DEC_BACKLASH_DEFAULT);
     pCloudSlider->SetValue(0);
 
@@ -2048,6 +2287,9 @@ void CameraSimulator::ShowPropertyDialog()
         upd.Update(SimCamParams::nr_stars, dlg.pStarsSlider->GetValue());
         upd.Update(SimCamParams::nr_hot_pixels, dlg.pHotpxSlider->GetValue());
         SimCamParams::noise_multiplier = (double) dlg.pNoiseSlider->GetValue() * NOISE_MAX / 100.0;
+        upd.Update(SimCamParams::width, (unsigned int) dlg.pWidthSpin->GetValue());
+        upd.Update(SimCamParams::height, (unsigned int) dlg.pHeightSpin->GetValue());
+        upd.Update(SimCamParams::virtual_clock, dlg.pVirtualClock->GetValue());
         upd.Update(SimCamParams::dec_backlash, dlg.pBacklashSpin->GetValue() / imageScale); // a-s -> px
 
         bool use_pe = dlg.pUsePECbx->GetValue();
@@ -75,7 +75,8 @@ double GuideAlgorithm::SmartDefaultMinMove()
         double focalLength = pFrame->GetFocalLength();
         if (focalLength != 0)
         {
-            return GuideAlgorithm::SmartDefaultMinMove(focalLength, pCamera->GetCameraPixelSize(), pCamera->Binning);
+            return GuideAlgorithm::SmartDefaultMinMove(focalLength, pCamera->GetCameraPixelSize(),
+                                                       pCamera->TotalBinning());
         }
         else
             return 0.2;
@@ -45,6 +45,7 @@
 #include "gaussian_process_guider.h"
 
 #include <ctime>
+#include <fstream>
 
 #include "math_tools.h"
 #include "gaussian_process.h"
@@ -73,6 +74,10 @@ static const double DefaultNoresetMaxPctPeriod =
 
 static const bool DefaultComputePeriod = true;
 
+static const bool DefaultAsyncUpdate = false; // update the model on a background thread
+static const bool DefaultWarmStart = true; // continue with the saved model when guiding starts with a reset model
+static const int DefaultUpdateTimeBudgetMs = 50; // max time a guide step waits for a background update
+
 static void MakeBold(wxControl *ctrl)
 {
     wxFont font = ctrl->GetFont();
@@ -301,6 +306,16 @@ static void SetRetainModelPct(const GuideAlgorithm *algo, double val)
     pConfig->Profile.SetDouble(algo->GetConfigPath() + "/noreset_max_pct_period", val);
 }
 
+static bool GetWarmStart(const GuideAlgorithm *algo)
+{
+    return pConfig->Profile.GetBoolean(algo->GetConfigPath() + "/gp_warm_start", DefaultWarmStart);
+}
+
+static void SetWarmStart(const GuideAlgorithm *algo, bool val)
+{
+    pConfig->Profile.SetBoolean(algo->GetConfigPath() + "/gp_warm_start", val);
+}
+
 class GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcessDialogPane : public wxEvtHandler, public ConfigDialogPane
 {
     GuideAlgorithmGaussianProcess *m_pGuideAlgorithm;
@@ -310,6 +325,8 @@ class GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcessDialogPane : p
     wxSpinCtrl *m_pPredictionGain;
     wxCheckBox *m_checkboxComputePeriod;
     wxSpinCtrlDouble *m_retainModelPct;
+    wxCheckBox *m_checkboxAsyncUpdate;
+    wxCheckBox *m_checkboxWarmStart;
     wxButton *m_btnExpertOptions;
 
 public:
@@ -367,6 +384,21 @@ public:
                                  "Default = %.f%% of the period length."),
                                DefaultNoresetMaxPctPeriod));
 
+        m_checkboxAsyncUpdate = new wxCheckBox(pParent, wxID_ANY, _("Update model in background"));
+        m_checkboxAsyncUpdate->SetToolTip(
+            wxString::Format(_("Update the prediction model on a background thread so that slow computers do not delay "
+                               "the guide pulses. The pulses use the model of the previous step. Default = %s"),
+                             DefaultAsyncUpdate ? _("On") : _("Off")));
+        DoAdd(m_checkboxAsyncUpdate);
+
+        m_checkboxWarmStart = new wxCheckBox(pParent, wxID_ANY, _("Resume saved model"));
+        m_checkboxWarmStart->SetToolTip(
+            wxString::Format(_("Save the PPEC model when guiding stops and continue with it when guiding starts again, "
+                               "also after a restart of PHD2 or a meridian flip, so that the prediction does not have to "
+                               "be learned again. Requires the mount pointing position. Default = %s"),
+                             DefaultWarmStart ? _("On") : _("Off")));
+        DoAdd(m_checkboxWarmStart);
+
         m_btnExpertOptions = new wxButton(pParent, wxID_ANY, _("Expert..."));
         m_btnExpertOptions->Bind(wxEVT_COMMAND_BUTTON_CLICKED, &GuideAlgorithmGaussianProcessDialogPane::OnExpertButton, this);
         m_btnExpertOptions->SetToolTip(_("Change expert options for tuning the predictions. Use at your own risk!"));
@@ -399,6 +431,8 @@ public:
         m_checkboxComputePeriod->SetValue(m_pGuideAlgorithm->GetBoolComputePeriod());
         m_checkboxComputePeriod->Enable(!pFrame->pGuider || !pFrame->pGuider->IsCalibratingOrGuiding());
         m_retainModelPct->SetValue(GetRetainModelPct(m_pGuideAlgorithm));
+        m_checkboxAsyncUpdate->SetValue(m_pGuideAlgorithm->GetBoolAsyncUpdate());
+        m_checkboxWarmStart->SetValue(GetWarmStart(m_pGuideAlgorithm));
 
         m_pGuideAlgorithm->m_expertDialog->LoadExpertValues(m_pGuideAlgorithm, hyperparameters);
 
@@ -423,6 +457,8 @@ public:
         m_pGuideAlgorithm->SetBoolComputePeriod(m_checkboxComputePeriod->GetValue());
 
         SetRetainModelPct(m_pGuideAlgorithm, m_retainModelPct->GetValue());
+        m_pGuideAlgorithm->SetBoolAsyncUpdate(m_checkboxAsyncUpdate->GetValue());
+        SetWarmStart(m_pGuideAlgorithm, m_checkboxWarmStart->GetValue());
     }
 
     virtual void OnImageScaleChange() { GuideAlgorithm::AdjustMinMoveSpinCtrl(m_pMinMove); }
@@ -502,6 +538,13 @@ GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcess(Mount *pMount, Guid
 
     bool compute_period = pConfig->Profile.GetBoolean(configPath + "/gp_compute_period", DefaultComputePeriod);
     SetBoolComputePeriod(compute_period);
+
+    int update_time_budget = pConfig->Profile.GetInt(configPath + "/gp_update_time_budget_ms", DefaultUpdateTimeBudgetMs);
+    SetUpdateTimeBudget(update_time_budget);
+
+    bool async_update = pConfig->Profile.GetBoolean(configPath + "/gp_async_update", DefaultAsyncUpdate);
+    SetBoolAsyncUpdate(async_update);
+
     m_expertDialog = NULL;
     block_updates_ = !(m_pMount->GetGuidingEnabled());
     guiding_ra_ = math_tools::NaN;
@@ -872,6 +915,40 @@ bool GuideAlgorithmGaussianProcess::SetBoolComputePeriod(bool active)
     return true;
 }
 
+bool GuideAlgorithmGaussianProcess::SetBoolAsyncUpdate(bool active)
+{
+    bool error = GPG->SetAsynchronousUpdate(active);
+    if (!error)
+    {
+        pConfig->Profile.SetBoolean(GetConfigPath() + "/gp_async_update", active);
+    }
+    return error;
+}
+
+bool GuideAlgorithmGaussianProcess::SetUpdateTimeBudget(int milliseconds)
+{
+    bool error = false;
+
+    try
+    {
+        if (milliseconds < 0)
+        {
+            throw ERROR_INFO("invalid update time budget");
+        }
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        error = true;
+        milliseconds = DefaultUpdateTimeBudgetMs;
+    }
+
+    GPG->SetUpdateTimeBudget(milliseconds / 1000.0);
+    pConfig->Profile.SetInt(GetConfigPath() + "/gp_update_time_budget_ms", milliseconds);
+
+    return error;
+}
+
 double GuideAlgorithmGaussianProcess::GetControlGain() const
 {
     return GPG->GetControlGain();
@@ -912,6 +989,16 @@ bool GuideAlgorithmGaussianProcess::GetBoolComputePeriod() const
     return GPG->GetBoolComputePeriod();
 }
 
+bool GuideAlgorithmGaussianProcess::GetBoolAsyncUpdate() const
+{
+    return GPG->GetAsynchronousUpdate();
+}
+
+int GuideAlgorithmGaussianProcess::GetUpdateTimeBudget() const
+{
+    return (int) (GPG->GetUpdateTimeBudget() * 1000.0 + 0.5);
+}
+
 bool GuideAlgorithmGaussianProcess::GetDarkTracking() const
 {
     return dark_tracking_mode_;
@@ -937,7 +1024,9 @@ wxString GuideAlgorithmGaussianProcess::GetSettingsSummary() const
                                 "\tSignal variance short range SE kernel = %.3f\n"
                                 "\tPeriod length periodic kernel = %.3f\n"
                                 "\tFFT called after = %.3f worm cycles\n"
-                                "\tAuto-adjust period length = %s\n";
+                                "\tAuto-adjust period length = %s\n"
+                                "\tBackground model update = %s\n"
+                                "\tResume saved model = %s\n";
 
     std::vector<double> hyperparameters = GetGPHyperparameters();
 
@@ -945,7 +1034,8 @@ wxString GuideAlgorithmGaussianProcess::GetSettingsSummary() const
                             hyperparameters[SE0KSignalVariance], hyperparameters[PKLengthScale],
                             hyperparameters[PKSignalVariance], hyperparameters[SE1KLengthScale],
                             hyperparameters[SE1KSignalVariance], hyperparameters[PKPeriodLength],
-                            GetPeriodLengthsPeriodEstimation(), GetBoolComputePeriod() ? "On" : "Off");
+                            GetPeriodLengthsPeriodEstimation(), GetBoolComputePeriod() ? "On" : "Off",
+                            GetBoolAsyncUpdate() ? "On" : "Off", GetWarmStart(this) ? "On" : "Off");
 }
 
 GUIDE_ALGORITHM GuideAlgorithmGaussianProcess::Algorithm() const
@@ -1014,6 +1104,108 @@ inline static wxString FormatRA(double ra)
     return math_tools::isNaN(ra) ? _T("unknown") : wxString::Format("%.4f hr", ra);
 }
 
+// Angle of the RA axis in hours. The worm position only depends on this
+// angle, which changes by 12 hours in a meridian flip.
+static double CurrentAxisAngle()
+{
+    if (pPointingSource)
+    {
+        double ra, dec, st;
+        bool err = pPointingSource->GetCoordinates(&ra, &dec, &st);
+        PierSide side = pPointingSource->SideOfPier();
+        if (!err && side != PIER_SIDE_UNKNOWN)
+        {
+            return norm(st - ra + (side == PIER_SIDE_EAST ? 12. : 0.), 0., 24.);
+        }
+    }
+
+    return math_tools::NaN;
+}
+
+wxString GuideAlgorithmGaussianProcess::ModelStateFileName(int profileId) const
+{
+    int inst = wxGetApp().GetInstanceNumber();
+    return MyFrame::GetDefaultFileDir() + PATHSEPSTR +
+        wxString::Format("PHD2_ppec_model%s_%s_%d.txt", inst > 1 ? wxString::Format("_%d", inst) : "", GetAxis(),
+                         profileId);
+}
+
+void GuideAlgorithmGaussianProcess::SaveModelState()
+{
+    wxString filename = ModelStateFileName(pConfig->GetCurrentProfileId());
+
+    double axis = CurrentAxisAngle();
+    GaussianProcessGuider::model_state state;
+    if (math_tools::isNaN(axis) || GPG->GetModelState(state))
+    {
+        // an old model would be resumed at the wrong phase
+        if (wxFileExists(filename))
+            wxRemoveFile(filename);
+        return;
+    }
+
+    std::ofstream ofs(filename.fn_str(), std::ios::out | std::ios::trunc);
+    ofs << "mount " << m_pMount->Name().ToStdString() << "\n";
+    ofs << "axis " << wxString::Format("%.6f", axis).ToStdString() << "\n";
+    bool err = state.write(ofs);
+    ofs.close();
+
+    if (err || !ofs)
+    {
+        Debug.Write(wxString::Format("PPEC: could not save the model to %s\n", filename));
+        wxRemoveFile(filename);
+        return;
+    }
+
+    Debug.Write(wxString::Format("PPEC: saved %u model points at axis angle %.4f hr to %s\n",
+                                 (unsigned int) state.timestamps.size(), axis, filename));
+}
+
+bool GuideAlgorithmGaussianProcess::LoadModelState()
+{
+    wxString filename = ModelStateFileName(pConfig->GetCurrentProfileId());
+    if (!wxFileExists(filename))
+        return true;
+
+    double axis = CurrentAxisAngle();
+    if (math_tools::isNaN(axis))
+    {
+        Debug.Write("PPEC: mount position unknown, saved model not resumed\n");
+        return true;
+    }
+
+    std::ifstream ifs(filename.fn_str());
+    std::string line;
+    std::getline(ifs, line);
+    if (line != "mount " + m_pMount->Name().ToStdString())
+    {
+        Debug.Write(wxString::Format("PPEC: saved model is for a different mount (%s), not resumed\n", line));
+        return true;
+    }
+
+    double saved_axis;
+    GaussianProcessGuider::model_state state;
+    if (!std::getline(ifs, line) || sscanf(line.c_str(), "axis %lf", &saved_axis) != 1 || state.read(ifs))
+    {
+        Debug.Write(wxString::Format("PPEC: could not read the saved model from %s\n", filename));
+        return true;
+    }
+
+    // The worm turned with the RA axis, including the 12 hours of a meridian flip
+    double gear_time_elapsed = GaussianProcessGuider::AxisRotationGearTime(saved_axis, axis);
+
+    if (GPG->WarmStart(state, gear_time_elapsed))
+    {
+        Debug.Write("PPEC: saved model could not be resumed\n");
+        return true;
+    }
+
+    Debug.Write(wxString::Format("PPEC: resumed saved model, axis angle %.4f hr, saved at %.4f hr, gear time offset %.1f "
+                                 "seconds, period length %.1f seconds\n",
+                                 axis, saved_axis, gear_time_elapsed, GPG->GetGPHyperparameters()[PKPeriodLength]));
+    return false;
+}
+
 void GuideAlgorithmGaussianProcess::GuidingStarted()
 {
     bool need_reset = true;
@@ -1075,7 +1267,10 @@ void GuideAlgorithmGaussianProcess::GuidingStarted()
 
     if (need_reset)
     {
-        reset();
+        // after a restart, a meridian flip or a long pause, continue with
+        // the saved model at the current worm phase if possible
+        if (!GetWarmStart(this) || LoadModelState())
+            reset();
     }
     else
     {
@@ -1092,6 +1287,9 @@ void GuideAlgorithmGaussianProcess::GuidingStopped()
     double period_length = GPG->GetGPHyperparameters()[PKPeriodLength];
     pConfig->Profile.SetDouble(GetConfigPath() + "/gp_period_per_kern", period_length);
 
+    if (GetWarmStart(this))
+        SaveModelState();
+
     guiding_stopped_time_ = std::chrono::system_clock::now();
 }
 
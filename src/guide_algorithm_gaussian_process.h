@@ -124,6 +124,15 @@ private:
     PierSide guiding_pier_side_;
     std::chrono::system_clock::time_point guiding_stopped_time_; // time guiding stopped
 
+    /**
+     * The model is saved per profile when guiding stops, together with the
+     * mount name and the angle of the RA axis, so that it can be resumed at
+     * the right phase of the gear error when guiding starts again.
+     */
+    wxString ModelStateFileName(int profileId) const;
+    void SaveModelState();
+    bool LoadModelState(); // returns true if the saved model could not be resumed
+
 protected:
     double GetControlGain() const;
     bool SetControlGain(double control_gain);
@@ -143,6 +152,12 @@ protected:
     bool GetBoolComputePeriod() const;
     bool SetBoolComputePeriod(bool);
 
+    bool GetBoolAsyncUpdate() const;
+    bool SetBoolAsyncUpdate(bool);
+
+    int GetUpdateTimeBudget() const;
+    bool SetUpdateTimeBudget(int milliseconds);
+
     std::vector<double> GetGPHyperparameters() const;
     bool SetGPHyperparameters(const std::vector<double>& hyperparameters);
 
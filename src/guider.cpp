@@ -1311,7 +1311,13 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
         GuiderOffset ofs;
         FrameDroppedInfo info;
 
-        if (UpdateCurrentPosition(pImage, &ofs, &info)) // true means error
+        bool lost;
+        {
+            PipelineTimer timer(PIPELINE_FIND);
+            lost = UpdateCurrentPosition(pImage, &ofs, &info); // true means error
+        }
+
+        if (lost)
         {
             info.frameNumber = pImage->FrameNum;
             info.time = pFrame->TimeSinceGuidingStarted();
@@ -1550,7 +1556,11 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
 
     pFrame->UpdateButtonsStatus();
 
-    UpdateImageDisplay(pImage);
+    {
+        PipelineTimer timer(PIPELINE_DISPLAY);
+        UpdateImageDisplay(pImage);
+    }
+    PipelineTiming.FrameDisplayed(pImage->FrameNum);
 
     Debug.AddLine("UpdateGuideState exits: " + statusMessage);
 }
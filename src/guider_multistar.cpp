@@ -200,7 +200,8 @@ wxEND_EVENT_TABLE();
 
 // Define a constructor for the guide canvas
 GuiderMultiStar::GuiderMultiStar(wxWindow *parent)
-    : Guider(parent, XWinSize, YWinSize), m_massChecker(new MassChecker()), m_stabilizing(false), m_multiStarMode(true),
+    : Guider(parent, XWinSize, YWinSize), m_massChecker(new MassChecker()), m_roiManager(new RoiManager()),
+      m_stabilizing(false), m_multiStarMode(true),
       m_lastPrimaryDistance(0), m_lockPositionMoved(false), m_maxStars(DEFAULT_MAX_STAR_COUNT),
       m_stabilitySigmaX(DEFAULT_STABILITY_SIGMAX), m_lastStarsUsed(0)
 {
@@ -211,6 +212,7 @@ GuiderMultiStar::GuiderMultiStar(wxWindow *parent)
 GuiderMultiStar::~GuiderMultiStar()
 {
     delete m_massChecker;
+    delete m_roiManager;
     delete m_primaryDistStats;
 }
 
@@ -384,6 +386,7 @@ bool GuiderMultiStar::SetCurrentPosition(const usImage *pImage, const PHD_Point&
         }
 
         m_massChecker->Reset();
+        m_roiManager->Reset();
         bError = !m_primaryStar.Find(pImage, m_searchRegion, x, y, pFrame->GetStarFindMode(), GetMinStarHFD(), GetMaxStarHFD(),
                                      pCamera->GetSaturationADU(), Star::FIND_LOGGING_VERBOSE);
     }
@@ -472,6 +475,7 @@ bool GuiderMultiStar::AutoSelect(const wxRect& roi)
         }
 
         m_massChecker->Reset();
+        m_roiManager->Reset();
 
         if (!m_primaryStar.Find(image, m_searchRegion, newStar.X, newStar.Y, Star::FIND_CENTROID, GetMinStarHFD(),
                                 GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_VERBOSE))
@@ -532,57 +536,98 @@ inline static wxRect SubframeRect(const PHD_Point& pos, int halfwidth)
     return wxRect(ROUND(pos.X) - halfwidth, ROUND(pos.Y) - halfwidth, 2 * halfwidth + 1, 2 * halfwidth + 1);
 }
 
-wxRect GuiderMultiStar::GetBoundingBox() const
+// whether the next capture can be a subframe, and the position of the primary star if so
+bool GuiderMultiStar::SubframeCenter(PHD_Point *pos) const
 {
-    enum
-    {
-        SUBFRAME_BOUNDARY_PX = 0
-    };
-
-    GUIDER_STATE state = GetState();
-
-    bool subframe;
-    PHD_Point pos;
+    if (m_forceFullFrame)
+        return false;
 
-    switch (state)
+    switch (GetState())
     {
     case STATE_SELECTED:
     case STATE_CALIBRATING_PRIMARY:
     case STATE_CALIBRATING_SECONDARY:
-        subframe = m_primaryStar.WasFound();
-        pos = CurrentPosition();
-        break;
     case STATE_GUIDING:
-    {
-        subframe = m_primaryStar.WasFound(); // true;
-        // As long as the star is close to the lock position, keep the subframe
-        // at the lock position. Otherwise, follow the star.
-        double dist = CurrentPosition().Distance(LockPosition());
-        if ((int) dist > m_searchRegion / 3)
-            pos = CurrentPosition();
-        else
-            pos = LockPosition();
-        break;
-    }
+        if (!m_primaryStar.WasFound())
+            return false;
+        *pos = CurrentPosition();
+        return true;
     default:
-        subframe = false;
+        return false;
     }
+}
 
-    if (m_forceFullFrame)
+wxRect GuiderMultiStar::GetBoundingBox() const
+{
+    PHD_Point pos;
+
+    if (!SubframeCenter(&pos))
+        return wxRect(0, 0, 0, 0);
+
+    // no window has been chosen since the star was selected
+    if (m_roiManager->Roi().IsEmpty())
     {
-        subframe = false;
+        wxRect box(SubframeRect(pos, m_searchRegion));
+        box.Intersect(wxRect(pCamera->FrameSize()));
+        return box;
     }
 
-    if (subframe)
+    return m_roiManager->Roi();
+}
+
+// Chooses the readout window for the next capture, called once per frame after
+// the star positions have been updated
+void GuiderMultiStar::UpdateRoi()
+{
+    PHD_Point pos;
+
+    if (!SubframeCenter(&pos))
     {
-        wxRect box(SubframeRect(pos, m_searchRegion + SUBFRAME_BOUNDARY_PX));
-        box.Intersect(wxRect(pCamera->FullSize));
-        return box;
+        m_roiManager->Reset();
+        return;
     }
-    else
+
+    wxSize fullSize = pCamera->FrameSize();
+    wxRect needed(SubframeRect(pos, m_searchRegion));
+    needed.Intersect(wxRect(fullSize));
+
+    // while guiding on multiple stars, extend the window to take in the secondary
+    // stars' search regions, best stars first, as long as it stays small enough to
+    // be worth reading out as a subframe. A star that does not fit would not be in
+    // the subframe, so it is dropped rather than left to be lost
+    if (GetState() == STATE_GUIDING && m_multiStarMode && m_guideStars.size() > 1)
     {
-        return wxRect(0, 0, 0, 0);
+        int maxArea = RoiManager::MaxArea(fullSize);
+
+        for (auto pGS = m_guideStars.begin() + 1; pGS != m_guideStars.end();)
+        {
+            PHD_Point starPos = pGS->wasLost ? m_primaryStar + pGS->offsetFromPrimary : PHD_Point(pGS->X, pGS->Y);
+            wxRect box(SubframeRect(starPos, m_searchRegion));
+            box.Intersect(wxRect(fullSize));
+            if (box.IsEmpty())
+            {
+                ++pGS;
+                continue;
+            }
+
+            wxRect merged = needed.Union(box);
+            if (merged.GetWidth() * merged.GetHeight() <= maxArea)
+            {
+                needed = merged;
+                ++pGS;
+            }
+            else if (pCamera->UseSubframes)
+            {
+                Debug.Write(
+                    wxString::Format("ROI: dropped secondary star at %.1f,%.1f outside the window\n", starPos.X, starPos.Y));
+                pGS = m_guideStars.erase(pGS);
+            }
+            else
+                ++pGS;
+        }
     }
+
+    m_roiManager->Update(needed, fullSize, m_searchRegion);
 }
 
 void GuiderMultiStar::InvalidateCurrentPosition(bool fullReset)
@@ -1022,6 +1067,7 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
         // update the star position, mass, etc.
         m_primaryStar = newStar;
         m_massChecker->AppendData(newStar.Mass);
+        m_roiManager->AddPosition(m_primaryStar);
 
         if (lockPos.IsValid())
         {
@@ -1053,6 +1099,8 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
         pFrame->ResetAutoExposure(); // use max exposure duration
     }
 
+    UpdateRoi();
+
     return bError;
 }
 
@@ -1316,8 +1364,8 @@ void GuiderMultiStar::SaveStarFITS()
         hdr.write("DATE", wxDateTime::UNow(), wxDateTime::UTC, "file creation time, UTC");
         hdr.write("DATE-OBS", pImage->ImgStartTime, wxDateTime::UTC, "image capture start time, UTC");
         hdr.write("EXPOSURE", (float) pImage->ImgExpDur / 1000.0f, "Exposure time [s]");
-        hdr.write("XBINNING", (unsigned int) pCamera->Binning, "Camera X binning");
-        hdr.write("YBINNING", (unsigned int) pCamera->Binning, "Camera Y binning");
+        hdr.write("XBINNING", (unsigned int) pCamera->TotalBinning(), "Camera X binning");
+        hdr.write("YBINNING", (unsigned int) pCamera->TotalBinning(), "Camera Y binning");
         hdr.write("XORGSUB", start_x, "Subframe x position in binned pixels");
         hdr.write("YORGSUB", start_y, "Subframe y position in binned pixels");
 
@@ -45,6 +45,7 @@
 #define GUIDER_MULTISTAR_H_INCLUDED
 
 class MassChecker;
+class RoiManager;
 class GuiderMultiStar;
 class GuiderConfigDialogCtrlSet;
 
@@ -78,6 +79,7 @@ class GuiderMultiStar : public Guider
     std::vector<GuideStar> m_guideStars;
     DescriptiveStats *m_primaryDistStats;
     MassChecker *m_massChecker;
+    RoiManager *m_roiManager;
     double m_lastPrimaryDistance;
     bool m_multiStarMode;
     bool m_stabilizing;
@@ -149,6 +151,9 @@ private:
     bool UpdateCurrentPosition(const usImage *pImage, GuiderOffset *ofs, FrameDroppedInfo *errorInfo) final;
     bool SetCurrentPosition(const usImage *pImage, const PHD_Point& position) final;
 
+    bool SubframeCenter(PHD_Point *pos) const;
+    void UpdateRoi();
+
     void OnLClick(wxMouseEvent& evt);
 
     void SaveStarFITS();
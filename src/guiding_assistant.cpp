@@ -1142,7 +1142,6 @@ void GuidingAsstWin::LoadGAResults(const wxString& TimeStamp, GADetails *Details
 // recommendations if things look wonky
 void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double& RecDec)
 {
-    AxisStats decVals;
     double bestEstimate = 1000;
     double slope = 0;
     double intcpt = 0;
@@ -1151,9 +1150,7 @@ void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double& RecDec)
     double selSlope = 0;
     double correctedRMS;
     const int MEASUREMENT_WINDOW_SIZE = 120; // seconds
-    const int WINDOW_ADJUSTMENT = MEASUREMENT_WINDOW_SIZE / 2;
 
-    int lastInx = m_decAxisStats.GetCount() - 1;
     double pxscale = pFrame->GetCameraPixelScale();
     StarDisplacement val = m_decAxisStats.GetEntry(0);
     double tStart = val.DeltaTime;
@@ -1166,53 +1163,7 @@ void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double& RecDec)
         if (m_decAxisStats.GetLastEntry().DeltaTime - tStart >
             1.2 * MEASUREMENT_WINDOW_SIZE) // Long GA run, more than 2.4 minutes
         {
-            bool done = false;
-            int inx = 0;
-            while (!done)
-            {
-                val = m_decAxisStats.GetEntry(inx);
-                decVals.AddGuideInfo(val.DeltaTime, val.StarPos, 0);
-                // Compute the minimum sigma for sliding, overlapping 2-min elapsed time intervals. Include the final interval
-                // if it's >= 1.6 minutes
-                if (val.DeltaTime - tStart >= MEASUREMENT_WINDOW_SIZE ||
-                    (inx == lastInx && val.DeltaTime - tStart >= 0.8 * MEASUREMENT_WINDOW_SIZE))
-                {
-                    if (decVals.GetCount() > 1)
-                    {
-                        double simpleSigma = decVals.GetSigma();
-                        rSquared = decVals.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
-                        // If there is little drift relative to the random movements, the drift-correction is irrelevant and can
-                        // actually degrade the result.  So don't use the drift-corrected RMS unless it's smaller than the
-                        // simple sigma
-                        if (correctedRMS < simpleSigma)
-                        {
-                            if (correctedRMS < bestEstimate) // Keep track of the smallest value seen
-                            {
-                                bestEstimate = correctedRMS;
-                                selRSquared = rSquared;
-                                selSlope = slope;
-                            }
-                        }
-                        else
-                            bestEstimate = wxMin(bestEstimate, simpleSigma);
-                        Debug.Write(wxString::Format("GA long series, window start=%0.0f, window end=%0.0f, Uncorrected "
-                                                     "RMS=%0.3f, Drift=%0.3f, Corrected RMS=%0.3f, R-sq=%0.3f\n",
-                                                     tStart, val.DeltaTime, simpleSigma, slope * 60, correctedRMS, rSquared));
-                    }
-                    // Move the start of the next window earlier by 1 minute
-                    double targetTime = val.DeltaTime - WINDOW_ADJUSTMENT;
-                    while (m_decAxisStats.GetEntry(inx).DeltaTime > targetTime)
-                        inx--;
-                    tStart = m_decAxisStats.GetEntry(inx).DeltaTime;
-
-                    decVals.ClearAll();
-                }
-                else
-                {
-                    inx++;
-                }
-                done = (inx > lastInx);
-            }
+            bestEstimate = GetBestIntervalSigma(m_decAxisStats, MEASUREMENT_WINDOW_SIZE, &selSlope, &selRSquared);
             Debug.Write(wxString::Format(
                 "Full uncorrected RMS=%0.3fpx, Selected Dec drift=%0.3f px/min, Best seeing estimate=%0.3fpx, R-sq=%0.3f\n",
                 m_decAxisStats.GetSigma(), selSlope * 60, bestEstimate, selRSquared));
@@ -1256,8 +1207,8 @@ void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double& RecDec)
         else
         {
             // Just reiterate the estimates made in the new-profile-wiz
-            RecDec =
-                GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+            RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                                         pCamera->TotalBinning());
             RecRA = wxMax(minMoveFloor, RecDec * multiplier_ra);
             Debug.Write(wxString::Format("GA Min-Move calcs failed sanity-check, DecEst=%0.3f, Dec-HPF-Sigma=%0.3f\n",
                                          roundUpEst, m_hpfDecStats.GetSigma()));
@@ -1268,7 +1219,8 @@ void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double& RecDec)
     {
         Debug.Write("Exception thrown in GA min-move calcs: " + msg + "\n");
         // Punt by reiterating estimates made by new-profile-wiz
-        RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+        RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                                     pCamera->TotalBinning());
         RecRA = RecDec * multiplier_ra / multiplier_dec;
         Debug.Write(wxString::Format("GA Min-Move recs reverting to smart defaults, RA=%0.3f, Dec=%0.3f\n", RecRA, RecDec));
     }
@@ -254,6 +254,159 @@ void LowPassFilter::Reset()
     lpfResult = 0.;
 }
 
+// Indexable skip list, see W. Pugh, "A Skip List Cookbook".  Each link
+// also holds its width, the number of values it skips, so the position
+// of a node is the sum of the widths on the search path to it.  Nodes live
+// in a vector and are re-used after removal, so a windowed dataset does not
+// allocate memory once the window is full
+OrderStatistics::OrderStatistics()
+{
+    randomState = 2463534242u;
+    Clear();
+}
+
+void OrderStatistics::Clear()
+{
+    nodes.resize(1);
+    freeNodes.clear();
+    count = 0;
+
+    Node& head = nodes[0];
+    head.levels = MaxLevels;
+    for (int level = 0; level < MaxLevels; level++)
+    {
+        head.link[level].next = -1;
+        head.link[level].width = 1;
+    }
+}
+
+// Each level holds 1/4 of the nodes of the level below
+int OrderStatistics::RandomLevels()
+{
+    // xorshift32, deterministic so that results are reproducible
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    int levels = 1;
+    unsigned int bits = randomState;
+    while (levels < MaxLevels && (bits & 3) == 0)
+    {
+        ++levels;
+        bits >>= 2;
+    }
+    return levels;
+}
+
+void OrderStatistics::Add(double Val)
+{
+    int chain[MaxLevels]; // last node before the new one on each level
+    unsigned int chainPos[MaxLevels]; // position of that node, the head is at 0
+
+    int inx = 0;
+    unsigned int pos = 0;
+    for (int level = MaxLevels - 1; level >= 0; level--)
+    {
+        while (nodes[inx].link[level].next >= 0 && nodes[nodes[inx].link[level].next].value <= Val)
+        {
+            pos += nodes[inx].link[level].width;
+            inx = nodes[inx].link[level].next;
+        }
+        chain[level] = inx;
+        chainPos[level] = pos;
+    }
+
+    int newInx;
+    if (!freeNodes.empty())
+    {
+        newInx = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else
+    {
+        newInx = nodes.size();
+        nodes.push_back(Node());
+    }
+
+    Node& node = nodes[newInx];
+    node.value = Val;
+    node.levels = RandomLevels();
+
+    unsigned int newPos = chainPos[0] + 1;
+    for (int level = 0; level < MaxLevels; level++)
+    {
+        Link& prev = nodes[chain[level]].link[level];
+        if (level < node.levels)
+        {
+            node.link[level].next = prev.next;
+            node.link[level].width = prev.width - (newPos - chainPos[level]) + 1;
+            prev.next = newInx;
+            prev.width = newPos - chainPos[level];
+        }
+        else
+            prev.width++;
+    }
+    ++count;
+}
+
+bool OrderStatistics::Remove(double Val)
+{
+    int chain[MaxLevels]; // last node with a smaller value on each level
+
+    int inx = 0;
+    for (int level = MaxLevels - 1; level >= 0; level--)
+    {
+        while (nodes[inx].link[level].next >= 0 && nodes[nodes[inx].link[level].next].value < Val)
+            inx = nodes[inx].link[level].next;
+        chain[level] = inx;
+    }
+
+    // the first node with the value is the next one on every level it is part of
+    int target = nodes[chain[0]].link[0].next;
+    if (target < 0 || nodes[target].value != Val)
+        return false;
+
+    const Node& node = nodes[target];
+    for (int level = 0; level < MaxLevels; level++)
+    {
+        Link& prev = nodes[chain[level]].link[level];
+        if (level < node.levels)
+        {
+            prev.width += node.link[level].width - 1;
+            prev.next = node.link[level].next;
+        }
+        else
+            prev.width--;
+    }
+
+    freeNodes.push_back(target);
+    --count;
+    return true;
+}
+
+unsigned int OrderStatistics::GetCount() const
+{
+    return count;
+}
+
+double OrderStatistics::GetValue(unsigned int Rank) const
+{
+    if (Rank >= count)
+        return 0.;
+
+    int inx = 0;
+    unsigned int pos = 0;
+    for (int level = MaxLevels - 1; level >= 0; level--)
+    {
+        while (nodes[inx].link[level].next >= 0 && pos + nodes[inx].link[level].width <= Rank + 1)
+        {
+            pos += nodes[inx].link[level].width;
+            inx = nodes[inx].link[level].next;
+        }
+    }
+    return nodes[inx].value;
+}
+
 // AxisStats, WindowedAxisStats, and the StarDisplacement classes can be
 // used to collect and evaluate typical guiding data.  Windowed datasets
 // will be automatically trimmed if AutoWindowSize > 0 or can be manually
@@ -279,6 +432,7 @@ void AxisStats::ClearAll()
 {
     InitializeScalars();
     guidingEntries.clear();
+    sortedPositions.Clear();
 }
 
 void AxisStats::InitializeScalars()
@@ -292,9 +446,8 @@ void AxisStats::InitializeScalars()
     sumXSq = 0.;
     prevPosition = 0.;
     prevMove = 0.;
-    minDisplacement = std::numeric_limits<double>::max();
-    maxDisplacement = std::numeric_limits<double>::min();
     maxDelta = 0.;
+    maxDeltaInx = 0;
 }
 
 // Return number of guide steps where GuideAmount was non-zero
@@ -323,8 +476,7 @@ void AxisStats::AddGuideInfo(double DeltaT, double StarPos, double GuideAmt)
 {
     StarDisplacement starInfo(DeltaT, StarPos);
 
-    minDisplacement = std::min(StarPos, minDisplacement);
-    maxDisplacement = std::max(StarPos, maxDisplacement);
+    sortedPositions.Add(StarPos);
 
     sumX += DeltaT;
     sumXY += DeltaT * StarPos;
@@ -468,24 +620,15 @@ double AxisStats::GetMedian() const
     if (sz > 1)
     {
         double rslt = 0.;
-
-        // Need a copy of guidingEntries to do a sort
-        std::vector<double> sortedEntries;
-
-        for (auto pGS = guidingEntries.begin(); pGS != guidingEntries.end(); ++pGS)
-        {
-            sortedEntries.push_back(pGS->StarPos);
-        }
-        std::sort(sortedEntries.begin(), sortedEntries.end());
-        size_t ctr = sortedEntries.size() / 2;
-        if (sortedEntries.size() % 2 == 1)
+        unsigned int ctr = sz / 2;
+        if (sz % 2 == 1)
         {
-            rslt = sortedEntries[ctr];
+            rslt = sortedPositions.GetValue(ctr);
         }
         else
         {
             // even number of entries => take average of two entires adjacent to center
-            rslt = (sortedEntries[ctr] + sortedEntries[ctr - 1]) / 2.0;
+            rslt = (sortedPositions.GetValue(ctr) + sortedPositions.GetValue(ctr - 1)) / 2.0;
         }
         return rslt;
     }
@@ -501,7 +644,7 @@ double AxisStats::GetMinDisplacement() const
     size_t sz = guidingEntries.size();
 
     if (sz > 0)
-        return minDisplacement;
+        return sortedPositions.GetValue(0);
     else
         return 0.;
 }
@@ -512,7 +655,7 @@ double AxisStats::GetMaxDisplacement() const
     size_t sz = guidingEntries.size();
 
     if (sz > 0)
-        return maxDisplacement;
+        return sortedPositions.GetValue(sz - 1);
     else
         return 0.;
 }
@@ -611,13 +754,14 @@ bool WindowedAxisStats::ChangeWindowSize(unsigned int NewSize)
     return success;
 }
 
-// Private function to re-compute min, max, and maxDelta values when a guide
-// entry is going to be removed.  With an auto-windowed instance of
-// AxisStats, an entry removal can happen for every addition, so we avoid
-// iterating through the entire collection unless it's required because of
-// the entry that's being aged out.  This function must be called before
-// entry[0] (the oldest) is actually removed.
-void WindowedAxisStats::AdjustMinMaxValues()
+// Private function to re-compute the maxDelta value when a guide entry is
+// going to be removed.  With an auto-windowed instance of AxisStats, an
+// entry removal can happen for every addition, so we avoid iterating
+// through the entire collection unless it's required because of the entry
+// that's being aged out.  Min and max values need no adjustment, they are
+// kept in sorted order.  This function must be called before entry[0] (the
+// oldest) is actually removed.
+void WindowedAxisStats::AdjustMaxDelta()
 {
     StarDisplacement target = guidingEntries.front(); // Entry that's about to be removed
     bool recalNeeded = false;
@@ -625,12 +769,10 @@ void WindowedAxisStats::AdjustMinMaxValues()
 
     if (guidingEntries.size() > 1)
     {
-        // Minimize recalculations
-        recalNeeded = target.StarPos == maxDisplacement || target.StarPos == minDisplacement || maxDeltaInx == 0;
+        // Minimize recalculations, the delta of entry 1 is measured from the entry being removed
+        recalNeeded = maxDeltaInx <= 1;
         if (recalNeeded)
         {
-            minDisplacement = std::numeric_limits<double>::max();
-            maxDisplacement = std::numeric_limits<double>::min();
             maxDelta = 0.;
         }
     }
@@ -641,8 +783,6 @@ void WindowedAxisStats::AdjustMinMaxValues()
              ++pGS) // Dont start at zero, that will be removed
         {
             StarDisplacement entry = *pGS;
-            minDisplacement = std::min(minDisplacement, entry.StarPos);
-            maxDisplacement = std::max(maxDisplacement, entry.StarPos);
             if (pGS - guidingEntries.begin() > 1)
             {
                 if (fabs(entry.StarPos - prev) > maxDelta)
@@ -675,7 +815,8 @@ void WindowedAxisStats::RemoveOldestEntry()
             axisReversals--;
         if (target.Guided)
             axisMoves--;
-        AdjustMinMaxValues(); // Will process list only if required
+        AdjustMaxDelta(); // Will process list only if required
+        sortedPositions.Remove(val);
         guidingEntries.pop_front();
         maxDeltaInx--;
     }
@@ -691,3 +832,96 @@ void WindowedAxisStats::AddGuideInfo(double DeltaT, double StarPos, double Guide
         RemoveOldestEntry();
     }
 }
+
+// The intervals slide over the series in a manually trimmed WindowedAxisStats.  Entries shared with the previous interval are
+// kept and only the oldest ones are removed, so every entry is added to the running sums once no matter how long the series is
+double GetBestIntervalSigma(const AxisStats& Series, double IntervalSecs, double *SelSlope, double *SelRSquared)
+{
+    WindowedAxisStats vals(0); // self-managed window
+    double bestEstimate = 1000;
+    double slope = 0;
+    double intcpt = 0;
+    double rSquared = 0;
+    double correctedRMS;
+    const double windowAdjustment = IntervalSecs / 2;
+
+    *SelSlope = 0;
+    *SelRSquared = 0;
+
+    int lastInx = Series.GetCount() - 1;
+    if (lastInx < 0)
+        return bestEstimate;
+
+    StarDisplacement val = Series.GetEntry(0);
+    double tStart = val.DeltaTime;
+    int inx = 0; // entry that may end the current interval
+    int startInx = 0; // first entry of the current interval, the oldest entry in vals
+    int endInx = -1; // newest entry in vals
+
+    while (inx <= lastInx)
+    {
+        val = Series.GetEntry(inx);
+        if (inx > endInx)
+        {
+            vals.AddGuideInfo(val.DeltaTime, val.StarPos, 0);
+            endInx = inx;
+        }
+        // Compute the minimum sigma for sliding, overlapping intervals. Include the final interval if it's >= 80% of the
+        // interval size
+        if (val.DeltaTime - tStart >= IntervalSecs || (inx == lastInx && val.DeltaTime - tStart >= 0.8 * IntervalSecs))
+        {
+            if (inx < endInx)
+            {
+                // Interval is shorter than the previous one, only possible with gaps in the data
+                vals.ClearAll();
+                for (endInx = startInx; endInx <= inx; endInx++)
+                {
+                    StarDisplacement entry = Series.GetEntry(endInx);
+                    vals.AddGuideInfo(entry.DeltaTime, entry.StarPos, 0);
+                }
+                endInx = inx;
+            }
+            if (vals.GetCount() > 1)
+            {
+                double simpleSigma = vals.GetSigma();
+                rSquared = vals.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
+                // If there is little drift relative to the random movements, the drift-correction is irrelevant and can
+                // actually degrade the result.  So don't use the drift-corrected RMS unless it's smaller than the simple sigma
+                if (correctedRMS < simpleSigma)
+                {
+                    if (correctedRMS < bestEstimate) // Keep track of the smallest value seen
+                    {
+                        bestEstimate = correctedRMS;
+                        *SelRSquared = rSquared;
+                        *SelSlope = slope;
+                    }
+                }
+                else
+                    bestEstimate = std::min(bestEstimate, simpleSigma);
+                Debug.Write(wxString::Format("GA long series, window start=%0.0f, window end=%0.0f, Uncorrected "
+                                             "RMS=%0.3f, Drift=%0.3f, Corrected RMS=%0.3f, R-sq=%0.3f\n",
+                                             tStart, val.DeltaTime, simpleSigma, slope * 60, correctedRMS, rSquared));
+            }
+            // Move the start of the next interval earlier by half an interval
+            double targetTime = val.DeltaTime - windowAdjustment;
+            while (Series.GetEntry(inx).DeltaTime > targetTime)
+                inx--;
+            // Always move forward, a gap in the data could otherwise select the same interval again
+            inx = std::max(inx, startInx + 1);
+            tStart = Series.GetEntry(inx).DeltaTime;
+
+            // Slide the window, entries up to endInx are re-used for the next interval
+            while (startInx < inx)
+            {
+                vals.RemoveOldestEntry();
+                startInx++;
+            }
+        }
+        else
+        {
+            inx++;
+        }
+    }
+
+    return bestEstimate;
+}
@@ -36,6 +36,7 @@
 #ifndef _GUIDING_STATS_H
 #define _GUIDING_STATS_H
 #include <deque>
+#include <vector>
 
 // DescriptiveStats is used for basic statistics.  Max, min, sigma and variance are computed on-the-fly as values are added to a
 // dataset Applicable to any double values, no semantic assumptions made.  Does not retain a list of values
@@ -105,6 +106,42 @@ public:
     void Reset();
 };
 
+// OrderStatistics keeps a multiset of double values in sorted order as an indexable skip list, so values can be added and
+// removed in any order and the value of any rank can be found in O(log n) time.  Used by AxisStats for the median, minimum
+// and maximum of windowed datasets without sorting or scanning the window on every call
+class OrderStatistics
+{
+private:
+    enum
+    {
+        MaxLevels = 12
+    };
+    struct Link
+    {
+        int next; // index of the next node on this level, -1 at the end
+        int width; // number of level-0 steps to the next node
+    };
+    struct Node
+    {
+        double value;
+        int levels;
+        Link link[MaxLevels];
+    };
+    std::vector<Node> nodes; // nodes[0] is the head, it precedes all values
+    std::vector<int> freeNodes; // removed nodes available for re-use
+    unsigned int count;
+    unsigned int randomState;
+    int RandomLevels();
+
+public:
+    OrderStatistics();
+    void Add(double Val); // Add a value, duplicates are allowed
+    bool Remove(double Val); // Remove one instance of a value, returns false if it is not present
+    void Clear();
+    unsigned int GetCount() const;
+    double GetValue(unsigned int Rank) const; // Value of rank 0..count-1 in ascending order. Caller should insure Rank < count
+};
+
 // Support structure for use with AxisStats to keep a queue of guide star displacements and relative time values
 // Timestamps are intended to be incremental, i.e seconds since start of guiding, and are used only for linear fit operations
 struct StarDisplacement
@@ -126,6 +163,7 @@ protected:
     std::deque<StarDisplacement> guidingEntries; // queue of elements in dataset
     unsigned int axisMoves; // number of times in window when guide pulse was non-zero
     unsigned int axisReversals; // number of times in window when guide pulse caused a direction reversal
+    OrderStatistics sortedPositions; // star positions in the dataset, in ascending order
     double prevMove; // value of guide pulse in next-to-last entry
     double prevPosition; // value of guide star location in next-to-last entry
     // Variables used to compute stats in windowed AxisStats
@@ -135,8 +173,6 @@ protected:
     double sumXSq; // Sum of (x squared)
     double sumYSq; // Sum of (y squared)
     // Variables needed for windowed or non-windowed versions
-    double maxDisplacement; // maximum star position value in current dataset
-    double minDisplacement; // minimum star position value in current dataset
     double maxDelta; // maximum absolute delta of incremental star deltas
     int maxDeltaInx;
     void InitializeScalars();
@@ -194,7 +230,7 @@ class WindowedAxisStats : public AxisStats
 {
     bool autoWindowing = false;
     int windowSize = 0;
-    void AdjustMinMaxValues();
+    void AdjustMaxDelta();
 
 public:
     WindowedAxisStats() {};
@@ -208,4 +244,10 @@ public:
     void AddGuideInfo(double DeltaT, double StarPos, double GuideAmt);
 };
 
+// Seeing estimate for a long series of star positions, as used by the Guiding Assistant.  The series is split into overlapping
+// intervals of IntervalSecs elapsed time, each starting half an interval after the previous one; the final interval is used if
+// it spans at least 80% of IntervalSecs.  Returns the smallest sigma of any interval, drift-corrected where that is smaller than
+// the plain sigma.  SelSlope and SelRSquared receive the linear fit of the drift-corrected interval that was selected
+extern double GetBestIntervalSigma(const AxisStats& Series, double IntervalSecs, double *SelSlope, double *SelRSquared);
+
 #endif
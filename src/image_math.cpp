@@ -76,77 +76,147 @@ double CalcSlope(const ArrayOfDbl& y)
     return (n * s_xy - (s_x * s_y)) / (n * s_xx - (s_x * s_x));
 }
 
-bool QuickLRecon(usImage& img)
+// Luminance reconstruction for one-shot color sensors. All of the methods work in
+// place within the image (or its subframe) and keep the frame geometry.
+
+static void LumSliding2x2(usImage& img, const wxRect& r)
 {
-    // Does a simple debayer of luminance data only -- sliding 2x2 window
-    usImage tmp;
-    if (tmp.Init(img.Size))
+    // each output pixel is the mean of the 2x2 block to its lower right; the block only
+    // reads pixels that have not been written yet, so no copy of the frame is needed
+    int const W = img.Size.GetWidth();
+
+    for (int y = r.GetTop(); y <= r.GetBottom(); y++)
     {
-        pFrame->Alert(_("Memory allocation error"));
-        return true;
+        unsigned short *p = img.ImageData + y * W + r.GetLeft();
+        const unsigned short *q = y < r.GetBottom() ? p + W : p;
+        int const n = r.GetWidth() - 1;
+
+        for (int x = 0; x < n; x++)
+            p[x] = (unsigned short) (((unsigned int) p[x] + p[x + 1] + q[x] + q[x + 1]) >> 2);
+        p[n] = (unsigned short) (((unsigned int) p[n] + q[n]) >> 1);
     }
+}
 
+static void LumSuperpixel(usImage& img, const wxRect& r)
+{
+    // average each whole RGGB cell and write the result to all four of its pixels. Cells
+    // are aligned to the sensor, not the subframe, so that each holds one of every color
     int const W = img.Size.GetWidth();
-    int RX, RY, RW, RH;
-    if (img.Subframe.IsEmpty())
-    {
-        RX = RY = 0;
-        RW = img.Size.GetWidth();
-        RH = img.Size.GetHeight();
-    }
-    else
+    int const x0 = r.GetLeft(), x1 = r.GetRight();
+    int const y0 = r.GetTop(), y1 = r.GetBottom();
+
+    for (int y = y0 & ~1; y <= y1; y += 2)
     {
-        RX = img.Subframe.GetX();
-        RY = img.Subframe.GetY();
-        RW = img.Subframe.GetWidth();
-        RH = img.Subframe.GetHeight();
-        tmp.Clear();
+        int const ya = wxMax(y, y0), yb = wxMin(y + 1, y1);
+        unsigned short *pa = img.ImageData + ya * W;
+        unsigned short *pb = img.ImageData + yb * W;
+
+        for (int x = x0 & ~1; x <= x1; x += 2)
+        {
+            int const xa = wxMax(x, x0), xb = wxMin(x + 1, x1);
+            unsigned short v =
+                (unsigned short) (((unsigned int) pa[xa] + pa[xb] + pb[xa] + pb[xb] + 2) >> 2);
+            pa[xa] = pa[xb] = pb[xa] = pb[xb] = v;
+        }
     }
+}
 
-#define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
+// copy one row of the region into buf with a reflected pixel at each end; reflection
+// keeps the color of the neighbors right
+static void LoadReflectedRow(unsigned short *buf, const unsigned short *row, int width)
+{
+    memcpy(buf + 1, row, width * sizeof(unsigned short));
+    buf[0] = width > 1 ? row[1] : row[0];
+    buf[width + 1] = width > 1 ? row[width - 2] : row[width - 1];
+}
 
-    unsigned short *d;
-    unsigned int t;
+static void LumBilinear(usImage& img, const wxRect& r, BayerPattern pattern)
+{
+    // Bilinear interpolation of the missing colors followed by L = (R + 2G + B) / 4 reduces
+    // to two 3x3 kernels:
+    //   at a red or blue pixel  L = (4 c + 2 (N + S + E + W) + (NE + NW + SE + SW)) / 16
+    //   at a green pixel        L = (8 c + 2 (N + S + E + W)) / 16
+    // so the only thing the pattern decides is which pixels are green.
+    int const W = img.Size.GetWidth();
+    int const w = r.GetWidth();
+    int const h = r.GetHeight();
+
+    if (w < 2 || h < 2)
+        return;
 
-    for (int y = 0; y <= RH - 2; y++)
+    // green sits where (x + y) is odd for RGGB / BGGR and even for GRBG / GBRG
+    int const greenParity = pattern == BAYER_RGGB || pattern == BAYER_BGGR ? 1 : 0;
+
+    // three reflected rows: previous and current are copies because the frame is
+    // overwritten as we go, the next row is still intact in the frame
+    std::vector<unsigned short> bufs(3 * (w + 2));
+    unsigned short *prev = &bufs[0];
+    unsigned short *cur = &bufs[w + 2];
+    unsigned short *next = &bufs[2 * (w + 2)];
+
+    unsigned short *row0 = img.ImageData + r.GetTop() * W + r.GetLeft();
+    LoadReflectedRow(cur, row0, w);
+    LoadReflectedRow(prev, row0 + W, w); // reflected row above the first
+
+    for (int y = 0; y < h; y++)
     {
-        d = &tmp.ImageData[IX(0, y)];
+        unsigned short *out = row0 + y * W;
+        if (y + 1 < h)
+            LoadReflectedRow(next, out + W, w);
+        else
+            memcpy(next, prev, (w + 2) * sizeof(unsigned short)); // reflected row below the last
+
+        // first pixel of this row that is green, in region coordinates
+        int const g0 = (r.GetLeft() + r.GetTop() + y + greenParity) & 1 ? 1 : 0;
 
-        for (int x = 0; x <= RW - 2; x++)
+        for (int x = 0; x < w; x++)
         {
-            t = img.ImageData[IX(x, y)];
-            t += img.ImageData[IX(x + 1, y)];
-            t += img.ImageData[IX(x, y + 1)];
-            t += img.ImageData[IX(x + 1, y + 1)];
-            *d++ = (unsigned short) (t >> 2);
+            int const i = x + 1;
+            unsigned int orth = (unsigned int) prev[i] + next[i] + cur[i - 1] + cur[i + 1];
+            unsigned int v;
+            if (((x + g0) & 1) == 0)
+                v = (8u * cur[i] + 2u * orth + 8) >> 4;
+            else
+                v = (4u * cur[i] + 2u * orth + prev[i - 1] + prev[i + 1] + next[i - 1] + next[i + 1] + 8) >> 4;
+            out[x] = (unsigned short) v;
         }
 
-        // last col
-        t = img.ImageData[IX(RW - 1, y)];
-        t += img.ImageData[IX(RW - 1, y + 1)];
-        *d = (unsigned short) (t >> 1);
+        std::swap(prev, cur);
+        std::swap(cur, next);
     }
+}
 
-    // last row
+bool LumRecon(usImage& img, DebayerMethod method, BayerPattern pattern)
+{
+    if (!img.ImageData)
+        return true;
 
-    d = &tmp.ImageData[IX(0, RH - 1)];
+    wxRect r = img.Subframe.IsEmpty() ? wxRect(img.Size) : img.Subframe;
 
-    for (int x = 0; x <= RW - 2; x++)
+    switch (method)
     {
-        t = img.ImageData[IX(x, RH - 1)];
-        t += img.ImageData[IX(x + 1, RH - 1)];
-        *d++ = (unsigned short) (t >> 1);
+    case DEBAYER_SLIDING_2X2:
+        LumSliding2x2(img, r);
+        break;
+    case DEBAYER_SUPERPIXEL:
+        LumSuperpixel(img, r);
+        break;
+    case DEBAYER_BILINEAR:
+    default:
+        LumBilinear(img, r, pattern);
+        break;
     }
 
-    // bottom-right pixel
-    *d = img.ImageData[IX(RW - 1, RH - 1)];
-
-#undef IX
-
-    img.SwapImageData(tmp);
     return false;
 }
 
+bool QuickLRecon(usImage& img)
+{
+    if (!pCamera)
+        return LumRecon(img, DEBAYER_SLIDING_2X2, BAYER_RGGB);
+    return LumRecon(img, pCamera->Debayer, pCamera->Pattern);
+}
+
 bool Median3(usImage& img)
 {
     usImage tmp;
@@ -646,6 +716,119 @@ bool SquarePixels(usImage& img, float xsize, float ysize)
     return false;
 }
 
+// Mean binning of the block rows starting at src, bin x bin pixels per output pixel. The
+// source rows are first summed column-wise into colsum so that the inner loops are plain
+// contiguous adds the compiler can vectorize.
+template<unsigned int B>
+static void BinRowsMean(unsigned short *dst, const unsigned short *src, int srcStride, int width, unsigned int *colsum)
+{
+    int const n = width * B;
+
+    for (int x = 0; x < n; x++)
+        colsum[x] = src[x];
+    for (unsigned int r = 1; r < B; r++)
+    {
+        const unsigned short *s = src + r * srcStride;
+        for (int x = 0; x < n; x++)
+            colsum[x] += s[x];
+    }
+
+    const unsigned int *c = colsum;
+    for (int x = 0; x < width; x++, c += B)
+    {
+        unsigned int sum = 0;
+        for (unsigned int k = 0; k < B; k++)
+            sum += c[k];
+        dst[x] = (unsigned short) ((sum + B * B / 2) / (B * B));
+    }
+}
+
+static void BinRowsMedian(unsigned short *dst, const unsigned short *src, int srcStride, int width, unsigned int bin)
+{
+    unsigned short block[16];
+    unsigned int const cnt = bin * bin;
+
+    for (int x = 0; x < width; x++)
+    {
+        unsigned short *p = block;
+        for (unsigned int r = 0; r < bin; r++)
+        {
+            const unsigned short *s = src + r * srcStride + x * bin;
+            for (unsigned int k = 0; k < bin; k++)
+                *p++ = s[k];
+        }
+
+        if (bin == 2)
+            dst[x] = median4(block);
+        else if (bin == 3)
+            dst[x] = median9(block);
+        else
+        {
+            std::nth_element(block, block + cnt / 2, block + cnt);
+            unsigned short hi = block[cnt / 2];
+            unsigned short lo = *std::max_element(block, block + cnt / 2);
+            dst[x] = (unsigned short) (((unsigned int) lo + (unsigned int) hi) / 2);
+        }
+    }
+}
+
+// Software binning: dst is set to src binned by 2, 3 or 4 in each direction, using the
+// mean or the median of each block. When src has a subframe only the blocks lying entirely
+// within it are binned, and dst gets the corresponding subframe.
+bool BinImage(usImage& dst, const usImage& src, unsigned int binning, bool median)
+{
+    if (!src.ImageData || binning < 2 || binning > 4)
+        return true;
+
+    if (dst.Init(src.Size.GetWidth() / binning, src.Size.GetHeight() / binning))
+        return true;
+
+    dst.ImgStartTime = src.ImgStartTime;
+    dst.ImgExpDur = src.ImgExpDur;
+    dst.ImgStackCnt = src.ImgStackCnt;
+    dst.BitsPerPixel = src.BitsPerPixel;
+    dst.Pedestal = src.Pedestal;
+
+    wxRect area(dst.Size);
+
+    if (!src.Subframe.IsEmpty())
+    {
+        int left = (src.Subframe.GetLeft() + binning - 1) / binning;
+        int top = (src.Subframe.GetTop() + binning - 1) / binning;
+        int right = (src.Subframe.GetRight() + 1) / binning; // exclusive
+        int bottom = (src.Subframe.GetBottom() + 1) / binning;
+
+        area = wxRect(left, top, wxMax(right - left, 0), wxMax(bottom - top, 0));
+        area.Intersect(wxRect(dst.Size));
+
+        memset(dst.ImageData, 0, dst.NPixels * sizeof(unsigned short));
+        dst.Subframe = area;
+    }
+
+    if (area.IsEmpty())
+        return false;
+
+    int const srcStride = src.Size.GetWidth();
+    std::vector<unsigned int> colsum(area.GetWidth() * binning);
+
+    for (int y = area.GetTop(); y <= area.GetBottom(); y++)
+    {
+        unsigned short *d = &dst.Pixel(area.GetLeft(), y);
+        const unsigned short *s = &src.Pixel(area.GetLeft() * binning, y * binning);
+
+        if (median)
+            BinRowsMedian(d, s, srcStride, area.GetWidth(), binning);
+        else if (binning == 2)
+            BinRowsMean<2>(d, s, srcStride, area.GetWidth(), &colsum[0]);
+        else if (binning == 3)
+            BinRowsMean<3>(d, s, srcStride, area.GetWidth(), &colsum[0]);
+        else
+            BinRowsMean<4>(d, s, srcStride, area.GetWidth(), &colsum[0]);
+    }
+
+    return false;
+}
+
 // Dark subtraction algorithm:
 //     Pedestal = max(median(dark_frame) - median(light_frame), 0) - handles overall gain/gradient differences
 //     Dark_corrected(i) = min(max(light(i) + pedestal - dark(i), 0), 65335)
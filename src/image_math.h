@@ -53,10 +53,12 @@ public:
     void AddDefect(const wxPoint& pt);
 };
 
+extern bool LumRecon(usImage& img, DebayerMethod method, BayerPattern pattern);
 extern bool QuickLRecon(usImage& img);
 extern void Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect);
 extern bool Median3(usImage& img);
 extern bool SquarePixels(usImage& img, float xsize, float ysize);
+extern bool BinImage(usImage& dst, const usImage& src, unsigned int binning, bool median);
 extern int dbl_sort_func(double *first, double *second);
 extern bool Subtract(usImage& light, const usImage& dark);
 extern double CalcSlope(const ArrayOfDbl& y);
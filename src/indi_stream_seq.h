@@ -0,0 +1,65 @@
+/*
+ *  indi_stream_seq.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INDI_STREAM_SEQ_H_INCLUDED
+#define INDI_STREAM_SEQ_H_INCLUDED
+
+// Sequence numbers of the frames of an INDI video stream, used by the streaming guide mode of CameraINDI.  Frames are
+// numbered as they arrive from the driver; they may finish decoding out of order, and a decoded frame is only published if it
+// is newer than every frame published before it.  Not thread-safe, the stream decoder calls it under its lock.
+class StreamSequence
+{
+    unsigned int m_next; // number of the next frame to arrive
+    unsigned int m_published; // newest published frame, 0 if none
+
+public:
+    StreamSequence() : m_next(1), m_published(0) { }
+
+    // Number a frame that just arrived
+    unsigned int Arrived() { return m_next++; }
+
+    // Oldest frame that a capture requested now may use.  Frames are exposed back-to-back, so the next frame to arrive was
+    // already exposing when the capture was requested, possibly while the mount was still moving; only the one after it was
+    // exposed entirely after the request
+    unsigned int CaptureMinSeq() const { return m_next + 1; }
+
+    // True if frame seq is newer than the newest published frame
+    bool IsNewer(unsigned int seq) const { return seq > m_published; }
+
+    void SetPublished(unsigned int seq) { m_published = seq; }
+
+    // True if the newest published frame may be used by a capture that needs frame minSeq or newer
+    bool IsUsable(unsigned int minSeq) const { return m_published >= minSeq; }
+};
+
+#endif // INDI_STREAM_SEQ_H_INCLUDED
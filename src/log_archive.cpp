@@ -0,0 +1,508 @@
+/*
+ *  log_archive.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+#include "log_archive.h"
+
+#include <deque>
+#include <zlib.h>
+
+namespace
+{
+
+// one chunk of a file; chunks after the first are primed with the tail of
+// the preceding chunk so that splitting costs little compression ratio
+struct DeflateChunk
+{
+    std::vector<unsigned char> in;
+    const unsigned char *dict;
+    unsigned int dictLen;
+    bool last;
+    std::vector<unsigned char> out;
+    uLong crc;
+    bool ok;
+};
+
+enum
+{
+    DICT_SIZE = 32768,
+};
+
+void CompressChunk(DeflateChunk& c, int level)
+{
+    c.ok = false;
+    c.crc = crc32(0L, c.in.data(), (uInt) c.in.size());
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return;
+
+    if (c.dictLen)
+        deflateSetDictionary(&zs, c.dict, c.dictLen);
+
+    // room for the sync flush marker in addition to the worst case expansion
+    c.out.resize(deflateBound(&zs, (uLong) c.in.size()) + 16);
+
+    zs.next_in = c.in.data();
+    zs.avail_in = (uInt) c.in.size();
+    zs.next_out = c.out.data();
+    zs.avail_out = (uInt) c.out.size();
+
+    // a sync flush ends the chunk on a byte boundary without marking the
+    // final block, so the compressed chunks can simply be concatenated
+    int ret = deflate(&zs, c.last ? Z_FINISH : Z_SYNC_FLUSH);
+    c.ok = c.last ? ret == Z_STREAM_END : ret == Z_OK && zs.avail_in == 0;
+    c.out.resize(zs.total_out);
+
+    deflateEnd(&zs);
+}
+
+void Put16(std::vector<unsigned char>& buf, unsigned int v)
+{
+    buf.push_back(v & 0xff);
+    buf.push_back((v >> 8) & 0xff);
+}
+
+void Put32(std::vector<unsigned char>& buf, unsigned long v)
+{
+    Put16(buf, v & 0xffff);
+    Put16(buf, (v >> 16) & 0xffff);
+}
+
+void Put64(std::vector<unsigned char>& buf, unsigned long long v)
+{
+    Put32(buf, (unsigned long) (v & 0xffffffffULL));
+    Put32(buf, (unsigned long) (v >> 32));
+}
+
+unsigned int DosTime(const wxDateTime& dt)
+{
+    if (!dt.IsValid() || dt.GetYear() < 1980)
+        return (1 << 21) | (1 << 16); // 1980-01-01
+    return ((dt.GetYear() - 1980) << 25) | ((dt.GetMonth() - wxDateTime::Jan + 1) << 21) | (dt.GetDay() << 16) |
+        (dt.GetHour() << 11) | (dt.GetMinute() << 5) | (dt.GetSecond() / 2);
+}
+
+const unsigned long long ZIP32_MAX = 0xffffffffULL;
+// entries approaching 4GB are written as zip64 since the compressed size is not known up front
+const unsigned long long ZIP64_THRESHOLD = 0xff000000ULL;
+
+} // namespace
+
+// worker threads started once per archive; chunks are queued by the writer,
+// which also compresses from the queue while it waits for the batch
+class LogArchive::DeflatePool
+{
+    struct Worker : public wxThread
+    {
+        DeflatePool& pool;
+
+        Worker(DeflatePool& pool_) : wxThread(wxTHREAD_JOINABLE), pool(pool_) { }
+
+        ExitCode Entry() override
+        {
+            pool.Work(false);
+            return nullptr;
+        }
+    };
+
+    wxMutex m_lock;
+    wxCondition m_workCond; // signaled when chunks are queued or on stop
+    wxCondition m_doneCond; // signaled when the last queued chunk completes
+    std::deque<DeflateChunk *> m_queue;
+    size_t m_pending;
+    bool m_stop;
+    int m_level;
+    std::vector<Worker *> m_workers;
+
+    void Work(bool caller);
+
+public:
+    DeflatePool(int nthreads, int level);
+    ~DeflatePool();
+
+    // compress chunks[0..count) and wait for all of them to complete
+    void Compress(std::vector<DeflateChunk>& chunks, size_t count);
+};
+
+LogArchive::DeflatePool::DeflatePool(int nthreads, int level)
+    : m_workCond(m_lock), m_doneCond(m_lock), m_pending(0), m_stop(false), m_level(level)
+{
+    for (int i = 1; i < nthreads; i++)
+    {
+        Worker *worker = new Worker(*this);
+        if (worker->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete worker;
+            break;
+        }
+        m_workers.push_back(worker);
+    }
+}
+
+LogArchive::DeflatePool::~DeflatePool()
+{
+    {
+        wxMutexLocker lck(m_lock);
+        m_stop = true;
+        m_workCond.Broadcast();
+    }
+
+    for (auto worker : m_workers)
+    {
+        worker->Wait();
+        delete worker;
+    }
+}
+
+// workers run until stopped; the caller returns once the queue is empty
+void LogArchive::DeflatePool::Work(bool caller)
+{
+    wxMutexLocker lck(m_lock);
+
+    while (true)
+    {
+        if (m_queue.empty())
+        {
+            if (caller || m_stop)
+                return;
+            m_workCond.Wait();
+            continue;
+        }
+
+        DeflateChunk *c = m_queue.front();
+        m_queue.pop_front();
+
+        m_lock.Unlock();
+        CompressChunk(*c, m_level);
+        m_lock.Lock();
+
+        if (--m_pending == 0)
+            m_doneCond.Broadcast();
+    }
+}
+
+void LogArchive::DeflatePool::Compress(std::vector<DeflateChunk>& chunks, size_t count)
+{
+    {
+        wxMutexLocker lck(m_lock);
+        for (size_t i = 0; i < count; i++)
+            m_queue.push_back(&chunks[i]);
+        m_pending += count;
+        m_workCond.Broadcast();
+    }
+
+    Work(true);
+
+    wxMutexLocker lck(m_lock);
+    while (m_pending > 0)
+        m_doneCond.Wait();
+}
+
+LogArchive::LogArchive()
+    : m_level(Z_DEFAULT_COMPRESSION), m_threads(1), m_writeError(false), m_inputBytes(0), m_outputBytes(0),
+      m_compressMillis(0)
+{
+}
+
+LogArchive::~LogArchive()
+{
+    m_pool.reset();
+    if (m_file.IsOpened())
+        m_file.Close();
+}
+
+bool LogArchive::Create(const wxString& path, int level, int threads)
+{
+    m_entries.clear();
+    m_writeError = false;
+    m_inputBytes = m_outputBytes = 0;
+    m_compressMillis = 0;
+    m_level = level;
+
+    if (threads <= 0)
+        threads = wxThread::GetCPUCount();
+    m_threads = std::max(threads, 1);
+
+    if (!m_file.Open(path, "wb"))
+    {
+        Debug.Write(wxString::Format("Log archive: could not create %s\n", path));
+        m_writeError = true;
+        return false;
+    }
+
+    m_pool.reset(new DeflatePool(m_threads, m_level));
+
+    return true;
+}
+
+bool LogArchive::Write(const std::vector<unsigned char>& buf)
+{
+    if (m_file.Write(buf.data(), buf.size()) != buf.size())
+    {
+        Debug.Write("Log archive: write error\n");
+        m_writeError = true;
+        return false;
+    }
+    return true;
+}
+
+bool LogArchive::AddFile(const wxString& filename, const wxDateTime& timestamp, const ProgressFn& progress)
+{
+    wxFFile in(filename, "rb");
+    if (!in.IsOpened())
+    {
+        Debug.Write(wxString::Format("Log archive: could not open %s\n", filename));
+        return false;
+    }
+
+    // the active logs keep growing, archive what is there now
+    wxFileOffset const total = in.Length();
+    if (total < 0)
+        return false;
+
+    Entry e;
+    e.name = wxFileName(filename).GetFullName().ToStdString();
+    e.dostime = DosTime(timestamp);
+    e.usize = total;
+    e.csize = 0;
+    e.crc = 0;
+    e.offset = m_file.Tell();
+    e.zip64 = e.usize >= ZIP64_THRESHOLD;
+
+    // local header, crc and compressed size are filled in afterwards
+    std::vector<unsigned char> hdr;
+    Put32(hdr, 0x04034b50);
+    Put16(hdr, e.zip64 ? 45 : 20); // version needed
+    Put16(hdr, 0); // flags
+    Put16(hdr, 8); // deflate
+    Put32(hdr, e.dostime);
+    Put32(hdr, 0); // crc
+    Put32(hdr, e.zip64 ? ZIP32_MAX : 0); // compressed size
+    Put32(hdr, e.zip64 ? ZIP32_MAX : (unsigned long) e.usize);
+    Put16(hdr, e.name.size());
+    Put16(hdr, e.zip64 ? 20 : 0);
+    hdr.insert(hdr.end(), e.name.begin(), e.name.end());
+    if (e.zip64)
+    {
+        Put16(hdr, 0x0001);
+        Put16(hdr, 16);
+        Put64(hdr, e.usize);
+        Put64(hdr, 0); // compressed size
+    }
+    if (!Write(hdr))
+        return false;
+
+    size_t const batch = m_threads;
+    std::vector<DeflateChunk> chunks(batch);
+    std::vector<unsigned char> tail; // dictionary for the first chunk of the next batch
+    wxFileOffset done = 0;
+    wxFileOffset const prevInput = m_inputBytes;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    wxStopWatch swatch;
+
+    do
+    {
+        size_t n = 0;
+        for (; n < batch && (done < total || (n == 0 && total == 0)); n++)
+        {
+            DeflateChunk& c = chunks[n];
+            size_t len = (size_t) std::min<wxFileOffset>(CHUNK_SIZE, total - done);
+            c.in.resize(len);
+            if (len && in.Read(c.in.data(), len) != len)
+            {
+                Debug.Write(wxString::Format("Log archive: error reading %s\n", filename));
+                return false;
+            }
+            done += len;
+            c.last = done >= total;
+
+            if (n == 0)
+            {
+                c.dict = tail.data();
+                c.dictLen = (unsigned int) tail.size();
+            }
+            else
+            {
+                const std::vector<unsigned char>& prev = chunks[n - 1].in;
+                size_t dlen = std::min<size_t>(prev.size(), DICT_SIZE);
+                c.dict = prev.data() + prev.size() - dlen;
+                c.dictLen = (unsigned int) dlen;
+            }
+        }
+
+        m_pool->Compress(chunks, n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const DeflateChunk& c = chunks[i];
+            if (!c.ok)
+            {
+                Debug.Write(wxString::Format("Log archive: deflate failed for %s\n", filename));
+                m_writeError = true;
+                return false;
+            }
+            crc = crc32_combine(crc, c.crc, (z_off_t) c.in.size());
+            if (!Write(c.out))
+                return false;
+            e.csize += c.out.size();
+        }
+
+        const std::vector<unsigned char>& last = chunks[n - 1].in;
+        size_t dlen = std::min<size_t>(last.size(), DICT_SIZE);
+        tail.assign(last.end() - dlen, last.end());
+
+        m_inputBytes = prevInput + done;
+
+        if (progress && !progress(done, total))
+            return false;
+    } while (done < total);
+
+    m_compressMillis += swatch.Time();
+
+    e.crc = crc;
+
+    // patch the local header
+    wxFileOffset end = m_file.Tell();
+    std::vector<unsigned char> fix;
+    Put32(fix, e.crc);
+    if (!e.zip64)
+        Put32(fix, (unsigned long) e.csize);
+    if (!m_file.Seek(e.offset + 14) || !Write(fix))
+        return false;
+    if (e.zip64)
+    {
+        std::vector<unsigned char> sz;
+        Put64(sz, e.csize);
+        if (!m_file.Seek(e.offset + 30 + e.name.size() + 12) || !Write(sz))
+            return false;
+    }
+    if (!m_file.Seek(end))
+    {
+        m_writeError = true;
+        return false;
+    }
+
+    m_entries.push_back(e);
+
+    return true;
+}
+
+bool LogArchive::Close()
+{
+    m_pool.reset();
+
+    if (!m_file.IsOpened())
+        return false;
+
+    unsigned long long cdOffset = m_file.Tell();
+    std::vector<unsigned char> cd;
+
+    for (const Entry& e : m_entries)
+    {
+        bool bigOffset = e.offset >= ZIP32_MAX;
+        std::vector<unsigned char> extra;
+        if (e.zip64)
+        {
+            Put64(extra, e.usize);
+            Put64(extra, e.csize);
+        }
+        if (bigOffset)
+            Put64(extra, e.offset);
+
+        Put32(cd, 0x02014b50);
+        Put16(cd, e.zip64 || bigOffset ? 45 : 20); // version made by
+        Put16(cd, e.zip64 || bigOffset ? 45 : 20); // version needed
+        Put16(cd, 0); // flags
+        Put16(cd, 8); // deflate
+        Put32(cd, e.dostime);
+        Put32(cd, e.crc);
+        Put32(cd, e.zip64 ? ZIP32_MAX : (unsigned long) e.csize);
+        Put32(cd, e.zip64 ? ZIP32_MAX : (unsigned long) e.usize);
+        Put16(cd, e.name.size());
+        Put16(cd, extra.empty() ? 0 : extra.size() + 4);
+        Put16(cd, 0); // comment length
+        Put16(cd, 0); // disk number
+        Put16(cd, 1); // internal attributes: text
+        Put32(cd, 0); // external attributes
+        Put32(cd, bigOffset ? ZIP32_MAX : (unsigned long) e.offset);
+        cd.insert(cd.end(), e.name.begin(), e.name.end());
+        if (!extra.empty())
+        {
+            Put16(cd, 0x0001);
+            Put16(cd, extra.size());
+            cd.insert(cd.end(), extra.begin(), extra.end());
+        }
+    }
+
+    unsigned long long cdSize = cd.size();
+    unsigned long long cdEnd = cdOffset + cdSize;
+    bool zip64 = cdOffset >= ZIP32_MAX || m_entries.size() >= 0xffff;
+
+    if (zip64)
+    {
+        Put32(cd, 0x06064b50);
+        Put64(cd, 44); // size of the remaining record
+        Put16(cd, 45);
+        Put16(cd, 45);
+        Put32(cd, 0);
+        Put32(cd, 0);
+        Put64(cd, m_entries.size());
+        Put64(cd, m_entries.size());
+        Put64(cd, cdSize);
+        Put64(cd, cdOffset);
+
+        Put32(cd, 0x07064b50);
+        Put32(cd, 0);
+        Put64(cd, cdEnd);
+        Put32(cd, 1);
+    }
+
+    Put32(cd, 0x06054b50);
+    Put16(cd, 0);
+    Put16(cd, 0);
+    Put16(cd, zip64 ? 0xffff : m_entries.size());
+    Put16(cd, zip64 ? 0xffff : m_entries.size());
+    Put32(cd, zip64 ? ZIP32_MAX : (unsigned long) cdSize);
+    Put32(cd, zip64 ? ZIP32_MAX : (unsigned long) cdOffset);
+    Put16(cd, 0); // comment length
+
+    bool ok = Write(cd);
+    m_outputBytes = m_file.Tell();
+    ok = m_file.Close() && ok;
+    if (!ok)
+        m_writeError = true;
+
+    return ok;
+}
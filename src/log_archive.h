@@ -0,0 +1,99 @@
+/*
+ *  log_archive.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef LOG_ARCHIVE_H
+#define LOG_ARCHIVE_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Writes a zip archive of log files. Each file is read in chunks that are
+// deflated in parallel and written to the archive as they complete, so
+// multi-GB logs are compressed using all cores without buffering whole files.
+// Zip64 records are written when an entry or the archive exceeds 4GB.
+//
+class LogArchive
+{
+public:
+    // called after each batch of chunks with the bytes read so far from the
+    // current file; return false to abandon the archive
+    typedef std::function<bool(wxFileOffset done, wxFileOffset total)> ProgressFn;
+
+    enum
+    {
+        CHUNK_SIZE = 1024 * 1024,
+    };
+
+    LogArchive();
+    ~LogArchive();
+
+    bool Create(const wxString& path, int level = -1 /* Z_DEFAULT_COMPRESSION */, int threads = 0);
+    bool AddFile(const wxString& filename, const wxDateTime& timestamp, const ProgressFn& progress);
+    bool Close();
+
+    // the archive could not be written as opposed to a source file not being readable
+    bool WriteError() const { return m_writeError; }
+
+    wxFileOffset InputBytes() const { return m_inputBytes; }
+    wxFileOffset OutputBytes() const { return m_file.IsOpened() ? m_file.Tell() : m_outputBytes; }
+    double CompressSeconds() const { return m_compressMillis / 1000.0; }
+
+private:
+    class DeflatePool;
+
+    struct Entry
+    {
+        std::string name;
+        unsigned int dostime;
+        unsigned int crc;
+        unsigned long long csize;
+        unsigned long long usize;
+        unsigned long long offset;
+        bool zip64;
+    };
+
+    wxFFile m_file;
+    int m_level;
+    int m_threads;
+    std::unique_ptr<DeflatePool> m_pool;
+    std::vector<Entry> m_entries;
+    bool m_writeError;
+    wxFileOffset m_inputBytes;
+    wxFileOffset m_outputBytes;
+    long long m_compressMillis;
+
+    bool Write(const std::vector<unsigned char>& buf);
+};
+
+#endif
@@ -34,8 +34,10 @@
 
 #include "log_uploader.h"
 #include "phd.h"
+#include "log_archive.h"
 
 #include <algorithm>
+#include <atomic>
 #include <curl/curl.h>
 #include <fstream>
 #include <sstream>
@@ -45,8 +47,6 @@
 #include <wx/regex.h>
 #include <wx/richtooltip.h>
 #include <wx/tokenzr.h>
-#include <wx/wfstream.h>
-#include <wx/zipstrm.h>
 
 #if LIBCURL_VERSION_MAJOR < 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR < 32)
 # define OLD_CURL
@@ -56,6 +56,13 @@
 # define strncasecmp strnicmp
 #endif
 
+#ifndef __WINDOWS__
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
 struct WindowUpdateLocker
 {
     wxWindow *m_win;
@@ -82,6 +89,8 @@ struct Session
     SummaryState summary_loaded = ST_BEGIN;
     bool has_guide = false;
     bool has_debug = false;
+    wxFileOffset guide_size = 0;
+    time_t guide_mtime = 0;
 
     bool HasGuiding() const
     {
@@ -115,31 +124,72 @@ enum
     MIN_ROWS = 16,
 };
 
-// state machine to allow scanning logs during idle event processing
-//
-struct LogScanner
+// activity counts for the part of a guide log that starts at a "Guiding Begins" line
+// and runs up to the next one; the first section starts at the log header
+struct LogSection
 {
-    wxGrid *m_grid;
-    std::deque<int> m_q; // indexes remaining to be checked
-    std::ifstream m_ifs;
-    wxDateTime m_guiding_starts;
-    void Init(wxGrid *grid);
-    void FindNextRow();
-    bool DoWork(unsigned int millis);
+    wxFileOffset ofs;
+    GuideLogSummaryInfo counts;
+
+    LogSection(wxFileOffset ofs_) : ofs(ofs_) { }
 };
 
-void LogScanner::Init(wxGrid *grid)
+struct LogIndexEntry
 {
-    m_grid = grid;
-    // load work queue in sorted order
-    for (auto idx : s_session_idx)
+    wxFileOffset size;
+    time_t mtime;
+    GuideLogSummaryInfo summary; // totals over all sections
+    std::vector<LogSection> sections;
+
+    LogIndexEntry() : size(0), mtime(0) { }
+
+    void SumSections()
     {
-        if (s_session[idx].summary_loaded != ST_LOADED)
-            m_q.push_back(idx);
+        summary.Clear();
+        for (const LogSection& s : sections)
+        {
+            summary.cal_cnt += s.counts.cal_cnt;
+            summary.guide_cnt += s.counts.guide_cnt;
+            summary.guide_dur += s.counts.guide_dur;
+            summary.ga_cnt += s.counts.ga_cnt;
+        }
+        summary.valid = true;
     }
-    m_guiding_starts = wxInvalidDateTime;
-    FindNextRow();
-}
+};
+
+// summaries of previously scanned guide logs, keyed by log file name
+static std::map<wxString, LogIndexEntry> s_index;
+
+struct ScanJob
+{
+    int idx; // session index
+    wxString path;
+    LogIndexEntry entry; // sections from an earlier scan if the log has grown since then
+};
+
+class LogScanThread;
+
+// scans guide logs that do not have a summary record on a pool of
+// background threads; results are collected during idle event processing
+//
+struct LogScanner
+{
+    wxGrid *m_grid;
+    wxCriticalSection m_lock; // protects m_q and m_done
+    std::deque<ScanJob> m_q; // logs remaining to be scanned
+    std::vector<ScanJob> m_done; // scanned logs not yet shown in the grid
+    unsigned int m_pending;
+    std::vector<LogScanThread *> m_threads;
+    std::atomic<bool> m_cancel;
+
+    LogScanner() : m_grid(nullptr), m_pending(0), m_cancel(false) { }
+    ~LogScanner() { Stop(); }
+    void Init(wxGrid *grid);
+    void Stop();
+    bool NextJob(ScanJob *job);
+    void JobDone(const ScanJob& job);
+    bool DoWork();
+};
 
 static wxString DebugLogName(const Session& session)
 {
@@ -214,114 +264,431 @@ static void FillActivity(wxGrid *grid, int row, const Session& session, bool res
     }
 }
 
-void LogScanner::FindNextRow()
+static std::string GUIDING_BEGINS("Guiding Begins at ");
+static std::string GUIDING_ENDS("Guiding Ends at ");
+static std::string CALIBRATION_ENDS("Calibration complete");
+static std::string GA_COMPLETE("INFO: GA Result - Dec Drift Rate=");
+
+inline static bool StartsWith(const char *s, size_t len, const std::string& pfx)
 {
-    while (!m_q.empty())
+    return len >= pfx.length() && memcmp(s, pfx.c_str(), pfx.length()) == 0;
+}
+
+// parse "YYYY-MM-DD HH:MM:SS" into seconds since 1970-01-01 without going
+// through wxDateTime so that logs can be scanned on any thread
+static bool ParseLogTime(const char *s, size_t len, long long *secs)
+{
+    if (len < 19)
+        return false;
+
+    int v[6];
+    static const int pos[6] = { 0, 5, 8, 11, 14, 17 };
+    static const int width[6] = { 4, 2, 2, 2, 2, 2 };
+    for (int i = 0; i < 6; i++)
     {
-        auto idx = m_q.front();
-        Session& session = s_session[idx];
+        int n = 0;
+        for (int j = 0; j < width[i]; j++)
+        {
+            char c = s[pos[i] + j];
+            if (c < '0' || c > '9')
+                return false;
+            n = n * 10 + (c - '0');
+        }
+        v[i] = n;
+    }
 
-        assert(session.has_guide);
-        assert(session.summary_loaded != ST_LOADED);
+    // days from civil, H. Hinnant
+    int y = v[0] - (v[1] <= 2);
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (v[1] + (v[1] > 2 ? -3 : 9)) + 2) / 5 + v[2] - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long long days = (long long) era * 146097 + doe - 719468;
 
-        int row = s_grid_row[idx];
+    *secs = days * 86400 + v[3] * 3600 + v[4] * 60 + v[5];
+    return true;
+}
+
+// read-only view of a file, mapped a window at a time so that large logs
+// do not exhaust the address space of 32-bit builds
+//
+class MappedFile
+{
+#ifdef __WINDOWS__
+    HANDLE m_file;
+    HANDLE m_map;
+#else
+    int m_fd;
+#endif
+    wxFileOffset m_size;
+    void *m_view;
+    size_t m_viewLen;
+
+    void Unmap()
+    {
+        if (!m_view)
+            return;
+#ifdef __WINDOWS__
+        UnmapViewOfFile(m_view);
+#else
+        munmap(m_view, m_viewLen);
+#endif
+        m_view = nullptr;
+    }
+
+public:
+    // window size, a multiple of the mapping granularity on all platforms
+    static const size_t WINDOW = 64 * 1024 * 1024;
+
+    MappedFile() : m_size(0), m_view(nullptr), m_viewLen(0)
+    {
+#ifdef __WINDOWS__
+        m_file = INVALID_HANDLE_VALUE;
+        m_map = nullptr;
+#else
+        m_fd = -1;
+#endif
+    }
 
-        wxFileName fn(Debug.GetLogDir(), GuideLogName(session));
-        m_ifs.open(fn.GetFullPath().fn_str());
-        if (!m_ifs)
+    ~MappedFile()
+    {
+        Unmap();
+#ifdef __WINDOWS__
+        if (m_map)
+            CloseHandle(m_map);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+#else
+        if (m_fd != -1)
+            close(m_fd);
+#endif
+    }
+
+    bool Open(const wxString& path)
+    {
+#ifdef __WINDOWS__
+        m_file = CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(m_file, &sz))
+            return false;
+        m_size = sz.QuadPart;
+        if (m_size > 0)
         {
-            // should never get here since we have already scanned the list once
-            session.summary_loaded = ST_LOADED;
-            FillActivity(m_grid, row, session, true);
-            m_q.pop_front();
-            continue;
+            m_map = CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_map)
+                return false;
         }
+#else
+        m_fd = open(path.fn_str(), O_RDONLY);
+        if (m_fd == -1)
+            return false;
+        struct stat st;
+        if (fstat(m_fd, &st) != 0)
+            return false;
+        m_size = st.st_size;
+#endif
+        return true;
+    }
 
-        session.summary_loaded = ST_LOADING;
-        FillActivity(m_grid, row, session, true);
+    wxFileOffset Size() const { return m_size; }
 
-        return;
+    // map len bytes at ofs, which must be a multiple of WINDOW
+    const char *Map(wxFileOffset ofs, size_t len)
+    {
+        Unmap();
+#ifdef __WINDOWS__
+        m_view = MapViewOfFile(m_map, FILE_MAP_READ, (DWORD) ((unsigned long long) ofs >> 32), (DWORD) ofs, len);
+#else
+        m_view = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, m_fd, ofs);
+        if (m_view == MAP_FAILED)
+            m_view = nullptr;
+        else
+            madvise(m_view, len, MADV_SEQUENTIAL);
+#endif
+        m_viewLen = len;
+        return static_cast<const char *>(m_view);
     }
-}
-
-static std::string GUIDING_BEGINS("Guiding Begins at ");
-static std::string GUIDING_ENDS("Guiding Ends at ");
-static std::string CALIBRATION_ENDS("Calibration complete");
-static std::string GA_COMPLETE("INFO: GA Result - Dec Drift Rate=");
+};
 
-inline static bool StartsWith(const std::string& s, const std::string& pfx)
+struct GuideLogScan
 {
-    return s.length() >= pfx.length() && s.compare(0, pfx.length(), pfx) == 0;
-}
+    LogIndexEntry& entry;
+    long long guiding_starts;
+    bool have_start;
 
-bool LogScanner::DoWork(unsigned int millis)
-{
-    int n = 0;
-    wxStopWatch swatch;
+    GuideLogScan(LogIndexEntry& e, wxFileOffset start) : entry(e), have_start(false)
+    {
+        entry.summary.Clear();
+        entry.sections.push_back(LogSection(start));
+    }
 
-    while (!m_q.empty())
+    void Line(const char *s, size_t len, wxFileOffset ofs)
     {
-        auto idx = m_q.front();
-        Session& session = s_session[idx];
+        if (StartsWith(s, len, GUIDING_BEGINS) && ofs != entry.sections.back().ofs)
+            entry.sections.push_back(LogSection(ofs));
 
-        std::string line;
-        while (true)
+        GuideLogSummaryInfo& summary = entry.sections.back().counts;
+
+        if (StartsWith(s, len, GUIDING_BEGINS))
+            have_start = ParseLogTime(s + GUIDING_BEGINS.length(), len - GUIDING_BEGINS.length(), &guiding_starts);
+        else if (StartsWith(s, len, GUIDING_ENDS))
         {
-            if (++n % 1000 == 0)
+            long long end;
+            if (have_start && ParseLogTime(s + GUIDING_ENDS.length(), len - GUIDING_ENDS.length(), &end) &&
+                end > guiding_starts)
             {
-                if (swatch.Time() > millis)
-                    return true;
+                ++summary.guide_cnt;
+                summary.guide_dur += end - guiding_starts;
             }
+            have_start = false;
+        }
+        else if (StartsWith(s, len, CALIBRATION_ENDS))
+            ++summary.cal_cnt;
+        else if (StartsWith(s, len, GA_COMPLETE))
+            ++summary.ga_cnt;
+    }
+};
 
-            if (!std::getline(m_ifs, line))
-                break;
+// returns false if the file could not be read
+//
+// If entry holds the sections from an earlier scan of a log that has since
+// grown, the scan seeks to the start of the last of those sections, which may
+// have been incomplete when it was scanned, and only reads from there on.
+static bool ScanGuideLog(const wxString& path, LogIndexEntry *entry, const std::atomic<bool>& cancel)
+{
+    MappedFile file;
+    if (!file.Open(path))
+        return false;
 
-            if (StartsWith(line, GUIDING_BEGINS))
-            {
-                std::string datestr = line.substr(GUIDING_BEGINS.length());
-                m_guiding_starts.ParseISOCombined(datestr, ' ');
-                continue;
-            }
+    wxFileOffset const size = file.Size();
 
-            if (StartsWith(line, GUIDING_ENDS) && m_guiding_starts.IsValid())
-            {
-                std::string datestr = line.substr(GUIDING_ENDS.length());
-                wxDateTime end;
-                end.ParseISOCombined(datestr, ' ');
-                if (end.IsValid() && end.IsLaterThan(m_guiding_starts))
-                {
-                    wxTimeSpan dt = end - m_guiding_starts;
-                    ++session.summary.guide_cnt;
-                    session.summary.guide_dur += dt.GetSeconds().GetValue();
-                }
-                m_guiding_starts = wxInvalidDateTime;
-                continue;
-            }
+    wxFileOffset start = 0;
+    if (!entry->sections.empty() && entry->sections.back().ofs < size)
+    {
+        start = entry->sections.back().ofs;
+        entry->sections.pop_back();
+    }
+    else
+        entry->sections.clear();
+
+    GuideLogScan scan(*entry, start);
+    std::string carry; // partial line spanning two windows
+    wxFileOffset carry_ofs = 0;
+
+    for (wxFileOffset ofs = start - start % MappedFile::WINDOW; ofs < size; ofs += MappedFile::WINDOW)
+    {
+        if (cancel)
+            return false;
 
-            if (StartsWith(line, CALIBRATION_ENDS))
+        size_t len = (size_t) std::min<wxFileOffset>(MappedFile::WINDOW, size - ofs);
+        const char *p = file.Map(ofs, len);
+        if (!p)
+            return false;
+
+        const char *end = p + len;
+        const char *line = ofs < start ? p + (start - ofs) : p;
+        while (line < end)
+        {
+            const char *nl = static_cast<const char *>(memchr(line, '\n', end - line));
+            if (!nl)
             {
-                ++session.summary.cal_cnt;
-                continue;
+                if (carry.empty())
+                    carry_ofs = ofs + (line - p);
+                carry.append(line, end);
+                break;
             }
-
-            if (StartsWith(line, GA_COMPLETE))
+            if (!carry.empty())
             {
-                ++session.summary.ga_cnt;
-                continue;
+                carry.append(line, nl);
+                scan.Line(carry.c_str(), carry.length(), carry_ofs);
+                carry.clear();
             }
+            else
+                scan.Line(line, nl - line, ofs + (line - p));
+            line = nl + 1;
+        }
+    }
+
+    if (!carry.empty())
+        scan.Line(carry.c_str(), carry.length(), carry_ofs);
+
+    entry->SumSections();
+    return true;
+}
+
+class LogScanThread : public wxThread
+{
+    LogScanner *m_scanner;
+
+public:
+    LogScanThread(LogScanner *scanner) : wxThread(wxTHREAD_JOINABLE), m_scanner(scanner) { }
+
+    ExitCode Entry() override
+    {
+        ScanJob job;
+        while (m_scanner->NextJob(&job))
+        {
+            if (!ScanGuideLog(job.path, &job.entry, m_scanner->m_cancel))
+                job.entry.summary.Clear();
+            if (m_scanner->m_cancel)
+                break;
+            m_scanner->JobDone(job);
+        }
+        return nullptr;
+    }
+};
+
+void LogScanner::Init(wxGrid *grid)
+{
+    enum
+    {
+        MAX_SCAN_THREADS = 4, // scanning is mostly I/O bound
+    };
+
+    m_grid = grid;
+    m_cancel = false;
+
+    unsigned int resumed = 0;
+
+    // load work queue in sorted order so that the visible rows fill in first
+    for (auto idx : s_session_idx)
+    {
+        Session& session = s_session[idx];
+        if (session.summary_loaded == ST_LOADED)
+            continue;
+
+        assert(session.has_guide);
+
+        ScanJob job;
+        job.idx = idx;
+        job.path = wxFileName(Debug.GetLogDir(), GuideLogName(session)).GetFullPath();
+        job.entry.size = session.guide_size;
+        job.entry.mtime = session.guide_mtime;
+
+        // a log that has only been appended to since it was indexed (typically the
+        // log that is still open) is rescanned from its last indexed section
+        auto it = s_index.find(GuideLogName(session));
+        if (it != s_index.end() && it->second.size < session.guide_size)
+        {
+            job.entry.sections = it->second.sections;
+            ++resumed;
+        }
+
+        m_q.push_back(job);
+
+        session.summary_loaded = ST_LOADING;
+        FillActivity(m_grid, s_grid_row[idx], session, false);
+    }
+
+    m_pending = m_q.size();
+    if (!m_pending)
+        return;
+
+    m_grid->AutoSizeColumn(COL_GUIDE);
+
+    int ncpu = wxThread::GetCPUCount();
+    unsigned int nthreads = ncpu > 0 ? std::min(ncpu, (int) MAX_SCAN_THREADS) : 1;
+    nthreads = std::min(nthreads, m_pending);
+
+    Debug.Write(wxString::Format("Log uploader: scanning %u guide logs (%u from the last indexed section) on %u threads\n",
+                                 m_pending, resumed, nthreads));
+
+    for (unsigned int i = 0; i < nthreads; i++)
+    {
+        LogScanThread *thread = new LogScanThread(this);
+        if (thread->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete thread;
+            continue;
         }
+        m_threads.push_back(thread);
+    }
 
-        session.summary.valid = true;
+    if (m_threads.empty())
+    {
+        // could not start any threads, scan on the UI thread
+        ScanJob job;
+        while (NextJob(&job))
+        {
+            if (!ScanGuideLog(job.path, &job.entry, m_cancel))
+                job.entry.summary.Clear();
+            JobDone(job);
+        }
+    }
+}
+
+void LogScanner::Stop()
+{
+    m_cancel = true;
+    for (auto thread : m_threads)
+    {
+        thread->Wait();
+        delete thread;
+    }
+    m_threads.clear();
+}
+
+bool LogScanner::NextJob(ScanJob *job)
+{
+    wxCriticalSectionLocker lck(m_lock);
+    if (m_q.empty() || m_cancel)
+        return false;
+    *job = m_q.front();
+    m_q.pop_front();
+    return true;
+}
+
+void LogScanner::JobDone(const ScanJob& job)
+{
+    {
+        wxCriticalSectionLocker lck(m_lock);
+        m_done.push_back(job);
+    }
+    wxWakeUpIdle();
+}
+
+static void SaveIndex();
+
+// show the results of completed scans, returns true while scans are outstanding
+bool LogScanner::DoWork()
+{
+    if (!m_pending)
+        return false;
+
+    std::vector<ScanJob> done;
+    {
+        wxCriticalSectionLocker lck(m_lock);
+        done.swap(m_done);
+    }
+
+    if (done.empty())
+        return true;
+
+    for (const ScanJob& job : done)
+    {
+        Session& session = s_session[job.idx];
+        session.summary = job.entry.summary;
         session.summary_loaded = ST_LOADED;
+        if (job.entry.summary.valid)
+            s_index[GuideLogName(session)] = job.entry;
+        FillActivity(m_grid, s_grid_row[job.idx], session, false);
+    }
 
-        FillActivity(m_grid, s_grid_row[idx], session, true);
+    m_grid->AutoSizeColumn(COL_GUIDE);
+    m_grid->AutoSizeColumn(COL_CAL);
+    m_grid->AutoSizeColumn(COL_GA);
 
-        m_ifs.close();
-        m_q.pop_front();
-        FindNextRow();
+    m_pending -= done.size();
+    if (!m_pending)
+    {
+        Stop();
+        SaveIndex();
     }
 
-    return false;
+    return m_pending > 0;
 }
 
 class LogUploadDialog : public wxDialog
@@ -405,6 +772,96 @@ static void QuickInitSummary(Session& s)
         s.summary_loaded = ST_LOADED;
 }
 
+static const std::string INDEX_VERSION("PHD2 log index 2");
+
+static wxString IndexFileName()
+{
+    return wxFileName(Debug.GetLogDir(), "PHD2_LogIndex.txt").GetFullPath();
+}
+
+// one line per scanned guide log, with the offset and counts of each section:
+//   <log name> <size> <mtime> { <section offset> <calcnt> <gcnt> <gdur> <gacnt> } ...
+static void LoadIndex()
+{
+    s_index.clear();
+
+    std::ifstream ifs(IndexFileName().fn_str());
+    std::string line;
+    if (!std::getline(ifs, line) || line != INDEX_VERSION)
+        return;
+
+    while (std::getline(ifs, line))
+    {
+        std::istringstream is(line);
+        std::string name;
+        long long size, mtime;
+        is >> name >> size >> mtime;
+        if (!is)
+            continue;
+        LogIndexEntry e;
+        long long ofs;
+        while (is >> ofs)
+        {
+            LogSection s(ofs);
+            if (!(is >> s.counts.cal_cnt >> s.counts.guide_cnt >> s.counts.guide_dur >> s.counts.ga_cnt))
+                break;
+            e.sections.push_back(s);
+        }
+        if (e.sections.empty() || e.sections.front().ofs != 0)
+            continue;
+        e.size = size;
+        e.mtime = (time_t) mtime;
+        e.SumSections();
+        s_index[wxString(name)] = e;
+    }
+}
+
+static void SaveIndex()
+{
+    std::ofstream ofs(IndexFileName().fn_str(), std::ios::out | std::ios::trunc);
+    if (!ofs)
+    {
+        Debug.Write("Log uploader: could not write log index\n");
+        return;
+    }
+
+    ofs << INDEX_VERSION << '\n';
+
+    // drop entries for logs that have since been removed or modified
+    for (const Session& session : s_session)
+    {
+        if (!session.has_guide)
+            continue;
+        auto it = s_index.find(GuideLogName(session));
+        if (it == s_index.end())
+            continue;
+        const LogIndexEntry& e = it->second;
+        if (e.size != session.guide_size || e.mtime != session.guide_mtime)
+            continue;
+
+        ofs << it->first.ToStdString() << ' ' << (long long) e.size << ' ' << (long long) e.mtime;
+        for (const LogSection& s : e.sections)
+            ofs << ' ' << (long long) s.ofs << ' ' << s.counts.cal_cnt << ' ' << s.counts.guide_cnt << ' '
+                << (long long) s.counts.guide_dur << ' ' << s.counts.ga_cnt;
+        ofs << '\n';
+    }
+}
+
+// use the summary from the index if the log has not changed since it was scanned
+static bool IndexedSummary(Session& s)
+{
+    if (!s.has_guide)
+        return false;
+
+    auto it = s_index.find(GuideLogName(s));
+    if (it == s_index.end() || it->second.size != s.guide_size || it->second.mtime != s.guide_mtime)
+        return false;
+
+    s.summary = it->second.summary;
+    s.summary_loaded = ST_LOADED;
+    return true;
+}
+
 static void ReallyFlush(const wxFFile& ffile)
 {
 #ifdef __WINDOWS__
@@ -529,11 +986,15 @@ static void LoadGrid(wxGrid *grid)
                 s.timestamp = timestamp;
                 s.start = SessionStart(timestamp);
                 s.has_guide = true;
+                s.guide_size = st.st_size;
+                s.guide_mtime = st.st_mtime;
                 logs[timestamp] = s;
             }
             else
             {
                 it->second.has_guide = true;
+                it->second.guide_size = st.st_size;
+                it->second.guide_mtime = st.st_mtime;
             }
         }
     }
@@ -570,11 +1031,14 @@ static void LoadGrid(wxGrid *grid)
     s_session_idx.clear();
     s_grid_row.clear();
 
+    LoadIndex();
+
     int r = 0;
     for (auto it = logs.begin(); it != logs.end(); ++it, ++r)
     {
         Session& session = it->second;
-        QuickInitSummary(session);
+        if (!IndexedSummary(session))
+            QuickInitSummary(session);
         s_session.push_back(session);
         s_session_idx.push_back(r);
         s_grid_row.push_back(r);
@@ -589,8 +1053,8 @@ static void LoadGrid(wxGrid *grid)
 
 void LogUploadDialog::OnIdle(wxIdleEvent& event)
 {
-    bool more = m_scanner.DoWork(100);
-    event.RequestMore(more);
+    // the scan threads wake up idle processing as results arrive
+    m_scanner.DoWork();
 }
 
 void LogUploadDialog::OnIncludeEmpty(wxCommandEvent& ev)
@@ -880,9 +1344,14 @@ enum UploadErr
     UPL_SIZE_ERROR,
 };
 
+#define DEFAULT_UPLOAD_URL "https://openphdguiding.org/logs/upload"
+
 struct BgUpload : public RunInBg
 {
     std::vector<FileData> m_input;
+    wxString m_url; // upload service, can point to a local stand-in for testing
+    wxString m_archiveDir; // when set, save the archive here instead of uploading
+    wxString m_archivePath;
     wxFFile m_ff;
     CURL *m_curl;
     std::ostringstream m_response;
@@ -931,47 +1400,9 @@ BgUpload::~BgUpload()
         curl_easy_cleanup(m_curl);
 }
 
-static bool InterruptibleWrite(BgUpload *upload, wxOutputStream& out, wxInputStream& in)
-{
-    while (true)
-    {
-        char buf[4096];
-
-        size_t sz = in.Read(buf, WXSIZEOF(buf)).LastRead();
-        if (!sz)
-            return true;
-
-        if (upload->IsCanceled())
-            return false;
-
-        if (out.Write(buf, sz).LastWrite() != sz)
-        {
-            Debug.Write("Upload log: error writing to zip file\n");
-            upload->m_err = UPL_COMPRESS_ERROR;
-            return false;
-        }
-
-        if (upload->IsCanceled())
-            return false;
-    }
-}
-
-static bool AddFile(BgUpload *upload, wxZipOutputStream& zip, const wxString& filename, const wxDateTime& dt)
-{
-    wxFFileInputStream is(filename);
-    if (!is.IsOk())
-    {
-        Debug.Write(wxString::Format("Upload log: could not open %s\n", filename));
-        upload->m_err = UPL_COMPRESS_ERROR;
-        return false;
-    }
-    zip.PutNextEntry(filename, dt);
-    return InterruptibleWrite(upload, zip, is);
-}
-
 static long QueryMaxSize(BgUpload *upload)
 {
-    curl_easy_setopt(upload->m_curl, CURLOPT_URL, "https://openphdguiding.org/logs/upload?limits");
+    curl_easy_setopt(upload->m_curl, CURLOPT_URL, static_cast<const char *>((upload->m_url + "?limits").c_str()));
 
     upload->SetMessage(_("Connecting ..."));
 
@@ -1037,8 +1468,83 @@ static long QueryMaxSize(BgUpload *upload)
     return limit;
 }
 
+static bool CreateArchive(BgUpload *upload, const wxString& zipfile, long limit)
+{
+    LogArchive archive;
+    if (!archive.Create(zipfile))
+    {
+        upload->m_err = UPL_COMPRESS_ERROR;
+        return false;
+    }
+
+    wxStopWatch swatch;
+    bool oversize = false;
+
+    for (auto it = upload->m_input.begin(); it != upload->m_input.end(); ++it)
+    {
+        upload->SetMessage(wxString::Format(_("Compressing %s..."), it->filename));
+
+        auto progress = [&](wxFileOffset done, wxFileOffset total) {
+            if (upload->IsCanceled())
+                return false;
+            // no need to finish compressing once the archive is too big to upload
+            if (limit != -1 && archive.OutputBytes() > limit)
+            {
+                oversize = true;
+                return false;
+            }
+            double secs = swatch.Time() / 1000.0;
+            if (total > 0 && secs > 0.)
+            {
+                upload->SetMessage(wxString::Format(_("Compressing %s... %.f%% (%.1f MB/s)"), it->filename,
+                                                    (double) done / (double) total * 100.0,
+                                                    (double) archive.InputBytes() / (1024. * 1024.) / secs));
+            }
+            return true;
+        };
+
+        if (!archive.AddFile(it->filename, it->timestamp, progress))
+        {
+            if (oversize)
+            {
+                Debug.Write(wxString::Format("Upload log: compressed size exceeds limit of %ld\n", limit));
+                upload->m_err = UPL_SIZE_ERROR;
+            }
+            else if (!upload->IsCanceled())
+                upload->m_err = UPL_COMPRESS_ERROR;
+            return false;
+        }
+    }
+
+    if (!archive.Close())
+    {
+        upload->m_err = UPL_COMPRESS_ERROR;
+        return false;
+    }
+
+    double secs = swatch.Time() / 1000.0;
+    Debug.Write(wxString::Format("Upload log: compressed %lld bytes to %lld bytes in %.3f seconds, %.1f MB/s\n",
+                                 (long long) archive.InputBytes(), (long long) archive.OutputBytes(), secs,
+                                 secs > 0. ? (double) archive.InputBytes() / (1024. * 1024.) / secs : 0.));
+
+    return true;
+}
+
 bool BgUpload::Entry()
 {
+    const wxString& logDir = Debug.GetLogDir();
+
+    AutoChdir cd(logDir);
+    wxLogNull nolog;
+
+    if (!m_archiveDir.empty())
+    {
+        m_archivePath =
+            wxFileName(m_archiveDir, "PHD2_logs_" + wxDateTime::Now().Format("%Y-%m-%d_%H%M%S") + ".zip").GetFullPath();
+        Debug.Write(wxString::Format("Upload log: saving logs to %s\n", m_archivePath));
+        return CreateArchive(this, m_archivePath, -1);
+    }
+
     m_curl = curl_easy_init();
     if (!m_curl)
     {
@@ -1057,28 +1563,11 @@ bool BgUpload::Entry()
     if (limit == -1)
         return false;
 
-    const wxString& logDir = Debug.GetLogDir();
-
-    AutoChdir cd(logDir);
-    wxLogNull nolog;
-
     wxString zipfile("PHD2_upload.zip");
     ::wxRemove(zipfile);
 
-    wxFFileOutputStream out(zipfile);
-    wxZipOutputStream zip(out);
-
-    for (auto it = m_input.begin(); it != m_input.end(); ++it)
-    {
-        SetMessage(wxString::Format("Compressing %s...", it->filename));
-        if (!AddFile(this, zip, it->filename, it->timestamp))
-            return false;
-        if (IsCanceled())
-            return false;
-    }
-
-    zip.Close();
-    out.Close();
+    if (!CreateArchive(this, zipfile, limit))
+        return false;
 
     SetMessage("Uploading ...");
 
@@ -1112,7 +1601,7 @@ bool BgUpload::Entry()
     m_response.clear();
     m_response.str("");
 
-    curl_easy_setopt(m_curl, CURLOPT_URL, "https://openphdguiding.org/logs/upload");
+    curl_easy_setopt(m_curl, CURLOPT_URL, static_cast<const char *>(m_url.c_str()));
 
     // enable upload
     curl_easy_setopt(m_curl, CURLOPT_UPLOAD, 1L);
@@ -1231,6 +1720,8 @@ void LogUploadDialog::ExecUpload()
     m_back->Enable(false);
 
     BgUpload upload(this);
+    upload.m_url = pConfig->Global.GetString("/log_uploader/url", DEFAULT_UPLOAD_URL);
+    upload.m_archiveDir = pConfig->Global.GetString("/log_uploader/archive_dir", wxEmptyString);
 
     for (int r = 0; r < s_session.size(); r++)
     {
@@ -1258,6 +1749,22 @@ void LogUploadDialog::ExecUpload()
         return;
     }
 
+    if (ok && !upload.m_archiveDir.empty())
+    {
+        wxString msg = wxString::Format(_("The log files have been saved to:") +
+                                            "<br>"
+                                            "<br>"
+                                            "<font size=-1>%s</font>",
+                                        upload.m_archivePath);
+        WindowUpdateLocker noUpdates(this);
+        SetTitle(STEP3_TITLE_OK);
+        m_html->SetPage(msg);
+        m_back->Hide();
+        m_upload->Hide();
+        Layout();
+        return;
+    }
+
     wxString url;
     wxString err;
 
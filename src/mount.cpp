@@ -977,6 +977,7 @@ void Mount::LogGuideStepInfo()
 Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions)
 {
     MOVE_RESULT result = MOVE_OK;
+    long long algoStart = PipelineStats::NowUs();
 
     try
     {
@@ -1029,6 +1030,10 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
             }
         }
 
+        long long pulseStart = PipelineStats::NowUs();
+        if (moveOptions & MOVEOPT_ALGO_RESULT)
+            PipelineTiming.Add(PIPELINE_ALGORITHM, pulseStart - algoStart);
+
         // Figure out the guide directions based on the (possibly) updated distances
         GUIDE_DIRECTION xDirection = xDistance > 0.0 ? LEFT : RIGHT;
         GUIDE_DIRECTION yDirection = yDistance > 0.0 ? DOWN : UP;
@@ -1048,6 +1053,8 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
             result = MoveAxis(yDirection, requestedYAmount, moveOptions, &yMoveResult);
         }
 
+        PipelineTiming.Add(PIPELINE_PULSE, PipelineStats::NowUs() - pulseStart);
+
         // Record the info about the guide step. The info will be picked up back in the main UI thread.
         // We don't want to do anything with the info here in the worker thread since UI operations are
         // not allowed outside the main UI thread.
@@ -1254,7 +1261,7 @@ void Mount::AdjustCalibrationForScopePointing()
     double newDeclination = pPointingSource->GetDeclinationRadians();
     PierSide newPierSide = pPointingSource->SideOfPier();
     double newRotatorAngle = Rotator::RotatorPosition();
-    unsigned short binning = pCamera->Binning;
+    unsigned short binning = pCamera->TotalBinning();
 
     Debug.AddLine(wxString::Format(
         "AdjustCalibrationForScopePointing (%s): current dec=%s pierSide=%d, cal dec=%s pierSide=%d rotAngle=%s bin=%hu",
@@ -135,6 +135,7 @@ wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
     EVT_MENU(MENU_TOOLBAR,MyFrame::OnToolBar)
     EVT_MENU(MENU_GRAPH, MyFrame::OnGraph)
     EVT_MENU(MENU_STATS, MyFrame::OnStats)
+    EVT_MENU(MENU_PIPELINE_STATS, MyFrame::OnPipelineStats)
     EVT_MENU(MENU_AO_GRAPH, MyFrame::OnAoGraph)
     EVT_MENU(MENU_TARGET, MyFrame::OnTarget)
     EVT_MENU(MENU_SERVER, MyFrame::OnServerMenu)
@@ -211,7 +212,8 @@ struct FileDropTarget : public wxFileDropTarget
 // ---------------------- Main Frame -------------------------------------
 // frame constructor
 MyFrame::MyFrame()
-    : wxFrame(nullptr, wxID_ANY, wxEmptyString), m_showBookmarksAccel(0), m_bookmarkLockPosAccel(0), pStatsWin(nullptr)
+    : wxFrame(nullptr, wxID_ANY, wxEmptyString), m_showBookmarksAccel(0), m_bookmarkLockPosAccel(0), pStatsWin(nullptr),
+      pPipelineStatsWin(nullptr)
 {
     m_mgr.SetManagedWindow(this);
 
@@ -220,6 +222,8 @@ MyFrame::MyFrame()
     StartWorkerThread(m_pPrimaryWorkerThread);
     m_pSecondaryWorkerThread = nullptr;
     StartWorkerThread(m_pSecondaryWorkerThread);
+    m_pAOFastLoop = nullptr;
+    StartAOFastLoop();
 
     m_statusbarTimer.SetOwner(this, STATUSBAR_TIMER_EVENT);
 
@@ -315,6 +319,9 @@ MyFrame::MyFrame()
     pStatsWin = new StatsWindow(this);
     m_mgr.AddPane(pStatsWin, wxAuiPaneInfo().Name(_T("Stats")).Caption(_("Guide Stats")).Hide());
 
+    pPipelineStatsWin = new PipelineStatsWindow(this);
+    m_mgr.AddPane(pPipelineStatsWin, wxAuiPaneInfo().Name(_T("PipelineStats")).Caption(_("Pipeline Timing")).Hide());
+
     pStepGuiderGraph = new GraphStepguiderWindow(this);
     m_mgr.AddPane(pStepGuiderGraph, wxAuiPaneInfo().Name(_T("AOPosition")).Caption(_("AO Position")).Hide());
 
@@ -382,6 +389,7 @@ MyFrame::MyFrame()
         m_mgr.GetPane(_T("Guider")).Caption(_T("Guider"));
         m_mgr.GetPane(_T("GraphLog")).Caption(_("History"));
         m_mgr.GetPane(_T("Stats")).Caption(_("Guide Stats"));
+        m_mgr.GetPane(_T("PipelineStats")).Caption(_("Pipeline Timing"));
         m_mgr.GetPane(_T("AOPosition")).Caption(_("AO Position"));
         m_mgr.GetPane(_T("Profile")).Caption(_("Star Profile"));
         m_mgr.GetPane(_T("Target")).Caption(_("Target"));
@@ -401,6 +409,10 @@ MyFrame::MyFrame()
     pStatsWin->SetState(panel_state);
     Menubar->Check(MENU_STATS, panel_state);
 
+    panel_state = m_mgr.GetPane(_T("PipelineStats")).IsShown();
+    pPipelineStatsWin->SetState(panel_state);
+    Menubar->Check(MENU_PIPELINE_STATS, panel_state);
+
     panel_state = m_mgr.GetPane(_T("AOPosition")).IsShown();
     pStepGuiderGraph->SetState(panel_state);
     Menubar->Check(MENU_AO_GRAPH, panel_state);
@@ -515,6 +527,8 @@ void MyFrame::SetupMenuBar()
     view_menu->AppendCheckItem(MENU_TOOLBAR, _("Display Toolbar"), _("Enable / disable tool bar"));
     view_menu->AppendCheckItem(MENU_GRAPH, _("Display &Graph"), _("Enable / disable graph"));
     view_menu->AppendCheckItem(MENU_STATS, _("Display &Stats"), _("Enable / disable guide stats"));
+    view_menu->AppendCheckItem(MENU_PIPELINE_STATS, _("Display Pipeline &Timing"),
+                               _("Enable / disable frame pipeline latency stats"));
     view_menu->AppendCheckItem(MENU_AO_GRAPH, _("Display &AO Graph"), _("Enable / disable AO graph"));
     view_menu->AppendCheckItem(MENU_TARGET, _("Display &Target"), _("Enable / disable target"));
     view_menu->AppendCheckItem(MENU_STARPROFILE, _("Display Star &Profile"), _("Enable / disable star profile view"));
@@ -1608,6 +1622,41 @@ bool MyFrame::StartWorkerThread(WorkerThread *& pWorkerThread)
     return bError;
 }
 
+void MyFrame::StartAOFastLoop()
+{
+    // the thread always runs so that enabling the fast loop only changes
+    // where AO moves are routed; it sits idle otherwise
+    AOFastLoop *loop = new AOFastLoop(this);
+    if (loop->Run() != wxTHREAD_NO_ERROR)
+    {
+        Debug.Write("Could not Run() the AO fast loop thread\n");
+        delete loop;
+        return;
+    }
+    m_pAOFastLoop = loop;
+}
+
+void MyFrame::StopAOFastLoop()
+{
+    if (m_pAOFastLoop)
+    {
+        m_pAOFastLoop->Stop();
+        delete m_pAOFastLoop;
+        m_pAOFastLoop = nullptr;
+    }
+}
+
+void MyFrame::WaitForAOMoves()
+{
+    enum
+    {
+        AO_MOVE_TIMEOUT_MS = 10000
+    };
+
+    if (m_pAOFastLoop)
+        m_pAOFastLoop->WaitIdle(AO_MOVE_TIMEOUT_MS);
+}
+
 bool MyFrame::StopWorkerThread(WorkerThread *& pWorkerThread)
 {
     bool killed = false;
@@ -1731,6 +1780,12 @@ void MyFrame::SchedulePrimaryMove(Mount *mount, const GuiderOffset& ofs, unsigne
     if ((moveOptions & MOVEOPT_MANUAL) == 0)
         mount->IncrementRequestCount();
 
+    if (m_pAOFastLoop && mount->IsStepGuider() && mount->HasNonGuiMove() && AOFastLoop::IsEnabled())
+    {
+        m_pAOFastLoop->EnqueueMove(mount, ofs, moveOptions);
+        return;
+    }
+
     assert(m_pPrimaryWorkerThread);
     m_pPrimaryWorkerThread->EnqueueWorkerThreadMoveRequest(mount, ofs, moveOptions);
 }
@@ -1817,7 +1872,7 @@ bool MyFrame::StartSingleExposure(int duration, const wxRect& subframe)
     m_singleExposure.duration = duration;
     m_singleExposure.subframe = subframe;
     if (!m_singleExposure.subframe.IsEmpty())
-        m_singleExposure.subframe.Intersect(wxRect(pCamera->FullSize));
+        m_singleExposure.subframe.Intersect(wxRect(pCamera->FrameSize()));
 
     StartCapturing();
 
@@ -2152,6 +2207,7 @@ void MyFrame::OnClose(wxCloseEvent& event)
     bool killed = StopWorkerThread(m_pPrimaryWorkerThread);
     if (StopWorkerThread(m_pSecondaryWorkerThread))
         killed = true;
+    StopAOFastLoop();
 
     // disconnect all gear
     pGearDialog->Shutdown(killed);
@@ -2268,6 +2324,9 @@ void MyFrame::NotifyGuidingStopped()
     if (pSecondaryMount)
         pSecondaryMount->NotifyGuidingStopped();
 
+    if (m_pAOFastLoop)
+        m_pAOFastLoop->LogStats();
+
     EvtServer.NotifyGuidingStopped();
     GuideLog.GuidingStopped();
     PhdController::AbortController("Guiding stopped");
@@ -2765,7 +2824,7 @@ double MyFrame::GetCameraPixelScale() const
     if (!pCamera || pCamera->GetCameraPixelSize() == 0.0 || m_focalLength == 0)
         return 1.0;
 
-    return GetPixelScale(pCamera->GetCameraPixelSize(), m_focalLength, pCamera->Binning);
+    return GetPixelScale(pCamera->GetCameraPixelSize(), m_focalLength, pCamera->TotalBinning());
 }
 
 wxString MyFrame::PixelScaleSummary() const
@@ -2783,7 +2842,8 @@ wxString MyFrame::PixelScaleSummary() const
     else
         focalLengthStr = wxString::Format("%d mm", m_focalLength);
 
-    return wxString::Format("Pixel scale = %s, Binning = %hu, Focal length = %s", scaleStr, pCamera->Binning, focalLengthStr);
+    return wxString::Format("Pixel scale = %s, Binning = %u, Focal length = %s", scaleStr, pCamera->TotalBinning(),
+                            focalLengthStr);
 }
 
 bool MyFrame::GetBeepForLostStar()
@@ -238,6 +238,7 @@ public:
     AdvancedDialog *pAdvancedDialog;
     GraphLogWindow *pGraphLog;
     StatsWindow *pStatsWin;
+    PipelineStatsWindow *pPipelineStatsWin;
     GraphStepguiderWindow *pStepGuiderGraph;
     GearDialog *pGearDialog;
     ProfileWindow *pProfile;
@@ -327,6 +328,7 @@ public:
 #endif
     void OnGraph(wxCommandEvent& evt);
     void OnStats(wxCommandEvent& evt);
+    void OnPipelineStats(wxCommandEvent& evt);
     void OnToolBar(wxCommandEvent& evt);
     void OnAoGraph(wxCommandEvent& evt);
     void OnStarProfile(wxCommandEvent& evt);
@@ -408,6 +410,7 @@ public:
     void ScheduleSecondaryMove(Mount *mount, const GuiderOffset& ofs, unsigned int moveOptions);
     void ScheduleAxisMove(Mount *mount, const GUIDE_DIRECTION direction, int duration, unsigned int moveOptions);
     void ScheduleManualMove(Mount *mount, const GUIDE_DIRECTION direction, int duration);
+    void WaitForAOMoves();
 
     void StartCapturing();
     bool StopCapturing();
@@ -480,6 +483,7 @@ private:
     wxCriticalSection m_CSpWorkerThread;
     WorkerThread *m_pPrimaryWorkerThread;
     WorkerThread *m_pSecondaryWorkerThread;
+    AOFastLoop *m_pAOFastLoop;
 
     wxSocketServer *SocketServer;
     wxTimer m_statusbarTimer;
@@ -495,6 +499,8 @@ private:
 
     bool StartWorkerThread(WorkerThread *& pWorkerThread);
     bool StopWorkerThread(WorkerThread *& pWorkerThread);
+    void StartAOFastLoop();
+    void StopAOFastLoop();
     void OnStatusMsg(wxThreadEvent& event);
     void DoAlert(const alert_params& params);
     void OnAlertButton(wxCommandEvent& evt);
@@ -626,6 +632,7 @@ enum
     MENU_TOOLBAR,
     MENU_GRAPH,
     MENU_STATS,
+    MENU_PIPELINE_STATS,
     MENU_AO_GRAPH,
     MENU_STARPROFILE,
     MENU_RESTORE_WINDOWS,
@@ -423,7 +423,7 @@ static void SuppressRawModeWarning(long)
 
 static void WarnRawImageMode(void)
 {
-    if (pCamera->FullSize != pCamera->DarkFrameSize())
+    if (pCamera->FullSize != pCamera->NativeDarkFrameSize())
     {
         pFrame->SuppressableAlert(RawModeWarningKey(),
                                   _("For refining the Bad-pixel Map PHD2 is now displaying raw camera data frames, which are a "
@@ -816,6 +816,20 @@ void MyFrame::OnStats(wxCommandEvent& evt)
     m_mgr.Update();
 }
 
+void MyFrame::OnPipelineStats(wxCommandEvent& evt)
+{
+    if (evt.IsChecked())
+    {
+        m_mgr.GetPane(_T("PipelineStats")).Show().Bottom().Position(1).MinSize(-1, 240);
+    }
+    else
+    {
+        m_mgr.GetPane(_T("PipelineStats")).Hide();
+    }
+    pPipelineStatsWin->SetState(evt.IsChecked());
+    m_mgr.Update();
+}
+
 void MyFrame::OnAoGraph(wxCommandEvent& evt)
 {
     if (pStepGuiderGraph->SetState(evt.IsChecked()))
@@ -1145,6 +1159,11 @@ void MyFrame::OnPanelClose(wxAuiManagerEvent& evt)
         Menubar->Check(MENU_STATS, false);
         pStatsWin->SetState(false);
     }
+    if (p->name == _T("PipelineStats"))
+    {
+        Menubar->Check(MENU_PIPELINE_STATS, false);
+        pPipelineStatsWin->SetState(false);
+    }
     if (p->name == _T("Profile"))
     {
         Menubar->Check(MENU_STARPROFILE, false);
@@ -59,6 +59,7 @@ GuideCamera *pCamera = nullptr;
 
 DebugLog Debug;
 GuidingLog GuideLog;
+PipelineStats PipelineTiming;
 
 int XWinSize = 640;
 int YWinSize = 512;
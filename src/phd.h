@@ -183,6 +183,9 @@ WX_DEFINE_ARRAY_DOUBLE(double, ArrayOfDbl);
 #include "myframe.h"
 #include "debuglog.h"
 #include "worker_thread.h"
+#include "pipeline_stats.h"
+#include "roi_manager.h"
+#include "ao_fastloop.h"
 #include "event_server.h"
 #include "confirm_dialog.h"
 #include "phdcontrol.h"
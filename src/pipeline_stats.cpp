@@ -0,0 +1,236 @@
+/*
+ *  pipeline_stats.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <chrono>
+
+void LatencyHistogram::Reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_totalUs = 0.0;
+    m_maxUs = 0;
+}
+
+void LatencyHistogram::Add(long long us)
+{
+    if (us < 0)
+        us = 0;
+
+    int bucket = 0;
+    while (bucket < NUM_BUCKETS - 1 && us >= (1LL << bucket))
+        ++bucket;
+
+    ++m_buckets[bucket];
+    ++m_count;
+    m_totalUs += (double) us;
+    if (us > m_maxUs)
+        m_maxUs = us;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    for (int i = 0; i < NUM_BUCKETS; i++)
+        m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+    m_totalUs += other.m_totalUs;
+    if (other.m_maxUs > m_maxUs)
+        m_maxUs = other.m_maxUs;
+}
+
+long long LatencyHistogram::PercentileUs(double p) const
+{
+    if (!m_count)
+        return 0;
+
+    unsigned int target = (unsigned int) ceil(p * m_count);
+    unsigned int sum = 0;
+    for (int i = 0; i < NUM_BUCKETS - 1; i++)
+    {
+        sum += m_buckets[i];
+        if (sum >= target)
+            return wxMin(1LL << i, m_maxUs);
+    }
+    return m_maxUs;
+}
+
+wxString LatencyHistogram::Summary() const
+{
+    return wxString::Format("n=%u mean=%.0fus p50<=%lldus p90<=%lldus p99<=%lldus max=%lldus", m_count, MeanUs(),
+                            PercentileUs(0.5), PercentileUs(0.9), PercentileUs(0.99), m_maxUs);
+}
+
+PipelineStats::PipelineStats()
+{
+    Reset();
+}
+
+long long PipelineStats::NowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+const char *PipelineStats::StageName(PipelineStage stage)
+{
+    switch (stage)
+    {
+    case PIPELINE_CAPTURE:
+        return "capture";
+    case PIPELINE_DARK:
+        return "dark";
+    case PIPELINE_STATS:
+        return "stats";
+    case PIPELINE_FIND:
+        return "find";
+    case PIPELINE_ALGORITHM:
+        return "algorithm";
+    case PIPELINE_DISPATCH:
+        return "dispatch";
+    case PIPELINE_PULSE:
+        return "pulse";
+    case PIPELINE_DISPLAY:
+        return "display";
+    case PIPELINE_TOTAL:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
+
+void PipelineStats::Reset()
+{
+    wxCriticalSectionLocker lck(m_lock);
+
+    for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+    {
+        m_current[i].Reset();
+        m_previous[i].Reset();
+        m_last[i] = 0;
+    }
+    m_frameEndUs = 0;
+    m_frames = 0;
+    m_spikes = 0;
+}
+
+void PipelineStats::AddLocked(PipelineStage stage, long long us)
+{
+    LatencyHistogram& cur = m_current[stage];
+    if (cur.Count() >= WINDOW_SIZE)
+    {
+        m_previous[stage] = cur;
+        cur.Reset();
+    }
+    cur.Add(us);
+    m_last[stage] = us;
+}
+
+void PipelineStats::Add(PipelineStage stage, long long us)
+{
+    wxCriticalSectionLocker lck(m_lock);
+    AddLocked(stage, us);
+}
+
+void PipelineStats::FrameCaptured(long long exposureEndUs)
+{
+    wxCriticalSectionLocker lck(m_lock);
+    m_frameEndUs = exposureEndUs;
+}
+
+void PipelineStats::FrameDisplayed(unsigned int frameNum)
+{
+    long long now = NowUs();
+
+    wxCriticalSectionLocker lck(m_lock);
+
+    if (!m_frameEndUs)
+        return; // frame did not come through the worker thread, e.g. a loaded image
+
+    long long total = now - m_frameEndUs;
+    m_frameEndUs = 0;
+    ++m_frames;
+
+    // compare against the median before this frame is added
+    LatencyHistogram h(m_previous[PIPELINE_TOTAL]);
+    h.Merge(m_current[PIPELINE_TOTAL]);
+    long long median = h.PercentileUs(0.5);
+
+    AddLocked(PIPELINE_TOTAL, total);
+
+    if (h.Count() >= 10 && total >= SPIKE_MIN_US && total > SPIKE_FACTOR * median)
+    {
+        ++m_spikes;
+
+        wxString stages;
+        for (int i = 0; i < PIPELINE_TOTAL; i++)
+            stages += wxString::Format(" %s=%lld", StageName((PipelineStage) i), m_last[i]);
+        Debug.Write(wxString::Format("Pipeline: latency spike frame %u total=%lldus median<=%lldus, last (us):%s\n",
+                                     frameNum, total, median, stages));
+    }
+}
+
+PipelineStats::StageSummary PipelineStats::GetSummary(PipelineStage stage) const
+{
+    wxCriticalSectionLocker lck(m_lock);
+
+    LatencyHistogram h(m_previous[stage]);
+    h.Merge(m_current[stage]);
+
+    StageSummary s;
+    s.count = h.Count();
+    s.meanUs = h.MeanUs();
+    s.p50Us = h.PercentileUs(0.5);
+    s.p90Us = h.PercentileUs(0.9);
+    s.p99Us = h.PercentileUs(0.99);
+    s.maxUs = h.MaxUs();
+    s.lastUs = m_last[stage];
+    return s;
+}
+
+unsigned int PipelineStats::FrameCount() const
+{
+    wxCriticalSectionLocker lck(m_lock);
+    return m_frames;
+}
+
+unsigned int PipelineStats::SpikeCount() const
+{
+    wxCriticalSectionLocker lck(m_lock);
+    return m_spikes;
+}
+
+PipelineTimer::~PipelineTimer()
+{
+    PipelineTiming.Add(m_stage, PipelineStats::NowUs() - m_start);
+}
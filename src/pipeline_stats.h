@@ -0,0 +1,150 @@
+/*
+ *  pipeline_stats.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PIPELINE_STATS_H_INCLUDED
+#define PIPELINE_STATS_H_INCLUDED
+
+// Latency histogram with power-of-two microsecond buckets, cheap enough to
+// update on every frame or AO step
+class LatencyHistogram
+{
+    enum
+    {
+        NUM_BUCKETS = 24, // bucket i counts samples below 2^i us, the last one is open-ended
+    };
+
+    unsigned int m_buckets[NUM_BUCKETS];
+    unsigned int m_count;
+    double m_totalUs;
+    long long m_maxUs;
+
+public:
+    LatencyHistogram() { Reset(); }
+
+    void Reset();
+    void Add(long long us);
+    void Merge(const LatencyHistogram& other);
+
+    unsigned int Count() const { return m_count; }
+    double MeanUs() const { return m_count ? m_totalUs / m_count : 0.0; }
+    long long MaxUs() const { return m_maxUs; }
+    // upper bound of the bucket holding the given fraction of the samples
+    long long PercentileUs(double p) const;
+    wxString Summary() const;
+};
+
+// Stages of the path from the end of an exposure to the guide pulse and the
+// image on screen
+enum PipelineStage
+{
+    PIPELINE_CAPTURE, // camera capture beyond the exposure time: download and driver overhead
+    PIPELINE_DARK, // dark subtraction or defect removal
+    PIPELINE_STATS, // noise reduction and image statistics
+    PIPELINE_FIND, // locating the guide star(s)
+    PIPELINE_ALGORITHM, // guide algorithms
+    PIPELINE_DISPATCH, // guide request waiting to be picked up by a worker
+    PIPELINE_PULSE, // guide pulse or AO step, including the pulse duration
+    PIPELINE_DISPLAY, // image display
+    PIPELINE_TOTAL, // nominal end of exposure to image displayed
+    NUM_PIPELINE_STAGES
+};
+
+/*
+ * Rolling per-stage latency statistics for the guide frame pipeline. Each
+ * stage keeps the current and the previous window of samples so the figures
+ * follow the recent behavior without ever jumping to empty. Stages are
+ * recorded from the main thread, the worker threads and the AO fast loop.
+ */
+class PipelineStats
+{
+    enum
+    {
+        WINDOW_SIZE = 500, // samples per window
+        SPIKE_FACTOR = 4, // a frame is a spike if its total exceeds this multiple of the median
+        SPIKE_MIN_US = 100000, // ignore spikes shorter than this
+    };
+
+    mutable wxCriticalSection m_lock;
+    LatencyHistogram m_current[NUM_PIPELINE_STAGES];
+    LatencyHistogram m_previous[NUM_PIPELINE_STAGES];
+    long long m_last[NUM_PIPELINE_STAGES]; // most recent sample of each stage
+    long long m_frameEndUs; // nominal end of the exposure of the frame in progress, 0 if none
+    unsigned int m_frames;
+    unsigned int m_spikes;
+
+    void AddLocked(PipelineStage stage, long long us);
+
+public:
+    struct StageSummary
+    {
+        unsigned int count;
+        double meanUs;
+        long long p50Us;
+        long long p90Us;
+        long long p99Us;
+        long long maxUs;
+        long long lastUs;
+    };
+
+    PipelineStats();
+
+    static long long NowUs(); // monotonic clock
+    static const char *StageName(PipelineStage stage);
+
+    void Reset();
+    void Add(PipelineStage stage, long long us);
+
+    // a frame was captured; exposureEndUs is when its exposure nominally ended
+    void FrameCaptured(long long exposureEndUs);
+    // the captured frame is on screen, completing its PIPELINE_TOTAL sample
+    void FrameDisplayed(unsigned int frameNum);
+
+    StageSummary GetSummary(PipelineStage stage) const;
+    unsigned int FrameCount() const;
+    unsigned int SpikeCount() const;
+};
+
+// Adds the lifetime of the object to a pipeline stage
+class PipelineTimer
+{
+    PipelineStage m_stage;
+    long long m_start;
+
+public:
+    PipelineTimer(PipelineStage stage) : m_stage(stage), m_start(PipelineStats::NowUs()) { }
+    ~PipelineTimer();
+};
+
+extern PipelineStats PipelineTiming;
+
+#endif // PIPELINE_STATS_H_INCLUDED
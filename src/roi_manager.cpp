@@ -0,0 +1,74 @@
+/*
+ *  roi_manager.cpp
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+const double RoiManager::MOTION_DECAY = 0.9;
+
+void RoiManager::Reset()
+{
+    m_roi = wxRect();
+    m_lastPos.Invalidate();
+    m_motion = 0.;
+}
+
+void RoiManager::AddPosition(const PHD_Point& pos)
+{
+    if (m_lastPos.IsValid())
+        m_motion = wxMax(pos.Distance(m_lastPos), m_motion * MOTION_DECAY);
+    m_lastPos = pos;
+}
+
+const wxRect& RoiManager::Update(const wxRect& needed, const wxSize& fullSize, int searchRegion)
+{
+    if (!m_roi.IsEmpty() && m_roi.Contains(needed) &&
+        needed.GetWidth() * needed.GetHeight() * SHRINK_RATIO >= m_roi.GetWidth() * m_roi.GetHeight())
+    {
+        return m_roi;
+    }
+
+    int slack = wxMin(wxMax((int) ceil(2. * m_motion), (int) MIN_SLACK_PX), searchRegion);
+
+    wxRect roi(needed);
+    roi.Inflate(slack);
+    roi.Intersect(wxRect(fullSize));
+
+    if (roi != m_roi)
+    {
+        Debug.Write(wxString::Format("ROI: readout window %d,%d %dx%d (motion %.1f px)\n", roi.x, roi.y, roi.width,
+                                     roi.height, m_motion));
+        m_roi = roi;
+    }
+
+    return m_roi;
+}
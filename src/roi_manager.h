@@ -0,0 +1,75 @@
+/*
+ *  roi_manager.h
+ *  PHD2 Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of OpenPHDGuiding.org nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef ROI_MANAGER_H_INCLUDED
+#define ROI_MANAGER_H_INCLUDED
+
+// Chooses the readout window for subframe captures. The window covers the
+// search region of every star being tracked plus some slack, and it is only
+// moved or resized when a star's search region would fall outside it or when it
+// has become much larger than needed, so the camera is not reconfigured every
+// frame. The slack follows the recent frame-to-frame star motion.
+class RoiManager
+{
+public:
+    enum
+    {
+        MIN_SLACK_PX = 4,
+        SHRINK_RATIO = 2, // the window is recomputed when it is this many times larger than needed
+    };
+
+    static const double MOTION_DECAY; // per frame decay of the motion peak
+
+private:
+    wxRect m_roi; // current readout window, empty when none has been chosen
+    PHD_Point m_lastPos;
+    double m_motion; // decaying peak of frame-to-frame star motion, pixels
+
+public:
+    RoiManager() : m_motion(0.) { }
+
+    void Reset();
+    void AddPosition(const PHD_Point& pos);
+
+    // the largest window worth reading out before multi-star coverage gives way to
+    // the primary star alone
+    static int MaxArea(const wxSize& fullSize) { return fullSize.GetWidth() * fullSize.GetHeight() / 4; }
+
+    // keeps or replaces the readout window so that it covers the needed area
+    const wxRect& Update(const wxRect& needed, const wxSize& fullSize, int searchRegion);
+
+    const wxRect& Roi() const { return m_roi; }
+    double Motion() const { return m_motion; }
+};
+
+#endif // ROI_MANAGER_H_INCLUDED
@@ -995,14 +995,14 @@ void Scope::CheckCalibrationDuration(int currDuration)
     CalibrationDetails calDetails;
     LoadCalibrationDetails(&calDetails);
 
-    bool binningChange = pCamera->Binning != calDetails.origBinning;
+    bool binningChange = pCamera->TotalBinning() != calDetails.origBinning;
 
     // if binning changed, may need to update the calibration distance
     if (binningChange)
     {
         int prevDistance = GetCalibrationDistance();
-        int newDistance =
-            CalstepDialog::GetCalibrationDistance(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+        int newDistance = CalstepDialog::GetCalibrationDistance(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                                                pCamera->TotalBinning());
 
         if (newDistance != prevDistance)
         {
@@ -1031,8 +1031,9 @@ void Scope::CheckCalibrationDuration(int currDuration)
         return;
 
     int rslt;
-    CalstepDialog::GetCalibrationStepSize(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning, currSpdX,
-                                          CalstepDialog::DEFAULT_STEPS, 0.0, GetCalibrationDistance(), 0, &rslt);
+    CalstepDialog::GetCalibrationStepSize(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
+                                          pCamera->TotalBinning(), currSpdX, CalstepDialog::DEFAULT_STEPS, 0.0,
+                                          GetCalibrationDistance(), 0, &rslt);
 
     wxString why = binningChange ? " binning " : " mount guide speed ";
     Debug.Write(wxString::Format("CalDuration adjusted at start of calibration from %d to %d because of %s change\n",
@@ -1750,11 +1751,12 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
             cal.declination = pPointingSource->GetDeclinationRadians();
             cal.pierSide = pPointingSource->SideOfPier();
             cal.rotatorAngle = Rotator::RotatorPosition();
-            cal.binning = pCamera->Binning;
+            cal.binning = pCamera->TotalBinning();
             SetCalibration(cal);
             m_calibrationDetails.raStepCount = m_raSteps;
             m_calibrationDetails.decStepCount = m_decSteps;
-            SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle, pCamera->Binning);
+            SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle,
+                                  pCamera->TotalBinning());
             if (SANITY_CHECKING_ACTIVE)
                 SanityCheckCalibration(m_prevCalibration, m_prevCalibrationDetails); // method gets "new" info itself
             pFrame->StatusMsg(_("Calibration complete"));
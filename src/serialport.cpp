@@ -35,6 +35,47 @@
 
 #include "phd.h"
 
+SerialTrace::SerialTrace() : m_next(0), m_size(0) { }
+
+void SerialTrace::Add(bool send, const unsigned char *pData, unsigned count)
+{
+    wxCriticalSectionLocker lck(m_lock);
+
+    Record& rec = m_records[m_next];
+    rec.ms = ::wxGetUTCTimeMillis();
+    rec.send = send;
+    rec.count = count;
+    memcpy(rec.data, pData, wxMin(count, (unsigned) MAX_BYTES));
+
+    m_next = (m_next + 1) % MAX_RECORDS;
+    if (m_size < MAX_RECORDS)
+        ++m_size;
+}
+
+void SerialTrace::Dump(const wxString& title)
+{
+    wxCriticalSectionLocker lck(m_lock);
+
+    Debug.Write(wxString::Format("%s: last %u serial transfers\n", title, m_size));
+
+    unsigned idx = (m_next + MAX_RECORDS - m_size) % MAX_RECORDS;
+    for (unsigned i = 0; i < m_size; i++)
+    {
+        const Record& rec = m_records[idx];
+        unsigned n = wxMin(rec.count, (unsigned) MAX_BYTES);
+        Debug.AddBytes(wxString::Format("  %s %s %u bytes", wxDateTime(rec.ms).Format("%H:%M:%S.%l"),
+                                        rec.send ? "sent" : "recv", rec.count),
+                       rec.data, n);
+        idx = (idx + 1) % MAX_RECORDS;
+    }
+}
+
+void SerialTrace::Clear()
+{
+    wxCriticalSectionLocker lck(m_lock);
+    m_next = m_size = 0;
+}
+
 SerialPort::SerialPort(void) { }
 
 SerialPort::~SerialPort(void) { }
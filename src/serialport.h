@@ -36,6 +36,39 @@
 #ifndef SERIALPORT_H_INCLUDED
 #define SERIALPORT_H_INCLUDED
 
+// Fixed-size history of the most recent serial transfers. Recording a transfer
+// is cheap enough to do on every command; the history is only written to the
+// debug log when something goes wrong.
+class SerialTrace
+{
+public:
+    enum
+    {
+        MAX_RECORDS = 64,
+        MAX_BYTES = 24,
+    };
+
+    SerialTrace();
+
+    void Add(bool send, const unsigned char *pData, unsigned count);
+    void Dump(const wxString& title);
+    void Clear();
+
+private:
+    struct Record
+    {
+        wxLongLong ms;
+        bool send;
+        unsigned count;
+        unsigned char data[MAX_BYTES];
+    };
+
+    wxCriticalSection m_lock;
+    Record m_records[MAX_RECORDS];
+    unsigned m_next;
+    unsigned m_size;
+};
+
 class SerialPort
 {
 public:
@@ -65,6 +98,9 @@ public:
 
     virtual bool SetRTS(bool asserted) = 0;
     virtual bool SetDTR(bool asserted) = 0;
+
+protected:
+    SerialTrace m_trace;
 };
 
 #endif // SERIALPORT_H_INCLUDED
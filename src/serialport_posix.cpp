@@ -40,6 +40,27 @@
 # include <unistd.h>
 # include <sys/ioctl.h>
 # include <errno.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <time.h>
+
+// The port is opened non-blocking and all waiting is done in poll() against an
+// absolute deadline, so a timeout is honored to the millisecond instead of being
+// rounded up to the deciseconds of VTIME.
+//
+// O_NONBLOCK only changes what read() and write() do when they cannot make
+// progress, and m_fd is only read or written in ReadAll() and WriteAll(), which
+// wait in poll() on EAGAIN. Callers see the same Send/Receive contract as before:
+// Send returns once every byte is queued, Receive returns once count bytes have
+// arrived or fails when the receive timeout expires. Opening non-blocking also
+// keeps open() from waiting for carrier detect before CLOCAL is set.
+
+static long long NowMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
 wxArrayString SerialPortPosix::GetSerialPortList(void)
 {
@@ -58,6 +79,7 @@ wxArrayString SerialPortPosix::GetSerialPortList(void)
 SerialPortPosix::SerialPortPosix(void)
 {
     m_fd = -1;
+    m_receiveTimeoutMs = 0;
 }
 
 SerialPortPosix::~SerialPortPosix(void)
@@ -76,7 +98,7 @@ bool SerialPortPosix::Connect(const wxString& portName, int baud, int dataBits,
 
     try
     {
-        if ((m_fd = open(portName.mb_str(), O_RDWR | O_NOCTTY)) < 0)
+        if ((m_fd = open(portName.mb_str(), O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0)
         {
             wxString exposeToUser = wxString::Format("open %s failed %s(%d)", portName, strerror((int) errno), (int) errno);
             throw ERROR_INFO("SerialPortPosix::Connect " + exposeToUser);
@@ -247,16 +269,18 @@ bool SerialPortPosix::SetReceiveTimeout(int timeoutMilliSeconds)
 
     Debug.Write(wxString::Format("SerialPortPosix::SetReceiveTimeout %d ms\n", timeoutMilliSeconds));
 
+    m_receiveTimeoutMs = timeoutMilliSeconds;
+
     try
     {
+        // the timeout is enforced by poll() now, but callers still rely on the
+        // input flush that reprogramming VTIME used to do
         struct termios attr;
 
         if (tcgetattr(m_fd, &attr) < 0)
         {
             throw ERROR_INFO("tcgetattr failed");
         }
-        int timeoutDeciSeconds = (timeoutMilliSeconds + 99) / 100;
-        attr.c_cc[VTIME] = (uint8_t) timeoutDeciSeconds;
         if (tcsetattr(m_fd, TCSAFLUSH, &attr) < 0)
         {
             throw ERROR_INFO("tcsetattr failed");
@@ -271,13 +295,57 @@ bool SerialPortPosix::SetReceiveTimeout(int timeoutMilliSeconds)
     return bError;
 }
 
-bool SerialPortPosix::Send(const unsigned char *pData, unsigned int count)
+// wait until the port is ready for events or the deadline passes
+bool SerialPortPosix::WaitFd(short events, long long deadlineMs)
+{
+    bool bError = false;
+
+    try
+    {
+        while (true)
+        {
+            long long rem = deadlineMs - NowMs();
+            int waitMs = rem > 0 ? (int) rem : 0;
+
+            struct pollfd pfd;
+            pfd.fd = m_fd;
+            pfd.events = events;
+            pfd.revents = 0;
+
+            int ret = poll(&pfd, 1, waitMs);
+
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw ERROR_INFO("SerialPortPosix: poll failed " + wxString(strerror(errno)));
+            }
+
+            if (ret == 0)
+                throw ERROR_INFO("SerialPortPosix: timed-out");
+
+            if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+                throw ERROR_INFO("SerialPortPosix: port error or hangup");
+
+            break;
+        }
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+    }
+
+    return bError;
+}
+
+bool SerialPortPosix::WriteAll(const unsigned char *pData, unsigned count)
 {
     bool bError = false;
 
     try
     {
-        Debug.AddBytes("SerialPortPosix::Send", pData, count);
+        m_trace.Add(true, pData, count);
 
         size_t rem = count;
         while (rem > 0)
@@ -285,7 +353,17 @@ bool SerialPortPosix::Send(const unsigned char *pData, unsigned int count)
             ssize_t const nBytesWritten = write(m_fd, pData, rem);
 
             if (nBytesWritten < 0)
-                throw ERROR_INFO("SerialPortPosix: write failed");
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    throw ERROR_INFO("SerialPortPosix: write failed");
+
+                // output queue is full, wait for it to drain
+                if (WaitFd(POLLOUT, NowMs() + 1000))
+                    throw ERROR_INFO("SerialPortPosix: write stalled");
+                continue;
+            }
 
             rem -= nBytesWritten;
             pData += nBytesWritten;
@@ -300,9 +378,10 @@ bool SerialPortPosix::Send(const unsigned char *pData, unsigned int count)
     return bError;
 }
 
-bool SerialPortPosix::Receive(unsigned char *pData, unsigned int count)
+bool SerialPortPosix::ReadAll(unsigned char *pData, unsigned count, long long deadlineMs)
 {
     bool bError = false;
+    unsigned char *const pStart = pData;
 
     try
     {
@@ -312,33 +391,58 @@ bool SerialPortPosix::Receive(unsigned char *pData, unsigned int count)
         {
             ssize_t const receiveCount = read(m_fd, pData, rem);
 
-            if (receiveCount == -1)
-                throw ERROR_INFO("SerialPortPosix: read Failed");
-
-            if (receiveCount == 0)
-                break; // eof
+            if (receiveCount > 0)
+            {
+                rem -= receiveCount;
+                pData += receiveCount;
+                continue;
+            }
 
-            Debug.AddBytes("SerialPortPosix::Receive", pData, receiveCount);
+            if (receiveCount < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                throw ERROR_INFO("SerialPortPosix: read Failed");
 
-            rem -= receiveCount;
-            pData += receiveCount;
+            if (WaitFd(POLLIN, deadlineMs))
+            {
+                throw ERROR_INFO("SerialPortPosix: " + wxString::Format(wxT("%i"), (int) rem) +
+                                 " remaining bytes to read at timeout, expected total of " +
+                                 wxString::Format(wxT("%i"), count));
+            }
         }
 
-        if (rem > 0)
-        {
-            throw ERROR_INFO("SerialPortPosix: " + wxString::Format(wxT("%i"), rem) + " remaining bytes to read at eof " +
-                             ", expected total of " + wxString::Format(wxT("%i"), count));
-        }
+        m_trace.Add(false, pStart, count);
     }
     catch (const wxString& Msg)
     {
         POSSIBLY_UNUSED(Msg);
+        m_trace.Add(false, pStart, pData - pStart);
         bError = true;
     }
 
     return bError;
 }
 
+bool SerialPortPosix::Send(const unsigned char *pData, unsigned int count)
+{
+    if (WriteAll(pData, count))
+    {
+        m_trace.Dump("SerialPortPosix::Send failed");
+        return true;
+    }
+
+    return false;
+}
+
+bool SerialPortPosix::Receive(unsigned char *pData, unsigned int count)
+{
+    if (ReadAll(pData, count, NowMs() + m_receiveTimeoutMs))
+    {
+        m_trace.Dump("SerialPortPosix::Receive failed");
+        return true;
+    }
+
+    return false;
+}
+
 bool SerialPortPosix::SetRTS(bool asserted)
 {
     return true; // TODO
@@ -41,7 +41,7 @@
 
 class SerialPortPosix : public SerialPort
 {
-    int m_fd;
+    int m_receiveTimeoutMs;
 #  if defined(__APPLE__)
     struct termios m_originalAttrs;
 #  endif
@@ -63,6 +63,13 @@ public:
 
     bool SetRTS(bool asserted) override;
     bool SetDTR(bool asserted) override;
+
+protected:
+    int m_fd;
+
+    bool WaitFd(short events, long long deadlineMs);
+    bool WriteAll(const unsigned char *pData, unsigned count);
+    bool ReadAll(unsigned char *pData, unsigned count, long long deadlineMs);
 };
 
 # endif // __linux__ || __APPLE__
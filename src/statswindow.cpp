@@ -38,6 +38,8 @@
 enum
 {
     TIMER_ID_COOLER = 101,
+    TIMER_ID_PIPELINE_REFRESH,
+    BUTTON_PIPELINE_RESET,
 };
 
 // clang-format off
@@ -327,7 +329,7 @@ void StatsWindow::UpdateScopePointing()
         m_grid2->SetCellValue(row++, col, Mount::DeclinationStrTr(declination, "% .1f" DEGREES_SYMBOL));
         m_grid2->SetCellValue(row++, col, Mount::PierSideStrTr(pierSide));
         m_grid2->SetCellValue(row++, col, RotatorPosStr());
-        m_grid2->SetCellValue(row++, col, pCamera ? wxString::Format("%hu", pCamera->Binning) : _("N/A"));
+        m_grid2->SetCellValue(row++, col, pCamera ? wxString::Format("%u", pCamera->TotalBinning()) : _("N/A"));
         m_grid2->EndBatch();
     }
 }
@@ -351,3 +353,130 @@ void StatsWindow::OnButtonClear(wxCommandEvent& evt)
 {
     pFrame->pGraphLog->OnButtonClear(evt);
 }
+
+// clang-format off
+wxBEGIN_EVENT_TABLE(PipelineStatsWindow, wxWindow)
+    EVT_TIMER(TIMER_ID_PIPELINE_REFRESH, PipelineStatsWindow::OnTimerRefresh)
+    EVT_BUTTON(BUTTON_PIPELINE_RESET, PipelineStatsWindow::OnButtonReset)
+wxEND_EVENT_TABLE();
+// clang-format on
+
+static const int PIPELINE_REFRESH_INTERVAL_MS = 1000;
+
+PipelineStatsWindow::PipelineStatsWindow(wxWindow *parent)
+    : wxWindow(parent, wxID_ANY), m_visible(false), m_refreshTimer(this, TIMER_ID_PIPELINE_REFRESH)
+{
+    SetBackgroundColour(*wxBLACK);
+
+    m_grid = new wxGrid(this, wxID_ANY);
+
+    m_grid->CreateGrid(NUM_PIPELINE_STAGES + 1, 6);
+    m_grid->SetRowLabelSize(1);
+    m_grid->SetColLabelSize(1);
+    m_grid->EnableEditing(false);
+    m_grid->SetDefaultCellBackgroundColour(*wxBLACK);
+    m_grid->SetDefaultCellTextColour(*wxLIGHT_GREY);
+    m_grid->SetGridLineColour(wxColour(40, 40, 40));
+
+    int col = 0;
+    m_grid->SetCellValue(0, col++, _("Stage"));
+    m_grid->SetCellValue(0, col++, _("Last [ms]"));
+    m_grid->SetCellValue(0, col++, _("Mean [ms]"));
+    m_grid->SetCellValue(0, col++, _("p90 [ms]"));
+    m_grid->SetCellValue(0, col++, _("p99 [ms]"));
+    m_grid->SetCellValue(0, col++, _("Max [ms]"));
+
+    const wxString stageLabels[NUM_PIPELINE_STAGES] = {
+        _("Capture"), _("Dark"), _("Stats"), _("Find"), _("Algorithm"), _("Dispatch"), _("Pulse"), _("Display"),
+        _("Total"),
+    };
+    for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+    {
+        m_grid->SetCellValue(i + 1, 0, stageLabels[i]);
+        m_grid->SetCellValue(i + 1, 1, _T("99999.9"));
+    }
+
+    m_grid->AutoSize();
+    for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+        m_grid->SetCellValue(i + 1, 1, wxEmptyString);
+    m_grid->ClearSelection();
+    m_grid->DisableDragGridSize();
+
+    wxSizer *sizer1 = new wxBoxSizer(wxHORIZONTAL);
+
+    wxButton *resetButton = new wxButton(this, BUTTON_PIPELINE_RESET, _("Reset"));
+    resetButton->SetToolTip(_("Clear the pipeline timing statistics"));
+    resetButton->SetBackgroundStyle(wxBG_STYLE_TRANSPARENT);
+    sizer1->Add(resetButton, 0, wxALL, 10);
+
+    m_frames = new wxStaticText(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(220, -1));
+    m_frames->SetForegroundColour(*wxLIGHT_GREY);
+    sizer1->Add(m_frames, wxSizerFlags(0).Border(wxALL, 10).Align(wxALIGN_CENTER_VERTICAL));
+
+    wxSizer *sizer2 = new wxBoxSizer(wxVERTICAL);
+
+    sizer2->Add(sizer1, 0, wxEXPAND, 10);
+    sizer2->Add(m_grid, wxSizerFlags(0).Border(wxALL, 10));
+
+    SetSizerAndFit(sizer2);
+}
+
+PipelineStatsWindow::~PipelineStatsWindow(void) { }
+
+void PipelineStatsWindow::SetState(bool is_active)
+{
+    m_visible = is_active;
+    if (m_visible)
+    {
+        UpdateStats();
+        m_refreshTimer.Start(PIPELINE_REFRESH_INTERVAL_MS);
+    }
+    else
+        m_refreshTimer.Stop();
+}
+
+static wxString millis(long long us)
+{
+    return wxString::Format("%.1f", us / 1000.0);
+}
+
+void PipelineStatsWindow::UpdateStats()
+{
+    if (!m_visible)
+        return;
+
+    m_grid->BeginBatch();
+    for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+    {
+        PipelineStats::StageSummary s = PipelineTiming.GetSummary((PipelineStage) i);
+        int row = i + 1, col = 1;
+        if (s.count)
+        {
+            m_grid->SetCellValue(row, col++, millis(s.lastUs));
+            m_grid->SetCellValue(row, col++, millis((long long) s.meanUs));
+            m_grid->SetCellValue(row, col++, millis(s.p90Us));
+            m_grid->SetCellValue(row, col++, millis(s.p99Us));
+            m_grid->SetCellValue(row, col++, millis(s.maxUs));
+        }
+        else
+        {
+            while (col < m_grid->GetNumberCols())
+                m_grid->SetCellValue(row, col++, wxEmptyString);
+        }
+    }
+    m_grid->EndBatch();
+
+    m_frames->SetLabel(wxString::Format(_("Frames: %u, spikes: %u"), PipelineTiming.FrameCount(),
+                                        PipelineTiming.SpikeCount()));
+}
+
+void PipelineStatsWindow::OnTimerRefresh(wxTimerEvent&)
+{
+    UpdateStats();
+}
+
+void PipelineStatsWindow::OnButtonReset(wxCommandEvent&)
+{
+    PipelineTiming.Reset();
+    UpdateStats();
+}
@@ -67,4 +67,25 @@ public:
     wxDECLARE_EVENT_TABLE();
 };
 
+// Per-stage latencies of the frame pipeline, refreshed once a second while shown
+class PipelineStatsWindow : public wxWindow
+{
+    bool m_visible;
+    wxGrid *m_grid;
+    wxStaticText *m_frames;
+    wxTimer m_refreshTimer;
+
+    void OnTimerRefresh(wxTimerEvent&);
+    void OnButtonReset(wxCommandEvent&);
+
+public:
+    PipelineStatsWindow(wxWindow *parent);
+    ~PipelineStatsWindow();
+
+    void UpdateStats();
+    void SetState(bool is_active);
+
+    wxDECLARE_EVENT_TABLE();
+};
+
 #endif
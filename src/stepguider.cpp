@@ -755,9 +755,10 @@ bool StepGuider::UpdateCalibrationState(const PHD_Point& currentLocation)
             m_calibration.pierSide = PIER_SIDE_UNKNOWN;
             m_calibration.raGuideParity = m_calibration.decGuideParity = GUIDE_PARITY_UNKNOWN;
             m_calibration.rotatorAngle = Rotator::RotatorPosition();
-            m_calibration.binning = pCamera->Binning;
+            m_calibration.binning = pCamera->TotalBinning();
             SetCalibration(m_calibration);
-            SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle, pCamera->Binning);
+            SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle,
+                                  pCamera->TotalBinning());
             status0 = _("Calibration complete");
             GuideLog.CalibrationComplete(this);
             Debug.Write("Calibration Complete\n");
@@ -1315,7 +1316,7 @@ void StepGuider::AdjustCalibrationForScopePointing()
 {
     // compensate for binning change
 
-    unsigned short binning = pCamera->Binning;
+    unsigned short binning = pCamera->TotalBinning();
 
     if (binning == m_calibration.binning)
     {
@@ -1432,6 +1433,7 @@ void AOConfigDialogPane::LayoutControls(wxPanel *pParent, BrainCtrlIdMap& CtrlMa
     pAoDetailSizer->Add(GetSizerCtrl(CtrlMap, AD_szBumpPercentage));
     pAoDetailSizer->Add(GetSizerCtrl(CtrlMap, AD_szBumpSteps));
     pAoDetailSizer->Add(GetSingleCtrl(CtrlMap, AD_cbBumpOnDither));
+    pAoDetailSizer->Add(GetSingleCtrl(CtrlMap, AD_cbAOFastLoop));
     wxSizer *blBumpSizer = GetSizerCtrl(CtrlMap, AD_szBumpBLCompCtrls);
     if (blBumpSizer)
         pAoDetailSizer->Add(blBumpSizer);
@@ -1496,6 +1498,11 @@ AOConfigDialogCtrlSet::AOConfigDialogCtrlSet(wxWindow *pParent, Mount *pStepGuid
     m_bumpOnDither = new wxCheckBox(GetParentWindow(AD_cbBumpOnDither), wxID_ANY, _("Bump on dither"));
     AddCtrl(CtrlMap, AD_cbBumpOnDither, m_bumpOnDither, _("Bump the mount to return the AO to center at each dither"));
 
+    m_fastLoop = new wxCheckBox(GetParentWindow(AD_cbAOFastLoop), wxID_ANY, _("Fast AO loop"));
+    AddCtrl(CtrlMap, AD_cbAOFastLoop, m_fastLoop,
+            _("Send AO corrections from a dedicated thread as soon as each star position is measured. "
+              "Reduces latency for short exposures"));
+
     m_pClearAOCalibration = new wxCheckBox(GetParentWindow(AD_cbClearAOCalibration), wxID_ANY, _("Clear AO calibration"));
     m_pClearAOCalibration->Enable(m_pStepGuider && m_pStepGuider->IsConnected());
     AddCtrl(CtrlMap, AD_cbClearAOCalibration, m_pClearAOCalibration,
@@ -1514,6 +1521,7 @@ void AOConfigDialogCtrlSet::LoadValues()
     m_pBumpPercentage->SetValue(m_pStepGuider->GetBumpPercentage());
     m_pBumpMaxStepsPerCycle->SetValue(m_pStepGuider->GetBumpMaxStepsPerCycle());
     m_bumpOnDither->SetValue(m_pStepGuider->m_bumpOnDither);
+    m_fastLoop->SetValue(AOFastLoop::IsEnabled());
     m_pClearAOCalibration->Enable(m_pStepGuider->IsCalibrated());
     m_pClearAOCalibration->SetValue(false);
     m_pEnableAOGuide->SetValue(m_pStepGuider->GetGuidingEnabled());
@@ -1527,6 +1535,7 @@ void AOConfigDialogCtrlSet::UnloadValues()
     m_pStepGuider->SetBumpPercentage(m_pBumpPercentage->GetValue(), true);
     m_pStepGuider->SetBumpMaxStepsPerCycle(m_pBumpMaxStepsPerCycle->GetValue());
     m_pStepGuider->SetBumpOnDither(m_bumpOnDither->GetValue());
+    AOFastLoop::SetEnabled(m_fastLoop->GetValue());
 
     if (m_pClearAOCalibration->IsChecked())
     {
@@ -50,6 +50,7 @@ class AOConfigDialogCtrlSet : ConfigDialogCtrlSet
     wxSpinCtrl *m_pBumpPercentage;
     wxSpinCtrlDouble *m_pBumpMaxStepsPerCycle;
     wxCheckBox *m_bumpOnDither;
+    wxCheckBox *m_fastLoop;
     wxCheckBox *m_pClearAOCalibration;
     wxCheckBox *m_pEnableAOGuide;
 
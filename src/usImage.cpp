@@ -236,7 +236,7 @@ static unsigned char *buildGammaLookupTable(int blevel, int wlevel, double power
     if (blevel > 0xffff)
         blevel = 0xffff;
     if (wlevel > 0xffff)
-        blevel = 0xffff;
+        wlevel = 0xffff;
 
     for (int i = 0; i <= blevel; ++i)
         result[i] = 0;
@@ -326,7 +326,7 @@ bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
         if (pCamera)
         {
             hdr.write("INSTRUME", pCamera->Name.c_str(), "Instrument name");
-            unsigned int b = pCamera->Binning;
+            unsigned int b = pCamera->TotalBinning();
             hdr.write("XBINNING", b, "Camera X Bin");
             hdr.write("YBINNING", b, "Camera Y Bin");
             hdr.write("CCDXBIN", b, "Camera X Bin");
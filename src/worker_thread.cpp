@@ -36,7 +36,8 @@
 #include "phd.h"
 
 WorkerThread::WorkerThread(MyFrame *pFrame)
-    : wxThread(wxTHREAD_JOINABLE), m_interruptRequested(0), m_killable(true), m_skipSendExposeComplete(false)
+    : wxThread(wxTHREAD_JOINABLE), m_interruptRequested(0), m_killable(true), m_waiter(nullptr),
+      m_sleeper(new ExposureCompletion()), m_skipSendExposeComplete(false)
 {
     m_pFrame = pFrame;
     Debug.Write("WorkerThread constructor called\n");
@@ -45,6 +46,22 @@ WorkerThread::WorkerThread(MyFrame *pFrame)
 WorkerThread::~WorkerThread(void)
 {
     Debug.Write("WorkerThread destructor called\n");
+    delete m_sleeper;
+}
+
+ExposureCompletion *WorkerThread::SetWaiter(ExposureCompletion *waiter)
+{
+    wxCriticalSectionLocker lck(m_waiterLock);
+    ExposureCompletion *prev = m_waiter;
+    m_waiter = waiter;
+    return prev;
+}
+
+void WorkerThread::WakeWaiter()
+{
+    wxCriticalSectionLocker lck(m_waiterLock);
+    if (m_waiter)
+        m_waiter->Wake();
 }
 
 void WorkerThread::EnqueueMessage(const WORKER_THREAD_REQUEST& message)
@@ -72,6 +89,7 @@ void WorkerThread::EnqueueMessage(const WORKER_THREAD_REQUEST& message)
 void WorkerThread::EnqueueWorkerThreadTerminateRequest(void)
 {
     m_interruptRequested = INT_STOP | INT_TERMINATE;
+    WakeWaiter();
 
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
@@ -104,32 +122,96 @@ void WorkerThread::EnqueueWorkerThreadExposeRequest(usImage *pImage, int exposur
 
 unsigned int WorkerThread::MilliSleep(int ms, unsigned int checkInterrupts)
 {
-    enum
-    {
-        MAX_SLEEP = 100
-    };
+    WorkerThread *thr = WorkerThread::This();
 
-    if (ms <= MAX_SLEEP)
+    if (!thr)
     {
         if (ms > 0)
             wxMilliSleep(ms);
-        return WorkerThread::InterruptRequested() & checkInterrupts;
+        return 0;
     }
 
-    WorkerThread *thr = WorkerThread::This();
+    // the sleeper is never signaled, so this returns when the time is up or
+    // as soon as one of the requested interrupts arrives
+    if (ms > 0)
+        thr->m_sleeper->Wait(ms, checkInterrupts);
+
+    return thr->m_interruptRequested & checkInterrupts;
+}
+
+ExposureCompletion::ExposureCompletion() : m_cond(m_lock), m_signaled(false) { }
+
+void ExposureCompletion::Reset()
+{
+    wxMutexLocker lck(m_lock);
+    m_signaled = false;
+}
+
+void ExposureCompletion::Signal()
+{
+    wxMutexLocker lck(m_lock);
+    m_signaled = true;
+    m_cond.Broadcast();
+}
+
+void ExposureCompletion::Wake()
+{
+    // taking the lock ensures a waiter that has just checked the interrupt
+    // flags is blocked in WaitTimeout before the broadcast
+    wxMutexLocker lck(m_lock);
+    m_cond.Broadcast();
+}
+
+ExposureCompletion::Result ExposureCompletion::Wait(const Watchdog& watchdog, unsigned int checkInterrupts)
+{
+    return WaitUntil(watchdog, watchdog.TimeoutMs(), checkInterrupts);
+}
+
+ExposureCompletion::Result ExposureCompletion::Wait(long timeoutMs, unsigned int checkInterrupts)
+{
     wxStopWatch swatch;
+    return WaitUntil(swatch, timeoutMs, checkInterrupts);
+}
 
-    long elapsed = 0;
-    do
+ExposureCompletion::Result ExposureCompletion::WaitUntil(const wxStopWatch& swatch, long timeoutMs,
+                                                         unsigned int checkInterrupts)
+{
+    // Register with the worker thread before looking at the interrupt flags.
+    // An interrupt requested before that is seen by the check below, one
+    // requested after it wakes the condition.
+    WorkerThread *thr = WorkerThread::This();
+    ExposureCompletion *prev = thr ? thr->SetWaiter(this) : nullptr;
+
+    Result result;
     {
-        wxMilliSleep(wxMin((long) ms - elapsed, (long) MAX_SLEEP));
-        unsigned int val = thr ? (thr->m_interruptRequested & checkInterrupts) : 0;
-        if (val)
-            return val;
-        elapsed = swatch.Time();
-    } while (elapsed < ms);
-
-    return 0;
+        wxMutexLocker lck(m_lock);
+        while (true)
+        {
+            if (m_signaled)
+            {
+                m_signaled = false;
+                result = COMPLETED;
+                break;
+            }
+            if (thr && (thr->m_interruptRequested & checkInterrupts))
+            {
+                result = INTERRUPTED;
+                break;
+            }
+            long remaining = timeoutMs - swatch.Time();
+            if (remaining <= 0)
+            {
+                result = TIMED_OUT;
+                break;
+            }
+            m_cond.WaitTimeout(remaining);
+        }
+    }
+
+    if (thr)
+        thr->SetWaiter(prev);
+
+    return result;
 }
 
 void WorkerThread::SetSkipExposeComplete()
@@ -184,6 +266,11 @@ bool WorkerThread::HandleExpose(EXPOSE_REQUEST *req)
             throw ERROR_INFO("Time lapse interrupted");
         }
 
+        // do not start integrating until the AO has finished moving
+        m_pFrame->WaitForAOMoves();
+
+        long long captureStart = PipelineStats::NowUs();
+
         if (pCamera->HasNonGuiCapture())
         {
             Debug.Write(wxString::Format("Handling exposure in thread, d=%d o=%x r=(%d,%d,%d,%d)\n", req->exposureDuration,
@@ -219,6 +306,13 @@ bool WorkerThread::HandleExpose(EXPOSE_REQUEST *req)
 
         if (!bError)
         {
+            // whatever the capture took beyond the exposure time is download and driver overhead
+            long long exposureEnd = captureStart + req->exposureDuration * 1000LL;
+            PipelineTiming.Add(PIPELINE_CAPTURE, wxMax(0LL, PipelineStats::NowUs() - exposureEnd));
+            PipelineTiming.FrameCaptured(exposureEnd);
+
+            PipelineTimer timer(PIPELINE_STATS);
+
             CameraROITest(req->pImage);
 
             switch (m_pFrame->GetNoiseReductionMethod())
@@ -226,7 +320,8 @@ bool WorkerThread::HandleExpose(EXPOSE_REQUEST *req)
             case NR_NONE:
                 break;
             case NR_2x2MEAN:
-                QuickLRecon(*req->pImage);
+                // noise reduction, not debayering, so it must not depend on the camera's debayer setting
+                LumRecon(*req->pImage, DEBAYER_SLIDING_2X2, BAYER_RGGB);
                 break;
             case NR_3x3MEDIAN:
                 Median3(*req->pImage);
@@ -270,6 +365,7 @@ void WorkerThread::EnqueueWorkerThreadMoveRequest(Mount *mount, const GuiderOffs
     message.args.move.axisMove = false;
     message.args.move.ofs = ofs;
     message.args.move.moveOptions = moveOptions;
+    message.args.move.enqueuedUs = PipelineStats::NowUs();
     message.args.move.semaphore = nullptr;
 
     EnqueueMessage(message);
@@ -300,8 +396,15 @@ void WorkerThread::HandleMove(MOVE_REQUEST *req)
 {
     Mount::MOVE_RESULT result = Mount::MOVE_OK;
 
+    if (!req->axisMove)
+        PipelineTiming.Add(PIPELINE_DISPATCH, PipelineStats::NowUs() - req->enqueuedUs);
+
     try
     {
+        // AO offset moves may be running on the AO fast loop thread
+        if (req->mount->IsStepGuider())
+            m_pFrame->WaitForAOMoves();
+
         if (req->mount->HasNonGuiMove())
         {
             if (req->axisMove)
@@ -36,6 +36,8 @@
 #ifndef WORKER_THREAD_H_INCLUDED
 #define WORKER_THREAD_H_INCLUDED
 
+class ExposureCompletion;
+
 class MyFrame;
 
 /*
@@ -75,6 +77,7 @@ struct MOVE_REQUEST
     unsigned int moveOptions;
     Mount::MOVE_RESULT moveResult;
     GuiderOffset ofs;
+    long long enqueuedUs; // PipelineStats::NowUs() when the request was queued
     wxSemaphore *semaphore;
 };
 
@@ -89,6 +92,8 @@ struct MoveCompleteEvent : public wxThreadEvent
 
 class WorkerThread : public wxThread
 {
+    friend class ExposureCompletion;
+
     // types and routines for the server->worker message queue
     enum WORKER_REQUEST_TYPE
     {
@@ -115,6 +120,9 @@ class WorkerThread : public wxThread
     MyFrame *m_pFrame;
     volatile unsigned int m_interruptRequested;
     volatile bool m_killable;
+    wxCriticalSection m_waiterLock; // protects m_waiter
+    ExposureCompletion *m_waiter; // completion the thread is blocked on, woken by interrupt requests
+    ExposureCompletion *m_sleeper; // used by MilliSleep
     wxMessageQueue<bool> m_wakeupQueue;
     wxMessageQueue<WORKER_THREAD_REQUEST> m_highPriorityQueue;
     wxMessageQueue<WORKER_THREAD_REQUEST> m_lowPriorityQueue;
@@ -171,6 +179,9 @@ public:
     bool IsKillable() const;
     bool SetKillable(bool killable);
 
+    ExposureCompletion *SetWaiter(ExposureCompletion *waiter);
+    void WakeWaiter();
+
 protected:
     // there is no struct ARGS_TERMINATE
     // there is no HandleTerminate(ARGS_TERMINATE *pArgs) routine
@@ -204,11 +215,13 @@ protected:
 inline void WorkerThread::RequestStop(void)
 {
     m_interruptRequested |= INT_STOP;
+    WakeWaiter();
 }
 
 inline WorkerThread *WorkerThread::This(void)
 {
-    return static_cast<WorkerThread *>(wxThread::This());
+    // other background threads (RunInBg, driver threads) call the static helpers too
+    return dynamic_cast<WorkerThread *>(wxThread::This());
 }
 
 inline unsigned int WorkerThread::InterruptRequested(void)
@@ -263,9 +276,50 @@ class Watchdog : public wxStopWatch
 public:
     Watchdog(unsigned int timeout_ms, unsigned int grace_period_ms) : m_timeout_ms(timeout_ms + grace_period_ms) { }
     bool Expired(void) const { return Time() > m_timeout_ms; }
+    long TimeoutMs(void) const { return m_timeout_ms; }
 };
 
 typedef Watchdog CameraWatchdog;
 typedef Watchdog MountWatchdog;
 
+/*
+ * Lets a worker thread block until a camera driver reports that a frame
+ * has arrived, without polling. Signal() can be called from any thread,
+ * typically an SDK or INDI callback. Wait() returns as soon as the
+ * completion is signaled, the worker thread is interrupted, or the
+ * watchdog expires.
+ *
+ * The completion resets itself when Wait() returns COMPLETED, so each
+ * Signal() satisfies one Wait(). Call Reset() before starting an exposure
+ * to discard a signal left over from a previous frame.
+ */
+class ExposureCompletion
+{
+    wxMutex m_lock;
+    wxCondition m_cond;
+    bool m_signaled;
+
+    friend class WorkerThread;
+    void Wake();
+
+public:
+    enum Result
+    {
+        COMPLETED,
+        INTERRUPTED,
+        TIMED_OUT,
+    };
+
+    ExposureCompletion();
+
+    void Reset();
+    void Signal();
+
+    Result Wait(const Watchdog& watchdog, unsigned int checkInterrupts = WorkerThread::INT_ANY);
+    Result Wait(long timeoutMs, unsigned int checkInterrupts = WorkerThread::INT_ANY);
+
+private:
+    Result WaitUntil(const wxStopWatch& swatch, long timeoutMs, unsigned int checkInterrupts);
+};
+
 #endif /* WORKER_THREAD_H_INCLUDED */
@@ -253,6 +253,16 @@ else()
 endif()
 
 
+##############################################
+# zlib (log archive compression)
+
+# on Windows zlib comes with cfitsio above
+if(NOT WIN32)
+  find_package(ZLIB REQUIRED)
+  include_directories(${ZLIB_INCLUDE_DIRS})
+  set(PHD_LINK_EXTERNAL ${PHD_LINK_EXTERNAL} ${ZLIB_LIBRARIES})
+endif()
+
 
 ##############################################
 # VidCapture